@@ -0,0 +1,50 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifndef ARCHIVE_CACHE_H
+#define ARCHIVE_CACHE_H
+
+#include <mgba-util/common.h>
+
+CXX_GUARD_START
+
+#include <mgba-util/threading.h>
+
+// Decompressed archive entries are kept as plain files in a directory, named after the
+// archive's path and modification time and the entry's CRC32, so they can be mapped
+// directly on later opens, including from other processes sharing the directory.
+struct ArchiveCache {
+	char path[PATH_MAX];
+	size_t maxSize;
+
+	Mutex mutex;
+	uint64_t hits;
+	uint64_t misses;
+};
+
+struct VDir;
+struct VFile;
+
+bool ArchiveCacheInit(struct ArchiveCache*, const char* path, size_t maxSize);
+void ArchiveCacheDeinit(struct ArchiveCache*);
+
+// Returns a file that may be mapped without decompressing, extracting the entry into
+// the cache first if needed. Returns NULL if the entry can't be cached.
+struct VFile* ArchiveCacheOpenFile(struct ArchiveCache*, const char* archivePath, struct VDir* archive, const char* name, uint32_t crc32);
+// Deletes the least recently used entries until the cache fits in maxSize.
+void ArchiveCacheTrim(struct ArchiveCache*);
+
+// Wraps an archive so that read-only opens go through the cache. Entries whose CRC32
+// can't be looked up with entryCRC32 are opened from the archive directly.
+struct VDir* ArchiveCacheWrap(struct ArchiveCache*, const char* archivePath, struct VDir* archive,
+                              bool (*entryCRC32)(struct VDir*, const char* name, uint32_t* crc32));
+
+// When set, VDirOpenArchive wraps every archive it opens with this cache
+void ArchiveCacheSetDefault(struct ArchiveCache*);
+struct ArchiveCache* ArchiveCacheGetDefault(void);
+
+CXX_GUARD_END
+
+#endif
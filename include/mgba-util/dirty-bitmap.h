@@ -0,0 +1,57 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifndef DIRTY_BITMAP_H
+#define DIRTY_BITMAP_H
+
+#include <mgba-util/common.h>
+
+CXX_GUARD_START
+
+#define DIRTY_PAGE_SHIFT 8
+#define DIRTY_PAGE_SIZE (1 << DIRTY_PAGE_SHIFT)
+
+// One bit per DIRTY_PAGE_SIZE bytes of a tracked buffer. A bitmap with no
+// storage (bits == NULL) is inert: marking it is a no-op, so tracking can be
+// left compiled into hot paths and switched on by allocating the bitmap.
+struct DirtyBitmap {
+	uint32_t* bits;
+	size_t pages;
+};
+
+void DirtyBitmapInit(struct DirtyBitmap* bitmap, size_t size);
+void DirtyBitmapDeinit(struct DirtyBitmap* bitmap);
+
+void DirtyBitmapClear(struct DirtyBitmap* bitmap);
+void DirtyBitmapFill(struct DirtyBitmap* bitmap);
+void DirtyBitmapMarkRange(struct DirtyBitmap* bitmap, size_t offset, size_t size);
+size_t DirtyBitmapCount(const struct DirtyBitmap* bitmap);
+
+// Copy `src` over the tracked buffer `dest`, marking only the pages whose
+// contents actually change. Falls back to a plain copy if tracking is off.
+void DirtyBitmapCopy(struct DirtyBitmap* bitmap, void* dest, const void* src, size_t size);
+
+// Mirror a bitmap tracking a buffer of `size` bytes that is stored at `offset`
+// within the buffer tracked by `dest`. Pages of `dest` wholly inside that span
+// are cleared unless the corresponding pages of `src` are dirty; pages only
+// partially covered by it are left untouched.
+void DirtyBitmapProject(struct DirtyBitmap* dest, size_t offset, const struct DirtyBitmap* src, size_t size);
+
+#ifndef PYCPARSE
+static inline void DirtyBitmapMark(struct DirtyBitmap* bitmap, size_t offset) {
+	if (bitmap->bits) {
+		size_t page = offset >> DIRTY_PAGE_SHIFT;
+		bitmap->bits[page >> 5] |= 1U << (page & 31);
+	}
+}
+
+static inline bool DirtyBitmapTest(const struct DirtyBitmap* bitmap, size_t page) {
+	return bitmap->bits[page >> 5] & (1U << (page & 31));
+}
+#endif
+
+CXX_GUARD_END
+
+#endif
@@ -12,6 +12,20 @@ CXX_GUARD_START
 
 uint32_t hash32(const void* key, int len, uint32_t seed);
 
+// Incremental 128-bit hash; feeding data in pieces gives the same result as hashing it at once
+struct Hash128 {
+	uint64_t h1;
+	uint64_t h2;
+	uint8_t tail[16];
+	size_t tailSize;
+	uint64_t length;
+};
+
+void hash128Init(struct Hash128*, uint32_t seed);
+void hash128Update(struct Hash128*, const void* key, size_t len);
+void hash128Finish(struct Hash128*, uint64_t out[2]);
+void hash128(const void* key, size_t len, uint32_t seed, uint64_t out[2]);
+
 CXX_GUARD_END
 
 #endif
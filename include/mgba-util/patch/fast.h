@@ -10,6 +10,7 @@
 
 CXX_GUARD_START
 
+#include <mgba-util/dirty-bitmap.h>
 #include <mgba-util/patch.h>
 #include <mgba-util/vector.h>
 
@@ -32,6 +33,9 @@ struct PatchFast {
 void initPatchFast(struct PatchFast*);
 void deinitPatchFast(struct PatchFast*);
 bool diffPatchFast(struct PatchFast* patch, const void* restrict in, const void* restrict out, size_t size);
+// Only pages marked in the mask (or past its end) are compared; clean pages are
+// assumed to be identical in both buffers.
+bool diffPatchFastMasked(struct PatchFast* patch, const void* restrict in, const void* restrict out, size_t size, const struct DirtyBitmap* mask);
 
 CXX_GUARD_END
 
@@ -0,0 +1,43 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <mgba-util/common.h>
+
+CXX_GUARD_START
+
+#include <mgba-util/threading.h>
+
+typedef void (*ThreadPoolJob)(void* context, size_t index);
+
+struct ThreadPool {
+	const char* name;
+	ThreadPoolJob job;
+	void* context;
+
+	// Jobs [next, end) are waiting to be claimed; finished counts the ones done so far
+	size_t next;
+	size_t end;
+	size_t finished;
+	bool shutdown;
+
+	Mutex mutex;
+	Condition work;
+	Condition done;
+	Thread* threads;
+	size_t nThreads;
+};
+
+// The thread calling ThreadPoolRun takes jobs too, so a pool of one thread starts no workers
+void ThreadPoolInit(struct ThreadPool* pool, size_t threads, const char* name);
+void ThreadPoolDeinit(struct ThreadPool* pool);
+// Calls job(context, i) for each i below count, and returns once they have all finished
+void ThreadPoolRun(struct ThreadPool* pool, size_t count, ThreadPoolJob job, void* context);
+
+CXX_GUARD_END
+
+#endif
@@ -81,10 +81,12 @@ struct VDir* VDirOpenArchive(const char* path);
 
 #if defined(USE_LIBZIP) || defined(USE_ZLIB)
 struct VDir* VDirOpenZip(const char* path, int flags);
+bool VDirZipEntryCRC32(struct VDir* dir, const char* path, uint32_t* crc32);
 #endif
 
 #ifdef USE_LZMA
 struct VDir* VDirOpen7z(const char* path, int flags);
+bool VDir7zEntryCRC32(struct VDir* dir, const char* path, uint32_t* crc32);
 #endif
 
 #if defined(__wii__) || defined(_3DS) || defined(PSP2)
@@ -44,9 +44,29 @@ struct mCheat {
 	int32_t operandOffset;
 };
 
+struct mCheatOp {
+	struct mCheat cheat;
+	// Index into the program's block table, or -1 if the cheat has to go through the bus
+	int block;
+	uint32_t offset;
+};
+
+#define mCHEAT_MAX_DIRECT_BLOCKS 8
+
 mLOG_DECLARE_CATEGORY(CHEATS);
 
 DECLARE_VECTOR(mCheatList, struct mCheat);
+DECLARE_VECTOR(mCheatOpList, struct mCheatOp);
+
+struct mCoreMemoryBlock;
+struct mCheatProgram {
+	struct mCheatOpList ops;
+	struct mCheatList source;
+	const struct mCoreMemoryBlock* memoryBlocks;
+	size_t blockIds[mCHEAT_MAX_DIRECT_BLOCKS];
+	uint32_t blockExtents[mCHEAT_MAX_DIRECT_BLOCKS];
+	size_t nBlocks;
+};
 
 struct mCheatDevice;
 struct mCheatSet {
@@ -67,6 +87,8 @@ struct mCheatSet {
 	char* name;
 	bool enabled;
 	struct StringList lines;
+
+	struct mCheatProgram program;
 };
 
 DECLARE_VECTOR(mCheatSets, struct mCheatSet*);
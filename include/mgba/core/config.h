@@ -33,6 +33,7 @@ struct mCoreOptions {
 	int frameskip;
 	bool rewindEnable;
 	int rewindBufferCapacity;
+	int runAhead;
 	float fpsTarget;
 	size_t audioBuffers;
 	unsigned sampleRate;
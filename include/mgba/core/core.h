@@ -38,8 +38,12 @@ enum mCoreChecksumType {
 
 struct mCoreConfig;
 struct mCoreSync;
+struct DirtyBitmap;
+struct Hash128;
 struct mDebuggerSymbols;
+struct mProfile;
 struct mStateExtdata;
+struct mStateSlots;
 struct mVideoLogContext;
 struct mCore {
 	void* cpu;
@@ -50,6 +54,8 @@ struct mCore {
 
 #if !defined(MINIMAL_CORE) || MINIMAL_CORE < 2
 	struct mDirectorySet dirs;
+	// If set, quick-save slots it has room for are kept there instead of in separate files
+	struct mStateSlots* stateSlots;
 #endif
 #ifndef MINIMAL_CORE
 	struct mInputMap inputMap;
@@ -80,6 +86,8 @@ struct mCore {
 	void (*addCoreCallbacks)(struct mCore*, struct mCoreCallbacks*);
 	void (*clearCoreCallbacks)(struct mCore*);
 	void (*setAVStream)(struct mCore*, struct mAVStream*);
+	void (*enableOutput)(struct mCore*, bool video, bool audio);
+	void (*setProfile)(struct mCore*, struct mProfile*);
 
 	bool (*isROM)(struct VFile* vf);
 	bool (*loadROM)(struct mCore*, struct VFile* vf);
@@ -101,10 +109,12 @@ struct mCore {
 	size_t (*stateSize)(struct mCore*);
 	bool (*loadState)(struct mCore*, const void* state);
 	bool (*saveState)(struct mCore*, void* state);
+	void (*hashState)(struct mCore*, struct Hash128*);
 
 	void (*setKeys)(struct mCore*, uint32_t keys);
 	void (*addKeys)(struct mCore*, uint32_t keys);
 	void (*clearKeys)(struct mCore*, uint32_t keys);
+	uint32_t (*getKeys)(struct mCore*);
 
 	int32_t (*frameCounter)(const struct mCore*);
 	int32_t (*frameCycles)(const struct mCore*);
@@ -134,6 +144,11 @@ struct mCore {
 	size_t (*listMemoryBlocks)(const struct mCore*, const struct mCoreMemoryBlock**);
 	void* (*getMemoryBlock)(struct mCore*, size_t id, size_t* sizeOut);
 
+	void (*setDirtyTracking)(struct mCore*, bool enable);
+	struct DirtyBitmap* (*getDirtyPages)(struct mCore*, size_t id);
+	void (*clearDirtyPages)(struct mCore*);
+	bool (*stateDirtyPages)(struct mCore*, struct DirtyBitmap* pages);
+
 #ifdef USE_DEBUGGERS
 	bool (*supportsDebuggerType)(struct mCore*, enum mDebuggerType);
 	struct mDebuggerPlatform* (*debuggerPlatform)(struct mCore*);
@@ -187,6 +202,11 @@ enum mPlatform mCoreIsCompatible(struct VFile* vf);
 bool mCoreSaveStateNamed(struct mCore* core, struct VFile* vf, int flags);
 bool mCoreLoadStateNamed(struct mCore* core, struct VFile* vf, int flags);
 
+// A 128-bit hash of what the game can observe, computed from the live core rather than from a
+// savestate. Timing and host details are left out, so hashes can be compared between machines
+// and versions. hash[0] can be used on its own as a 64-bit hash.
+void mCoreHashState(struct mCore* core, uint64_t hash[2]);
+
 void mCoreInitConfig(struct mCore* core, const char* port);
 void mCoreLoadConfig(struct mCore* core);
 void mCoreLoadForeignConfig(struct mCore* core, const struct mCoreConfig* config);
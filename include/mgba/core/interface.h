@@ -171,6 +171,8 @@ enum mCoreMemoryBlockFlags {
 	mCORE_MEMORY_RW = 0x03,
 	mCORE_MEMORY_MAPPED = 0x10,
 	mCORE_MEMORY_VIRTUAL = 0x20,
+	// Plain memory: accessing it through the host pointer is equivalent to going through the bus
+	mCORE_MEMORY_DIRECT = 0x40,
 };
 
 struct mCoreMemoryBlock {
@@ -10,6 +10,14 @@
 
 CXX_GUARD_START
 
+#include <mgba/core/timing.h>
+#include <mgba-util/thread-pool.h>
+
+#define mLOCKSTEP_MAX_NODES 4
+
+struct mCore;
+struct mLockstepScheduler;
+
 enum mLockstepPhase {
 	TRANSFER_IDLE = 0,
 	TRANSFER_STARTING,
@@ -22,6 +30,8 @@ struct mLockstep {
 	int attached;
 	enum mLockstepPhase transferActive;
 	int32_t transferCycles;
+	// Cycles a node may run ahead while no transfer is pending; 0 selects the platform default
+	int32_t window;
 
 	bool (*signal)(struct mLockstep*, unsigned mask);
 	bool (*wait)(struct mLockstep*, unsigned mask);
@@ -29,6 +39,12 @@ struct mLockstep {
 	int32_t (*useCycles)(struct mLockstep*, int id, int32_t cycles);
 	void (*unload)(struct mLockstep*, int id);
 	void* context;
+
+	// Filled in by the platform: runs node id's side of a sync from outside its core's run loop,
+	// returning how many cycles the nodes should run until the next one
+	int32_t (*syncNode)(struct mLockstep*, int id);
+	// Set while an mLockstepScheduler drives the nodes, in which case they never sync on their own
+	struct mLockstepScheduler* scheduler;
 #ifndef NDEBUG
 	int transferId;
 #endif
@@ -36,6 +52,30 @@ struct mLockstep {
 
 void mLockstepInit(struct mLockstep*);
 
+struct mLockstepSchedulerNode {
+	struct mCore* core;
+	struct mTimingEvent barrier;
+	bool stopped;
+};
+
+// Runs linked cores in rounds: every core runs up to the same cycle on its own, then all of
+// them sync in player order on one thread. Given the same inputs the result doesn't depend on
+// how many threads there are or how they're scheduled.
+struct mLockstepScheduler {
+	struct mLockstep* lockstep;
+	struct mLockstepSchedulerNode nodes[mLOCKSTEP_MAX_NODES];
+	int nNodes;
+	uint64_t rounds;
+
+	struct ThreadPool pool;
+};
+
+void mLockstepSchedulerInit(struct mLockstepScheduler*, struct mLockstep*, size_t threads);
+void mLockstepSchedulerDeinit(struct mLockstepScheduler*);
+// Cores go in the same order as their nodes, once they've been reset and their nodes attached
+bool mLockstepSchedulerAttachCore(struct mLockstepScheduler*, struct mCore*);
+void mLockstepSchedulerRunFrames(struct mLockstepScheduler*, unsigned frames);
+
 CXX_GUARD_END
 
 #endif
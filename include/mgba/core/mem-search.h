@@ -49,10 +49,33 @@ struct mCoreMemorySearchResult {
 
 DECLARE_VECTOR(mCoreMemorySearchResults, struct mCoreMemorySearchResult);
 
+struct mCoreMemorySnapshotBlock {
+	size_t id;
+	uint32_t start;
+	size_t size;
+	uint8_t* data;
+};
+
+DECLARE_VECTOR(mCoreMemorySnapshotBlocks, struct mCoreMemorySnapshotBlock);
+
+struct mCoreMemorySnapshot {
+	struct mCoreMemorySnapshotBlocks blocks;
+};
+
 struct mCore;
 void mCoreMemorySearch(struct mCore* core, const struct mCoreMemorySearchParams* params, struct mCoreMemorySearchResults* out, size_t limit);
 void mCoreMemorySearchRepeat(struct mCore* core, const struct mCoreMemorySearchParams* params, struct mCoreMemorySearchResults* inout);
 
+void mCoreMemorySnapshotInit(struct mCoreMemorySnapshot*);
+void mCoreMemorySnapshotDeinit(struct mCoreMemorySnapshot*);
+void mCoreMemorySnapshotTake(struct mCore* core, int memoryFlags, struct mCoreMemorySnapshot*);
+
+// Compare against the values in a snapshot instead of a known value, e.g. for searching for something whose value is
+// unknown. EQUAL finds unchanged values, GREATER and LESS find increased and decreased ones, and DELTA finds values that
+// changed by exactly params->valueInt. Only integer searches are supported.
+void mCoreMemorySearchSnapshot(struct mCore* core, const struct mCoreMemorySearchParams* params, const struct mCoreMemorySnapshot*, struct mCoreMemorySearchResults* out, size_t limit);
+void mCoreMemorySearchRepeatSnapshot(struct mCore* core, const struct mCoreMemorySearchParams* params, const struct mCoreMemorySnapshot*, struct mCoreMemorySearchResults* inout);
+
 CXX_GUARD_END
 
 #endif
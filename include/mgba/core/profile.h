@@ -0,0 +1,56 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifndef M_CORE_PROFILE_H
+#define M_CORE_PROFILE_H
+
+#include <mgba-util/common.h>
+
+CXX_GUARD_START
+
+#define mPROFILE_MAX_EVENTS 32
+#define mPROFILE_MAX_MODES 4
+#define mPROFILE_MAX_DMAS 4
+
+struct mProfileCounter {
+	const char* name;
+	uint64_t count;
+};
+
+// Hot-path counters, filled in while attached to a core with mCore.setProfile.
+// Nothing is counted while no profile is attached.
+struct mProfile {
+	// Timing events dispatched, keyed by mTimingEvent.name
+	struct mProfileCounter events[mPROFILE_MAX_EVENTS];
+	size_t nEvents;
+	uint64_t eventsUnlisted;
+
+	// Instructions executed per CPU execution mode
+	struct mProfileCounter instructions[mPROFILE_MAX_MODES];
+	size_t nModes;
+
+	// Units transferred per DMA channel
+	struct mProfileCounter dma[mPROFILE_MAX_DMAS];
+	size_t nDMAs;
+
+	// Scanlines drawn vs. reused from the previous frame because they weren't dirty
+	uint64_t scanlinesRendered;
+	uint64_t scanlinesSkipped;
+
+	// Packets, and bytes including their payloads, queued for a proxy renderer such as the threaded one
+	uint64_t proxyPackets;
+	uint64_t proxyBytes;
+};
+
+void mProfileInit(struct mProfile*);
+void mProfileClear(struct mProfile*);
+void mProfileCountEvent(struct mProfile*, const char* name);
+
+uint64_t mProfileTotalEvents(const struct mProfile*);
+uint64_t mProfileTotalInstructions(const struct mProfile*);
+
+CXX_GUARD_END
+
+#endif
@@ -10,6 +10,7 @@
 
 CXX_GUARD_START
 
+#include <mgba-util/dirty-bitmap.h>
 #include <mgba-util/vector.h>
 #ifndef DISABLE_THREADING
 #include <mgba-util/threading.h>
@@ -25,6 +26,13 @@ struct mCoreRewindContext {
 	struct VFile* previousState;
 	struct VFile* currentState;
 
+	// Pages of the newest state that may differ from the one before it. The
+	// context owns the core's dirty tracking once appending begins, clearing
+	// it after every snapshot.
+	struct DirtyBitmap stateMask;
+	bool trackingDirty;
+	bool maskValid;
+
 #ifndef DISABLE_THREADING
 	bool onThread;
 	Thread thread;
@@ -0,0 +1,29 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifndef M_CORE_ROM_CACHE_H
+#define M_CORE_ROM_CACHE_H
+
+#include <mgba-util/common.h>
+
+CXX_GUARD_START
+
+struct mROMCacheEntry;
+
+// Sharing is off by default, since a lone instance only pays for an extra copy of the ROM.
+// Frontends that run several instances in one process should enable it before loading ROMs.
+void mROMCacheSetEnabled(bool enable);
+bool mROMCacheIsEnabled(void);
+
+// Returns a private, writable view of size viewSize onto a process-wide copy of the ROM.
+// Instances loading identical ROMs share the backing pages, and writes only copy the pages
+// they touch. Bytes past romSize read as zero. Returns NULL if sharing is disabled or the
+// platform can't do this.
+void* mROMCacheMap(const void* rom, size_t romSize, uint32_t hash, size_t viewSize, struct mROMCacheEntry** entry);
+void mROMCacheUnmap(struct mROMCacheEntry* entry, void* view, size_t viewSize);
+
+CXX_GUARD_END
+
+#endif
@@ -50,6 +50,14 @@ bool mCoreSaveStateNamed(struct mCore* core, struct VFile* vf, int flags);
 bool mCoreLoadStateNamed(struct mCore* core, struct VFile* vf, int flags);
 void* mCoreExtractState(struct mCore* core, struct VFile* vf, struct mStateExtdata* extdata);
 
+// Same layout as mCoreSaveStateNamed without a screenshot, but written to and read from
+// caller-owned memory with no intermediate copies. mCoreSaveStateBufferSize returns a size
+// that always suffices as long as savedata stays within maxSavedataSize and cheats are not
+// included.
+size_t mCoreSaveStateBufferSize(struct mCore* core, size_t maxSavedataSize, int flags);
+bool mCoreSaveStateBuffer(struct mCore* core, void* buffer, size_t size, int flags);
+bool mCoreLoadStateBuffer(struct mCore* core, const void* buffer, size_t size, int flags);
+
 CXX_GUARD_END
 
 #endif
@@ -0,0 +1,48 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifndef M_CORE_STATE_SLOTS_H
+#define M_CORE_STATE_SLOTS_H
+
+#include <mgba-util/common.h>
+
+CXX_GUARD_START
+
+// A fixed number of savestate slots kept in one preallocated, memory-mapped file. Each slot
+// holds two copies of its state; a save overwrites the older copy in place and then publishes
+// it by bumping its sequence number, so a save interrupted at any point leaves the previous
+// state of the slot loadable. States use the mCoreSaveStateBuffer layout.
+struct VFile;
+struct mStateSlots {
+	struct VFile* vf;
+	uint8_t* data;
+	size_t mapSize;
+	size_t headerSize;
+	size_t slotSize;
+	unsigned nSlots;
+	uint32_t sequence;
+
+	// Flush each save to disk before returning, not just to the page cache. On by default.
+	bool durable;
+};
+
+// An existing file is reused if it was created with the same number and size of slots,
+// otherwise it is reinitialized with every slot empty
+bool mStateSlotsInit(struct mStateSlots*, struct VFile* vf, unsigned slots, size_t slotSize);
+void mStateSlotsDeinit(struct mStateSlots*);
+void mStateSlotsSetDurable(struct mStateSlots*, bool durable);
+
+struct mCore;
+bool mStateSlotsSave(struct mStateSlots*, struct mCore*, unsigned slot, int flags);
+bool mStateSlotsLoad(struct mStateSlots*, struct mCore*, unsigned slot, int flags);
+void mStateSlotsDelete(struct mStateSlots*, unsigned slot);
+
+// Returns 0 for an empty slot. Sequence numbers increase with every save to any slot.
+uint32_t mStateSlotsSequence(const struct mStateSlots*, unsigned slot);
+const void* mStateSlotsGet(const struct mStateSlots*, unsigned slot, size_t* size);
+
+CXX_GUARD_END
+
+#endif
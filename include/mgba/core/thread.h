@@ -23,10 +23,22 @@ struct mThreadLogger {
 	struct mCoreThread* p;
 };
 
+struct mCoreRunAheadStats {
+	uint64_t frames;
+	uint64_t emulatedFrames;
+	uint64_t stateLoads;
+	uint64_t usec;
+	uint64_t stateUsec;
+};
+
 struct mCoreThreadInternal;
 struct mCoreThread {
 	// Input
 	struct mCore* core;
+	// Optional second instance of the same game. If set, run-ahead keeps it
+	// ahead of the main core instead of saving and loading a state every frame.
+	// It must not have a save file attached; its savedata comes from the main core
+	struct mCore* runAheadCore;
 
 	struct mThreadLogger logger;
 	ThreadCallback startCallback;
@@ -70,6 +82,20 @@ enum mCoreThreadState {
 	THREAD_CRASHED
 };
 
+struct mCoreThreadRunAhead {
+	int frames;
+	void* state;
+	size_t stateSize;
+	size_t maxSavedataSize;
+
+	bool active;
+	bool hidden;
+	bool secondaryValid;
+	uint32_t predictedKeys;
+
+	struct mCoreRunAheadStats stats;
+};
+
 struct mCoreThreadInternal {
 	Thread thread;
 	enum mCoreThreadState state;
@@ -82,6 +108,7 @@ struct mCoreThreadInternal {
 
 	struct mCoreSync sync;
 	struct mCoreRewindContext rewind;
+	struct mCoreThreadRunAhead runAhead;
 };
 
 #endif
@@ -113,6 +140,9 @@ void mCoreThreadStopWaiting(struct mCoreThread* threadContext);
 void mCoreThreadSetRewinding(struct mCoreThread* threadContext, bool);
 void mCoreThreadRewindParamsChanged(struct mCoreThread* threadContext);
 
+void mCoreThreadRunAheadParamsChanged(struct mCoreThread* threadContext);
+void mCoreThreadGetRunAheadStats(struct mCoreThread* threadContext, struct mCoreRunAheadStats* stats);
+
 struct mCoreThread* mCoreThreadGet(void);
 struct mLogger* mCoreThreadLogger(void);
 
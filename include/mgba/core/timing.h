@@ -10,6 +10,7 @@
 
 CXX_GUARD_START
 
+struct mProfile;
 struct mTiming;
 struct mTimingEvent {
 	void* context;
@@ -28,6 +29,8 @@ struct mTiming {
 	uint32_t masterCycles;
 	int32_t* relativeCycles;
 	int32_t* nextEvent;
+
+	struct mProfile* profile;
 };
 
 void mTimingInit(struct mTiming* timing, int32_t* relativeCycles, int32_t* nextEvent);
@@ -35,6 +35,7 @@ struct mVideoLoggerDirtyInfo {
 };
 
 struct VFile;
+struct mProfile;
 struct mVideoLogger {
 	bool (*writeData)(struct mVideoLogger* logger, const void* data, size_t length);
 	bool (*readData)(struct mVideoLogger* logger, void* data, size_t length, bool block);
@@ -64,6 +65,8 @@ struct mVideoLogger {
 	uint16_t* vram;
 	uint16_t* oam;
 	uint16_t* palette;
+
+	struct mProfile* profile;
 };
 
 void mVideoLoggerRendererCreate(struct mVideoLogger* logger, bool readonly);
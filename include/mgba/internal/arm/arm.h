@@ -67,6 +67,8 @@ enum LSMDirection {
 };
 
 struct ARMCore;
+struct ARMTracer;
+struct mProfile;
 
 union PSR {
 	struct {
@@ -142,6 +144,9 @@ struct ARMCore {
 	int32_t nextEvent;
 	int halted;
 
+	struct mProfile* profile;
+	struct ARMTracer* tracer;
+
 	int32_t bankedRegisters[6][7];
 	int32_t bankedSPSRs[6];
 
@@ -0,0 +1,76 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifndef ARM_TRACE_H
+#define ARM_TRACE_H
+
+#include <mgba-util/common.h>
+
+CXX_GUARD_START
+
+#include <mgba/internal/arm/arm.h>
+
+#define ARM_TRACE_MAGIC "mTRC"
+#define ARM_TRACE_VERSION 1
+
+// r0-r14, then CPSR; the PC is implied by each record's address
+#define ARM_TRACE_REGISTERS 16
+#define ARM_TRACE_CPSR 15
+
+enum ARMTraceFlags {
+	ARM_TRACE_FLAG_REGISTERS = 1,
+};
+
+// All fields are stored little-endian. Each record is followed by one 32-bit value
+// for every bit set in registers, in ascending order, holding that register's value
+// just before the instruction ran.
+struct ARMTraceHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t flags;
+	uint32_t reserved;
+};
+
+struct ARMTraceRecord {
+	uint32_t address; // Bit 0 is set for Thumb instructions
+	uint32_t opcode; // Thumb records hold the following halfword in the top 16 bits
+	uint32_t cycle;
+	uint16_t registers;
+	uint16_t reserved;
+};
+
+#define ARM_TRACE_RECORD_MAX (sizeof(struct ARMTraceRecord) + ARM_TRACE_REGISTERS * sizeof(uint32_t))
+
+struct mTiming;
+struct VFile;
+struct ARMTracer {
+	struct VFile* vf;
+	const struct mTiming* timing;
+	uint32_t flags;
+
+	uint8_t* buffer;
+	size_t capacity;
+	size_t used;
+
+	int32_t registers[ARM_TRACE_REGISTERS];
+	uint64_t records;
+	bool failed;
+};
+
+bool ARMTracerInit(struct ARMTracer*, struct VFile* vf, uint32_t flags);
+void ARMTracerDeinit(struct ARMTracer*);
+void ARMTracerAttach(struct ARMTracer*, struct ARMCore*, const struct mTiming*);
+void ARMTracerDetach(struct ARMTracer*, struct ARMCore*);
+void ARMTracerFlush(struct ARMTracer*);
+void ARMTracerRecord(struct ARMTracer*, const struct ARMCore*);
+
+bool ARMTraceParseHeader(const void* data, size_t size, struct ARMTraceHeader*);
+// Returns the number of bytes consumed, or 0 if the record is truncated.
+// Registers named by the record are updated in place.
+size_t ARMTraceParseRecord(const void* data, size_t size, struct ARMTraceRecord*, int32_t registers[ARM_TRACE_REGISTERS]);
+
+CXX_GUARD_END
+
+#endif
@@ -201,6 +201,12 @@ struct GBAudio {
 	struct mTimingEvent sampleEvent;
 	bool enable;
 
+	// When set, channel steps are caught up on demand instead of being scheduled as events
+	bool lazyChannels;
+	unsigned lazyScheduled;
+	// Skips mixing entirely; only guest-visible state (NR52, length, sweep) keeps running
+	bool suspendSynthesis;
+
 	size_t samples;
 	bool forceDisableCh[4];
 	int masterVolume;
@@ -238,6 +244,10 @@ void GBAudioWriteNR50(struct GBAudio* audio, uint8_t);
 void GBAudioWriteNR51(struct GBAudio* audio, uint8_t);
 void GBAudioWriteNR52(struct GBAudio* audio, uint8_t);
 
+void GBAudioSetLazyChannels(struct GBAudio* audio, bool enable);
+void GBAudioSuspendSynthesis(struct GBAudio* audio, bool suspend);
+void GBAudioRun(struct GBAudio* audio, uint32_t timestamp);
+
 void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing);
 
 void GBAudioSamplePSG(struct GBAudio* audio, int16_t* left, int16_t* right);
@@ -12,6 +12,7 @@ CXX_GUARD_START
 
 #include <mgba/core/log.h>
 #include <mgba/core/timing.h>
+#include <mgba-util/dirty-bitmap.h>
 #include <mgba/gb/interface.h>
 
 mLOG_DECLARE_CATEGORY(GB_MBC);
@@ -202,6 +203,11 @@ struct GBMemory {
 	struct mRotationSource* rotation;
 	struct mRumble* rumble;
 	struct mImageSource* cam;
+
+	struct DirtyBitmap dirtyWram;
+	struct DirtyBitmap dirtySram;
+	struct DirtyBitmap dirtyVram;
+	struct DirtyBitmap dirtyOam;
 };
 
 struct LR35902Core;
@@ -211,6 +217,10 @@ void GBMemoryDeinit(struct GB* gb);
 void GBMemoryReset(struct GB* gb);
 void GBMemorySwitchWramBank(struct GBMemory* memory, int bank);
 
+void GBMemorySetDirtyTracking(struct GB* gb, bool enable);
+void GBMemoryMarkAllDirty(struct GB* gb);
+void GBMemoryClearDirty(struct GB* gb);
+
 uint8_t GBLoad8(struct LR35902Core* cpu, uint16_t address);
 void GBStore8(struct LR35902Core* cpu, uint16_t address, int8_t value);
 
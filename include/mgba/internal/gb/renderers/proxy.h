@@ -10,6 +10,7 @@
 
 CXX_GUARD_START
 
+#include <mgba/internal/gb/memory.h>
 #include <mgba/internal/gb/video.h>
 #include <mgba/feature/video-logger.h>
 
@@ -20,6 +21,15 @@ struct GBVideoProxyRenderer {
 
 	struct GBObj objThisLine[40];
 	size_t oamMax;
+
+	// A drawn range not queued yet, so the next one can extend it, and the last register values
+	// and object list queued, so repeats can be dropped. Only touched on the emulation side.
+	int pendingY;
+	int pendingStartX;
+	int pendingEndX;
+	struct GBObj lastObj[40];
+	ssize_t lastOamMax;
+	int16_t lastRegisters[GB_SIZE_IO];
 };
 
 void GBVideoProxyRendererCreate(struct GBVideoProxyRenderer* renderer, struct GBVideoRenderer* backend);
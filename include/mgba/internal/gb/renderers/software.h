@@ -14,6 +14,19 @@ CXX_GUARD_START
 #include <mgba/internal/gb/gb.h>
 #include <mgba/internal/gb/video.h>
 
+// The registers a span of a scanline was drawn with, for replaying a line in one go
+struct GBVideoSoftwareSpan {
+	uint8_t startX;
+	uint8_t endX;
+	GBRegisterLCDC lcdc;
+	uint8_t scx;
+	uint8_t scy;
+	uint8_t wx;
+	uint8_t wy;
+	uint8_t currentWy;
+	int sgbRenderMode;
+};
+
 struct GBVideoSoftwareRenderer {
 	struct GBVideoRenderer d;
 
@@ -45,6 +58,14 @@ struct GBVideoSoftwareRenderer {
 	int16_t offsetWx;
 	int16_t offsetWy;
 
+	// When set, spans of a scanline are logged and drawn together once the line is complete
+	bool batchScanlines;
+	struct GBVideoSoftwareSpan spans[GB_VIDEO_HORIZONTAL_PIXELS];
+	int nSpans;
+	int spanY;
+	struct GBObj spanObj[10];
+	size_t spanObjMax;
+
 	int sgbTransfer;
 	uint8_t sgbPacket[128];
 	uint8_t sgbCommandHeader;
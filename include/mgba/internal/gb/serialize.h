@@ -418,6 +418,11 @@ struct GBSerializedState {
 bool GBDeserialize(struct GB* gb, const struct GBSerializedState* state);
 void GBSerialize(struct GB* gb, struct GBSerializedState* state);
 
+// Hashes what the game can see directly: the CPU registers, memory, I/O registers and savedata.
+// Scheduling state, such as cycle counts and pending events, is left out.
+struct Hash128;
+void GBHashState(struct GB* gb, struct Hash128* hash);
+
 CXX_GUARD_END
 
 #endif
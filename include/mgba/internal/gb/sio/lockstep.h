@@ -31,6 +31,7 @@ struct GBSIOLockstepNode {
 	int32_t eventDiff;
 	int id;
 	bool transferFinished;
+	bool transferPending;
 #ifndef NDEBUG
 	int transferId;
 	enum mLockstepPhase phase;
@@ -90,6 +90,7 @@ void GBAAudioReset(struct GBAAudio* audio);
 void GBAAudioDeinit(struct GBAAudio* audio);
 
 void GBAAudioResizeBuffer(struct GBAAudio* audio, size_t samples);
+void GBAAudioSuspendSynthesis(struct GBAAudio* audio, bool suspend);
 
 void GBAAudioScheduleFifoDma(struct GBAAudio* audio, int number, struct GBADMA* info);
 
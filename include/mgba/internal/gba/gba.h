@@ -54,6 +54,7 @@ struct ARMCore;
 struct GBA;
 struct Patch;
 struct VFile;
+struct mROMCacheEntry;
 
 mLOG_DECLARE_CATEGORY(GBA);
 mLOG_DECLARE_CATEGORY(GBA_DEBUG);
@@ -97,6 +98,7 @@ struct GBA {
 	size_t yankedRomSize;
 	uint32_t romCrc32;
 	struct VFile* romVf;
+	struct mROMCacheEntry* romCache;
 	struct VFile* biosVf;
 
 	struct mAVStream* stream;
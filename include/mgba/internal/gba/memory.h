@@ -11,6 +11,7 @@
 CXX_GUARD_START
 
 #include <mgba/core/timing.h>
+#include <mgba-util/dirty-bitmap.h>
 
 #include <mgba/internal/arm/arm.h>
 #include <mgba/internal/gba/dma.h>
@@ -132,6 +133,12 @@ struct GBAMemory {
 	uint16_t* agbPrintBuffer;
 
 	bool mirroring;
+
+	struct DirtyBitmap dirtyWram;
+	struct DirtyBitmap dirtyIwram;
+	struct DirtyBitmap dirtyPalette;
+	struct DirtyBitmap dirtyVram;
+	struct DirtyBitmap dirtyOam;
 };
 
 struct GBA;
@@ -140,6 +147,10 @@ void GBAMemoryDeinit(struct GBA* gba);
 
 void GBAMemoryReset(struct GBA* gba);
 
+void GBAMemorySetDirtyTracking(struct GBA* gba, bool enable);
+void GBAMemoryMarkAllDirty(struct GBA* gba);
+void GBAMemoryClearDirty(struct GBA* gba);
+
 uint32_t GBALoad32(struct ARMCore* cpu, uint32_t address, int* cycleCounter);
 uint32_t GBALoad16(struct ARMCore* cpu, uint32_t address, int* cycleCounter);
 uint32_t GBALoad8(struct ARMCore* cpu, uint32_t address, int* cycleCounter);
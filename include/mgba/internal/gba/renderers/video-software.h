@@ -165,6 +165,7 @@ struct GBAVideoSoftwareRenderer {
 	int16_t objOffsetY;
 
 	uint32_t scanlineDirty[5];
+	struct mProfile* profile;
 	uint16_t nextIo[REG_SOUND1CNT_LO];
 	struct ScanlineCache {
 		uint16_t io[REG_SOUND1CNT_LO];
@@ -24,6 +24,15 @@ enum GBARRInitFrom {
 	INIT_FROM_BOTH = 3,
 };
 
+// Where playback is within a movie at the end of a frame
+struct GBARRPosition {
+	uint32_t streamId;
+	uint32_t offset;
+	uint32_t frames;
+	uint32_t lagFrames;
+	uint16_t input;
+};
+
 struct GBARRContext {
 	void (*destroy)(struct GBARRContext*);
 
@@ -36,6 +45,8 @@ struct GBARRContext {
 	bool (*isRecording)(const struct GBARRContext*);
 
 	void (*nextFrame)(struct GBARRContext*);
+	// Advances the movie with nextFrame and keeps its keyframes
+	void (*frameEnded)(struct GBARRContext*, struct GBA*);
 	void (*logInput)(struct GBARRContext*, uint16_t input);
 	uint16_t (*queryInput)(struct GBARRContext*);
 	bool (*queryReset)(struct GBARRContext*);
@@ -46,6 +57,9 @@ struct GBARRContext {
 	struct VFile* (*openSavedata)(struct GBARRContext* mgm, int flags);
 	struct VFile* (*openSavestate)(struct GBARRContext* mgm, int flags);
 
+	bool (*getPosition)(struct GBARRContext*, struct GBARRPosition*);
+	bool (*setPosition)(struct GBARRContext*, const struct GBARRPosition*);
+
 	uint32_t frames;
 	uint32_t lagFrames;
 	enum GBARRInitFrom initFrom;
@@ -53,12 +67,42 @@ struct GBARRContext {
 	uint32_t rrCount;
 
 	struct VFile* savedata;
+
+	// Frames since the start of the movie, across all segments
+	uint32_t currentFrame;
+	struct VFile* keyframes;
+	uint32_t keyframeInterval;
+	// Keyframes only carry savedata when it changed, so their records differ in size; this
+	// holds where each one starts, followed by where the last one ends
+	uint64_t* keyframeOffsets;
+	uint32_t nKeyframes;
+	uint32_t keyframeOffsetsCapacity;
+	// Compare keyframes that playback reaches against the index instead of filling it in
+	bool verifyKeyframes;
+	uint32_t keyframeMismatches;
 };
 
 void GBARRDestroy(struct GBARRContext*);
 
 void GBARRInitRecord(struct GBA*);
 void GBARRInitPlay(struct GBA*);
+void GBARRFrameEnded(struct GBARRContext*, struct GBA*);
+
+// Keeps a savestate of every intervalth frame of the movie in an index file, taking ownership
+// of it. Keyframes are written as playback or recording first reaches them, so the index must
+// be set before GBARRInitPlay or GBARRInitRecord. Recordings are assumed to have no rerecords.
+bool GBARRSetKeyframes(struct GBARRContext*, struct VFile* vf, uint32_t interval);
+uint32_t GBARRKeyframeCount(const struct GBARRContext*);
+
+// Continues playback from the nearest keyframe at or before the frame when that is closer
+// than the current frame, then emulates up to the frame itself
+bool GBARRSeek(struct GBA*, uint32_t frame);
+
+// Plays the movie from one keyframe up to the next, or to the end of the movie after the last
+// one, and returns whether every keyframe reached matched. Needs verifyKeyframes to be set
+// before GBARRSetKeyframes, which then leaves the index untouched, so that several contexts
+// can check different segments of the same movie at once.
+bool GBARRVerifySegment(struct GBA*, uint32_t index);
 
 CXX_GUARD_END
 
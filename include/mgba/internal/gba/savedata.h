@@ -12,6 +12,7 @@ CXX_GUARD_START
 
 #include <mgba/core/log.h>
 #include <mgba/core/timing.h>
+#include <mgba-util/dirty-bitmap.h>
 
 mLOG_DECLARE_CATEGORY(GBA_SAVE);
 
@@ -95,6 +96,8 @@ struct GBASavedata {
 	uint32_t dirtAge;
 
 	enum FlashStateMachine flashState;
+
+	struct DirtyBitmap dirtyPages;
 };
 
 void GBASavedataInit(struct GBASavedata* savedata, struct VFile* vf);
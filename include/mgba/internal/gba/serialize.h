@@ -340,6 +340,11 @@ struct VDir;
 void GBASerialize(struct GBA* gba, struct GBASerializedState* state);
 bool GBADeserialize(struct GBA* gba, const struct GBASerializedState* state);
 
+// Hashes what the game can see directly: the CPU registers, memory, I/O registers and savedata.
+// Scheduling state, such as cycle counts and pending events, is left out.
+struct Hash128;
+void GBAHashState(struct GBA* gba, struct Hash128* hash);
+
 CXX_GUARD_END
 
 #endif
@@ -35,6 +35,7 @@ struct GBASIOLockstepNode {
 	int id;
 	enum GBASIOMode mode;
 	bool transferFinished;
+	bool transferPending;
 #ifndef NDEBUG
 	int transferId;
 	enum mLockstepPhase phase;
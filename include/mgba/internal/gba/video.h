@@ -178,6 +178,12 @@ struct GBAVideo {
 	// VCOUNT
 	int vcount;
 
+	// With lazy timing, the event only fires on scanline boundaries that something
+	// can observe; the ones in between are caught up on demand by GBAVideoRun
+	bool lazyTiming;
+	uint32_t nextBoundary;
+	bool nextHblank;
+
 	uint16_t palette[512];
 	uint16_t* vram;
 	union GBAOAM oam;
@@ -194,6 +200,10 @@ void GBAVideoAssociateRenderer(struct GBAVideo* video, struct GBAVideoRenderer*
 
 void GBAVideoWriteDISPSTAT(struct GBAVideo* video, uint16_t value);
 
+void GBAVideoSetLazyTiming(struct GBAVideo* video, bool enable);
+void GBAVideoRun(struct GBAVideo* video, uint32_t timestamp);
+void GBAVideoReschedule(struct GBAVideo* video);
+
 struct GBASerializedState;
 void GBAVideoSerialize(const struct GBAVideo* video, struct GBASerializedState* state);
 void GBAVideoDeserialize(struct GBAVideo* video, const struct GBASerializedState* state);
@@ -14,6 +14,7 @@ CXX_GUARD_START
 #include <mgba/internal/lr35902/isa-lr35902.h>
 
 struct LR35902Core;
+struct mProfile;
 
 #pragma pack(push, 1)
 union FlagRegister {
@@ -119,6 +120,7 @@ struct LR35902Core {
 	LR35902Instruction instruction;
 
 	bool irqPending;
+	struct mProfile* profile;
 
 	struct LR35902Memory memory;
 	struct LR35902InterruptHandler irqh;
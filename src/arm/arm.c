@@ -5,9 +5,11 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <mgba/internal/arm/arm.h>
 
+#include <mgba/core/profile.h>
 #include <mgba/internal/arm/isa-arm.h>
 #include <mgba/internal/arm/isa-inlines.h>
 #include <mgba/internal/arm/isa-thumb.h>
+#include <mgba/internal/arm/trace.h>
 
 static inline enum RegisterBank _ARMSelectBank(enum PrivilegeMode);
 
@@ -69,6 +71,8 @@ static inline enum RegisterBank _ARMSelectBank(enum PrivilegeMode mode) {
 }
 
 void ARMInit(struct ARMCore* cpu) {
+	cpu->profile = NULL;
+	cpu->tracer = NULL;
 	cpu->master->init(cpu, cpu->master);
 	size_t i;
 	for (i = 0; i < cpu->numComponents; ++i) {
@@ -275,19 +279,63 @@ static inline void ThumbStep(struct ARMCore* cpu) {
 	instruction(cpu, opcode);
 }
 
+static uint32_t _ARMRunLoopTraced(struct ARMCore* cpu, enum ExecutionMode mode) {
+	struct ARMTracer* tracer = cpu->tracer;
+	uint32_t instructions = 0;
+	while (cpu->cycles < cpu->nextEvent) {
+		ARMTracerRecord(tracer, cpu);
+		if (mode == MODE_THUMB) {
+			ThumbStep(cpu);
+		} else {
+			ARMStep(cpu);
+		}
+		++instructions;
+	}
+	return instructions;
+}
+
+static uint32_t _ARMRunLoopCounted(struct ARMCore* cpu, enum ExecutionMode mode) {
+	uint32_t instructions = 0;
+	if (mode == MODE_THUMB) {
+		while (cpu->cycles < cpu->nextEvent) {
+			ThumbStep(cpu);
+			++instructions;
+		}
+	} else {
+		while (cpu->cycles < cpu->nextEvent) {
+			ARMStep(cpu);
+			++instructions;
+		}
+	}
+	return instructions;
+}
+
 void ARMRun(struct ARMCore* cpu) {
-	if (cpu->executionMode == MODE_THUMB) {
+	enum ExecutionMode mode = cpu->executionMode;
+	if (cpu->tracer) {
+		ARMTracerRecord(cpu->tracer, cpu);
+	}
+	if (mode == MODE_THUMB) {
 		ThumbStep(cpu);
 	} else {
 		ARMStep(cpu);
 	}
+	if (cpu->profile) {
+		++cpu->profile->instructions[mode].count;
+	}
 	if (cpu->cycles >= cpu->nextEvent) {
 		cpu->irqh.processEvents(cpu);
 	}
 }
 
 void ARMRunLoop(struct ARMCore* cpu) {
-	if (cpu->executionMode == MODE_THUMB) {
+	uint32_t instructions = 0;
+	enum ExecutionMode mode = cpu->executionMode;
+	if (cpu->tracer) {
+		instructions = _ARMRunLoopTraced(cpu, mode);
+	} else if (cpu->profile) {
+		instructions = _ARMRunLoopCounted(cpu, mode);
+	} else if (mode == MODE_THUMB) {
 		while (cpu->cycles < cpu->nextEvent) {
 			ThumbStep(cpu);
 		}
@@ -296,6 +344,10 @@ void ARMRunLoop(struct ARMCore* cpu) {
 			ARMStep(cpu);
 		}
 	}
+	if (cpu->profile) {
+		// Switching modes ends the loop, so everything in it ran in the starting mode
+		cpu->profile->instructions[mode].count += instructions;
+	}
 	cpu->irqh.processEvents(cpu);
 }
 
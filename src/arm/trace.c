@@ -0,0 +1,158 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/internal/arm/trace.h>
+
+#include <mgba/core/timing.h>
+#include <mgba-util/vfs.h>
+
+#define TRACE_BUFFER_SIZE 0x40000
+
+bool ARMTracerInit(struct ARMTracer* tracer, struct VFile* vf, uint32_t flags) {
+	memset(tracer, 0, sizeof(*tracer));
+	tracer->vf = vf;
+	tracer->flags = flags;
+	tracer->capacity = TRACE_BUFFER_SIZE;
+	tracer->buffer = malloc(tracer->capacity);
+	if (!tracer->buffer) {
+		return false;
+	}
+
+	uint8_t header[sizeof(struct ARMTraceHeader)];
+	memcpy(header, ARM_TRACE_MAGIC, 4);
+	STORE_32LE(ARM_TRACE_VERSION, 4, header);
+	STORE_32LE(flags, 8, header);
+	STORE_32LE(0, 12, header);
+	if (vf->write(vf, header, sizeof(header)) != (ssize_t) sizeof(header)) {
+		free(tracer->buffer);
+		tracer->buffer = NULL;
+		return false;
+	}
+	return true;
+}
+
+void ARMTracerDeinit(struct ARMTracer* tracer) {
+	ARMTracerFlush(tracer);
+	free(tracer->buffer);
+	tracer->buffer = NULL;
+}
+
+void ARMTracerAttach(struct ARMTracer* tracer, struct ARMCore* cpu, const struct mTiming* timing) {
+	tracer->timing = timing;
+	// Make every register look changed so the first record carries the whole register file
+	size_t i;
+	for (i = 0; i < ARM_TRACE_CPSR; ++i) {
+		tracer->registers[i] = ~cpu->gprs[i];
+	}
+	tracer->registers[ARM_TRACE_CPSR] = ~cpu->cpsr.packed;
+	cpu->tracer = tracer;
+}
+
+void ARMTracerDetach(struct ARMTracer* tracer, struct ARMCore* cpu) {
+	if (cpu->tracer == tracer) {
+		cpu->tracer = NULL;
+	}
+	ARMTracerFlush(tracer);
+}
+
+void ARMTracerFlush(struct ARMTracer* tracer) {
+	if (!tracer->used) {
+		return;
+	}
+	if (tracer->vf->write(tracer->vf, tracer->buffer, tracer->used) != (ssize_t) tracer->used) {
+		tracer->failed = true;
+	}
+	tracer->used = 0;
+}
+
+void ARMTracerRecord(struct ARMTracer* tracer, const struct ARMCore* cpu) {
+	if (tracer->used + ARM_TRACE_RECORD_MAX > tracer->capacity) {
+		ARMTracerFlush(tracer);
+	}
+	uint8_t* out = &tracer->buffer[tracer->used];
+
+	uint32_t address;
+	uint32_t opcode;
+	if (cpu->executionMode == MODE_THUMB) {
+		address = (cpu->gprs[ARM_PC] - WORD_SIZE_THUMB) | 1;
+		opcode = (cpu->prefetch[0] & 0xFFFF) | (cpu->prefetch[1] << 16);
+	} else {
+		address = cpu->gprs[ARM_PC] - WORD_SIZE_ARM;
+		opcode = cpu->prefetch[0];
+	}
+	uint32_t cycle = cpu->cycles;
+	if (tracer->timing) {
+		cycle += tracer->timing->masterCycles;
+	}
+
+	size_t size = sizeof(struct ARMTraceRecord);
+	unsigned changed = 0;
+	if (tracer->flags & ARM_TRACE_FLAG_REGISTERS) {
+		size_t i;
+		for (i = 0; i < ARM_TRACE_CPSR; ++i) {
+			if (cpu->gprs[i] != tracer->registers[i]) {
+				tracer->registers[i] = cpu->gprs[i];
+				STORE_32LE(cpu->gprs[i], size, out);
+				size += sizeof(uint32_t);
+				changed |= 1 << i;
+			}
+		}
+		if (cpu->cpsr.packed != tracer->registers[ARM_TRACE_CPSR]) {
+			tracer->registers[ARM_TRACE_CPSR] = cpu->cpsr.packed;
+			STORE_32LE(cpu->cpsr.packed, size, out);
+			size += sizeof(uint32_t);
+			changed |= 1 << ARM_TRACE_CPSR;
+		}
+	}
+
+	STORE_32LE(address, 0, out);
+	STORE_32LE(opcode, 4, out);
+	STORE_32LE(cycle, 8, out);
+	STORE_16LE(changed, 12, out);
+	STORE_16LE(0, 14, out);
+	tracer->used += size;
+	++tracer->records;
+}
+
+bool ARMTraceParseHeader(const void* data, size_t size, struct ARMTraceHeader* header) {
+	if (size < sizeof(*header)) {
+		return false;
+	}
+	const uint8_t* in = data;
+	memcpy(header->magic, in, 4);
+	if (memcmp(header->magic, ARM_TRACE_MAGIC, 4) != 0) {
+		return false;
+	}
+	LOAD_32LE(header->version, 4, in);
+	LOAD_32LE(header->flags, 8, in);
+	LOAD_32LE(header->reserved, 12, in);
+	return header->version == ARM_TRACE_VERSION;
+}
+
+size_t ARMTraceParseRecord(const void* data, size_t size, struct ARMTraceRecord* record, int32_t registers[ARM_TRACE_REGISTERS]) {
+	if (size < sizeof(*record)) {
+		return 0;
+	}
+	const uint8_t* in = data;
+	LOAD_32LE(record->address, 0, in);
+	LOAD_32LE(record->opcode, 4, in);
+	LOAD_32LE(record->cycle, 8, in);
+	LOAD_16LE(record->registers, 12, in);
+	LOAD_16LE(record->reserved, 14, in);
+
+	size_t offset = sizeof(*record);
+	size_t i;
+	for (i = 0; i < ARM_TRACE_REGISTERS; ++i) {
+		if (!(record->registers & (1 << i))) {
+			continue;
+		}
+		if (offset + sizeof(uint32_t) > size) {
+			return 0;
+		}
+		LOAD_32LE(registers[i], offset, in);
+		offset += sizeof(uint32_t);
+	}
+	return offset;
+}
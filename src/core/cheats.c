@@ -6,6 +6,7 @@
 #include <mgba/core/cheats.h>
 
 #include <mgba/core/core.h>
+#include <mgba-util/dirty-bitmap.h>
 #include <mgba-util/string.h>
 #include <mgba-util/vfs.h>
 
@@ -17,6 +18,7 @@ mLOG_DEFINE_CATEGORY(CHEATS, "Cheats", "core.cheats");
 
 DEFINE_VECTOR(mCheatList, struct mCheat);
 DEFINE_VECTOR(mCheatSets, struct mCheatSet*);
+DEFINE_VECTOR(mCheatOpList, struct mCheatOp);
 
 static int32_t _readMem(struct mCore* core, uint32_t address, int width) {
 	switch (width) {
@@ -44,6 +46,54 @@ static void _writeMem(struct mCore* core, uint32_t address, int width, int32_t v
 	}
 }
 
+static int32_t _readDirect(const uint8_t* host, int width) {
+	uint32_t value = 0;
+	switch (width) {
+	case 1:
+		return host[0];
+	case 2:
+		LOAD_16LE(value, 0, host);
+		return (uint16_t) value;
+	case 4:
+		LOAD_32LE(value, 0, host);
+		return value;
+	}
+	return 0;
+}
+
+static void _writeDirect(uint8_t* host, int width, int32_t value) {
+	switch (width) {
+	case 1:
+		host[0] = value;
+		break;
+	case 2:
+		STORE_16LE(value, 0, host);
+		break;
+	case 4:
+		STORE_32LE(value, 0, host);
+		break;
+	}
+}
+
+static int32_t _readCheat(struct mCore* core, const uint8_t* host, uint32_t address, int width) {
+	if (host) {
+		return _readDirect(host, width);
+	}
+	return _readMem(core, address, width);
+}
+
+static void _writeCheat(struct mCore* core, uint8_t* host, struct DirtyBitmap* dirty, size_t offset, uint32_t address, int width, int32_t value) {
+	if (host) {
+		_writeDirect(host, width, value);
+		// Direct writes bypass the bus, so they have to mark pages themselves
+		if (dirty) {
+			DirtyBitmapMark(dirty, offset);
+		}
+	} else {
+		_writeMem(core, address, width, value);
+	}
+}
+
 static void mCheatDeviceInit(void*, struct mCPUComponent*);
 static void mCheatDeviceDeinit(struct mCPUComponent*);
 
@@ -79,10 +129,16 @@ void mCheatSetInit(struct mCheatSet* set, const char* name) {
 		set->name = 0;
 	}
 	set->enabled = true;
+	mCheatOpListInit(&set->program.ops, 0);
+	mCheatListInit(&set->program.source, 0);
+	set->program.memoryBlocks = NULL;
+	set->program.nBlocks = 0;
 }
 
 void mCheatSetDeinit(struct mCheatSet* set) {
 	mCheatListDeinit(&set->list);
+	mCheatOpListDeinit(&set->program.ops);
+	mCheatListDeinit(&set->program.source);
 	size_t i;
 	for (i = 0; i < StringListSize(&set->lines); ++i) {
 		free(*StringListGetPointer(&set->lines, i));
@@ -268,27 +324,173 @@ void mCheatAutosave(struct mCheatDevice* device) {
 }
 #endif
 
+static int _directBlock(struct mCheatProgram* program, const struct mCoreMemoryBlock* blocks, size_t nBlocks, const struct mCheat* cheat, uint32_t* offset) {
+	switch (cheat->type) {
+	case CHEAT_ASSIGN:
+	case CHEAT_AND:
+	case CHEAT_ADD:
+	case CHEAT_OR:
+	case CHEAT_IF_EQ:
+	case CHEAT_IF_NE:
+	case CHEAT_IF_LT:
+	case CHEAT_IF_GT:
+	case CHEAT_IF_ULT:
+	case CHEAT_IF_UGT:
+	case CHEAT_IF_AND:
+	case CHEAT_IF_LAND:
+	case CHEAT_IF_NAND:
+		break;
+	default:
+		return -1;
+	}
+	if (cheat->width != 1 && cheat->width != 2 && cheat->width != 4) {
+		return -1;
+	}
+	// Unaligned accesses get rotated or split by the bus, so leave those to it
+	if ((cheat->address | cheat->addressOffset) & (cheat->width - 1)) {
+		return -1;
+	}
+
+	int64_t first = cheat->address;
+	int64_t last = first;
+	if (cheat->type < CHEAT_IF_EQ && cheat->repeat > 1) {
+		last += (int64_t) cheat->addressOffset * (cheat->repeat - 1);
+	}
+	if (last < first) {
+		int64_t swap = first;
+		first = last;
+		last = swap;
+	}
+	last += cheat->width;
+
+	size_t i;
+	for (i = 0; i < nBlocks; ++i) {
+		const struct mCoreMemoryBlock* block = &blocks[i];
+		if ((block->flags & (mCORE_MEMORY_DIRECT | mCORE_MEMORY_VIRTUAL)) != mCORE_MEMORY_DIRECT) {
+			continue;
+		}
+		int64_t end = block->end;
+		if (block->maxSegment) {
+			// Only the part in front of the banked window always maps to the same memory
+			if (!block->segmentStart) {
+				continue;
+			}
+			end = block->segmentStart;
+		}
+		if (end > (int64_t) block->start + block->size) {
+			end = (int64_t) block->start + block->size;
+		}
+		if (first < block->start || last > end) {
+			continue;
+		}
+
+		size_t b;
+		for (b = 0; b < program->nBlocks; ++b) {
+			if (program->blockIds[b] == block->id) {
+				break;
+			}
+		}
+		if (b == program->nBlocks) {
+			if (b == mCHEAT_MAX_DIRECT_BLOCKS) {
+				return -1;
+			}
+			program->blockIds[b] = block->id;
+			program->blockExtents[b] = 0;
+			++program->nBlocks;
+		}
+		if (program->blockExtents[b] < last - block->start) {
+			program->blockExtents[b] = last - block->start;
+		}
+		*offset = cheat->address - block->start;
+		return b;
+	}
+	return -1;
+}
+
+static bool _programIsCurrent(const struct mCheatProgram* program, const struct mCheatList* list, const struct mCoreMemoryBlock* blocks) {
+	if (program->memoryBlocks != blocks) {
+		return false;
+	}
+	size_t nCodes = mCheatListSize(list);
+	if (mCheatListSize(&program->source) != nCodes) {
+		return false;
+	}
+	// Cheat parsers patch earlier lines when later ones arrive, so the size alone isn't enough
+	return !nCodes || memcmp(program->source.vector, list->vector, nCodes * sizeof(struct mCheat)) == 0;
+}
+
+static void _compile(struct mCheatProgram* program, const struct mCheatList* list, const struct mCoreMemoryBlock* blocks, size_t nBlocks) {
+	mCheatOpListClear(&program->ops);
+	mCheatListCopy(&program->source, list);
+	program->memoryBlocks = blocks;
+	program->nBlocks = 0;
+	size_t nCodes = mCheatListSize(list);
+	size_t i;
+	for (i = 0; i < nCodes; ++i) {
+		struct mCheatOp* op = mCheatOpListAppend(&program->ops);
+		op->cheat = *mCheatListGetConstPointer(list, i);
+		op->offset = 0;
+		op->block = _directBlock(program, blocks, nBlocks, &op->cheat, &op->offset);
+	}
+}
+
 void mCheatRefresh(struct mCheatDevice* device, struct mCheatSet* cheats) {
 	cheats->refresh(cheats, device);
 	if (!cheats->enabled) {
 		return;
 	}
 
+	struct mCore* core = device->p;
+	struct mCheatProgram* program = &cheats->program;
+	const struct mCoreMemoryBlock* blocks;
+	size_t nBlocks = core->listMemoryBlocks(core, &blocks);
+	if (!_programIsCurrent(program, &cheats->list, blocks)) {
+		_compile(program, &cheats->list, blocks, nBlocks);
+	}
+
+	// Memory can be reallocated behind our back (e.g. on reset), so host pointers are only looked up per refresh
+	uint8_t* bases[mCHEAT_MAX_DIRECT_BLOCKS];
+	struct DirtyBitmap* dirtyPages[mCHEAT_MAX_DIRECT_BLOCKS];
+	size_t b;
+	for (b = 0; b < program->nBlocks; ++b) {
+		size_t size = 0;
+		bases[b] = core->getMemoryBlock(core, program->blockIds[b], &size);
+		if (size < program->blockExtents[b]) {
+			bases[b] = NULL;
+		}
+		dirtyPages[b] = core->getDirtyPages ? core->getDirtyPages(core, program->blockIds[b]) : NULL;
+	}
+
 	size_t elseLoc = 0;
 	size_t endLoc = 0;
-	size_t nCodes = mCheatListSize(&cheats->list);
+	size_t nCodes = mCheatOpListSize(&program->ops);
 	size_t i;
 	for (i = 0; i < nCodes; ++i) {
-		struct mCheat* cheat = mCheatListGetPointer(&cheats->list, i);
+		const struct mCheatOp* op = mCheatOpListGetConstPointer(&program->ops, i);
+		const struct mCheat* cheat = &op->cheat;
 		int32_t value = 0;
 		int32_t operand = cheat->operand;
 		uint32_t operationsRemaining = cheat->repeat;
 		uint32_t address = cheat->address;
+		uint8_t* host = NULL;
+		struct DirtyBitmap* dirty = NULL;
+		size_t offset = op->offset;
 		bool performAssignment = false;
 		bool condition = true;
 		int conditionRemaining = 0;
 		int negativeConditionRemaining = 0;
 
+		if (op->block >= 0 && bases[op->block]) {
+			host = &bases[op->block][op->offset];
+			dirty = dirtyPages[op->block];
+		}
+
+		if (host && cheat->type == CHEAT_ASSIGN && cheat->repeat == 1) {
+			// By far the most common code, so skip the general loop for it
+			_writeCheat(core, host, dirty, offset, address, cheat->width, operand);
+			operationsRemaining = 0;
+		}
+
 		for (; operationsRemaining; --operationsRemaining) {
 			switch (cheat->type) {
 			case CHEAT_ASSIGN:
@@ -297,71 +499,71 @@ void mCheatRefresh(struct mCheatDevice* device, struct mCheatSet* cheats) {
 				break;
 			case CHEAT_ASSIGN_INDIRECT:
 				value = operand;
-				address = _readMem(device->p, address + cheat->addressOffset, 4);
+				address = _readMem(core, address + cheat->addressOffset, 4);
 				performAssignment = true;
 				break;
 			case CHEAT_AND:
-				value = _readMem(device->p, address, cheat->width) & operand;
+				value = _readCheat(core, host, address, cheat->width) & operand;
 				performAssignment = true;
 				break;
 			case CHEAT_ADD:
-				value = _readMem(device->p, address, cheat->width) + operand;
+				value = _readCheat(core, host, address, cheat->width) + operand;
 				performAssignment = true;
 				break;
 			case CHEAT_OR:
-				value = _readMem(device->p, address, cheat->width) | operand;
+				value = _readCheat(core, host, address, cheat->width) | operand;
 				performAssignment = true;
 				break;
 			case CHEAT_IF_EQ:
-				condition = _readMem(device->p, address, cheat->width) == operand;
+				condition = _readCheat(core, host, address, cheat->width) == operand;
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
 				break;
 			case CHEAT_IF_NE:
-				condition = _readMem(device->p, address, cheat->width) != operand;
+				condition = _readCheat(core, host, address, cheat->width) != operand;
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
 				break;
 			case CHEAT_IF_LT:
-				condition = _readMem(device->p, address, cheat->width) < operand;
+				condition = _readCheat(core, host, address, cheat->width) < operand;
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
 				break;
 			case CHEAT_IF_GT:
-				condition = _readMem(device->p, address, cheat->width) > operand;
+				condition = _readCheat(core, host, address, cheat->width) > operand;
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
 				break;
 			case CHEAT_IF_ULT:
-				condition = (uint32_t) _readMem(device->p, address, cheat->width) < (uint32_t) operand;
+				condition = (uint32_t) _readCheat(core, host, address, cheat->width) < (uint32_t) operand;
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
 				break;
 			case CHEAT_IF_UGT:
-				condition = (uint32_t) _readMem(device->p, address, cheat->width) > (uint32_t) operand;
+				condition = (uint32_t) _readCheat(core, host, address, cheat->width) > (uint32_t) operand;
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
 				break;
 			case CHEAT_IF_AND:
-				condition = _readMem(device->p, address, cheat->width) & operand;
+				condition = _readCheat(core, host, address, cheat->width) & operand;
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
 				break;
 			case CHEAT_IF_LAND:
-				condition = _readMem(device->p, address, cheat->width) && operand;
+				condition = _readCheat(core, host, address, cheat->width) && operand;
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
 				break;
 			case CHEAT_IF_NAND:
-				condition = !(_readMem(device->p, address, cheat->width) & operand);
+				condition = !(_readCheat(core, host, address, cheat->width) & operand);
 				conditionRemaining = cheat->repeat;
 				negativeConditionRemaining = cheat->negativeRepeat;
 				operationsRemaining = 1;
@@ -375,11 +577,15 @@ void mCheatRefresh(struct mCheatDevice* device, struct mCheatSet* cheats) {
 			}
 
 			if (performAssignment) {
-				_writeMem(device->p, address, cheat->width, value);
+				_writeCheat(core, host, dirty, offset, address, cheat->width, value);
 			}
 
 			address += cheat->addressOffset;
 			operand += cheat->operandOffset;
+			if (host) {
+				host += cheat->addressOffset;
+				offset += cheat->addressOffset;
+			}
 		}
 
 
@@ -8,6 +8,7 @@
 #include <mgba/core/cheats.h>
 #include <mgba/core/log.h>
 #include <mgba/core/serialize.h>
+#include <mgba/core/state-slots.h>
 #include <mgba-util/vfs.h>
 #include <mgba/internal/debugger/symbols.h>
 
@@ -184,13 +185,22 @@ bool mCoreAutoloadCheats(struct mCore* core) {
 	return success;
 }
 
+static bool _inStateSlots(struct mCore* core, int slot) {
+	return core->stateSlots && slot >= 0 && (unsigned) slot < core->stateSlots->nSlots;
+}
+
 bool mCoreSaveState(struct mCore* core, int slot, int flags) {
-	struct VFile* vf = mCoreGetState(core, slot, true);
-	if (!vf) {
-		return false;
+	bool success;
+	if (_inStateSlots(core, slot)) {
+		success = mStateSlotsSave(core->stateSlots, core, slot, flags);
+	} else {
+		struct VFile* vf = mCoreGetState(core, slot, true);
+		if (!vf) {
+			return false;
+		}
+		success = mCoreSaveStateNamed(core, vf, flags);
+		vf->close(vf);
 	}
-	bool success = mCoreSaveStateNamed(core, vf, flags);
-	vf->close(vf);
 	if (success) {
 		mLOG(STATUS, INFO, "State %i saved", slot);
 	} else {
@@ -201,12 +211,17 @@ bool mCoreSaveState(struct mCore* core, int slot, int flags) {
 }
 
 bool mCoreLoadState(struct mCore* core, int slot, int flags) {
-	struct VFile* vf = mCoreGetState(core, slot, false);
-	if (!vf) {
-		return false;
+	bool success;
+	if (_inStateSlots(core, slot)) {
+		success = mStateSlotsLoad(core->stateSlots, core, slot, flags);
+	} else {
+		struct VFile* vf = mCoreGetState(core, slot, false);
+		if (!vf) {
+			return false;
+		}
+		success = mCoreLoadStateNamed(core, vf, flags);
+		vf->close(vf);
 	}
-	bool success = mCoreLoadStateNamed(core, vf, flags);
-	vf->close(vf);
 	if (success) {
 		mLOG(STATUS, INFO, "State %i loaded", slot);
 	} else {
@@ -223,6 +238,10 @@ struct VFile* mCoreGetState(struct mCore* core, int slot, bool write) {
 }
 
 void mCoreDeleteState(struct mCore* core, int slot) {
+	if (_inStateSlots(core, slot)) {
+		mStateSlotsDelete(core->stateSlots, slot);
+		return;
+	}
 	char name[PATH_MAX];
 	snprintf(name, sizeof(name), "%s.ss%i", core->dirs.baseName, slot);
 	core->dirs.state->deleteFile(core->dirs.state, name);
@@ -5,12 +5,138 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <mgba/core/lockstep.h>
 
+#include <mgba/core/core.h>
+
 void mLockstepInit(struct mLockstep* lockstep) {
 	lockstep->attached = 0;
 	lockstep->transferActive = 0;
+	lockstep->window = 0;
+	lockstep->syncNode = NULL;
+	lockstep->scheduler = NULL;
 #ifndef NDEBUG
 	lockstep->transferId = 0;
 #endif
 }
 
 // TODO: Migrate nodes
+
+// Every node is caught up by the end of a round, so there is never anything to wait for
+static bool _schedulerSignal(struct mLockstep* lockstep, unsigned mask) {
+	UNUSED(lockstep);
+	UNUSED(mask);
+	return true;
+}
+
+static bool _schedulerWait(struct mLockstep* lockstep, unsigned mask) {
+	UNUSED(lockstep);
+	UNUSED(mask);
+	return true;
+}
+
+static void _schedulerAddCycles(struct mLockstep* lockstep, int id, int32_t cycles) {
+	UNUSED(lockstep);
+	UNUSED(id);
+	UNUSED(cycles);
+}
+
+static int32_t _schedulerUseCycles(struct mLockstep* lockstep, int id, int32_t cycles) {
+	UNUSED(lockstep);
+	UNUSED(id);
+	UNUSED(cycles);
+	return 0;
+}
+
+static void _schedulerUnload(struct mLockstep* lockstep, int id) {
+	UNUSED(lockstep);
+	UNUSED(id);
+}
+
+static void _barrier(struct mTiming* timing, void* context, uint32_t cyclesLate) {
+	UNUSED(timing);
+	UNUSED(cyclesLate);
+	struct mLockstepSchedulerNode* node = context;
+	node->stopped = true;
+}
+
+static void _runNode(void* context, size_t index) {
+	struct mLockstepScheduler* scheduler = context;
+	struct mLockstepSchedulerNode* node = &scheduler->nodes[index];
+	// The run loop returns whenever it has handled events, so the core stops at the first
+	// opportunity after reaching the barrier, which only depends on what it has run itself
+	node->stopped = false;
+	while (!node->stopped) {
+		node->core->runLoop(node->core);
+	}
+}
+
+void mLockstepSchedulerInit(struct mLockstepScheduler* scheduler, struct mLockstep* lockstep, size_t threads) {
+	memset(scheduler, 0, sizeof(*scheduler));
+	scheduler->lockstep = lockstep;
+	lockstep->scheduler = scheduler;
+	lockstep->context = scheduler;
+	lockstep->signal = _schedulerSignal;
+	lockstep->wait = _schedulerWait;
+	lockstep->addCycles = _schedulerAddCycles;
+	lockstep->useCycles = _schedulerUseCycles;
+	lockstep->unload = _schedulerUnload;
+	ThreadPoolInit(&scheduler->pool, threads, "Lockstep Thread");
+}
+
+void mLockstepSchedulerDeinit(struct mLockstepScheduler* scheduler) {
+	ThreadPoolDeinit(&scheduler->pool);
+	int n;
+	for (n = 0; n < scheduler->nNodes; ++n) {
+		struct mLockstepSchedulerNode* node = &scheduler->nodes[n];
+		mTimingDeschedule(node->core->timing, &node->barrier);
+	}
+	scheduler->lockstep->scheduler = NULL;
+}
+
+bool mLockstepSchedulerAttachCore(struct mLockstepScheduler* scheduler, struct mCore* core) {
+	if (scheduler->nNodes == mLOCKSTEP_MAX_NODES) {
+		return false;
+	}
+	struct mLockstepSchedulerNode* node = &scheduler->nodes[scheduler->nNodes];
+	++scheduler->nNodes;
+	node->core = core;
+	node->barrier.context = node;
+	node->barrier.name = "Lockstep Barrier";
+	node->barrier.callback = _barrier;
+	node->barrier.priority = 0x7F;
+	mTimingSchedule(core->timing, &node->barrier, 0);
+	return true;
+}
+
+static void _runRound(struct mLockstepScheduler* scheduler) {
+	ThreadPoolRun(&scheduler->pool, scheduler->nNodes, _runNode, scheduler);
+
+	struct mLockstep* lockstep = scheduler->lockstep;
+	int32_t cycles = lockstep->syncNode(lockstep, 0);
+	int i;
+	for (i = 1; i < scheduler->nNodes; ++i) {
+		lockstep->syncNode(lockstep, i);
+	}
+	if (cycles < 1) {
+		cycles = 1;
+	}
+	for (i = 0; i < scheduler->nNodes; ++i) {
+		// Measure from where the barrier was due rather than where the core stopped,
+		// so that the cores never drift apart
+		struct mLockstepSchedulerNode* node = &scheduler->nodes[i];
+		struct mTiming* timing = node->core->timing;
+		int32_t when = (int32_t) (node->barrier.when + cycles - mTimingCurrentTime(timing));
+		mTimingSchedule(timing, &node->barrier, when > 0 ? when : 0);
+	}
+	++scheduler->rounds;
+}
+
+void mLockstepSchedulerRunFrames(struct mLockstepScheduler* scheduler, unsigned frames) {
+	if (!scheduler->nNodes) {
+		return;
+	}
+	struct mCore* core = scheduler->nodes[0].core;
+	int32_t start = core->frameCounter(core);
+	while ((uint32_t) (core->frameCounter(core) - start) < frames) {
+		_runRound(scheduler);
+	}
+}
@@ -7,8 +7,10 @@
 
 #include <mgba/core/core.h>
 #include <mgba/core/interface.h>
+#include <mgba-util/thread-pool.h>
 
 DEFINE_VECTOR(mCoreMemorySearchResults, struct mCoreMemorySearchResult);
+DEFINE_VECTOR(mCoreMemorySnapshotBlocks, struct mCoreMemorySnapshotBlock);
 
 static bool _op(int32_t value, int32_t match, enum mCoreMemorySearchOp op) {
 	switch (op) {
@@ -23,70 +25,143 @@ static bool _op(int32_t value, int32_t match, enum mCoreMemorySearchOp op) {
 	return false;
 }
 
+// Scanning is done a chunk at a time: a branchless pass that the compiler can vectorize checks whether anything in the
+// chunk matches at all, and only chunks with matches are walked element by element
+#define SEARCH_CHUNK 64
+
+#define SEARCH_SCAN(MEM, CTYPE, MATCH, WIDTH, OLD) \
+	for (i = 0; (!limit || found < limit) && i < n; i += SEARCH_CHUNK) { \
+		size_t chunk = n - i < SEARCH_CHUNK ? n - i : SEARCH_CHUNK; \
+		unsigned any = 0; \
+		size_t j; \
+		for (j = 0; j < chunk; ++j) { \
+			CTYPE v = MEM[i + j]; \
+			any |= MATCH; \
+		} \
+		if (!any) { \
+			continue; \
+		} \
+		mCoreMemorySearchResultsEnsureCapacity(out, mCoreMemorySearchResultsSize(out) + chunk); \
+		for (j = 0; j < chunk && (!limit || found < limit); ++j) { \
+			CTYPE v = MEM[i + j]; \
+			if (MATCH) { \
+				_appendInt(out, start + (i + j) * WIDTH, WIDTH, OLD); \
+				++found; \
+			} \
+		} \
+	}
+
+#define SEARCH_OPS(MEM, CTYPE, MATCH_VALUE, WIDTH) \
+	switch (op) { \
+	case mCORE_MEMORY_SEARCH_GREATER: \
+		SEARCH_SCAN(MEM, CTYPE, v > MATCH_VALUE, WIDTH, MATCH_VALUE); \
+		break; \
+	case mCORE_MEMORY_SEARCH_LESS: \
+		SEARCH_SCAN(MEM, CTYPE, v < MATCH_VALUE, WIDTH, MATCH_VALUE); \
+		break; \
+	case mCORE_MEMORY_SEARCH_EQUAL: \
+	case mCORE_MEMORY_SEARCH_DELTA: \
+		SEARCH_SCAN(MEM, CTYPE, v == MATCH_VALUE, WIDTH, MATCH_VALUE); \
+		break; \
+	}
+
+// Capacity has to be reserved beforehand
+static inline void _appendInt(struct mCoreMemorySearchResults* out, uint32_t address, int width, int32_t oldValue) {
+	struct mCoreMemorySearchResult* res = &out->vector[out->size];
+	++out->size;
+	res->address = address;
+	res->type = mCORE_MEMORY_SEARCH_INT;
+	res->width = width;
+	res->segment = -1; // TODO
+	res->guessDivisor = 1;
+	res->guessMultiplier = 1;
+	res->oldValue = oldValue;
+}
+
 static size_t _search32(const void* mem, size_t size, const struct mCoreMemoryBlock* block, uint32_t value32, enum mCoreMemorySearchOp op, struct mCoreMemorySearchResults* out, size_t limit) {
 	const uint32_t* mem32 = mem;
+	int32_t match = value32;
 	size_t found = 0;
 	uint32_t start = block->start;
-	uint32_t end = size; // TODO: Segments
+	size_t n = size >> 2; // TODO: Segments
 	size_t i;
 	// TODO: Big endian
-	for (i = 0; (!limit || found < limit) && i < end; i += 4) {
-		if (_op(mem32[i >> 2], value32, op)) {
-			struct mCoreMemorySearchResult* res = mCoreMemorySearchResultsAppend(out);
-			res->address = start + i;
-			res->type = mCORE_MEMORY_SEARCH_INT;
-			res->width = 4;
-			res->segment = -1; // TODO
-			res->guessDivisor = 1;
-			res->guessMultiplier = 1;
-			res->oldValue = value32;
-			++found;
-		}
-	}
+	SEARCH_OPS(mem32, int32_t, match, 4);
 	return found;
 }
 
 static size_t _search16(const void* mem, size_t size, const struct mCoreMemoryBlock* block, uint16_t value16, enum mCoreMemorySearchOp op, struct mCoreMemorySearchResults* out, size_t limit) {
 	const uint16_t* mem16 = mem;
+	int32_t match = value16;
 	size_t found = 0;
 	uint32_t start = block->start;
-	uint32_t end = size; // TODO: Segments
+	size_t n = size >> 1; // TODO: Segments
 	size_t i;
 	// TODO: Big endian
-	for (i = 0; (!limit || found < limit) && i < end; i += 2) {
-		if (_op(mem16[i >> 1], value16, op)) {
-			struct mCoreMemorySearchResult* res = mCoreMemorySearchResultsAppend(out);
-			res->address = start + i;
-			res->type = mCORE_MEMORY_SEARCH_INT;
-			res->width = 2;
-			res->segment = -1; // TODO
-			res->guessDivisor = 1;
-			res->guessMultiplier = 1;
-			res->oldValue = value16;
-			++found;
-		}
-	}
+	SEARCH_OPS(mem16, int32_t, match, 2);
 	return found;
 }
 
 static size_t _search8(const void* mem, size_t size, const struct mCoreMemoryBlock* block, uint8_t value8, enum mCoreMemorySearchOp op, struct mCoreMemorySearchResults* out, size_t limit) {
 	const uint8_t* mem8 = mem;
+	int32_t match = value8;
 	size_t found = 0;
 	uint32_t start = block->start;
-	uint32_t end = size; // TODO: Segments
+	size_t n = size; // TODO: Segments
 	size_t i;
-	for (i = 0; (!limit || found < limit) && i < end; ++i) {
-		if (_op(mem8[i], value8, op)) {
-			struct mCoreMemorySearchResult* res = mCoreMemorySearchResultsAppend(out);
-			res->address = start + i;
-			res->type = mCORE_MEMORY_SEARCH_INT;
-			res->width = 1;
-			res->segment = -1; // TODO
-			res->guessDivisor = 1;
-			res->guessMultiplier = 1;
-			res->oldValue = value8;
-			++found;
-		}
+	SEARCH_OPS(mem8, int32_t, match, 1);
+	return found;
+}
+
+#define SNAPSHOT_OPS(MEM, OLD, CTYPE, WIDTH) \
+	switch (op) { \
+	case mCORE_MEMORY_SEARCH_GREATER: \
+		SEARCH_SCAN(MEM, CTYPE, v > (CTYPE) OLD[i + j], WIDTH, v); \
+		break; \
+	case mCORE_MEMORY_SEARCH_LESS: \
+		SEARCH_SCAN(MEM, CTYPE, v < (CTYPE) OLD[i + j], WIDTH, v); \
+		break; \
+	case mCORE_MEMORY_SEARCH_EQUAL: \
+		SEARCH_SCAN(MEM, CTYPE, v == (CTYPE) OLD[i + j], WIDTH, v); \
+		break; \
+	case mCORE_MEMORY_SEARCH_DELTA: \
+		SEARCH_SCAN(MEM, CTYPE, (uint32_t) v - OLD[i + j] == (uint32_t) delta, WIDTH, v); \
+		break; \
+	}
+
+static size_t _searchSnapshot(const void* mem, const void* old, size_t size, const struct mCoreMemoryBlock* block, const struct mCoreMemorySearchParams* params, struct mCoreMemorySearchResults* out, size_t limit) {
+	if (params->type != mCORE_MEMORY_SEARCH_INT || (params->align != params->width && params->align != -1)) {
+		return 0;
+	}
+	enum mCoreMemorySearchOp op = params->op;
+	int32_t delta = params->valueInt;
+	size_t found = 0;
+	uint32_t start = block->start;
+	size_t n;
+	size_t i;
+	// TODO: Big endian
+	switch (params->width) {
+	case 4: {
+		const uint32_t* mem32 = mem;
+		const uint32_t* old32 = old;
+		n = size >> 2;
+		SNAPSHOT_OPS(mem32, old32, int32_t, 4);
+		break;
+	}
+	case 2: {
+		const uint16_t* mem16 = mem;
+		const uint16_t* old16 = old;
+		n = size >> 1;
+		SNAPSHOT_OPS(mem16, old16, int32_t, 2);
+		break;
+	}
+	case 1: {
+		const uint8_t* mem8 = mem;
+		const uint8_t* old8 = old;
+		n = size;
+		SNAPSHOT_OPS(mem8, old8, int32_t, 1);
+		break;
+	}
 	}
 	return found;
 }
@@ -217,13 +292,61 @@ static size_t _search(const void* mem, size_t size, const struct mCoreMemoryBloc
 	return 0;
 }
 
-void mCoreMemorySearch(struct mCore* core, const struct mCoreMemorySearchParams* params, struct mCoreMemorySearchResults* out, size_t limit) {
+struct mCoreMemorySearchJob {
+	const struct mCoreMemoryBlock* block;
+	const void* mem;
+	const void* old;
+	size_t size;
+	const struct mCoreMemorySearchParams* params;
+	struct mCoreMemorySearchResults* out;
+	size_t limit;
+	size_t found;
+	struct mCoreMemorySearchResults results;
+	bool parallel;
+};
+
+DECLARE_VECTOR(mCoreMemorySearchJobs, struct mCoreMemorySearchJob);
+DEFINE_VECTOR(mCoreMemorySearchJobs, struct mCoreMemorySearchJob);
+
+static void _runJob(struct mCoreMemorySearchJob* job) {
+	if (job->old) {
+		job->found = _searchSnapshot(job->mem, job->old, job->size, job->block, job->params, job->out, job->limit);
+	} else {
+		job->found = _search(job->mem, job->size, job->block, job->params, job->out, job->limit);
+	}
+}
+
+// Blocks smaller than this are scanned faster than they can be handed to another thread
+#define SEARCH_PARALLEL_MIN 0x10000
+
+#ifndef DISABLE_THREADING
+static void _runParallelJob(void* context, size_t index) {
+	struct mCoreMemorySearchJob* job = mCoreMemorySearchJobsGetPointer(context, index);
+	if (job->parallel) {
+		_runJob(job);
+	}
+}
+#endif
+
+static const struct mCoreMemorySnapshotBlock* _snapshotBlock(const struct mCoreMemorySnapshot* snapshot, size_t id) {
+	size_t i;
+	for (i = 0; i < mCoreMemorySnapshotBlocksSize(&snapshot->blocks); ++i) {
+		const struct mCoreMemorySnapshotBlock* block = mCoreMemorySnapshotBlocksGetConstPointer(&snapshot->blocks, i);
+		if (block->id == id) {
+			return block;
+		}
+	}
+	return NULL;
+}
+
+static void _searchBlocks(struct mCore* core, const struct mCoreMemorySearchParams* params, const struct mCoreMemorySnapshot* snapshot, struct mCoreMemorySearchResults* out, size_t limit) {
 	const struct mCoreMemoryBlock* blocks;
 	size_t nBlocks = core->listMemoryBlocks(core, &blocks);
-	size_t found = 0;
+	struct mCoreMemorySearchJobs jobs;
+	mCoreMemorySearchJobsInit(&jobs, nBlocks);
 
 	size_t b;
-	for (b = 0; (!limit || found < limit) && b < nBlocks; ++b) {
+	for (b = 0; b < nBlocks; ++b) {
 		size_t size;
 		const struct mCoreMemoryBlock* block = &blocks[b];
 		if (!(block->flags & params->memoryFlags)) {
@@ -236,8 +359,148 @@ void mCoreMemorySearch(struct mCore* core, const struct mCoreMemorySearchParams*
 		if (size > block->end - block->start) {
 			size = block->end - block->start; // TOOD: Segments
 		}
-		found += _search(mem, size, block, params, out, limit ? limit - found : 0);
+		const void* old = NULL;
+		if (snapshot) {
+			const struct mCoreMemorySnapshotBlock* oldBlock = _snapshotBlock(snapshot, block->id);
+			if (!oldBlock) {
+				continue;
+			}
+			if (size > oldBlock->size) {
+				size = oldBlock->size;
+			}
+			old = oldBlock->data;
+		}
+		struct mCoreMemorySearchJob* job = mCoreMemorySearchJobsAppend(&jobs);
+		job->block = block;
+		job->mem = mem;
+		job->old = old;
+		job->size = size;
+		job->params = params;
+		job->out = out;
+		job->limit = limit;
+		job->found = 0;
+	}
+
+	size_t nJobs = mCoreMemorySearchJobsSize(&jobs);
+	size_t found = 0;
+	size_t j;
+	size_t nParallel = 0;
+	for (j = 0; j < nJobs; ++j) {
+		struct mCoreMemorySearchJob* job = mCoreMemorySearchJobsGetPointer(&jobs, j);
+		job->parallel = job->size >= SEARCH_PARALLEL_MIN;
+		if (job->parallel) {
+			++nParallel;
+		}
+	}
+#ifndef DISABLE_THREADING
+	// The blocks are independent, so large ones are scanned concurrently when there is more than one.
+	// Each gets its own results, which are appended in block order afterwards so the output matches a serial scan.
+	if (nParallel > 1) {
+		for (j = 0; j < nJobs; ++j) {
+			struct mCoreMemorySearchJob* job = mCoreMemorySearchJobsGetPointer(&jobs, j);
+			if (job->parallel) {
+				mCoreMemorySearchResultsInit(&job->results, 0);
+				job->out = &job->results;
+			}
+		}
+		struct ThreadPool pool;
+		ThreadPoolInit(&pool, nParallel, "Memory Search Thread");
+		ThreadPoolRun(&pool, nJobs, _runParallelJob, &jobs);
+		ThreadPoolDeinit(&pool);
+	} else
+#endif
+	{
+		for (j = 0; j < nJobs; ++j) {
+			mCoreMemorySearchJobsGetPointer(&jobs, j)->parallel = false;
+		}
 	}
+	for (j = 0; j < nJobs && (!limit || found < limit); ++j) {
+		struct mCoreMemorySearchJob* job = mCoreMemorySearchJobsGetPointer(&jobs, j);
+		if (job->parallel) {
+			size_t size = mCoreMemorySearchResultsSize(&job->results);
+			if (limit && size > limit - found) {
+				size = limit - found;
+			}
+			size_t offset = mCoreMemorySearchResultsSize(out);
+			mCoreMemorySearchResultsResize(out, size);
+			memcpy(mCoreMemorySearchResultsGetPointer(out, offset), job->results.vector, size * sizeof(struct mCoreMemorySearchResult));
+			found += size;
+			continue;
+		}
+		job->limit = limit ? limit - found : 0;
+		_runJob(job);
+		found += job->found;
+	}
+	for (j = 0; j < nJobs; ++j) {
+		struct mCoreMemorySearchJob* job = mCoreMemorySearchJobsGetPointer(&jobs, j);
+		if (job->parallel) {
+			mCoreMemorySearchResultsDeinit(&job->results);
+		}
+	}
+	mCoreMemorySearchJobsDeinit(&jobs);
+}
+
+void mCoreMemorySearch(struct mCore* core, const struct mCoreMemorySearchParams* params, struct mCoreMemorySearchResults* out, size_t limit) {
+	_searchBlocks(core, params, NULL, out, limit);
+}
+
+void mCoreMemorySearchSnapshot(struct mCore* core, const struct mCoreMemorySearchParams* params, const struct mCoreMemorySnapshot* snapshot, struct mCoreMemorySearchResults* out, size_t limit) {
+	_searchBlocks(core, params, snapshot, out, limit);
+}
+
+void mCoreMemorySnapshotInit(struct mCoreMemorySnapshot* snapshot) {
+	mCoreMemorySnapshotBlocksInit(&snapshot->blocks, 0);
+}
+
+void mCoreMemorySnapshotDeinit(struct mCoreMemorySnapshot* snapshot) {
+	size_t i;
+	for (i = 0; i < mCoreMemorySnapshotBlocksSize(&snapshot->blocks); ++i) {
+		free(mCoreMemorySnapshotBlocksGetPointer(&snapshot->blocks, i)->data);
+	}
+	mCoreMemorySnapshotBlocksDeinit(&snapshot->blocks);
+}
+
+void mCoreMemorySnapshotTake(struct mCore* core, int memoryFlags, struct mCoreMemorySnapshot* snapshot) {
+	const struct mCoreMemoryBlock* blocks;
+	size_t nBlocks = core->listMemoryBlocks(core, &blocks);
+	size_t used = 0;
+	size_t b;
+	for (b = 0; b < nBlocks; ++b) {
+		size_t size;
+		const struct mCoreMemoryBlock* block = &blocks[b];
+		if (!(block->flags & memoryFlags) || (block->flags & mCORE_MEMORY_VIRTUAL)) {
+			continue;
+		}
+		void* mem = core->getMemoryBlock(core, block->id, &size);
+		if (!mem) {
+			continue;
+		}
+		if (size > block->end - block->start) {
+			size = block->end - block->start; // TOOD: Segments
+		}
+		// Reuse the buffers from the last snapshot where possible, since snapshots tend to be taken over and over
+		struct mCoreMemorySnapshotBlock* copy;
+		if (used < mCoreMemorySnapshotBlocksSize(&snapshot->blocks)) {
+			copy = mCoreMemorySnapshotBlocksGetPointer(&snapshot->blocks, used);
+			if (copy->size != size) {
+				free(copy->data);
+				copy->data = malloc(size);
+			}
+		} else {
+			copy = mCoreMemorySnapshotBlocksAppend(&snapshot->blocks);
+			copy->data = malloc(size);
+		}
+		++used;
+		copy->id = block->id;
+		copy->start = block->start;
+		copy->size = size;
+		memcpy(copy->data, mem, size);
+	}
+	size_t i;
+	for (i = used; i < mCoreMemorySnapshotBlocksSize(&snapshot->blocks); ++i) {
+		free(mCoreMemorySnapshotBlocksGetPointer(&snapshot->blocks, i)->data);
+	}
+	mCoreMemorySnapshotBlocksResize(&snapshot->blocks, (ssize_t) used - (ssize_t) mCoreMemorySnapshotBlocksSize(&snapshot->blocks));
 }
 
 bool _testGuess(struct mCore* core, struct mCoreMemorySearchResult* res, const struct mCoreMemorySearchParams* params) {
@@ -280,42 +543,123 @@ bool _testGuess(struct mCore* core, struct mCoreMemorySearchResult* res, const s
 	return false;
 }
 
+struct mCoreMemoryDirectRange {
+	uint32_t start;
+	uint32_t end;
+	const uint8_t* mem;
+};
+
+#define SEARCH_MAX_DIRECT_RANGES 16
+
+struct mCoreMemoryReader {
+	struct mCore* core;
+	struct mCoreMemoryDirectRange ranges[SEARCH_MAX_DIRECT_RANGES];
+	size_t nRanges;
+	size_t last;
+};
+
+static void _readerInit(struct mCoreMemoryReader* reader, struct mCore* core) {
+	const struct mCoreMemoryBlock* blocks;
+	size_t nBlocks = core->listMemoryBlocks(core, &blocks);
+	reader->core = core;
+	reader->nRanges = 0;
+	reader->last = 0;
+	size_t b;
+	for (b = 0; b < nBlocks && reader->nRanges < SEARCH_MAX_DIRECT_RANGES; ++b) {
+		const struct mCoreMemoryBlock* block = &blocks[b];
+		if ((block->flags & (mCORE_MEMORY_DIRECT | mCORE_MEMORY_VIRTUAL)) != mCORE_MEMORY_DIRECT) {
+			continue;
+		}
+		uint32_t end = block->end;
+		if (block->maxSegment) {
+			// Only the part in front of the banked window always maps to the same memory
+			if (!block->segmentStart) {
+				continue;
+			}
+			end = block->segmentStart;
+		}
+		size_t size;
+		const uint8_t* mem = core->getMemoryBlock(core, block->id, &size);
+		if (!mem) {
+			continue;
+		}
+		if (end - block->start > size) {
+			end = block->start + size;
+		}
+		struct mCoreMemoryDirectRange* range = &reader->ranges[reader->nRanges];
+		range->start = block->start;
+		range->end = end;
+		range->mem = mem;
+		++reader->nRanges;
+	}
+}
+
+// Reads the same value as core->rawRead*, but skips the core for plain memory
+static inline int32_t _readerRead(struct mCoreMemoryReader* reader, uint32_t address, int segment, int width) {
+	if (segment < 0 && !(address & (width - 1)) && reader->nRanges) {
+		// Results are mostly in address order, so try the block the last one was in first
+		size_t r = reader->last;
+		const struct mCoreMemoryDirectRange* range = &reader->ranges[r];
+		if (address < range->start || address + width > range->end) {
+			for (r = 0; r < reader->nRanges; ++r) {
+				range = &reader->ranges[r];
+				if (address >= range->start && address + width <= range->end) {
+					break;
+				}
+			}
+		}
+		if (r < reader->nRanges) {
+			reader->last = r;
+			uint32_t value = 0;
+			switch (width) {
+			case 1:
+				return range->mem[address - range->start];
+			case 2:
+				LOAD_16LE(value, address - range->start, range->mem);
+				return (uint16_t) value;
+			case 4:
+				LOAD_32LE(value, address - range->start, range->mem);
+				return value;
+			}
+		}
+	}
+	switch (width) {
+	case 1:
+		return reader->core->rawRead8(reader->core, address, segment);
+	case 2:
+		return reader->core->rawRead16(reader->core, address, segment);
+	case 4:
+		return reader->core->rawRead32(reader->core, address, segment);
+	}
+	return 0;
+}
+
 void mCoreMemorySearchRepeat(struct mCore* core, const struct mCoreMemorySearchParams* params, struct mCoreMemorySearchResults* inout) {
+	struct mCoreMemoryReader reader;
+	_readerInit(&reader, core);
+	size_t nResults = mCoreMemorySearchResultsSize(inout);
+	struct mCoreMemorySearchResult* results = mCoreMemorySearchResultsGetPointer(inout, 0);
+	bool delta = params->op == mCORE_MEMORY_SEARCH_DELTA;
+	size_t kept = 0;
 	size_t i;
-	for (i = 0; i < mCoreMemorySearchResultsSize(inout); ++i) {
-		struct mCoreMemorySearchResult* res = mCoreMemorySearchResultsGetPointer(inout, i);
+	for (i = 0; i < nResults; ++i) {
+		struct mCoreMemorySearchResult* res = &results[i];
+		bool keep = true;
 		switch (res->type) {
 		case mCORE_MEMORY_SEARCH_INT:
 			if (params->type == mCORE_MEMORY_SEARCH_GUESS) {
-				if (!_testGuess(core, res, params)) {
-					*res = *mCoreMemorySearchResultsGetPointer(inout, mCoreMemorySearchResultsSize(inout) - 1);
-					mCoreMemorySearchResultsResize(inout, -1);
-					--i;
-				}
+				keep = _testGuess(core, res, params);
 			} else if (params->type == mCORE_MEMORY_SEARCH_INT) {
 				int32_t oldValue = params->valueInt;
-				if (params->op == mCORE_MEMORY_SEARCH_DELTA) {
+				if (delta) {
 					oldValue += res->oldValue;
 				}
 				int32_t value = 0;
-				switch (params->width) {
-				case 1:
-					value = core->rawRead8(core, res->address, res->segment);
-					break;
-				case 2:
-					value = core->rawRead16(core, res->address, res->segment);
-					break;
-				case 4:
-					value = core->rawRead32(core, res->address, res->segment);
-					break;
-				default:
-					break;
+				if (params->width == 1 || params->width == 2 || params->width == 4) {
+					value = _readerRead(&reader, res->address, res->segment, params->width);
 				}
-				if (!_op(value, oldValue, params->op)) {
-					*res = *mCoreMemorySearchResultsGetPointer(inout, mCoreMemorySearchResultsSize(inout) - 1);
-					mCoreMemorySearchResultsResize(inout, -1);
-					--i;
-				} else {
+				keep = _op(value, oldValue, params->op);
+				if (keep) {
 					res->oldValue = value;
 				}
 			}
@@ -325,5 +669,70 @@ void mCoreMemorySearchRepeat(struct mCore* core, const struct mCoreMemorySearchP
 			// TOOD
 			break;
 		}
+		// Compact in place, which keeps the results in address order
+		if (keep) {
+			if (kept != i) {
+				results[kept] = *res;
+			}
+			++kept;
+		}
+	}
+	mCoreMemorySearchResultsResize(inout, (ssize_t) kept - (ssize_t) nResults);
+}
+
+static bool _opSnapshot(int32_t value, int32_t old, const struct mCoreMemorySearchParams* params) {
+	switch (params->op) {
+	case mCORE_MEMORY_SEARCH_GREATER:
+		return value > old;
+	case mCORE_MEMORY_SEARCH_LESS:
+		return value < old;
+	case mCORE_MEMORY_SEARCH_EQUAL:
+		return value == old;
+	case mCORE_MEMORY_SEARCH_DELTA:
+		return (uint32_t) value - (uint32_t) old == (uint32_t) params->valueInt;
+	}
+	return false;
+}
+
+void mCoreMemorySearchRepeatSnapshot(struct mCore* core, const struct mCoreMemorySearchParams* params, const struct mCoreMemorySnapshot* snapshot, struct mCoreMemorySearchResults* inout) {
+	struct mCoreMemoryReader reader;
+	_readerInit(&reader, core);
+	int width = params->width;
+	size_t kept = 0;
+	size_t i;
+	for (i = 0; i < mCoreMemorySearchResultsSize(inout); ++i) {
+		struct mCoreMemorySearchResult* res = mCoreMemorySearchResultsGetPointer(inout, i);
+		if (res->type != mCORE_MEMORY_SEARCH_INT || params->type != mCORE_MEMORY_SEARCH_INT || (width != 1 && width != 2 && width != 4)) {
+			continue;
+		}
+		const struct mCoreMemorySnapshotBlock* block = NULL;
+		size_t b;
+		for (b = 0; b < mCoreMemorySnapshotBlocksSize(&snapshot->blocks); ++b) {
+			const struct mCoreMemorySnapshotBlock* candidate = mCoreMemorySnapshotBlocksGetConstPointer(&snapshot->blocks, b);
+			if (res->address >= candidate->start && res->address - candidate->start + width <= candidate->size) {
+				block = candidate;
+				break;
+			}
+		}
+		// Values that weren't in the snapshot have nothing to be compared against
+		if (!block || res->segment >= 0) {
+			continue;
+		}
+		const uint8_t* data = &block->data[res->address - block->start];
+		uint32_t old = 0;
+		int byte;
+		for (byte = width; byte--;) {
+			old = (old << 8) | data[byte];
+		}
+		int32_t value = _readerRead(&reader, res->address, res->segment, width);
+		if (!_opSnapshot(value, old, params)) {
+			continue;
+		}
+		res->oldValue = value;
+		if (kept != i) {
+			*mCoreMemorySearchResultsGetPointer(inout, kept) = *res;
+		}
+		++kept;
 	}
+	mCoreMemorySearchResultsResize(inout, (ssize_t) kept - (ssize_t) mCoreMemorySearchResultsSize(inout));
 }
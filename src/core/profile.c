@@ -0,0 +1,73 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/core/profile.h>
+
+void mProfileInit(struct mProfile* profile) {
+	memset(profile, 0, sizeof(*profile));
+}
+
+void mProfileClear(struct mProfile* profile) {
+	size_t i;
+	for (i = 0; i < profile->nEvents; ++i) {
+		profile->events[i].count = 0;
+	}
+	for (i = 0; i < profile->nModes; ++i) {
+		profile->instructions[i].count = 0;
+	}
+	for (i = 0; i < profile->nDMAs; ++i) {
+		profile->dma[i].count = 0;
+	}
+	profile->eventsUnlisted = 0;
+	profile->scanlinesRendered = 0;
+	profile->scanlinesSkipped = 0;
+	profile->proxyPackets = 0;
+	profile->proxyBytes = 0;
+}
+
+void mProfileCountEvent(struct mProfile* profile, const char* name) {
+	if (!name) {
+		name = "Unnamed";
+	}
+	size_t i;
+	// Event names are string literals, so comparing pointers almost always suffices
+	for (i = 0; i < profile->nEvents; ++i) {
+		if (profile->events[i].name == name) {
+			++profile->events[i].count;
+			return;
+		}
+	}
+	for (i = 0; i < profile->nEvents; ++i) {
+		if (strcmp(profile->events[i].name, name) == 0) {
+			++profile->events[i].count;
+			return;
+		}
+	}
+	if (profile->nEvents == mPROFILE_MAX_EVENTS) {
+		++profile->eventsUnlisted;
+		return;
+	}
+	profile->events[profile->nEvents].name = name;
+	profile->events[profile->nEvents].count = 1;
+	++profile->nEvents;
+}
+
+uint64_t mProfileTotalEvents(const struct mProfile* profile) {
+	uint64_t total = profile->eventsUnlisted;
+	size_t i;
+	for (i = 0; i < profile->nEvents; ++i) {
+		total += profile->events[i].count;
+	}
+	return total;
+}
+
+uint64_t mProfileTotalInstructions(const struct mProfile* profile) {
+	uint64_t total = 0;
+	size_t i;
+	for (i = 0; i < profile->nModes; ++i) {
+		total += profile->instructions[i].count;
+	}
+	return total;
+}
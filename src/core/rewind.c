@@ -30,6 +30,10 @@ void mCoreRewindContextInit(struct mCoreRewindContext* context, size_t entries,
 	context->previousState = VFileMemChunk(0, 0);
 	context->currentState = VFileMemChunk(0, 0);
 	context->size = 0;
+	context->stateMask.bits = NULL;
+	context->stateMask.pages = 0;
+	context->trackingDirty = false;
+	context->maskValid = false;
 #ifndef DISABLE_THREADING
 	context->onThread = onThread;
 	context->ready = false;
@@ -62,6 +66,7 @@ void mCoreRewindContextDeinit(struct mCoreRewindContext* context) {
 	context->currentState->close(context->currentState);
 	context->previousState = NULL;
 	context->currentState = NULL;
+	DirtyBitmapDeinit(&context->stateMask);
 	size_t s;
 	for (s = 0; s < mCoreRewindPatchesSize(&context->patchMemory); ++s) {
 		deinitPatchFast(mCoreRewindPatchesGetPointer(&context->patchMemory, s));
@@ -76,7 +81,18 @@ void mCoreRewindAppend(struct mCoreRewindContext* context, struct mCore* core) {
 	}
 #endif
 	struct VFile* nextState = context->previousState;
+	if (context->trackingDirty) {
+		context->maskValid = core->stateDirtyPages(core, &context->stateMask);
+	} else {
+		// The previous snapshot isn't known to match the core yet, so the first
+		// diff always has to cover everything
+		DirtyBitmapInit(&context->stateMask, core->stateSize(core));
+		core->setDirtyTracking(core, true);
+		context->trackingDirty = true;
+		context->maskValid = false;
+	}
 	mCoreSaveStateNamed(core, nextState, SAVESTATE_SAVEDATA | SAVESTATE_RTC);
+	core->clearDirtyPages(core);
 	context->previousState = context->currentState;
 	context->currentState = nextState;
 #ifndef DISABLE_THREADING
@@ -109,7 +125,11 @@ void _rewindDiff(struct mCoreRewindContext* context) {
 	}
 	void* current = context->previousState->map(context->previousState, size, MAP_READ);
 	void* next = context->currentState->map(context->currentState, size, MAP_READ);
-	diffPatchFast(patch, current, next, size);
+	if (context->maskValid) {
+		diffPatchFastMasked(patch, current, next, size, &context->stateMask);
+	} else {
+		diffPatchFast(patch, current, next, size);
+	}
 	context->previousState->unmap(context->previousState, current, size);
 	context->currentState->unmap(context->currentState, next, size);
 }
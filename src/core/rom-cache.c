@@ -0,0 +1,156 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifdef HAVE_MEMFD_CREATE
+#ifndef _GNU_SOURCE
+// For memfd_create
+#define _GNU_SOURCE
+#endif
+#endif
+#include <mgba/core/rom-cache.h>
+
+static bool _enabled = false;
+
+void mROMCacheSetEnabled(bool enable) {
+	_enabled = enable;
+}
+
+bool mROMCacheIsEnabled(void) {
+	return _enabled;
+}
+
+#ifdef HAVE_MEMFD_CREATE
+#ifndef DISABLE_THREADING
+#include <mgba-util/threading.h>
+#endif
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+struct mROMCacheEntry {
+	struct mROMCacheEntry* next;
+	uint32_t hash;
+	size_t size;
+	size_t mappedSize;
+	int fd;
+	const void* contents;
+	unsigned refs;
+};
+
+static struct mROMCacheEntry* _entries = NULL;
+#ifndef DISABLE_THREADING
+static Mutex _mutex = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK MutexLock(&_mutex)
+#define UNLOCK MutexUnlock(&_mutex)
+#else
+#define LOCK
+#define UNLOCK
+#endif
+
+static struct mROMCacheEntry* _createEntry(const void* rom, size_t romSize, uint32_t hash) {
+	size_t pageSize = sysconf(_SC_PAGESIZE);
+	size_t mappedSize = (romSize + pageSize - 1) & ~(pageSize - 1);
+	int fd = memfd_create("rom", MFD_CLOEXEC);
+	if (fd < 0) {
+		return NULL;
+	}
+	if (ftruncate(fd, mappedSize) < 0) {
+		close(fd);
+		return NULL;
+	}
+	void* contents = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (contents == MAP_FAILED) {
+		close(fd);
+		return NULL;
+	}
+	memcpy(contents, rom, romSize);
+	mprotect(contents, mappedSize, PROT_READ);
+
+	struct mROMCacheEntry* entry = malloc(sizeof(*entry));
+	entry->hash = hash;
+	entry->size = romSize;
+	entry->mappedSize = mappedSize;
+	entry->fd = fd;
+	entry->contents = contents;
+	entry->refs = 0;
+	entry->next = _entries;
+	_entries = entry;
+	return entry;
+}
+
+static void _destroyEntry(struct mROMCacheEntry* entry) {
+	struct mROMCacheEntry** previous = &_entries;
+	while (*previous != entry) {
+		previous = &(*previous)->next;
+	}
+	*previous = entry->next;
+	munmap((void*) entry->contents, entry->mappedSize);
+	close(entry->fd);
+	free(entry);
+}
+
+void* mROMCacheMap(const void* rom, size_t romSize, uint32_t hash, size_t viewSize, struct mROMCacheEntry** entryOut) {
+	if (!_enabled || !romSize || romSize > viewSize) {
+		return NULL;
+	}
+	LOCK;
+	struct mROMCacheEntry* entry;
+	for (entry = _entries; entry; entry = entry->next) {
+		if (entry->hash == hash && entry->size == romSize && memcmp(entry->contents, rom, romSize) == 0) {
+			break;
+		}
+	}
+	if (!entry) {
+		entry = _createEntry(rom, romSize, hash);
+		if (!entry) {
+			UNLOCK;
+			return NULL;
+		}
+	}
+
+	// Reserve the whole view as zeroed memory, then put a private mapping of the ROM over its start
+	void* view = mmap(NULL, viewSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (view != MAP_FAILED && mmap(view, entry->mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, entry->fd, 0) == MAP_FAILED) {
+		munmap(view, viewSize);
+		view = MAP_FAILED;
+	}
+	if (view == MAP_FAILED) {
+		if (!entry->refs) {
+			_destroyEntry(entry);
+		}
+		UNLOCK;
+		return NULL;
+	}
+	++entry->refs;
+	UNLOCK;
+	*entryOut = entry;
+	return view;
+}
+
+void mROMCacheUnmap(struct mROMCacheEntry* entry, void* view, size_t viewSize) {
+	munmap(view, viewSize);
+	LOCK;
+	--entry->refs;
+	if (!entry->refs) {
+		_destroyEntry(entry);
+	}
+	UNLOCK;
+}
+#else
+void* mROMCacheMap(const void* rom, size_t romSize, uint32_t hash, size_t viewSize, struct mROMCacheEntry** entry) {
+	UNUSED(rom);
+	UNUSED(romSize);
+	UNUSED(hash);
+	UNUSED(viewSize);
+	UNUSED(entry);
+	return NULL;
+}
+
+void mROMCacheUnmap(struct mROMCacheEntry* entry, void* view, size_t viewSize) {
+	UNUSED(entry);
+	UNUSED(view);
+	UNUSED(viewSize);
+}
+#endif
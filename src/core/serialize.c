@@ -8,6 +8,7 @@
 #include <mgba/core/core.h>
 #include <mgba/core/cheats.h>
 #include <mgba/core/interface.h>
+#include <mgba-util/hash.h>
 #include <mgba-util/memory.h>
 #include <mgba-util/vfs.h>
 
@@ -65,21 +66,19 @@ bool mStateExtdataGet(struct mStateExtdata* extdata, enum mStateExtdataTag tag,
 	return true;
 }
 
-bool mStateExtdataSerialize(struct mStateExtdata* extdata, struct VFile* vf) {
-	ssize_t position = vf->seek(vf, 0, SEEK_CUR);
-	ssize_t size = sizeof(struct mStateExtdataHeader);
-	size_t i = 0;
+static size_t _extdataHeaderSize(const struct mStateExtdata* extdata) {
+	size_t size = sizeof(struct mStateExtdataHeader);
+	size_t i;
 	for (i = 1; i < EXTDATA_MAX; ++i) {
 		if (extdata->data[i].data) {
 			size += sizeof(struct mStateExtdataHeader);
 		}
 	}
-	if (size == sizeof(struct mStateExtdataHeader)) {
-		return true;
-	}
-	struct mStateExtdataHeader* header = malloc(size);
-	position += size;
+	return size;
+}
 
+static void _extdataFillHeader(const struct mStateExtdata* extdata, struct mStateExtdataHeader* header, int64_t position) {
+	size_t i;
 	size_t j;
 	for (i = 1, j = 0; i < EXTDATA_MAX; ++i) {
 		if (extdata->data[i].data) {
@@ -90,9 +89,18 @@ bool mStateExtdataSerialize(struct mStateExtdata* extdata, struct VFile* vf) {
 			++j;
 		}
 	}
-	header[j].tag = 0;
-	header[j].size = 0;
-	header[j].offset = 0;
+	memset(&header[j], 0, sizeof(header[j]));
+}
+
+bool mStateExtdataSerialize(struct mStateExtdata* extdata, struct VFile* vf) {
+	ssize_t position = vf->seek(vf, 0, SEEK_CUR);
+	ssize_t size = _extdataHeaderSize(extdata);
+	size_t i;
+	if (size == sizeof(struct mStateExtdataHeader)) {
+		return true;
+	}
+	struct mStateExtdataHeader* header = malloc(size);
+	_extdataFillHeader(extdata, header, position + size);
 
 	if (vf->write(vf, header, size) != size) {
 		free(header);
@@ -299,11 +307,7 @@ static void* _loadPNGState(struct mCore* core, struct VFile* vf, struct mStateEx
 }
 #endif
 
-bool mCoreSaveStateNamed(struct mCore* core, struct VFile* vf, int flags) {
-	struct mStateExtdata extdata;
-	mStateExtdataInit(&extdata);
-	size_t stateSize = core->stateSize(core);
-
+static void _collectExtdata(struct mCore* core, struct mStateExtdata* extdata, int flags, struct VFile** cheatVfOut) {
 	if (flags & SAVESTATE_METADATA) {
 		uint64_t* creationUsec = malloc(sizeof(*creationUsec));
 #ifndef _MSC_VER
@@ -330,7 +334,7 @@ bool mCoreSaveStateNamed(struct mCore* core, struct VFile* vf, int flags) {
 			.data = creationUsec,
 			.clean = free
 		};
-		mStateExtdataPut(&extdata, EXTDATA_META_TIME, &item);
+		mStateExtdataPut(extdata, EXTDATA_META_TIME, &item);
 	}
 
 	if (flags & SAVESTATE_SAVEDATA) {
@@ -342,13 +346,13 @@ bool mCoreSaveStateNamed(struct mCore* core, struct VFile* vf, int flags) {
 				.data = sram,
 				.clean = free
 			};
-			mStateExtdataPut(&extdata, EXTDATA_SAVEDATA, &item);
+			mStateExtdataPut(extdata, EXTDATA_SAVEDATA, &item);
 		}
 	}
-	struct VFile* cheatVf = 0;
 	struct mCheatDevice* device;
 	if (flags & SAVESTATE_CHEATS && (device = core->cheatDevice(core))) {
-		cheatVf = VFileMemChunk(0, 0);
+		struct VFile* cheatVf = VFileMemChunk(0, 0);
+		*cheatVfOut = cheatVf;
 		if (cheatVf) {
 			mCheatSaveFile(device, cheatVf);
 			struct mStateExtdataItem item = {
@@ -356,16 +360,25 @@ bool mCoreSaveStateNamed(struct mCore* core, struct VFile* vf, int flags) {
 				.data = cheatVf->map(cheatVf, cheatVf->size(cheatVf), MAP_READ),
 				.clean = 0
 			};
-			mStateExtdataPut(&extdata, EXTDATA_CHEATS, &item);
+			mStateExtdataPut(extdata, EXTDATA_CHEATS, &item);
 		}
 	}
 	if (flags & SAVESTATE_RTC) {
 		struct mStateExtdataItem item;
 		if (core->rtc.d.serialize) {
 			core->rtc.d.serialize(&core->rtc.d, &item);
-			mStateExtdataPut(&extdata, EXTDATA_RTC, &item);
+			mStateExtdataPut(extdata, EXTDATA_RTC, &item);
 		}
 	}
+}
+
+bool mCoreSaveStateNamed(struct mCore* core, struct VFile* vf, int flags) {
+	struct mStateExtdata extdata;
+	mStateExtdataInit(&extdata);
+	size_t stateSize = core->stateSize(core);
+
+	struct VFile* cheatVf = 0;
+	_collectExtdata(core, &extdata, flags, &cheatVf);
 #ifdef USE_PNG
 	if (!(flags & SAVESTATE_SCREENSHOT)) {
 #else
@@ -420,21 +433,12 @@ void* mCoreExtractState(struct mCore* core, struct VFile* vf, struct mStateExtda
 	return state;
 }
 
-bool mCoreLoadStateNamed(struct mCore* core, struct VFile* vf, int flags) {
-	struct mStateExtdata extdata;
-	mStateExtdataInit(&extdata);
-	void* state = mCoreExtractState(core, vf, &extdata);
-	if (!state) {
-		return false;
-	}
-	bool success = core->loadState(core, state);
-	mappedMemoryFree(state, core->stateSize(core));
-
+static void _applyExtdata(struct mCore* core, struct mStateExtdata* extdata, int flags) {
 	unsigned width, height;
 	core->desiredVideoDimensions(core, &width, &height);
 
 	struct mStateExtdataItem item;
-	if (flags & SAVESTATE_SCREENSHOT && mStateExtdataGet(&extdata, EXTDATA_SCREENSHOT, &item)) {
+	if (flags & SAVESTATE_SCREENSHOT && mStateExtdataGet(extdata, EXTDATA_SCREENSHOT, &item)) {
 		mLOG(SAVESTATE, INFO, "Loading screenshot");
 		if (item.size >= (int) (width * height) * 4) {
 			core->putPixels(core, item.data, width);
@@ -442,17 +446,17 @@ bool mCoreLoadStateNamed(struct mCore* core, struct VFile* vf, int flags) {
 			mLOG(SAVESTATE, WARN, "Savestate includes invalid screenshot");
 		}
 	}
-	if (mStateExtdataGet(&extdata, EXTDATA_SAVEDATA, &item)) {
+	if (mStateExtdataGet(extdata, EXTDATA_SAVEDATA, &item)) {
 		mLOG(SAVESTATE, INFO, "Loading savedata");
 		if (item.data) {
 			core->savedataRestore(core, item.data, item.size, flags & SAVESTATE_SAVEDATA);
 		}
 	}
 	struct mCheatDevice* device;
-	if (flags & SAVESTATE_CHEATS && (device = core->cheatDevice(core)) && mStateExtdataGet(&extdata, EXTDATA_CHEATS, &item)) {
+	if (flags & SAVESTATE_CHEATS && (device = core->cheatDevice(core)) && mStateExtdataGet(extdata, EXTDATA_CHEATS, &item)) {
 		mLOG(SAVESTATE, INFO, "Loading cheats");
 		if (item.size) {
-			struct VFile* svf = VFileFromMemory(item.data, item.size);
+			struct VFile* svf = VFileFromConstMemory(item.data, item.size);
 			if (svf) {
 				mCheatDeviceClear(device);
 				mCheatParseFile(device, svf);
@@ -460,13 +464,131 @@ bool mCoreLoadStateNamed(struct mCore* core, struct VFile* vf, int flags) {
 			}
 		}
 	}
-	if (flags & SAVESTATE_RTC && mStateExtdataGet(&extdata, EXTDATA_RTC, &item)) {
+	if (flags & SAVESTATE_RTC && mStateExtdataGet(extdata, EXTDATA_RTC, &item)) {
 		mLOG(SAVESTATE, INFO, "Loading RTC");
 		if (core->rtc.d.deserialize) {
 			core->rtc.d.deserialize(&core->rtc.d, &item);
 		}
 	}
+}
+
+bool mCoreLoadStateNamed(struct mCore* core, struct VFile* vf, int flags) {
+	struct mStateExtdata extdata;
+	mStateExtdataInit(&extdata);
+	void* state = mCoreExtractState(core, vf, &extdata);
+	if (!state) {
+		return false;
+	}
+	bool success = core->loadState(core, state);
+	mappedMemoryFree(state, core->stateSize(core));
+
+	_applyExtdata(core, &extdata, flags);
 	mStateExtdataDeinit(&extdata);
 	return success;
 }
 
+size_t mCoreSaveStateBufferSize(struct mCore* core, size_t maxSavedataSize, int flags) {
+	// One header per kind of extdata that can be present, plus the terminator
+	size_t size = core->stateSize(core) + sizeof(struct mStateExtdataHeader) * 4;
+	if (flags & SAVESTATE_METADATA) {
+		size += sizeof(uint64_t);
+	}
+	if (flags & SAVESTATE_SAVEDATA) {
+		size += maxSavedataSize;
+	}
+	if (flags & SAVESTATE_RTC && core->rtc.d.serialize) {
+		struct mStateExtdataItem item = {0};
+		core->rtc.d.serialize(&core->rtc.d, &item);
+		size += item.size;
+		if (item.data && item.clean) {
+			item.clean(item.data);
+		}
+	}
+	return size;
+}
+
+bool mCoreSaveStateBuffer(struct mCore* core, void* buffer, size_t size, int flags) {
+	size_t stateSize = core->stateSize(core);
+	if (size < stateSize) {
+		return false;
+	}
+	struct mStateExtdata extdata;
+	mStateExtdataInit(&extdata);
+	struct VFile* cheatVf = 0;
+	_collectExtdata(core, &extdata, flags & ~SAVESTATE_SCREENSHOT, &cheatVf);
+
+	uint8_t* bytes = buffer;
+	core->saveState(core, bytes);
+	size_t position = stateSize;
+	bool success = true;
+	size_t headerSize = _extdataHeaderSize(&extdata);
+	if (headerSize > sizeof(struct mStateExtdataHeader)) {
+		size_t i;
+		size_t end = position + headerSize;
+		for (i = 1; i < EXTDATA_MAX; ++i) {
+			end += extdata.data[i].data ? extdata.data[i].size : 0;
+		}
+		if (end > size) {
+			success = false;
+		} else {
+			_extdataFillHeader(&extdata, (struct mStateExtdataHeader*) &bytes[position], position + headerSize);
+			position += headerSize;
+			for (i = 1; i < EXTDATA_MAX; ++i) {
+				if (extdata.data[i].data) {
+					memcpy(&bytes[position], extdata.data[i].data, extdata.data[i].size);
+					position += extdata.data[i].size;
+				}
+			}
+		}
+	}
+	if (success) {
+		// Zero the slack so the same state always produces the same bytes
+		memset(&bytes[position], 0, size - position);
+	}
+	mStateExtdataDeinit(&extdata);
+	if (cheatVf) {
+		cheatVf->close(cheatVf);
+	}
+	return success;
+}
+
+bool mCoreLoadStateBuffer(struct mCore* core, const void* buffer, size_t size, int flags) {
+	size_t stateSize = core->stateSize(core);
+	if (size < stateSize) {
+		return false;
+	}
+	struct mStateExtdata extdata;
+	mStateExtdataInit(&extdata);
+	const uint8_t* bytes = buffer;
+	size_t position;
+	for (position = stateSize; position + sizeof(struct mStateExtdataHeader) <= size; position += sizeof(struct mStateExtdataHeader)) {
+		struct mStateExtdataHeader header;
+		LOAD_32LE(header.tag, offsetof(struct mStateExtdataHeader, tag), &bytes[position]);
+		LOAD_32LE(header.size, offsetof(struct mStateExtdataHeader, size), &bytes[position]);
+		LOAD_64LE(header.offset, offsetof(struct mStateExtdataHeader, offset), &bytes[position]);
+		if (header.tag == EXTDATA_NONE) {
+			break;
+		}
+		if (header.tag >= EXTDATA_MAX || header.size < 0 || header.offset < 0 || (uint64_t) header.offset + header.size > size) {
+			continue;
+		}
+		// Items point straight into the caller's buffer, so there is nothing to clean up
+		struct mStateExtdataItem item = {
+			.data = (void*) &bytes[header.offset],
+			.size = header.size,
+			.clean = NULL
+		};
+		mStateExtdataPut(&extdata, header.tag, &item);
+	}
+	bool success = core->loadState(core, buffer);
+	_applyExtdata(core, &extdata, flags);
+	mStateExtdataDeinit(&extdata);
+	return success;
+}
+
+void mCoreHashState(struct mCore* core, uint64_t hash[2]) {
+	struct Hash128 state;
+	hash128Init(&state, 0);
+	core->hashState(core, &state);
+	hash128Finish(&state, hash);
+}
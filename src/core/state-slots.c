@@ -0,0 +1,200 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/core/state-slots.h>
+
+#include <mgba/core/core.h>
+#include <mgba/core/serialize.h>
+#include <mgba-util/vfs.h>
+
+#define STATE_SLOTS_MAGIC "mGBAslot"
+#define STATE_SLOTS_VERSION 1
+// Large enough for every page size in use, so that each copy can be synced on its own
+#define STATE_SLOTS_ALIGN 0x4000
+
+struct mStateSlotsHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t slots;
+	uint64_t slotSize;
+	uint64_t reserved;
+	// Followed by two 32-bit sequence numbers per slot, one per copy
+};
+
+static size_t _align(size_t size) {
+	return (size + STATE_SLOTS_ALIGN - 1) & ~(size_t) (STATE_SLOTS_ALIGN - 1);
+}
+
+static size_t _sequenceOffset(unsigned slot, int copy) {
+	return sizeof(struct mStateSlotsHeader) + (slot * 2 + copy) * sizeof(uint32_t);
+}
+
+static uint32_t _sequence(const struct mStateSlots* slots, unsigned slot, int copy) {
+	uint32_t sequence;
+	LOAD_32LE(sequence, _sequenceOffset(slot, copy), slots->data);
+	return sequence;
+}
+
+static uint8_t* _copy(const struct mStateSlots* slots, unsigned slot, int copy) {
+	return &slots->data[slots->headerSize + (slot * 2 + copy) * slots->slotSize];
+}
+
+static int _newest(const struct mStateSlots* slots, unsigned slot) {
+	uint32_t a = _sequence(slots, slot, 0);
+	uint32_t b = _sequence(slots, slot, 1);
+	if (!a && !b) {
+		return -1;
+	}
+	return a > b ? 0 : 1;
+}
+
+static bool _syncHeader(struct mStateSlots* slots) {
+	return !slots->durable || slots->vf->sync(slots->vf, slots->data, slots->headerSize);
+}
+
+static bool _headerMatches(struct VFile* vf, unsigned nSlots, size_t slotSize) {
+	struct mStateSlotsHeader header;
+	if (vf->seek(vf, 0, SEEK_SET) < 0 || vf->read(vf, &header, sizeof(header)) != (ssize_t) sizeof(header)) {
+		return false;
+	}
+	uint32_t version;
+	uint32_t slots;
+	uint64_t size;
+	LOAD_32LE(version, 0, &header.version);
+	LOAD_32LE(slots, 0, &header.slots);
+	LOAD_64LE(size, 0, &header.slotSize);
+	return memcmp(header.magic, STATE_SLOTS_MAGIC, sizeof(header.magic)) == 0 &&
+	       version == STATE_SLOTS_VERSION && slots == nSlots && size == slotSize;
+}
+
+bool mStateSlotsInit(struct mStateSlots* slots, struct VFile* vf, unsigned nSlots, size_t slotSize) {
+	if (!vf || !nSlots || !slotSize) {
+		return false;
+	}
+	slots->vf = vf;
+	slots->nSlots = nSlots;
+	slots->slotSize = _align(slotSize);
+	slots->headerSize = _align(_sequenceOffset(nSlots, 0));
+	slots->mapSize = slots->headerSize + slots->slotSize * 2 * nSlots;
+	slots->sequence = 0;
+	slots->durable = true;
+
+	bool reuse = vf->size(vf) == (ssize_t) slots->mapSize && _headerMatches(vf, nSlots, slots->slotSize);
+	if (!reuse) {
+		// Truncating away the old contents first leaves the new file sparse until slots are used
+		vf->truncate(vf, 0);
+		vf->truncate(vf, slots->mapSize);
+		if (vf->size(vf) != (ssize_t) slots->mapSize) {
+			return false;
+		}
+	}
+	slots->data = vf->map(vf, slots->mapSize, MAP_READ | MAP_WRITE);
+	if (!slots->data || slots->data == (void*) -1) {
+		slots->data = NULL;
+		return false;
+	}
+
+	if (!reuse) {
+		memset(slots->data, 0, slots->headerSize);
+		struct mStateSlotsHeader* header = (struct mStateSlotsHeader*) slots->data;
+		memcpy(header->magic, STATE_SLOTS_MAGIC, sizeof(header->magic));
+		STORE_32LE(STATE_SLOTS_VERSION, 0, &header->version);
+		STORE_32LE(nSlots, 0, &header->slots);
+		STORE_64LE(slots->slotSize, 0, &header->slotSize);
+		vf->sync(vf, slots->data, slots->headerSize);
+		return true;
+	}
+
+	unsigned i;
+	for (i = 0; i < nSlots; ++i) {
+		uint32_t a = _sequence(slots, i, 0);
+		uint32_t b = _sequence(slots, i, 1);
+		if (a > slots->sequence) {
+			slots->sequence = a;
+		}
+		if (b > slots->sequence) {
+			slots->sequence = b;
+		}
+	}
+	return true;
+}
+
+void mStateSlotsDeinit(struct mStateSlots* slots) {
+	if (!slots->data) {
+		return;
+	}
+	slots->vf->unmap(slots->vf, slots->data, slots->mapSize);
+	slots->data = NULL;
+}
+
+void mStateSlotsSetDurable(struct mStateSlots* slots, bool durable) {
+	slots->durable = durable;
+}
+
+bool mStateSlotsSave(struct mStateSlots* slots, struct mCore* core, unsigned slot, int flags) {
+	if (!slots->data || slot >= slots->nSlots) {
+		return false;
+	}
+	int copy = _newest(slots, slot) == 0 ? 1 : 0;
+
+	// The copy being overwritten is the older one, so it is retired before it is touched
+	// and only published again once the new state is completely written
+	STORE_32LE(0, _sequenceOffset(slot, copy), slots->data);
+	uint8_t* buffer = _copy(slots, slot, copy);
+	if (!mCoreSaveStateBuffer(core, buffer, slots->slotSize, flags)) {
+		return false;
+	}
+	if (slots->durable && !slots->vf->sync(slots->vf, buffer, slots->slotSize)) {
+		return false;
+	}
+	++slots->sequence;
+	STORE_32LE(slots->sequence, _sequenceOffset(slot, copy), slots->data);
+	return _syncHeader(slots);
+}
+
+bool mStateSlotsLoad(struct mStateSlots* slots, struct mCore* core, unsigned slot, int flags) {
+	if (!slots->data || slot >= slots->nSlots) {
+		return false;
+	}
+	int copy = _newest(slots, slot);
+	if (copy < 0) {
+		return false;
+	}
+	return mCoreLoadStateBuffer(core, _copy(slots, slot, copy), slots->slotSize, flags);
+}
+
+void mStateSlotsDelete(struct mStateSlots* slots, unsigned slot) {
+	if (!slots->data || slot >= slots->nSlots) {
+		return;
+	}
+	STORE_32LE(0, _sequenceOffset(slot, 0), slots->data);
+	STORE_32LE(0, _sequenceOffset(slot, 1), slots->data);
+	_syncHeader(slots);
+}
+
+uint32_t mStateSlotsSequence(const struct mStateSlots* slots, unsigned slot) {
+	if (!slots->data || slot >= slots->nSlots) {
+		return 0;
+	}
+	int copy = _newest(slots, slot);
+	if (copy < 0) {
+		return 0;
+	}
+	return _sequence(slots, slot, copy);
+}
+
+const void* mStateSlotsGet(const struct mStateSlots* slots, unsigned slot, size_t* size) {
+	if (!slots->data || slot >= slots->nSlots) {
+		return NULL;
+	}
+	int copy = _newest(slots, slot);
+	if (copy < 0) {
+		return NULL;
+	}
+	if (size) {
+		*size = slots->slotSize;
+	}
+	return _copy(slots, slot, copy);
+}
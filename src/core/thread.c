@@ -101,6 +101,9 @@ void _frameStarted(void* context) {
 	if (!thread) {
 		return;
 	}
+	if (thread->impl->runAhead.hidden) {
+		return;
+	}
 	if (thread->core->opts.rewindEnable && thread->core->opts.rewindBufferCapacity > 0) {
 		if (thread->impl->state != THREAD_REWINDING) {
 			mCoreRewindAppend(&thread->impl->rewind, thread->core);
@@ -117,6 +120,10 @@ void _frameEnded(void* context) {
 	if (!thread) {
 		return;
 	}
+	if (thread->impl->runAhead.active) {
+		// The run-ahead loop reports the frame itself once the predicted one is ready
+		return;
+	}
 	if (thread->frameCallback) {
 		thread->frameCallback(thread);
 	}
@@ -140,6 +147,140 @@ void _coreSleep(void* context) {
 	}
 }
 
+static uint64_t _runAheadMicros(void) {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return 1000000ULL * tv.tv_sec + tv.tv_usec;
+}
+
+static void _runAheadShareVideoBuffer(struct mCore* core, struct mCore* ahead) {
+	// The second core draws the frame that gets shown, so it renders straight into the main core's buffer
+	const void* pixels;
+	size_t stride;
+	core->getPixels(core, &pixels, &stride);
+	ahead->setVideoBuffer(ahead, (color_t*) pixels, stride);
+}
+
+static void _runAheadResizeState(struct mCoreThreadRunAhead* runAhead, struct mCore* core) {
+	void* savedata = NULL;
+	size_t savedataSize = core->savedataClone(core, &savedata);
+	free(savedata);
+	if (savedataSize > runAhead->maxSavedataSize) {
+		runAhead->maxSavedataSize = savedataSize;
+	}
+	size_t stateSize = mCoreSaveStateBufferSize(core, runAhead->maxSavedataSize, SAVESTATE_SAVEDATA);
+	if (stateSize != runAhead->stateSize) {
+		free(runAhead->state);
+		runAhead->state = malloc(stateSize);
+		runAhead->stateSize = stateSize;
+	}
+}
+
+static void _runAheadSaveState(struct mCoreThreadRunAhead* runAhead, struct mCore* core) {
+	// Frames run ahead can write to savedata, so it has to be rolled back along with everything else
+	if (!mCoreSaveStateBuffer(core, runAhead->state, runAhead->stateSize, SAVESTATE_SAVEDATA)) {
+		// Savedata can grow after the buffer was sized, e.g. once the game first probes flash
+		_runAheadResizeState(runAhead, core);
+		mCoreSaveStateBuffer(core, runAhead->state, runAhead->stateSize, SAVESTATE_SAVEDATA);
+	}
+}
+
+static void _runAheadResetSecondary(struct mCoreThread* threadContext) {
+	struct mCore* ahead = threadContext->runAheadCore;
+	// Cores only attach their renderer on reset if they already have somewhere to draw
+	_runAheadShareVideoBuffer(threadContext->core, ahead);
+	ahead->reset(ahead);
+	threadContext->impl->runAhead.secondaryValid = false;
+}
+
+static void _runAheadFrame(struct mCoreThread* threadContext) {
+	struct mCoreThreadInternal* impl = threadContext->impl;
+	struct mCoreThreadRunAhead* runAhead = &impl->runAhead;
+	struct mCore* core = threadContext->core;
+	struct mCore* ahead = threadContext->runAheadCore;
+	uint64_t start = _runAheadMicros();
+	uint64_t stateUsec = 0;
+	unsigned emulated = 0;
+	unsigned loads = 0;
+	int i;
+
+	// Frames run here would otherwise post to the sync on their own, so audio and
+	// video are handed over manually once the real and predicted frames are done
+	core->setSync(core, NULL);
+	runAhead->active = true;
+
+	core->enableOutput(core, false, true);
+	core->runFrame(core);
+	++emulated;
+	mCoreSyncLockAudio(&impl->sync);
+	mCoreSyncProduceAudio(&impl->sync, core->getAudioChannel(core, 0), core->getAudioBufferSize(core));
+
+	if (ahead) {
+		uint32_t keys = core->getKeys(core);
+		if (!runAhead->secondaryValid || keys != runAhead->predictedKeys) {
+			uint64_t stateStart = _runAheadMicros();
+			_runAheadSaveState(runAhead, core);
+			// Loading without SAVESTATE_SAVEDATA only masks the second core's savedata,
+			// so nothing it writes ever reaches a file
+			mCoreLoadStateBuffer(ahead, runAhead->state, runAhead->stateSize, 0);
+			stateUsec += _runAheadMicros() - stateStart;
+			++loads;
+
+			ahead->setKeys(ahead, keys);
+			ahead->enableOutput(ahead, false, false);
+			for (i = 1; i < runAhead->frames; ++i) {
+				ahead->runFrame(ahead);
+				++emulated;
+			}
+		}
+		// The prediction held, so the second core only has to advance by one frame
+		_runAheadShareVideoBuffer(core, ahead);
+		ahead->setKeys(ahead, keys);
+		ahead->enableOutput(ahead, true, false);
+		ahead->runFrame(ahead);
+		++emulated;
+		runAhead->predictedKeys = keys;
+		runAhead->secondaryValid = true;
+		core->enableOutput(core, true, true);
+	} else {
+		uint64_t stateStart = _runAheadMicros();
+		_runAheadSaveState(runAhead, core);
+		stateUsec += _runAheadMicros() - stateStart;
+
+		runAhead->hidden = true;
+		core->enableOutput(core, false, false);
+		for (i = 1; i < runAhead->frames; ++i) {
+			core->runFrame(core);
+			++emulated;
+		}
+		core->enableOutput(core, true, false);
+		core->runFrame(core);
+		++emulated;
+		runAhead->hidden = false;
+
+		core->enableOutput(core, true, true);
+		stateStart = _runAheadMicros();
+		mCoreLoadStateBuffer(core, runAhead->state, runAhead->stateSize, SAVESTATE_SAVEDATA);
+		stateUsec += _runAheadMicros() - stateStart;
+		++loads;
+	}
+
+	runAhead->active = false;
+	core->setSync(core, &impl->sync);
+	if (threadContext->frameCallback) {
+		threadContext->frameCallback(threadContext);
+	}
+	mCoreSyncPostFrame(&impl->sync);
+
+	MutexLock(&impl->stateMutex);
+	++runAhead->stats.frames;
+	runAhead->stats.emulatedFrames += emulated;
+	runAhead->stats.stateLoads += loads;
+	runAhead->stats.usec += _runAheadMicros() - start;
+	runAhead->stats.stateUsec += stateUsec;
+	MutexUnlock(&impl->stateMutex);
+}
+
 static THREAD_ENTRY _mCoreThreadRun(void* context) {
 	struct mCoreThread* threadContext = context;
 #ifdef USE_PTHREADS
@@ -177,11 +318,15 @@ static THREAD_ENTRY _mCoreThreadRun(void* context) {
 	}
 
 	mCoreThreadRewindParamsChanged(threadContext);
+	mCoreThreadRunAheadParamsChanged(threadContext);
 	if (threadContext->startCallback) {
 		threadContext->startCallback(threadContext);
 	}
 
 	core->reset(core);
+	if (threadContext->runAheadCore) {
+		_runAheadResetSecondary(threadContext);
+	}
 	_changeState(threadContext->impl, THREAD_RUNNING, true);
 
 	if (threadContext->resetCallback) {
@@ -201,9 +346,15 @@ static THREAD_ENTRY _mCoreThreadRun(void* context) {
 #endif
 		{
 			while (impl->state <= THREAD_MAX_RUNNING) {
-				core->runLoop(core);
+				if (impl->runAhead.frames > 0 && impl->state == THREAD_RUNNING) {
+					_runAheadFrame(threadContext);
+				} else {
+					core->runLoop(core);
+				}
 			}
 		}
+		// Whatever happens while the thread is stopped may change the state behind our back
+		impl->runAhead.secondaryValid = false;
 
 		enum mCoreThreadState deferred = THREAD_RUNNING;
 		MutexLock(&impl->stateMutex);
@@ -264,6 +415,9 @@ static THREAD_ENTRY _mCoreThreadRun(void* context) {
 			break;
 		case THREAD_RESETING:
 			core->reset(core);
+			if (threadContext->runAheadCore) {
+				_runAheadResetSecondary(threadContext);
+			}
 			if (threadContext->resetCallback) {
 				threadContext->resetCallback(threadContext);
 			}
@@ -280,6 +434,8 @@ static THREAD_ENTRY _mCoreThreadRun(void* context) {
 	if (core->opts.rewindEnable) {
 		 mCoreRewindContextDeinit(&impl->rewind);
 	}
+	free(impl->runAhead.state);
+	impl->runAhead.state = NULL;
 
 	if (threadContext->cleanCallback) {
 		threadContext->cleanCallback(threadContext);
@@ -599,6 +755,31 @@ void mCoreThreadRewindParamsChanged(struct mCoreThread* threadContext) {
 	}
 }
 
+void mCoreThreadRunAheadParamsChanged(struct mCoreThread* threadContext) {
+	struct mCore* core = threadContext->core;
+	struct mCoreThreadRunAhead* runAhead = &threadContext->impl->runAhead;
+	int frames = core->opts.runAhead;
+	if (frames > 0 && (!core->enableOutput || !core->getKeys)) {
+		frames = 0;
+	}
+	if (frames > 0) {
+		_runAheadResizeState(runAhead, core);
+	} else {
+		free(runAhead->state);
+		runAhead->state = NULL;
+		runAhead->stateSize = 0;
+		runAhead->maxSavedataSize = 0;
+	}
+	runAhead->frames = frames;
+	runAhead->secondaryValid = false;
+}
+
+void mCoreThreadGetRunAheadStats(struct mCoreThread* threadContext, struct mCoreRunAheadStats* stats) {
+	MutexLock(&threadContext->impl->stateMutex);
+	*stats = threadContext->impl->runAhead.stats;
+	MutexUnlock(&threadContext->impl->stateMutex);
+}
+
 void mCoreThreadWaitFromThread(struct mCoreThread* threadContext) {
 	MutexLock(&threadContext->impl->stateMutex);
 	if (threadContext->impl->interruptDepth && threadContext->impl->savedState == THREAD_RUNNING) {
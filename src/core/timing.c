@@ -5,12 +5,15 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <mgba/core/timing.h>
 
+#include <mgba/core/profile.h>
+
 void mTimingInit(struct mTiming* timing, int32_t* relativeCycles, int32_t* nextEvent) {
 	timing->root = NULL;
 	timing->reroot = NULL;
 	timing->masterCycles = 0;
 	timing->relativeCycles = relativeCycles;
 	timing->nextEvent = nextEvent;
+	timing->profile = NULL;
 }
 
 void mTimingDeinit(struct mTiming* timing) {
@@ -88,6 +91,9 @@ int32_t mTimingTick(struct mTiming* timing, int32_t cycles) {
 			return nextWhen;
 		}
 		timing->root = next->next;
+		if (timing->profile) {
+			mProfileCountEvent(timing->profile, next->name);
+		}
 		next->callback(timing, next->context, -nextWhen);
 	}
 	if (timing->reroot) {
@@ -16,16 +16,19 @@ struct mDebuggerSymbol {
 
 struct mDebuggerSymbols {
 	struct Table names;
+	struct Table reverse;
 };
 
 struct mDebuggerSymbols* mDebuggerSymbolTableCreate(void) {
 	struct mDebuggerSymbols* st = malloc(sizeof(*st));
 	HashTableInit(&st->names, 0, free);
+	TableInit(&st->reverse, 0, free);
 	return st;
 }
 
 void mDebuggerSymbolTableDestroy(struct mDebuggerSymbols* st) {
 	HashTableDeinit(&st->names);
+	TableDeinit(&st->reverse);
 	free(st);
 }
 
@@ -39,14 +42,34 @@ bool mDebuggerSymbolLookup(const struct mDebuggerSymbols* st, const char* name,
 	return true;
 }
 
+const char* mDebuggerSymbolReverseLookup(const struct mDebuggerSymbols* st, int32_t value, int segment) {
+	const char* name = TableLookup(&st->reverse, value);
+	if (!name) {
+		return NULL;
+	}
+	struct mDebuggerSymbol* sym = HashTableLookup(&st->names, name);
+	if (!sym || (segment >= 0 && sym->segment >= 0 && sym->segment != segment)) {
+		return NULL;
+	}
+	return name;
+}
+
 void mDebuggerSymbolAdd(struct mDebuggerSymbols* st, const char* name, int32_t value, int segment) {
 	struct mDebuggerSymbol* sym = malloc(sizeof(*sym));
 	sym->value = value;
 	sym->segment = segment;
 	HashTableInsert(&st->names, name, sym);
+	TableInsert(&st->reverse, value, strdup(name));
 }
 
 void mDebuggerSymbolRemove(struct mDebuggerSymbols* st, const char* name) {
+	struct mDebuggerSymbol* sym = HashTableLookup(&st->names, name);
+	if (sym) {
+		const char* reverse = TableLookup(&st->reverse, sym->value);
+		if (reverse && strcmp(reverse, name) == 0) {
+			TableRemove(&st->reverse, sym->value);
+		}
+	}
 	HashTableRemove(&st->names, name);
 }
 
@@ -48,7 +48,14 @@ void mVideoThreadProxyInit(struct mVideoLogger* logger) {
 	RingFIFOInit(&proxyRenderer->dirtyQueue, 0x40000);
 
 	proxyRenderer->threadState = PROXY_THREAD_IDLE;
+	proxyRenderer->threadStarted = false;
+	MutexLock(&proxyRenderer->mutex);
 	ThreadCreate(&proxyRenderer->thread, _proxyThread, proxyRenderer);
+	// Don't return until the thread is waiting, otherwise the first wake can get lost
+	while (!proxyRenderer->threadStarted) {
+		ConditionWait(&proxyRenderer->fromThreadCond, &proxyRenderer->mutex);
+	}
+	MutexUnlock(&proxyRenderer->mutex);
 }
 
 void mVideoThreadProxyReset(struct mVideoLogger* logger) {
@@ -93,12 +100,22 @@ void _proxyThreadRecover(struct mVideoThreadProxy* proxyRenderer) {
 	RingFIFOClear(&proxyRenderer->dirtyQueue);
 	MutexUnlock(&proxyRenderer->mutex);
 	ThreadJoin(proxyRenderer->thread);
+	MutexLock(&proxyRenderer->mutex);
 	proxyRenderer->threadState = PROXY_THREAD_IDLE;
+	proxyRenderer->threadStarted = false;
 	ThreadCreate(&proxyRenderer->thread, _proxyThread, proxyRenderer);
+	while (!proxyRenderer->threadStarted) {
+		ConditionWait(&proxyRenderer->fromThreadCond, &proxyRenderer->mutex);
+	}
+	MutexUnlock(&proxyRenderer->mutex);
 }
 
 static bool _writeData(struct mVideoLogger* logger, const void* data, size_t length) {
 	struct mVideoThreadProxy* proxyRenderer = (struct mVideoThreadProxy*) logger;
+	if (!length) {
+		// The FIFO reports empty writes as failures, e.g. an empty object list
+		return true;
+	}
 	while (!RingFIFOWrite(&proxyRenderer->dirtyQueue, data, length)) {
 		mLOG(GBA_VIDEO, DEBUG, "Can't write %"PRIz"u bytes. Proxy thread asleep?", length);
 		MutexLock(&proxyRenderer->mutex);
@@ -116,6 +133,9 @@ static bool _writeData(struct mVideoLogger* logger, const void* data, size_t len
 
 static bool _readData(struct mVideoLogger* logger, void* data, size_t length, bool block) {
 	struct mVideoThreadProxy* proxyRenderer = (struct mVideoThreadProxy*) logger;
+	if (!length) {
+		return true;
+	}
 	bool read = false;
 	while (true) {
 		read = RingFIFORead(&proxyRenderer->dirtyQueue, data, length);
@@ -166,6 +186,8 @@ static THREAD_ENTRY _proxyThread(void* logger) {
 	ThreadSetName("Proxy Renderer Thread");
 
 	MutexLock(&proxyRenderer->mutex);
+	proxyRenderer->threadStarted = true;
+	ConditionWake(&proxyRenderer->fromThreadCond);
 	while (proxyRenderer->threadState != PROXY_THREAD_STOPPED) {
 		ConditionWait(&proxyRenderer->toThreadCond, &proxyRenderer->mutex);
 		if (proxyRenderer->threadState == PROXY_THREAD_STOPPED) {
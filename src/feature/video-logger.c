@@ -6,6 +6,7 @@
 #include <mgba/feature/video-logger.h>
 
 #include <mgba/core/core.h>
+#include <mgba/core/profile.h>
 #include <mgba-util/memory.h>
 #include <mgba-util/vfs.h>
 #include <mgba-util/math.h>
@@ -111,6 +112,21 @@ static inline size_t _roundUp(size_t value, int shift) {
 	return value >> shift;
 }
 
+static void _writePacket(struct mVideoLogger* logger, const struct mVideoLoggerDirtyInfo* dirty) {
+	if (logger->profile) {
+		++logger->profile->proxyPackets;
+		logger->profile->proxyBytes += sizeof(*dirty);
+	}
+	logger->writeData(logger, dirty, sizeof(*dirty));
+}
+
+static void _writePayload(struct mVideoLogger* logger, const void* data, size_t length) {
+	if (logger->profile) {
+		logger->profile->proxyBytes += length;
+	}
+	logger->writeData(logger, data, length);
+}
+
 void mVideoLoggerRendererCreate(struct mVideoLogger* logger, bool readonly) {
 	if (readonly) {
 		logger->writeData = _writeNull;
@@ -129,6 +145,8 @@ void mVideoLoggerRendererCreate(struct mVideoLogger* logger, bool readonly) {
 	logger->unlock = NULL;
 	logger->wait = NULL;
 	logger->wake = NULL;
+
+	logger->profile = NULL;
 }
 
 void mVideoLoggerRendererInit(struct mVideoLogger* logger) {
@@ -173,7 +191,7 @@ void mVideoLoggerRendererWriteVideoRegister(struct mVideoLogger* logger, uint32_
 		value,
 		0xDEADBEEF,
 	};
-	logger->writeData(logger, &dirty, sizeof(dirty));
+	_writePacket(logger, &dirty);
 }
 
 void mVideoLoggerRendererWriteVRAM(struct mVideoLogger* logger, uint32_t address) {
@@ -191,7 +209,7 @@ void mVideoLoggerRendererWritePalette(struct mVideoLogger* logger, uint32_t addr
 		value,
 		0xDEADBEEF,
 	};
-	logger->writeData(logger, &dirty, sizeof(dirty));
+	_writePacket(logger, &dirty);
 }
 
 void mVideoLoggerRendererWriteOAM(struct mVideoLogger* logger, uint32_t address, uint16_t value) {
@@ -201,7 +219,7 @@ void mVideoLoggerRendererWriteOAM(struct mVideoLogger* logger, uint32_t address,
 		value,
 		0xDEADBEEF,
 	};
-	logger->writeData(logger, &dirty, sizeof(dirty));
+	_writePacket(logger, &dirty);
 }
 
 static void _flushVRAM(struct mVideoLogger* logger) {
@@ -221,8 +239,8 @@ static void _flushVRAM(struct mVideoLogger* logger) {
 					0x1000,
 					0xDEADBEEF,
 				};
-				logger->writeData(logger, &dirty, sizeof(dirty));
-				logger->writeData(logger, logger->vramBlock(logger, j * 0x1000), 0x1000);
+				_writePacket(logger, &dirty);
+				_writePayload(logger, logger->vramBlock(logger, j * 0x1000), 0x1000);
 			}
 		}
 	}
@@ -236,7 +254,7 @@ void mVideoLoggerRendererDrawScanline(struct mVideoLogger* logger, int y) {
 		0,
 		0xDEADBEEF,
 	};
-	logger->writeData(logger, &dirty, sizeof(dirty));
+	_writePacket(logger, &dirty);
 }
 
 void mVideoLoggerRendererDrawRange(struct mVideoLogger* logger, int startX, int endX, int y) {
@@ -247,7 +265,7 @@ void mVideoLoggerRendererDrawRange(struct mVideoLogger* logger, int startX, int
 		startX,
 		endX,
 	};
-	logger->writeData(logger, &dirty, sizeof(dirty));
+	_writePacket(logger, &dirty);
 }
 
 void mVideoLoggerRendererFlush(struct mVideoLogger* logger) {
@@ -257,7 +275,7 @@ void mVideoLoggerRendererFlush(struct mVideoLogger* logger) {
 		0,
 		0xDEADBEEF,
 	};
-	logger->writeData(logger, &dirty, sizeof(dirty));
+	_writePacket(logger, &dirty);
 	if (logger->wait) {
 		logger->wait(logger);
 	}
@@ -270,7 +288,7 @@ void mVideoLoggerRendererFinishFrame(struct mVideoLogger* logger) {
 		0,
 		0xDEADBEEF,
 	};
-	logger->writeData(logger, &dirty, sizeof(dirty));
+	_writePacket(logger, &dirty);
 }
 
 void mVideoLoggerWriteBuffer(struct mVideoLogger* logger, uint32_t bufferId, uint32_t offset, uint32_t length, const void* data) {
@@ -280,8 +298,8 @@ void mVideoLoggerWriteBuffer(struct mVideoLogger* logger, uint32_t bufferId, uin
 		offset,
 		length,
 	};
-	logger->writeData(logger, &dirty, sizeof(dirty));
-	logger->writeData(logger, data, length);
+	_writePacket(logger, &dirty);
+	_writePayload(logger, data, length);
 }
 
 bool mVideoLoggerRendererRun(struct mVideoLogger* logger, bool block) {
@@ -39,6 +39,12 @@ static int32_t _updateSquareChannel(struct GBAudioSquareChannel* ch);
 
 static int8_t _coalesceNoiseChannel(struct GBAudioNoiseChannel* ch);
 
+static void _stepChannel3(struct GBAudio* audio);
+static int32_t _stepChannel4(struct GBAudio* audio);
+
+static void _scheduleChannel(struct GBAudio* audio, struct mTimingEvent* event, int32_t when);
+static void _descheduleChannel(struct GBAudio* audio, struct mTimingEvent* event);
+
 static void _updateFrame(struct mTiming* timing, void* user, uint32_t cyclesLate);
 static void _updateChannel1(struct mTiming* timing, void* user, uint32_t cyclesLate);
 static void _updateChannel2(struct mTiming* timing, void* user, uint32_t cyclesLate);
@@ -96,6 +102,9 @@ void GBAudioInit(struct GBAudio* audio, size_t samples, uint8_t* nr52, enum GBAu
 	audio->sampleEvent.name = "GB Audio Sample";
 	audio->sampleEvent.callback = _sample;
 	audio->sampleEvent.priority = 0x18;
+	audio->lazyChannels = false;
+	audio->lazyScheduled = 0;
+	audio->suspendSynthesis = false;
 }
 
 void GBAudioDeinit(struct GBAudio* audio) {
@@ -105,13 +114,13 @@ void GBAudioDeinit(struct GBAudio* audio) {
 
 void GBAudioReset(struct GBAudio* audio) {
 	mTimingDeschedule(audio->timing, &audio->frameEvent);
-	mTimingDeschedule(audio->timing, &audio->ch1Event);
-	mTimingDeschedule(audio->timing, &audio->ch2Event);
-	mTimingDeschedule(audio->timing, &audio->ch3Event);
-	mTimingDeschedule(audio->timing, &audio->ch3Fade);
-	mTimingDeschedule(audio->timing, &audio->ch4Event);
+	_descheduleChannel(audio, &audio->ch1Event);
+	_descheduleChannel(audio, &audio->ch2Event);
+	_descheduleChannel(audio, &audio->ch3Event);
+	_descheduleChannel(audio, &audio->ch3Fade);
+	_descheduleChannel(audio, &audio->ch4Event);
 	mTimingDeschedule(audio->timing, &audio->sampleEvent);
-	if (audio->style != GB_AUDIO_GBA) {
+	if (audio->style != GB_AUDIO_GBA && !audio->suspendSynthesis) {
 		mTimingSchedule(audio->timing, &audio->sampleEvent, 0);
 	}
 	if (audio->style == GB_AUDIO_GBA) {
@@ -167,32 +176,37 @@ void GBAudioResizeBuffer(struct GBAudio* audio, size_t samples) {
 }
 
 void GBAudioWriteNR10(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	if (!_writeSweep(&audio->ch1.sweep, value)) {
-		mTimingDeschedule(audio->timing, &audio->ch1Event);
+		_descheduleChannel(audio, &audio->ch1Event);
 		audio->playingCh1 = false;
 		*audio->nr52 &= ~0x0001;
 	}
 }
 
 void GBAudioWriteNR11(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	_writeDuty(&audio->ch1.envelope, value);
 	audio->ch1.control.length = 64 - audio->ch1.envelope.length;
 }
 
 void GBAudioWriteNR12(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	if (!_writeEnvelope(&audio->ch1.envelope, value, audio->style)) {
-		mTimingDeschedule(audio->timing, &audio->ch1Event);
+		_descheduleChannel(audio, &audio->ch1Event);
 		audio->playingCh1 = false;
 		*audio->nr52 &= ~0x0001;
 	}
 }
 
 void GBAudioWriteNR13(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch1.control.frequency &= 0x700;
 	audio->ch1.control.frequency |= GBAudioRegisterControlGetFrequency(value);
 }
 
 void GBAudioWriteNR14(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch1.control.frequency &= 0xFF;
 	audio->ch1.control.frequency |= GBAudioRegisterControlGetFrequency(value << 8);
 	bool wasStop = audio->ch1.control.stop;
@@ -200,7 +214,7 @@ void GBAudioWriteNR14(struct GBAudio* audio, uint8_t value) {
 	if (!wasStop && audio->ch1.control.stop && audio->ch1.control.length && !(audio->frame & 1)) {
 		--audio->ch1.control.length;
 		if (audio->ch1.control.length == 0) {
-			mTimingDeschedule(audio->timing, &audio->ch1Event);
+			_descheduleChannel(audio, &audio->ch1Event);
 			audio->playingCh1 = false;
 		}
 	}
@@ -219,8 +233,8 @@ void GBAudioWriteNR14(struct GBAudio* audio, uint8_t value) {
 		}
 		if (audio->playingCh1 && audio->ch1.envelope.dead != 2) {
 			_updateSquareChannel(&audio->ch1);
-			mTimingDeschedule(audio->timing, &audio->ch1Event);
-			mTimingSchedule(audio->timing, &audio->ch1Event, 0);
+			_descheduleChannel(audio, &audio->ch1Event);
+			_scheduleChannel(audio, &audio->ch1Event, 0);
 		}
 	}
 	*audio->nr52 &= ~0x0001;
@@ -228,24 +242,28 @@ void GBAudioWriteNR14(struct GBAudio* audio, uint8_t value) {
 }
 
 void GBAudioWriteNR21(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	_writeDuty(&audio->ch2.envelope, value);
 	audio->ch2.control.length = 64 - audio->ch2.envelope.length;
 }
 
 void GBAudioWriteNR22(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	if (!_writeEnvelope(&audio->ch2.envelope, value, audio->style)) {
-		mTimingDeschedule(audio->timing, &audio->ch2Event);
+		_descheduleChannel(audio, &audio->ch2Event);
 		audio->playingCh2 = false;
 		*audio->nr52 &= ~0x0002;
 	}
 }
 
 void GBAudioWriteNR23(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch2.control.frequency &= 0x700;
 	audio->ch2.control.frequency |= GBAudioRegisterControlGetFrequency(value);
 }
 
 void GBAudioWriteNR24(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch2.control.frequency &= 0xFF;
 	audio->ch2.control.frequency |= GBAudioRegisterControlGetFrequency(value << 8);
 	bool wasStop = audio->ch2.control.stop;
@@ -253,7 +271,7 @@ void GBAudioWriteNR24(struct GBAudio* audio, uint8_t value) {
 	if (!wasStop && audio->ch2.control.stop && audio->ch2.control.length && !(audio->frame & 1)) {
 		--audio->ch2.control.length;
 		if (audio->ch2.control.length == 0) {
-			mTimingDeschedule(audio->timing, &audio->ch2Event);
+			_descheduleChannel(audio, &audio->ch2Event);
 			audio->playingCh2 = false;
 		}
 	}
@@ -268,8 +286,8 @@ void GBAudioWriteNR24(struct GBAudio* audio, uint8_t value) {
 		}
 		if (audio->playingCh2 && audio->ch2.envelope.dead != 2) {
 			_updateSquareChannel(&audio->ch2);
-			mTimingDeschedule(audio->timing, &audio->ch2Event);
-			mTimingSchedule(audio->timing, &audio->ch2Event, 0);
+			_descheduleChannel(audio, &audio->ch2Event);
+			_scheduleChannel(audio, &audio->ch2Event, 0);
 		}
 	}
 	*audio->nr52 &= ~0x0002;
@@ -277,6 +295,7 @@ void GBAudioWriteNR24(struct GBAudio* audio, uint8_t value) {
 }
 
 void GBAudioWriteNR30(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch3.enable = GBAudioRegisterBankGetEnable(value);
 	if (!audio->ch3.enable) {
 		audio->playingCh3 = false;
@@ -285,19 +304,23 @@ void GBAudioWriteNR30(struct GBAudio* audio, uint8_t value) {
 }
 
 void GBAudioWriteNR31(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch3.length = 256 - value;
 }
 
 void GBAudioWriteNR32(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch3.volume = GBAudioRegisterBankVolumeGetVolumeGB(value);
 }
 
 void GBAudioWriteNR33(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch3.rate &= 0x700;
 	audio->ch3.rate |= GBAudioRegisterControlGetRate(value);
 }
 
 void GBAudioWriteNR34(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch3.rate &= 0xFF;
 	audio->ch3.rate |= GBAudioRegisterControlGetRate(value << 8);
 	bool wasStop = audio->ch3.stop;
@@ -331,43 +354,47 @@ void GBAudioWriteNR34(struct GBAudio* audio, uint8_t value) {
 		audio->ch3.window = 0;
 		audio->ch3.sample = 0;
 	}
-	mTimingDeschedule(audio->timing, &audio->ch3Fade);
-	mTimingDeschedule(audio->timing, &audio->ch3Event);
+	_descheduleChannel(audio, &audio->ch3Fade);
+	_descheduleChannel(audio, &audio->ch3Event);
 	if (audio->playingCh3) {
 		audio->ch3.readable = audio->style != GB_AUDIO_DMG;
 		// TODO: Where does this cycle delay come from?
-		mTimingSchedule(audio->timing, &audio->ch3Event, audio->timingFactor * 4 + 2 * (2048 - audio->ch3.rate));
+		_scheduleChannel(audio, &audio->ch3Event, audio->timingFactor * 4 + 2 * (2048 - audio->ch3.rate));
 	}
 	*audio->nr52 &= ~0x0004;
 	*audio->nr52 |= audio->playingCh3 << 2;
 }
 
 void GBAudioWriteNR41(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	_writeDuty(&audio->ch4.envelope, value);
 	audio->ch4.length = 64 - audio->ch4.envelope.length;
 }
 
 void GBAudioWriteNR42(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	if (!_writeEnvelope(&audio->ch4.envelope, value, audio->style)) {
-		mTimingDeschedule(audio->timing, &audio->ch4Event);
+		_descheduleChannel(audio, &audio->ch4Event);
 		audio->playingCh4 = false;
 		*audio->nr52 &= ~0x0008;
 	}
 }
 
 void GBAudioWriteNR43(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	audio->ch4.ratio = GBAudioRegisterNoiseFeedbackGetRatio(value);
 	audio->ch4.frequency = GBAudioRegisterNoiseFeedbackGetFrequency(value);
 	audio->ch4.power = GBAudioRegisterNoiseFeedbackGetPower(value);
 }
 
 void GBAudioWriteNR44(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	bool wasStop = audio->ch4.stop;
 	audio->ch4.stop = GBAudioRegisterNoiseControlGetStop(value);
 	if (!wasStop && audio->ch4.stop && audio->ch4.length && !(audio->frame & 1)) {
 		--audio->ch4.length;
 		if (audio->ch4.length == 0) {
-			mTimingDeschedule(audio->timing, &audio->ch4Event);
+			_descheduleChannel(audio, &audio->ch4Event);
 			audio->playingCh4 = false;
 		}
 	}
@@ -386,8 +413,8 @@ void GBAudioWriteNR44(struct GBAudio* audio, uint8_t value) {
 			}
 		}
 		if (audio->playingCh4 && audio->ch4.envelope.dead != 2) {
-			mTimingDeschedule(audio->timing, &audio->ch4Event);
-			mTimingSchedule(audio->timing, &audio->ch4Event, 0);
+			_descheduleChannel(audio, &audio->ch4Event);
+			_scheduleChannel(audio, &audio->ch4Event, 0);
 		}
 	}
 	*audio->nr52 &= ~0x0008;
@@ -411,6 +438,7 @@ void GBAudioWriteNR51(struct GBAudio* audio, uint8_t value) {
 }
 
 void GBAudioWriteNR52(struct GBAudio* audio, uint8_t value) {
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
 	bool wasEnable = audio->enable;
 	audio->enable = GBAudioEnableGetEnable(value);
 	if (!audio->enable) {
@@ -484,6 +512,8 @@ void GBAudioWriteNR52(struct GBAudio* audio, uint8_t value) {
 
 void _updateFrame(struct mTiming* timing, void* user, uint32_t cyclesLate) {
 	struct GBAudio* audio = user;
+	// Channel events due on this exact cycle would have run after the frame sequencer
+	GBAudioRun(audio, mTimingCurrentTime(timing) - cyclesLate - 1);
 	GBAudioUpdateFrame(audio, timing);
 	if (audio->style == GB_AUDIO_GBA) {
 		mTimingSchedule(timing, &audio->frameEvent, audio->timingFactor * FRAME_CYCLES - cyclesLate);
@@ -491,6 +521,7 @@ void _updateFrame(struct mTiming* timing, void* user, uint32_t cyclesLate) {
 }
 
 void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing) {
+	UNUSED(timing);
 	if (!audio->enable) {
 		return;
 	}
@@ -518,7 +549,7 @@ void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing) {
 		if (audio->ch1.control.length && audio->ch1.control.stop) {
 			--audio->ch1.control.length;
 			if (audio->ch1.control.length == 0) {
-				mTimingDeschedule(timing, &audio->ch1Event);
+				_descheduleChannel(audio, &audio->ch1Event);
 				audio->playingCh1 = 0;
 				*audio->nr52 &= ~0x0001;
 			}
@@ -527,7 +558,7 @@ void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing) {
 		if (audio->ch2.control.length && audio->ch2.control.stop) {
 			--audio->ch2.control.length;
 			if (audio->ch2.control.length == 0) {
-				mTimingDeschedule(timing, &audio->ch2Event);
+				_descheduleChannel(audio, &audio->ch2Event);
 				audio->playingCh2 = 0;
 				*audio->nr52 &= ~0x0002;
 			}
@@ -536,7 +567,7 @@ void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing) {
 		if (audio->ch3.length && audio->ch3.stop) {
 			--audio->ch3.length;
 			if (audio->ch3.length == 0) {
-				mTimingDeschedule(timing, &audio->ch3Event);
+				_descheduleChannel(audio, &audio->ch3Event);
 				audio->playingCh3 = 0;
 				*audio->nr52 &= ~0x0004;
 			}
@@ -545,7 +576,7 @@ void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing) {
 		if (audio->ch4.length && audio->ch4.stop) {
 			--audio->ch4.length;
 			if (audio->ch4.length == 0) {
-				mTimingDeschedule(timing, &audio->ch4Event);
+				_descheduleChannel(audio, &audio->ch4Event);
 				audio->playingCh4 = 0;
 				*audio->nr52 &= ~0x0008;
 			}
@@ -557,7 +588,7 @@ void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing) {
 			if (audio->ch1.envelope.nextStep == 0) {
 				_updateEnvelope(&audio->ch1.envelope);
 				if (audio->ch1.envelope.dead == 2) {
-					mTimingDeschedule(timing, &audio->ch1Event);
+					_descheduleChannel(audio, &audio->ch1Event);
 				}
 				_updateSquareSample(&audio->ch1);
 			}
@@ -568,7 +599,7 @@ void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing) {
 			if (audio->ch2.envelope.nextStep == 0) {
 				_updateEnvelope(&audio->ch2.envelope);
 				if (audio->ch2.envelope.dead == 2) {
-					mTimingDeschedule(timing, &audio->ch2Event);
+					_descheduleChannel(audio, &audio->ch2Event);
 				}
 				_updateSquareSample(&audio->ch2);
 			}
@@ -581,7 +612,7 @@ void GBAudioUpdateFrame(struct GBAudio* audio, struct mTiming* timing) {
 				audio->ch4.samples -= audio->ch4.sample;
 				_updateEnvelope(&audio->ch4.envelope);
 				if (audio->ch4.envelope.dead == 2) {
-					mTimingDeschedule(timing, &audio->ch4Event);
+					_descheduleChannel(audio, &audio->ch4Event);
 				}
 				audio->ch4.sample = sample * audio->ch4.envelope.currentVolume;
 				audio->ch4.samples += audio->ch4.sample;
@@ -646,6 +677,7 @@ void GBAudioSamplePSG(struct GBAudio* audio, int16_t* left, int16_t* right) {
 
 static void _sample(struct mTiming* timing, void* user, uint32_t cyclesLate) {
 	struct GBAudio* audio = user;
+	GBAudioRun(audio, mTimingCurrentTime(timing) - cyclesLate);
 	int16_t sampleLeft = 0;
 	int16_t sampleRight = 0;
 	GBAudioSamplePSG(audio, &sampleLeft, &sampleRight);
@@ -845,8 +877,7 @@ static void _updateChannel2(struct mTiming* timing, void* user, uint32_t cyclesL
 	mTimingSchedule(timing, &audio->ch2Event, audio->timingFactor * cycles - cyclesLate);
 }
 
-static void _updateChannel3(struct mTiming* timing, void* user, uint32_t cyclesLate) {
-	struct GBAudio* audio = user;
+static void _stepChannel3(struct GBAudio* audio) {
 	struct GBAudioWaveChannel* ch = &audio->ch3;
 	int i;
 	int volume;
@@ -905,13 +936,19 @@ static void _updateChannel3(struct mTiming* timing, void* user, uint32_t cyclesL
 	}
 	ch->sample >>= volume;
 	audio->ch3.readable = true;
+}
+
+static void _updateChannel3(struct mTiming* timing, void* user, uint32_t cyclesLate) {
+	struct GBAudio* audio = user;
+	_stepChannel3(audio);
 	if (audio->style == GB_AUDIO_DMG) {
 		mTimingDeschedule(audio->timing, &audio->ch3Fade);
 		mTimingSchedule(timing, &audio->ch3Fade, 2 - cyclesLate);
 	}
-	int cycles = 2 * (2048 - ch->rate);
+	int cycles = 2 * (2048 - audio->ch3.rate);
 	mTimingSchedule(timing, &audio->ch3Event, audio->timingFactor * cycles - cyclesLate);
 }
+
 static void _fadeChannel3(struct mTiming* timing, void* user, uint32_t cyclesLate) {
 	UNUSED(timing);
 	UNUSED(cyclesLate);
@@ -919,13 +956,17 @@ static void _fadeChannel3(struct mTiming* timing, void* user, uint32_t cyclesLat
 	audio->ch3.readable = false;
 }
 
-static void _updateChannel4(struct mTiming* timing, void* user, uint32_t cyclesLate) {
-	struct GBAudio* audio = user;
-	struct GBAudioNoiseChannel* ch = &audio->ch4;
-
+static int32_t _stepChannel4Cycles(const struct GBAudio* audio) {
+	const struct GBAudioNoiseChannel* ch = &audio->ch4;
 	int32_t cycles = ch->ratio ? 2 * ch->ratio : 1;
 	cycles <<= ch->frequency;
 	cycles *= 8 * audio->timingFactor;
+	return cycles;
+}
+
+static int32_t _stepChannel4(struct GBAudio* audio) {
+	struct GBAudioNoiseChannel* ch = &audio->ch4;
+	int32_t cycles = _stepChannel4Cycles(audio);
 
 	int lsb = ch->lfsr & 1;
 	ch->sample = lsb * ch->envelope.currentVolume;
@@ -934,9 +975,184 @@ static void _updateChannel4(struct mTiming* timing, void* user, uint32_t cyclesL
 	ch->lfsr >>= 1;
 	ch->lfsr ^= (lsb * 0x60) << (ch->power ? 0 : 8);
 
+	return cycles;
+}
+
+static void _updateChannel4(struct mTiming* timing, void* user, uint32_t cyclesLate) {
+	struct GBAudio* audio = user;
+	int32_t cycles = _stepChannel4(audio);
 	mTimingSchedule(timing, &audio->ch4Event, cycles - cyclesLate);
 }
 
+static unsigned _lazyChannelBit(const struct GBAudio* audio, const struct mTimingEvent* event) {
+	if (event == &audio->ch1Event) {
+		return 1;
+	}
+	if (event == &audio->ch2Event) {
+		return 2;
+	}
+	if (event == &audio->ch3Event) {
+		return 4;
+	}
+	if (event == &audio->ch4Event) {
+		return 8;
+	}
+	if (event == &audio->ch3Fade) {
+		return 0x10;
+	}
+	return 0;
+}
+
+static bool _isLazy(const struct GBAudio* audio) {
+	return audio->lazyChannels || audio->suspendSynthesis;
+}
+
+static void _scheduleChannel(struct GBAudio* audio, struct mTimingEvent* event, int32_t when) {
+	if (!_isLazy(audio)) {
+		mTimingSchedule(audio->timing, event, when);
+		return;
+	}
+	event->when = mTimingCurrentTime(audio->timing) + when;
+	audio->lazyScheduled |= _lazyChannelBit(audio, event);
+}
+
+static void _descheduleChannel(struct GBAudio* audio, struct mTimingEvent* event) {
+	if (!_isLazy(audio)) {
+		mTimingDeschedule(audio->timing, event);
+		return;
+	}
+	audio->lazyScheduled &= ~_lazyChannelBit(audio, event);
+}
+
+static void _runSquareChannel(struct GBAudio* audio, struct GBAudioSquareChannel* ch, struct mTimingEvent* event, uint32_t timestamp) {
+	int32_t diff = timestamp - event->when;
+	if (diff < 0) {
+		return;
+	}
+	// A whole duty cycle is always eight periods long and ends where it started
+	int32_t cycle = audio->timingFactor * 32 * (2048 - ch->control.frequency);
+	event->when += diff / cycle * cycle;
+	while ((int32_t) (timestamp - event->when) >= 0) {
+		event->when += audio->timingFactor * _updateSquareChannel(ch);
+	}
+}
+
+static void _runChannel3(struct GBAudio* audio, uint32_t timestamp) {
+	struct GBAudioWaveChannel* ch = &audio->ch3;
+	int32_t diff = timestamp - audio->ch3Event.when;
+	if (diff < 0) {
+		return;
+	}
+	int32_t period = audio->timingFactor * 2 * (2048 - ch->rate);
+	int32_t steps = diff / period;
+	uint32_t last = audio->ch3Event.when + steps * period;
+	audio->ch3Event.when = last + period;
+
+	// Only the final step affects the sample, so skip the window ahead to just before it
+	if (audio->style == GB_AUDIO_GBA) {
+		steps %= ch->size ? 64 : 32;
+	} else {
+		ch->window = (ch->window + steps) & 0x1F;
+		steps = 0;
+	}
+	for (; steps >= 0; --steps) {
+		_stepChannel3(audio);
+	}
+	if (audio->style == GB_AUDIO_DMG) {
+		audio->ch3Fade.when = last + 2;
+		audio->lazyScheduled |= 0x10;
+	}
+}
+
+static void _runChannel4(struct GBAudio* audio, uint32_t timestamp) {
+	if (audio->suspendSynthesis) {
+		// The LFSR is only audible, so don't bother stepping it
+		int32_t diff = timestamp - audio->ch4Event.when;
+		if (diff >= 0) {
+			int32_t cycles = _stepChannel4Cycles(audio);
+			audio->ch4Event.when += (diff / cycles + 1) * cycles;
+		}
+		return;
+	}
+	while ((int32_t) (timestamp - audio->ch4Event.when) >= 0) {
+		audio->ch4Event.when += _stepChannel4(audio);
+	}
+}
+
+void GBAudioRun(struct GBAudio* audio, uint32_t timestamp) {
+	if (!_isLazy(audio)) {
+		return;
+	}
+	if (audio->lazyScheduled & 1) {
+		_runSquareChannel(audio, &audio->ch1, &audio->ch1Event, timestamp);
+	}
+	if (audio->lazyScheduled & 2) {
+		_runSquareChannel(audio, &audio->ch2, &audio->ch2Event, timestamp);
+	}
+	if (audio->lazyScheduled & 4) {
+		_runChannel3(audio, timestamp);
+	}
+	if (audio->lazyScheduled & 8) {
+		_runChannel4(audio, timestamp);
+	}
+	if ((audio->lazyScheduled & 0x10) && (int32_t) (timestamp - audio->ch3Fade.when) >= 0) {
+		audio->ch3.readable = false;
+		audio->lazyScheduled &= ~0x10;
+	}
+}
+
+static void _convertChannelEvents(struct GBAudio* audio, bool wasLazy) {
+	bool lazy = _isLazy(audio);
+	if (lazy == wasLazy) {
+		return;
+	}
+	struct mTimingEvent* events[] = { &audio->ch1Event, &audio->ch2Event, &audio->ch3Event, &audio->ch4Event, &audio->ch3Fade };
+	size_t i;
+	if (lazy) {
+		audio->lazyScheduled = 0;
+		for (i = 0; i < sizeof(events) / sizeof(*events); ++i) {
+			if (mTimingIsScheduled(audio->timing, events[i])) {
+				mTimingDeschedule(audio->timing, events[i]);
+				audio->lazyScheduled |= 1 << i;
+			}
+		}
+	} else {
+		int32_t now = mTimingCurrentTime(audio->timing);
+		for (i = 0; i < sizeof(events) / sizeof(*events); ++i) {
+			if (audio->lazyScheduled & (1 << i)) {
+				mTimingSchedule(audio->timing, events[i], events[i]->when - now);
+			}
+		}
+		audio->lazyScheduled = 0;
+	}
+}
+
+void GBAudioSetLazyChannels(struct GBAudio* audio, bool enable) {
+	bool wasLazy = _isLazy(audio);
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
+	audio->lazyChannels = enable;
+	_convertChannelEvents(audio, wasLazy);
+}
+
+void GBAudioSuspendSynthesis(struct GBAudio* audio, bool suspend) {
+	if (audio->suspendSynthesis == suspend) {
+		return;
+	}
+	bool wasLazy = _isLazy(audio);
+	GBAudioRun(audio, mTimingCurrentTime(audio->timing));
+	audio->suspendSynthesis = suspend;
+	_convertChannelEvents(audio, wasLazy);
+	if (audio->style == GB_AUDIO_GBA) {
+		return;
+	}
+	if (suspend) {
+		mTimingDeschedule(audio->timing, &audio->sampleEvent);
+	} else {
+		mTimingDeschedule(audio->timing, &audio->sampleEvent);
+		mTimingSchedule(audio->timing, &audio->sampleEvent, 0);
+	}
+}
+
 void GBAudioPSGSerialize(const struct GBAudio* audio, struct GBSerializedPSGState* state, uint32_t* flagsOut) {
 	uint32_t flags = 0;
 	uint32_t ch1Flags = 0;
@@ -990,6 +1206,7 @@ void GBAudioPSGDeserialize(struct GBAudio* audio, const struct GBSerializedPSGSt
 	uint32_t ch4Flags = 0;
 	uint32_t when;
 
+	audio->lazyScheduled = 0;
 	audio->playingCh1 = !!(*audio->nr52 & 0x0001);
 	audio->playingCh2 = !!(*audio->nr52 & 0x0002);
 	audio->playingCh3 = !!(*audio->nr52 & 0x0004);
@@ -1016,7 +1233,7 @@ void GBAudioPSGDeserialize(struct GBAudio* audio, const struct GBSerializedPSGSt
 	audio->ch1.sweep.realFrequency = GBSerializedAudioEnvelopeGetFrequency(ch1Flags);
 	LOAD_32LE(when, 0, &state->ch1.nextEvent);
 	if (audio->ch1.envelope.dead < 2 && audio->playingCh1) {
-		mTimingSchedule(audio->timing, &audio->ch1Event, when);
+		_scheduleChannel(audio, &audio->ch1Event, when);
 	}
 
 	LOAD_32LE(ch2Flags, 0, &state->ch2.envelope);
@@ -1027,7 +1244,7 @@ void GBAudioPSGDeserialize(struct GBAudio* audio, const struct GBSerializedPSGSt
 	audio->ch2.envelope.nextStep = GBSerializedAudioEnvelopeGetNextStep(ch2Flags);
 	LOAD_32LE(when, 0, &state->ch2.nextEvent);
 	if (audio->ch2.envelope.dead < 2 && audio->playingCh2) {
-		mTimingSchedule(audio->timing, &audio->ch2Event, when);
+		_scheduleChannel(audio, &audio->ch2Event, when);
 	}
 
 	audio->ch3.readable = GBSerializedAudioFlagsGetCh3Readable(flags);
@@ -1036,11 +1253,11 @@ void GBAudioPSGDeserialize(struct GBAudio* audio, const struct GBSerializedPSGSt
 	LOAD_16LE(audio->ch3.length, 0, &state->ch3.length);
 	LOAD_32LE(when, 0, &state->ch3.nextEvent);
 	if (audio->playingCh3) {
-		mTimingSchedule(audio->timing, &audio->ch3Event, when);
+		_scheduleChannel(audio, &audio->ch3Event, when);
 	}
 	LOAD_32LE(when, 0, &state->ch1.nextCh3Fade);
 	if (audio->ch3.readable && audio->style == GB_AUDIO_DMG) {
-		mTimingSchedule(audio->timing, &audio->ch3Fade, when);
+		_scheduleChannel(audio, &audio->ch3Fade, when);
 	}
 
 	LOAD_32LE(ch4Flags, 0, &state->ch4.envelope);
@@ -1051,7 +1268,7 @@ void GBAudioPSGDeserialize(struct GBAudio* audio, const struct GBSerializedPSGSt
 	LOAD_32LE(audio->ch4.lfsr, 0, &state->ch4.lfsr);
 	LOAD_32LE(when, 0, &state->ch4.nextEvent);
 	if (audio->ch4.envelope.dead < 2 && audio->playingCh4) {
-		mTimingSchedule(audio->timing, &audio->ch4Event, when);
+		_scheduleChannel(audio, &audio->ch4Event, when);
 	}
 }
 
@@ -1059,7 +1276,11 @@ void GBAudioSerialize(const struct GBAudio* audio, struct GBSerializedState* sta
 	GBAudioPSGSerialize(audio, &state->audio.psg, &state->audio.flags);
 	STORE_32LE(audio->capLeft, 0, &state->audio.capLeft);
 	STORE_32LE(audio->capRight, 0, &state->audio.capRight);
-	STORE_32LE(audio->sampleEvent.when - mTimingCurrentTime(audio->timing), 0, &state->audio.nextSample);
+	if (audio->suspendSynthesis) {
+		STORE_32LE(0, 0, &state->audio.nextSample);
+	} else {
+		STORE_32LE(audio->sampleEvent.when - mTimingCurrentTime(audio->timing), 0, &state->audio.nextSample);
+	}
 }
 
 void GBAudioDeserialize(struct GBAudio* audio, const struct GBSerializedState* state) {
@@ -1068,5 +1289,7 @@ void GBAudioDeserialize(struct GBAudio* audio, const struct GBSerializedState* s
 	LOAD_32LE(audio->capRight, 0, &state->audio.capRight);
 	uint32_t when;
 	LOAD_32LE(when, 0, &state->audio.nextSample);
-	mTimingSchedule(audio->timing, &audio->sampleEvent, when);
+	if (!audio->suspendSynthesis) {
+		mTimingSchedule(audio->timing, &audio->sampleEvent, when);
+	}
 }
@@ -6,6 +6,10 @@
 #include <mgba/gb/core.h>
 
 #include <mgba/core/core.h>
+#include <mgba/core/profile.h>
+#ifndef DISABLE_THREADING
+#include <mgba/feature/thread-proxy.h>
+#endif
 #include <mgba/internal/debugger/symbols.h>
 #include <mgba/internal/gb/cheats.h>
 #include <mgba/internal/gb/debugger/symbols.h>
@@ -56,10 +60,10 @@ static const struct mCoreMemoryBlock _GBMemoryBlocks[] = {
 	{ GB_REGION_CART_BANK0, "cart0", "ROM Bank", "Game Pak (32kiB)", GB_BASE_CART_BANK0, GB_SIZE_CART_BANK0 * 2, 0x800000, mCORE_MEMORY_READ | mCORE_MEMORY_MAPPED, 511 },
 	{ GB_REGION_VRAM, "vram", "VRAM", "Video RAM (8kiB)", GB_BASE_VRAM, GB_BASE_VRAM + GB_SIZE_VRAM, GB_SIZE_VRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ GB_REGION_EXTERNAL_RAM, "sram", "SRAM", "External RAM (8kiB)", GB_BASE_EXTERNAL_RAM, GB_BASE_EXTERNAL_RAM + GB_SIZE_EXTERNAL_RAM, GB_SIZE_EXTERNAL_RAM * 4, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED, 3 },
-	{ GB_REGION_WORKING_RAM_BANK0, "wram", "WRAM", "Working RAM (8kiB)", GB_BASE_WORKING_RAM_BANK0, GB_BASE_WORKING_RAM_BANK0 + GB_SIZE_WORKING_RAM_BANK0 * 2 , GB_SIZE_WORKING_RAM_BANK0 * 2, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
+	{ GB_REGION_WORKING_RAM_BANK0, "wram", "WRAM", "Working RAM (8kiB)", GB_BASE_WORKING_RAM_BANK0, GB_BASE_WORKING_RAM_BANK0 + GB_SIZE_WORKING_RAM_BANK0 * 2 , GB_SIZE_WORKING_RAM_BANK0 * 2, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
 	{ GB_BASE_OAM, "oam", "OAM", "OBJ Attribute Memory", GB_BASE_OAM, GB_BASE_OAM + GB_SIZE_OAM, GB_SIZE_OAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ GB_BASE_IO, "io", "MMIO", "Memory-Mapped I/O", GB_BASE_IO, GB_BASE_IO + GB_SIZE_IO, GB_SIZE_IO, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
-	{ GB_BASE_HRAM, "hram", "HRAM", "High RAM", GB_BASE_HRAM, GB_BASE_HRAM + GB_SIZE_HRAM, GB_SIZE_HRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
+	{ GB_BASE_HRAM, "hram", "HRAM", "High RAM", GB_BASE_HRAM, GB_BASE_HRAM + GB_SIZE_HRAM, GB_SIZE_HRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
 };
 
 static const struct mCoreMemoryBlock _GBCMemoryBlocks[] = {
@@ -67,10 +71,10 @@ static const struct mCoreMemoryBlock _GBCMemoryBlocks[] = {
 	{ GB_REGION_CART_BANK0, "cart0", "ROM Bank", "Game Pak (32kiB)", GB_BASE_CART_BANK0, GB_SIZE_CART_BANK0 * 2, 0x800000, mCORE_MEMORY_READ | mCORE_MEMORY_MAPPED, 511 },
 	{ GB_REGION_VRAM, "vram", "VRAM", "Video RAM (8kiB)", GB_BASE_VRAM, GB_BASE_VRAM + GB_SIZE_VRAM, GB_SIZE_VRAM * 2, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED, 1 },
 	{ GB_REGION_EXTERNAL_RAM, "sram", "SRAM", "External RAM (8kiB)", GB_BASE_EXTERNAL_RAM, GB_BASE_EXTERNAL_RAM + GB_SIZE_EXTERNAL_RAM, GB_SIZE_EXTERNAL_RAM * 4, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED, 3 },
-	{ GB_REGION_WORKING_RAM_BANK0, "wram", "WRAM", "Working RAM (8kiB)", GB_BASE_WORKING_RAM_BANK0, GB_BASE_WORKING_RAM_BANK0 + GB_SIZE_WORKING_RAM_BANK0 * 2, GB_SIZE_WORKING_RAM_BANK0 * 8, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED, 7 },
+	{ GB_REGION_WORKING_RAM_BANK0, "wram", "WRAM", "Working RAM (8kiB)", GB_BASE_WORKING_RAM_BANK0, GB_BASE_WORKING_RAM_BANK0 + GB_SIZE_WORKING_RAM_BANK0 * 2, GB_SIZE_WORKING_RAM_BANK0 * 8, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT, 7, GB_BASE_WORKING_RAM_BANK1 },
 	{ GB_BASE_OAM, "oam", "OAM", "OBJ Attribute Memory", GB_BASE_OAM, GB_BASE_OAM + GB_SIZE_OAM, GB_SIZE_OAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ GB_BASE_IO, "io", "MMIO", "Memory-Mapped I/O", GB_BASE_IO, GB_BASE_IO + GB_SIZE_IO, GB_SIZE_IO, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
-	{ GB_BASE_HRAM, "hram", "HRAM", "High RAM", GB_BASE_HRAM, GB_BASE_HRAM + GB_SIZE_HRAM, GB_SIZE_HRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
+	{ GB_BASE_HRAM, "hram", "HRAM", "High RAM", GB_BASE_HRAM, GB_BASE_HRAM + GB_SIZE_HRAM, GB_SIZE_HRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
 };
 
 struct mVideoLogContext;
@@ -80,11 +84,17 @@ struct GBCore {
 	struct GBVideoProxyRenderer proxyRenderer;
 	struct mVideoLogContext* logContext;
 	struct mCoreCallbacks logCallbacks;
+#ifndef DISABLE_THREADING
+	struct mVideoThreadProxy threadProxy;
+#endif
 	uint8_t keys;
 	struct mCPUComponent* components[CPU_COMPONENT_MAX];
 	const struct Configuration* overrides;
 	struct mDebuggerPlatform* debuggerPlatform;
 	struct mCheatDevice* cheatDevice;
+	bool audioDisabled;
+	bool videoSuppressed;
+	bool audioSuppressed;
 };
 
 static bool _GBCoreInit(struct mCore* core) {
@@ -103,6 +113,9 @@ static bool _GBCoreInit(struct mCore* core) {
 	gbcore->overrides = NULL;
 	gbcore->debuggerPlatform = NULL;
 	gbcore->cheatDevice = NULL;
+	gbcore->audioDisabled = false;
+	gbcore->videoSuppressed = false;
+	gbcore->audioSuppressed = false;
 
 	GBCreate(gb);
 	memset(gbcore->components, 0, sizeof(gbcore->components));
@@ -114,11 +127,17 @@ static bool _GBCoreInit(struct mCore* core) {
 	GBVideoSoftwareRendererCreate(&gbcore->renderer);
 	gbcore->renderer.outputBuffer = NULL;
 
+#ifndef DISABLE_THREADING
+	mVideoThreadProxyCreate(&gbcore->threadProxy);
+#endif
+	gbcore->proxyRenderer.logger = NULL;
+
 	gbcore->keys = 0;
 	gb->keySource = &gbcore->keys;
 
 #if !defined(MINIMAL_CORE) || MINIMAL_CORE < 2
 	mDirectorySetInit(&core->dirs);
+	core->stateSlots = NULL;
 #endif
 	
 	return true;
@@ -159,6 +178,7 @@ static void _GBCoreSetSync(struct mCore* core, struct mCoreSync* sync) {
 static void _GBCoreLoadConfig(struct mCore* core, const struct mCoreConfig* config) {
 	UNUSED(config);
 
+	struct GBCore* gbcore = (struct GBCore*) core;
 	struct GB* gb = core->board;
 	if (core->opts.mute) {
 		gb->audio.masterVolume = 0;
@@ -217,13 +237,29 @@ static void _GBCoreLoadConfig(struct mCore* core, const struct mCoreConfig* conf
 	mCoreConfigGetIntValue(config, "allowOpposingDirections", &fakeBool);
 	gb->allowOpposingDirections = fakeBool;
 
+	if (mCoreConfigGetIntValue(config, "lazyAudio", &fakeBool)) {
+		GBAudioSetLazyChannels(&gb->audio, fakeBool);
+	}
+
+	if (mCoreConfigGetIntValue(config, "batchScanlines", &fakeBool)) {
+		gbcore->renderer.batchScanlines = fakeBool;
+	}
+
+	if (mCoreConfigGetIntValue(config, "disableAudio", &fakeBool)) {
+		gbcore->audioDisabled = fakeBool;
+		GBAudioSuspendSynthesis(&gb->audio, gbcore->audioDisabled || gbcore->audioSuppressed);
+	}
+
 	if (mCoreConfigGetIntValue(config, "sgb.borders", &fakeBool)) {
 		gb->video.sgbBorders = fakeBool;
 		gb->video.renderer->enableSGBBorder(gb->video.renderer, fakeBool);
 	}
 
+#ifndef DISABLE_THREADING
+	mCoreConfigCopyValue(&core->config, config, "threadedVideo");
+#endif
+
 #if !defined(MINIMAL_CORE) || MINIMAL_CORE < 2
-	struct GBCore* gbcore = (struct GBCore*) core;
 	gbcore->overrides = mCoreConfigGetOverridesConst(config);
 #endif
 }
@@ -297,6 +333,37 @@ static void _GBCoreSetAVStream(struct mCore* core, struct mAVStream* stream) {
 	}
 }
 
+static void _GBCoreEnableOutput(struct mCore* core, bool video, bool audio) {
+	struct GBCore* gbcore = (struct GBCore*) core;
+	struct GB* gb = core->board;
+	// Holding the frameskip counter up skips rendering without touching anything the game can see
+	if (!video) {
+		gb->video.frameskipCounter = INT_MAX;
+	} else if (gbcore->videoSuppressed) {
+		gb->video.frameskipCounter = 0;
+	}
+	gbcore->videoSuppressed = !video;
+	gbcore->audioSuppressed = !audio;
+	GBAudioSuspendSynthesis(&gb->audio, gbcore->audioDisabled || gbcore->audioSuppressed);
+}
+
+static void _GBCoreSetProfile(struct mCore* core, struct mProfile* profile) {
+	struct GB* gb = core->board;
+	if (profile) {
+		profile->instructions[0].name = "LR35902";
+		profile->nModes = 1;
+		profile->dma[0].name = "OAM DMA";
+		profile->dma[1].name = "HDMA";
+		profile->nDMAs = 2;
+	}
+	gb->timing.profile = profile;
+	gb->cpu->profile = profile;
+#ifndef DISABLE_THREADING
+	struct GBCore* gbcore = (struct GBCore*) core;
+	gbcore->threadProxy.d.profile = profile;
+#endif
+}
+
 static bool _GBCoreLoadROM(struct mCore* core, struct VFile* vf) {
 	return GBLoadROM(core->board, vf);
 }
@@ -355,7 +422,16 @@ static void _GBCoreReset(struct mCore* core) {
 	struct GBCore* gbcore = (struct GBCore*) core;
 	struct GB* gb = (struct GB*) core->board;
 	if (gbcore->renderer.outputBuffer) {
-		GBVideoAssociateRenderer(&gb->video, &gbcore->renderer.d);
+		struct GBVideoRenderer* renderer = &gbcore->renderer.d;
+#ifndef DISABLE_THREADING
+		int fakeBool;
+		if (mCoreConfigGetIntValue(&core->config, "threadedVideo", &fakeBool) && fakeBool) {
+			gbcore->proxyRenderer.logger = &gbcore->threadProxy.d;
+			GBVideoProxyRendererCreate(&gbcore->proxyRenderer, renderer);
+			renderer = &gbcore->proxyRenderer.d;
+		}
+#endif
+		GBVideoAssociateRenderer(&gb->video, renderer);
 	}
 
 	if (gb->memory.rom) {
@@ -501,6 +577,10 @@ static bool _GBCoreSaveState(struct mCore* core, void* state) {
 	return true;
 }
 
+static void _GBCoreHashState(struct mCore* core, struct Hash128* hash) {
+	GBHashState(core->board, hash);
+}
+
 static void _GBCoreSetKeys(struct mCore* core, uint32_t keys) {
 	struct GBCore* gbcore = (struct GBCore*) core;
 	gbcore->keys = keys;
@@ -518,6 +598,11 @@ static void _GBCoreClearKeys(struct mCore* core, uint32_t keys) {
 	gbcore->keys &= ~keys;
 }
 
+static uint32_t _GBCoreGetKeys(struct mCore* core) {
+	struct GBCore* gbcore = (struct GBCore*) core;
+	return gbcore->keys;
+}
+
 static int32_t _GBCoreFrameCounter(const struct mCore* core) {
 	const struct GB* gb = core->board;
 	return gb->video.frameCounter;
@@ -673,6 +758,51 @@ void* _GBGetMemoryBlock(struct mCore* core, size_t id, size_t* sizeOut) {
 	}
 }
 
+static void _GBCoreSetDirtyTracking(struct mCore* core, bool enable) {
+	GBMemorySetDirtyTracking(core->board, enable);
+}
+
+static struct DirtyBitmap* _GBCoreGetDirtyPages(struct mCore* core, size_t id) {
+	struct GB* gb = core->board;
+	struct DirtyBitmap* pages;
+	switch (id) {
+	default:
+		return NULL;
+	case GB_REGION_VRAM:
+		pages = &gb->memory.dirtyVram;
+		break;
+	case GB_REGION_EXTERNAL_RAM:
+		pages = &gb->memory.dirtySram;
+		break;
+	case GB_REGION_WORKING_RAM_BANK0:
+		pages = &gb->memory.dirtyWram;
+		break;
+	case GB_BASE_OAM:
+		pages = &gb->memory.dirtyOam;
+		break;
+	}
+	if (!pages->bits) {
+		return NULL;
+	}
+	return pages;
+}
+
+static void _GBCoreClearDirtyPages(struct mCore* core) {
+	GBMemoryClearDirty(core->board);
+}
+
+static bool _GBCoreStateDirtyPages(struct mCore* core, struct DirtyBitmap* pages) {
+	struct GB* gb = core->board;
+	if (!gb->memory.dirtyWram.bits) {
+		return false;
+	}
+	DirtyBitmapFill(pages);
+	DirtyBitmapProject(pages, offsetof(struct GBSerializedState, oam), &gb->memory.dirtyOam, GB_SIZE_OAM);
+	DirtyBitmapProject(pages, offsetof(struct GBSerializedState, vram), &gb->memory.dirtyVram, GB_SIZE_VRAM);
+	DirtyBitmapProject(pages, offsetof(struct GBSerializedState, wram), &gb->memory.dirtyWram, GB_SIZE_WORKING_RAM);
+	return true;
+}
+
 #ifdef USE_DEBUGGERS
 static bool _GBCoreSupportsDebuggerType(struct mCore* core, enum mDebuggerType type) {
 	UNUSED(core);
@@ -783,6 +913,7 @@ static bool _GBCoreSavedataRestore(struct mCore* core, const void* sram, size_t
 	}
 	struct VFile* vf = gb->sramVf;
 	if (vf) {
+		DirtyBitmapFill(&gb->memory.dirtySram);
 		vf->seek(vf, 0, SEEK_SET);
 		return vf->write(vf, sram, size) > 0;
 	}
@@ -907,6 +1038,8 @@ struct mCore* GBCoreCreate(void) {
 	core->setAudioBufferSize = _GBCoreSetAudioBufferSize;
 	core->getAudioBufferSize = _GBCoreGetAudioBufferSize;
 	core->setAVStream = _GBCoreSetAVStream;
+	core->enableOutput = _GBCoreEnableOutput;
+	core->setProfile = _GBCoreSetProfile;
 	core->addCoreCallbacks = _GBCoreAddCoreCallbacks;
 	core->clearCoreCallbacks = _GBCoreClearCoreCallbacks;
 	core->isROM = GBIsROM;
@@ -924,9 +1057,11 @@ struct mCore* GBCoreCreate(void) {
 	core->stateSize = _GBCoreStateSize;
 	core->loadState = _GBCoreLoadState;
 	core->saveState = _GBCoreSaveState;
+	core->hashState = _GBCoreHashState;
 	core->setKeys = _GBCoreSetKeys;
 	core->addKeys = _GBCoreAddKeys;
 	core->clearKeys = _GBCoreClearKeys;
+	core->getKeys = _GBCoreGetKeys;
 	core->frameCounter = _GBCoreFrameCounter;
 	core->frameCycles = _GBCoreFrameCycles;
 	core->frequency = _GBCoreFrequency;
@@ -947,6 +1082,10 @@ struct mCore* GBCoreCreate(void) {
 	core->rawWrite32 = _GBCoreRawWrite32;
 	core->listMemoryBlocks = _GBListMemoryBlocks;
 	core->getMemoryBlock = _GBGetMemoryBlock;
+	core->setDirtyTracking = _GBCoreSetDirtyTracking;
+	core->getDirtyPages = _GBCoreGetDirtyPages;
+	core->clearDirtyPages = _GBCoreClearDirtyPages;
+	core->stateDirtyPages = _GBCoreStateDirtyPages;
 #ifdef USE_DEBUGGERS
 	core->supportsDebuggerType = _GBCoreSupportsDebuggerType;
 	core->debuggerPlatform = _GBCoreDebuggerPlatform;
@@ -28,6 +28,7 @@ static void GBVideoProxyRendererPutPixels(struct GBVideoRenderer* renderer, size
 
 static bool _parsePacket(struct mVideoLogger* logger, const struct mVideoLoggerDirtyInfo* packet);
 static uint16_t* _vramBlock(struct mVideoLogger* logger, uint32_t address);
+static void _flushRange(struct GBVideoProxyRenderer* proxyRenderer);
 
 void GBVideoProxyRendererCreate(struct GBVideoProxyRenderer* renderer, struct GBVideoRenderer* backend) {
 	renderer->d.init = GBVideoProxyRendererInit;
@@ -43,6 +44,8 @@ void GBVideoProxyRendererCreate(struct GBVideoProxyRenderer* renderer, struct GB
 	renderer->d.enableSGBBorder = GBVideoProxyRendererEnableSGBBorder;
 	renderer->d.getPixels = GBVideoProxyRendererGetPixels;
 	renderer->d.putPixels = GBVideoProxyRendererPutPixels;
+	renderer->d.vram = NULL;
+	renderer->d.oam = NULL;
 
 	renderer->logger->context = renderer;
 	renderer->logger->parsePacket = _parsePacket;
@@ -54,8 +57,15 @@ void GBVideoProxyRendererCreate(struct GBVideoProxyRenderer* renderer, struct GB
 	renderer->backend = backend;
 }
 
+static void _resetCoalescing(struct GBVideoProxyRenderer* proxyRenderer) {
+	proxyRenderer->pendingY = -1;
+	proxyRenderer->lastOamMax = -1;
+	memset(proxyRenderer->lastRegisters, 0xFF, sizeof(proxyRenderer->lastRegisters));
+}
+
 static void _init(struct GBVideoProxyRenderer* proxyRenderer) {
 	mVideoLoggerRendererInit(proxyRenderer->logger);
+	_resetCoalescing(proxyRenderer);
 
 	if (proxyRenderer->logger->block) {
 		proxyRenderer->backend->vram = (uint8_t*) proxyRenderer->logger->vram;
@@ -65,10 +75,16 @@ static void _init(struct GBVideoProxyRenderer* proxyRenderer) {
 }
 
 static void _reset(struct GBVideoProxyRenderer* proxyRenderer, enum GBModel model) {
-	memcpy(proxyRenderer->logger->oam, &proxyRenderer->d.oam->raw, GB_SIZE_OAM);
-	memcpy(proxyRenderer->logger->vram, proxyRenderer->d.vram, GB_SIZE_VRAM);
+	// Associating a renderer initializes it before the video unit has handed it any memory
+	if (proxyRenderer->d.oam) {
+		memcpy(proxyRenderer->logger->oam, &proxyRenderer->d.oam->raw, GB_SIZE_OAM);
+	}
+	if (proxyRenderer->d.vram) {
+		memcpy(proxyRenderer->logger->vram, proxyRenderer->d.vram, GB_SIZE_VRAM);
+	}
 
 	proxyRenderer->oamMax = 0;
+	_resetCoalescing(proxyRenderer);
 
 	mVideoLoggerRendererReset(proxyRenderer->logger);
 }
@@ -102,7 +118,15 @@ void GBVideoProxyRendererInit(struct GBVideoRenderer* renderer, enum GBModel mod
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
 
 	_init(proxyRenderer);
-
+	_reset(proxyRenderer, model);
+
+	// The SGB state is owned by whichever renderer the video unit sees, which is this one
+	proxyRenderer->backend->sgbRenderMode = renderer->sgbRenderMode;
+	proxyRenderer->backend->sgbCharRam = renderer->sgbCharRam;
+	proxyRenderer->backend->sgbMapRam = renderer->sgbMapRam;
+	proxyRenderer->backend->sgbPalRam = renderer->sgbPalRam;
+	proxyRenderer->backend->sgbAttributeFiles = renderer->sgbAttributeFiles;
+	proxyRenderer->backend->sgbAttributes = renderer->sgbAttributes;
 	proxyRenderer->backend->init(proxyRenderer->backend, model, borders);
 }
 
@@ -163,6 +187,7 @@ static bool _parsePacket(struct mVideoLogger* logger, const struct mVideoLoggerD
 			break;
 		case BUFFER_SGB:
 			logger->readData(logger, sgbPacket, 16, true);
+			proxyRenderer->backend->sgbRenderMode = item->value;
 			proxyRenderer->backend->writeSGBPacket(proxyRenderer->backend, sgbPacket);
 			break;
 		}
@@ -180,10 +205,27 @@ static uint16_t* _vramBlock(struct mVideoLogger* logger, uint32_t address) {
 	return (uint16_t*) &proxyRenderer->d.vram[address];
 }
 
+// The PPU draws a scanline in many short ranges, splitting it wherever a register was written.
+// Ranges are held back until something else has to be queued, so that ranges only split by
+// writes that don't change anything reach the other side as one packet.
+static void _flushRange(struct GBVideoProxyRenderer* proxyRenderer) {
+	if (proxyRenderer->pendingY < 0) {
+		return;
+	}
+	mVideoLoggerRendererDrawRange(proxyRenderer->logger, proxyRenderer->pendingStartX, proxyRenderer->pendingEndX, proxyRenderer->pendingY);
+	proxyRenderer->pendingY = -1;
+}
+
 uint8_t GBVideoProxyRendererWriteVideoRegister(struct GBVideoRenderer* renderer, uint16_t address, uint8_t value) {
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
 
-	mVideoLoggerRendererWriteVideoRegister(proxyRenderer->logger, address, value);
+	if (address >= GB_SIZE_IO || proxyRenderer->lastRegisters[address] != value) {
+		_flushRange(proxyRenderer);
+		mVideoLoggerRendererWriteVideoRegister(proxyRenderer->logger, address, value);
+		if (address < GB_SIZE_IO) {
+			proxyRenderer->lastRegisters[address] = value;
+		}
+	}
 	if (!proxyRenderer->logger->block) {
 		proxyRenderer->backend->writeVideoRegister(proxyRenderer->backend, address, value);
 	}
@@ -193,13 +235,17 @@ uint8_t GBVideoProxyRendererWriteVideoRegister(struct GBVideoRenderer* renderer,
 void GBVideoProxyRendererWriteSGBPacket(struct GBVideoRenderer* renderer, uint8_t* data) {
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
 	if (!proxyRenderer->logger->block) {
+		proxyRenderer->backend->sgbRenderMode = renderer->sgbRenderMode;
 		proxyRenderer->backend->writeSGBPacket(proxyRenderer->backend, data);
 	}
-	mVideoLoggerWriteBuffer(proxyRenderer->logger, BUFFER_SGB, 0, 16, data);
+	_flushRange(proxyRenderer);
+	// The video unit sets the render mode itself before handing over the packet, so pass it along
+	mVideoLoggerWriteBuffer(proxyRenderer->logger, BUFFER_SGB, renderer->sgbRenderMode, 16, data);
 }
 
 void GBVideoProxyRendererWriteVRAM(struct GBVideoRenderer* renderer, uint16_t address) {
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
+	_flushRange(proxyRenderer);
 	mVideoLoggerRendererWriteVRAM(proxyRenderer->logger, address);
 	if (!proxyRenderer->logger->block) {
 		proxyRenderer->backend->writeVRAM(proxyRenderer->backend, address);
@@ -211,6 +257,7 @@ void GBVideoProxyRendererWriteVRAM(struct GBVideoRenderer* renderer, uint16_t ad
 
 void GBVideoProxyRendererWritePalette(struct GBVideoRenderer* renderer, int address, uint16_t value) {
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
+	_flushRange(proxyRenderer);
 	mVideoLoggerRendererWritePalette(proxyRenderer->logger, address, value);
 	if (!proxyRenderer->logger->block) {
 		proxyRenderer->backend->writePalette(proxyRenderer->backend, address, value);
@@ -225,6 +272,7 @@ void GBVideoProxyRendererWriteOAM(struct GBVideoRenderer* renderer, uint16_t oam
 	if (!proxyRenderer->logger->block) {
 		proxyRenderer->backend->writeOAM(proxyRenderer->backend, oam);
 	}
+	_flushRange(proxyRenderer);
 	mVideoLoggerRendererWriteOAM(proxyRenderer->logger, oam, ((uint8_t*) proxyRenderer->d.oam->raw)[oam]);
 }
 
@@ -233,8 +281,23 @@ void GBVideoProxyRendererDrawRange(struct GBVideoRenderer* renderer, int startX,
 	if (!proxyRenderer->logger->block) {
 		proxyRenderer->backend->drawRange(proxyRenderer->backend, startX, endX, y, obj, oamMax);
 	}
-	mVideoLoggerWriteBuffer(proxyRenderer->logger, BUFFER_OAM, 0, oamMax * sizeof(*obj), obj);	
-	mVideoLoggerRendererDrawRange(proxyRenderer->logger, startX, endX, y);	
+	if (startX >= endX) {
+		return;
+	}
+	bool objChanged = proxyRenderer->lastOamMax != (ssize_t) oamMax || memcmp(proxyRenderer->lastObj, obj, oamMax * sizeof(*obj));
+	if (!objChanged && proxyRenderer->pendingY == y && proxyRenderer->pendingEndX == startX) {
+		proxyRenderer->pendingEndX = endX;
+		return;
+	}
+	_flushRange(proxyRenderer);
+	if (objChanged) {
+		mVideoLoggerWriteBuffer(proxyRenderer->logger, BUFFER_OAM, 0, oamMax * sizeof(*obj), obj);
+		memcpy(proxyRenderer->lastObj, obj, oamMax * sizeof(*obj));
+		proxyRenderer->lastOamMax = oamMax;
+	}
+	proxyRenderer->pendingY = y;
+	proxyRenderer->pendingStartX = startX;
+	proxyRenderer->pendingEndX = endX;
 }
 
 void GBVideoProxyRendererFinishScanline(struct GBVideoRenderer* renderer, int y) {
@@ -242,6 +305,7 @@ void GBVideoProxyRendererFinishScanline(struct GBVideoRenderer* renderer, int y)
 	if (!proxyRenderer->logger->block) {
 		proxyRenderer->backend->finishScanline(proxyRenderer->backend, y);
 	}
+	_flushRange(proxyRenderer);
 	mVideoLoggerRendererDrawScanline(proxyRenderer->logger, y);
 	if (proxyRenderer->logger->block && proxyRenderer->logger->wake) {
 		proxyRenderer->logger->wake(proxyRenderer->logger, y);
@@ -250,6 +314,7 @@ void GBVideoProxyRendererFinishScanline(struct GBVideoRenderer* renderer, int y)
 
 void GBVideoProxyRendererFinishFrame(struct GBVideoRenderer* renderer) {
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
+	_flushRange(proxyRenderer);
 	if (proxyRenderer->logger->block && proxyRenderer->logger->wait) {
 		proxyRenderer->logger->lock(proxyRenderer->logger);
 	}
@@ -265,6 +330,7 @@ void GBVideoProxyRendererFinishFrame(struct GBVideoRenderer* renderer) {
 
 static void GBVideoProxyRendererEnableSGBBorder(struct GBVideoRenderer* renderer, bool enable) {
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
+	_flushRange(proxyRenderer);
 	if (proxyRenderer->logger->block && proxyRenderer->logger->wait) {
 		proxyRenderer->logger->lock(proxyRenderer->logger);
 		// Insert an extra item into the queue to make sure it gets flushed
@@ -279,6 +345,7 @@ static void GBVideoProxyRendererEnableSGBBorder(struct GBVideoRenderer* renderer
 
 static void GBVideoProxyRendererGetPixels(struct GBVideoRenderer* renderer, size_t* stride, const void** pixels) {
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
+	_flushRange(proxyRenderer);
 	if (proxyRenderer->logger->block && proxyRenderer->logger->wait) {
 		proxyRenderer->logger->lock(proxyRenderer->logger);
 		// Insert an extra item into the queue to make sure it gets flushed
@@ -293,6 +360,7 @@ static void GBVideoProxyRendererGetPixels(struct GBVideoRenderer* renderer, size
 
 static void GBVideoProxyRendererPutPixels(struct GBVideoRenderer* renderer, size_t stride, const void* pixels) {
 	struct GBVideoProxyRenderer* proxyRenderer = (struct GBVideoProxyRenderer*) renderer;
+	_flushRange(proxyRenderer);
 	if (proxyRenderer->logger->block && proxyRenderer->logger->wait) {
 		proxyRenderer->logger->lock(proxyRenderer->logger);
 		// Insert an extra item into the queue to make sure it gets flushed
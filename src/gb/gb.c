@@ -220,6 +220,7 @@ void GBResizeSram(struct GB* gb, size_t size) {
 	if (gb->sramSize < size) {
 		gb->sramSize = size;
 	}
+	DirtyBitmapFill(&gb->memory.dirtySram);
 }
 
 void GBSramClean(struct GB* gb, uint32_t frameCount) {
@@ -258,6 +259,7 @@ void GBSavedataMask(struct GB* gb, struct VFile* vf, bool writeback) {
 	gb->sramVf = vf;
 	gb->sramMaskWriteback = writeback;
 	gb->memory.sram = vf->map(vf, gb->sramSize, MAP_READ);
+	DirtyBitmapFill(&gb->memory.dirtySram);
 	GBMBCSwitchSramBank(gb, gb->memory.sramCurrentBank);
 }
 
@@ -274,6 +276,7 @@ void GBSavedataUnmask(struct GB* gb) {
 		vf->read(vf, gb->memory.sram, gb->sramSize);
 		gb->sramMaskWriteback = false;
 	}
+	DirtyBitmapFill(&gb->memory.dirtySram);
 	GBMBCSwitchSramBank(gb, gb->memory.sramCurrentBank);
 	vf->close(vf);
 }
@@ -462,6 +465,7 @@ void GBReset(struct LR35902Core* cpu) {
 
 	GBMemoryReset(gb);
 	GBVideoReset(&gb->video);
+	GBMemoryMarkAllDirty(gb);
 	GBTimerReset(&gb->timer);
 	if (!gb->biosVf) {
 		GBSkipBIOS(gb);
@@ -395,6 +395,7 @@ void GBIOWrite(struct GB* gb, unsigned address, uint8_t value) {
 	case REG_WAVE_D:
 	case REG_WAVE_E:
 	case REG_WAVE_F:
+		GBAudioRun(&gb->audio, mTimingCurrentTime(&gb->timing));
 		if (!gb->audio.playingCh3 || gb->audio.style != GB_AUDIO_DMG) {
 			gb->audio.ch3.wavedata8[address - REG_WAVE_0] = value;
 		} else if(gb->audio.ch3.readable) {
@@ -595,6 +596,7 @@ uint8_t GBIORead(struct GB* gb, unsigned address) {
 	case REG_WAVE_D:
 	case REG_WAVE_E:
 	case REG_WAVE_F:
+		GBAudioRun(&gb->audio, mTimingCurrentTime(&gb->timing));
 		if (gb->audio.playingCh3) {
 			if (gb->audio.ch3.readable || gb->audio.style != GB_AUDIO_DMG) {
 				return gb->audio.ch3.wavedata8[gb->audio.ch3.window >> 1];
@@ -686,6 +688,9 @@ void GBIODeserialize(struct GB* gb, const struct GBSerializedState* state) {
 	gb->memory.ie = state->ie;
 
 	if (GBAudioEnableGetEnable(*gb->audio.nr52)) {
+		// Replaying the registers runs against the channel state from before the load, which
+		// can clear the playing bits; the audio state is restored from NR52 afterwards
+		uint8_t nr52 = gb->memory.io[REG_NR52];
 		GBIOWrite(gb, REG_NR10, gb->memory.io[REG_NR10]);
 		GBIOWrite(gb, REG_NR11, gb->memory.io[REG_NR11]);
 		GBIOWrite(gb, REG_NR12, gb->memory.io[REG_NR12]);
@@ -695,14 +700,14 @@ void GBIODeserialize(struct GB* gb, const struct GBSerializedState* state) {
 		gb->audio.ch1.control.stop = GBAudioRegisterControlGetStop(gb->memory.io[REG_NR14] << 8);
 		GBIOWrite(gb, REG_NR21, gb->memory.io[REG_NR21]);
 		GBIOWrite(gb, REG_NR22, gb->memory.io[REG_NR22]);
-		GBIOWrite(gb, REG_NR22, gb->memory.io[REG_NR23]);
+		GBIOWrite(gb, REG_NR23, gb->memory.io[REG_NR23]);
 		gb->audio.ch2.control.frequency &= 0xFF;
 		gb->audio.ch2.control.frequency |= GBAudioRegisterControlGetFrequency(gb->memory.io[REG_NR24] << 8);
 		gb->audio.ch2.control.stop = GBAudioRegisterControlGetStop(gb->memory.io[REG_NR24] << 8);
 		GBIOWrite(gb, REG_NR30, gb->memory.io[REG_NR30]);
 		GBIOWrite(gb, REG_NR31, gb->memory.io[REG_NR31]);
 		GBIOWrite(gb, REG_NR32, gb->memory.io[REG_NR32]);
-		GBIOWrite(gb, REG_NR32, gb->memory.io[REG_NR33]);
+		GBIOWrite(gb, REG_NR33, gb->memory.io[REG_NR33]);
 		gb->audio.ch3.rate &= 0xFF;
 		gb->audio.ch3.rate |= GBAudioRegisterControlGetRate(gb->memory.io[REG_NR34] << 8);
 		gb->audio.ch3.stop = GBAudioRegisterControlGetStop(gb->memory.io[REG_NR34] << 8);
@@ -712,6 +717,7 @@ void GBIODeserialize(struct GB* gb, const struct GBSerializedState* state) {
 		gb->audio.ch4.stop = GBAudioRegisterNoiseControlGetStop(gb->memory.io[REG_NR44]);
 		GBIOWrite(gb, REG_NR50, gb->memory.io[REG_NR50]);
 		GBIOWrite(gb, REG_NR51, gb->memory.io[REG_NR51]);
+		gb->memory.io[REG_NR52] = nr52;
 	}
 
 	gb->video.renderer->writeVideoRegister(gb->video.renderer, REG_LCDC, state->io[REG_LCDC]);
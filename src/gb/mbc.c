@@ -470,6 +470,7 @@ void _GBMBC2(struct GB* gb, uint16_t address, uint8_t value) {
 		address &= 0x1FF;
 		memory->sramBank[(address >> 1)] &= 0xF0 >> shift;
 		memory->sramBank[(address >> 1)] |= (value & 0xF) << shift;
+		DirtyBitmapMark(&memory->dirtySram, (memory->sramBank - memory->sram) + (address >> 1));
 		break;
 	default:
 		// TODO
@@ -610,6 +611,7 @@ void _GBMBC6(struct GB* gb, uint16_t address, uint8_t value) {
 	case 0x2B:
 		if (memory->mbcState.mbc6.sramAccess) {
 			memory->sramBank[address & (GB_SIZE_EXTERNAL_RAM_HALFBANK - 1)] = value;
+			DirtyBitmapMark(&memory->dirtySram, (memory->sramBank - memory->sram) + (address & (GB_SIZE_EXTERNAL_RAM_HALFBANK - 1)));
 		}
 		break;
 	case 0x2C:
@@ -618,6 +620,7 @@ void _GBMBC6(struct GB* gb, uint16_t address, uint8_t value) {
 	case 0x2F:
 		if (memory->mbcState.mbc6.sramAccess) {
 			memory->mbcState.mbc6.sramBank1[address & (GB_SIZE_EXTERNAL_RAM_HALFBANK - 1)] = value;
+			DirtyBitmapMark(&memory->dirtySram, (memory->mbcState.mbc6.sramBank1 - memory->sram) + (address & (GB_SIZE_EXTERNAL_RAM_HALFBANK - 1)));
 		}
 		break;
 	default:
@@ -796,6 +799,7 @@ static void _GBMBC7Write(struct GBMemory* memory, uint16_t address, uint8_t valu
 				if (mbc7->writable) {
 					memory->sram[mbc7->address * 2] = mbc7->sr >> 8;
 					memory->sram[mbc7->address * 2 + 1] = mbc7->sr;
+					DirtyBitmapMark(&memory->dirtySram, mbc7->address * 2);
 				}
 				mbc7->state = GBMBC7_STATE_IDLE;
 			}
@@ -804,6 +808,7 @@ static void _GBMBC7Write(struct GBMemory* memory, uint16_t address, uint8_t valu
 			if (mbc7->writable) {
 				memory->sram[mbc7->address * 2] = 0xFF;
 				memory->sram[mbc7->address * 2 + 1] = 0xFF;
+				DirtyBitmapMark(&memory->dirtySram, mbc7->address * 2);
 			}
 			mbc7->state = GBMBC7_STATE_IDLE;
 			break;
@@ -822,6 +827,7 @@ static void _GBMBC7Write(struct GBMemory* memory, uint16_t address, uint8_t valu
 						memory->sram[i * 2] = mbc7->sr >> 8;
 						memory->sram[i * 2 + 1] = mbc7->sr;
 					}
+					DirtyBitmapMarkRange(&memory->dirtySram, 0, 256);
 				}
 				mbc7->state = GBMBC7_STATE_IDLE;
 			}
@@ -833,6 +839,7 @@ static void _GBMBC7Write(struct GBMemory* memory, uint16_t address, uint8_t valu
 					memory->sram[i * 2] = 0xFF;
 					memory->sram[i * 2 + 1] = 0xFF;
 				}
+				DirtyBitmapMarkRange(&memory->dirtySram, 0, 256);
 			}
 			mbc7->state = GBMBC7_STATE_IDLE;
 			break;
@@ -1021,6 +1028,7 @@ void _GBPocketCamCapture(struct GBMemory* memory) {
 		return;
 	}
 	memset(&memory->sram[0x100], 0, GBCAM_HEIGHT * GBCAM_WIDTH / 4);
+	DirtyBitmapMarkRange(&memory->dirtySram, 0x100, GBCAM_HEIGHT * GBCAM_WIDTH / 4);
 	struct GBPocketCamState* pocketCam = &memory->mbcState.pocketCam;
 	size_t x, y;
 	for (y = 0; y < GBCAM_HEIGHT; ++y) {
@@ -1111,6 +1119,7 @@ void _GBTAMA5(struct GB* gb, uint16_t address, uint8_t value) {
 					switch (tama5->registers[GBTAMA5_CS] >> 1) {
 					case 0x0: // RAM write
 						memory->sram[address] = out;
+						DirtyBitmapMark(&memory->dirtySram, address);
 						break;
 					case 0x1: // RAM read
 						break;
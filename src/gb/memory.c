@@ -6,6 +6,7 @@
 #include <mgba/internal/gb/memory.h>
 
 #include <mgba/core/interface.h>
+#include <mgba/core/profile.h>
 #include <mgba/internal/gb/gb.h>
 #include <mgba/internal/gb/io.h>
 #include <mgba/internal/gb/mbc.h>
@@ -135,6 +136,7 @@ void GBMemoryInit(struct GB* gb) {
 }
 
 void GBMemoryDeinit(struct GB* gb) {
+	GBMemorySetDirtyTracking(gb, false);
 	mappedMemoryFree(gb->memory.wram, GB_SIZE_WORKING_RAM);
 	if (gb->memory.rom) {
 		mappedMemoryFree(gb->memory.rom, gb->memory.romSize);
@@ -224,6 +226,43 @@ void GBMemorySwitchWramBank(struct GBMemory* memory, int bank) {
 	memory->wramCurrentBank = bank;
 }
 
+void GBMemorySetDirtyTracking(struct GB* gb, bool enable) {
+	struct GBMemory* memory = &gb->memory;
+	if (enable == !!memory->dirtyWram.bits) {
+		return;
+	}
+	if (!enable) {
+		DirtyBitmapDeinit(&memory->dirtyWram);
+		DirtyBitmapDeinit(&memory->dirtySram);
+		DirtyBitmapDeinit(&memory->dirtyVram);
+		DirtyBitmapDeinit(&memory->dirtyOam);
+		return;
+	}
+	DirtyBitmapInit(&memory->dirtyWram, GB_SIZE_WORKING_RAM);
+	// Sized for the largest cartridge RAM so that resizing never reallocates
+	DirtyBitmapInit(&memory->dirtySram, 0x20000);
+	DirtyBitmapInit(&memory->dirtyVram, GB_SIZE_VRAM);
+	DirtyBitmapInit(&memory->dirtyOam, GB_SIZE_OAM);
+	// Nothing is known about writes that happened before tracking began
+	GBMemoryMarkAllDirty(gb);
+}
+
+void GBMemoryMarkAllDirty(struct GB* gb) {
+	struct GBMemory* memory = &gb->memory;
+	DirtyBitmapFill(&memory->dirtyWram);
+	DirtyBitmapFill(&memory->dirtySram);
+	DirtyBitmapFill(&memory->dirtyVram);
+	DirtyBitmapFill(&memory->dirtyOam);
+}
+
+void GBMemoryClearDirty(struct GB* gb) {
+	struct GBMemory* memory = &gb->memory;
+	DirtyBitmapClear(&memory->dirtyWram);
+	DirtyBitmapClear(&memory->dirtySram);
+	DirtyBitmapClear(&memory->dirtyVram);
+	DirtyBitmapClear(&memory->dirtyOam);
+}
+
 uint8_t GBLoad8(struct LR35902Core* cpu, uint16_t address) {
 	struct GB* gb = (struct GB*) cpu->master;
 	struct GBMemory* memory = &gb->memory;
@@ -331,6 +370,7 @@ void GBStore8(struct LR35902Core* cpu, uint16_t address, int8_t value) {
 		if (gb->video.mode != 3) {
 			gb->video.renderer->writeVRAM(gb->video.renderer, (address & (GB_SIZE_VRAM_BANK0 - 1)) | (GB_SIZE_VRAM_BANK0 * gb->video.vramCurrentBank));
 			gb->video.vramBank[address & (GB_SIZE_VRAM_BANK0 - 1)] = value;
+			DirtyBitmapMark(&memory->dirtyVram, (gb->video.vramBank - gb->video.vram) + (address & (GB_SIZE_VRAM_BANK0 - 1)));
 		}
 		return;
 	case GB_REGION_EXTERNAL_RAM:
@@ -339,6 +379,7 @@ void GBStore8(struct LR35902Core* cpu, uint16_t address, int8_t value) {
 			memory->rtcRegs[memory->activeRtcReg] = value;
 		} else if (memory->sramAccess && memory->sram && memory->mbcType != GB_MBC2) {
 			memory->sramBank[address & (GB_SIZE_EXTERNAL_RAM - 1)] = value;
+			DirtyBitmapMark(&memory->dirtySram, (memory->sramBank - memory->sram) + (address & (GB_SIZE_EXTERNAL_RAM - 1)));
 		} else {
 			memory->mbcWrite(gb, address, value);
 		}
@@ -347,16 +388,20 @@ void GBStore8(struct LR35902Core* cpu, uint16_t address, int8_t value) {
 	case GB_REGION_WORKING_RAM_BANK0:
 	case GB_REGION_WORKING_RAM_BANK0 + 2:
 		memory->wram[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)] = value;
+		DirtyBitmapMark(&memory->dirtyWram, address & (GB_SIZE_WORKING_RAM_BANK0 - 1));
 		return;
 	case GB_REGION_WORKING_RAM_BANK1:
 		memory->wramBank[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)] = value;
+		DirtyBitmapMark(&memory->dirtyWram, (memory->wramBank - memory->wram) + (address & (GB_SIZE_WORKING_RAM_BANK0 - 1)));
 		return;
 	default:
 		if (address < GB_BASE_OAM) {
 			memory->wramBank[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)] = value;
+			DirtyBitmapMark(&memory->dirtyWram, (memory->wramBank - memory->wram) + (address & (GB_SIZE_WORKING_RAM_BANK0 - 1)));
 		} else if (address < GB_BASE_UNUSABLE) {
 			if (gb->video.mode < 2) {
 				gb->video.oam.raw[address & 0xFF] = value;
+				DirtyBitmapMark(&memory->dirtyOam, address & 0xFF);
 				gb->video.renderer->writeOAM(gb->video.renderer, address & 0xFF);
 			}
 		} else if (address < GB_BASE_IO) {
@@ -532,10 +577,14 @@ void _GBMemoryDMAService(struct mTiming* timing, void* context, uint32_t cyclesL
 	uint8_t b = GBLoad8(gb->cpu, gb->memory.dmaSource);
 	// TODO: Can DMA write OAM during modes 2-3?
 	gb->video.oam.raw[gb->memory.dmaDest] = b;
+	DirtyBitmapMark(&gb->memory.dirtyOam, gb->memory.dmaDest);
 	gb->video.renderer->writeOAM(gb->video.renderer, gb->memory.dmaDest);
 	++gb->memory.dmaSource;
 	++gb->memory.dmaDest;
 	gb->memory.dmaRemaining = dmaRemaining - 1;
+	if (timing->profile) {
+		++timing->profile->dma[0].count;
+	}
 	if (gb->memory.dmaRemaining) {
 		mTimingSchedule(timing, &gb->memory.dmaEvent, 4 - cyclesLate);
 	}
@@ -549,6 +598,9 @@ void _GBMemoryHDMAService(struct mTiming* timing, void* context, uint32_t cycles
 	++gb->memory.hdmaSource;
 	++gb->memory.hdmaDest;
 	--gb->memory.hdmaRemaining;
+	if (timing->profile) {
+		++timing->profile->dma[1].count;
+	}
 	if (gb->memory.hdmaRemaining) {
 		mTimingDeschedule(timing, &gb->memory.hdmaEvent);
 		mTimingSchedule(timing, &gb->memory.hdmaEvent, 2 - cyclesLate);
@@ -603,10 +655,12 @@ void GBPatch8(struct LR35902Core* cpu, uint16_t address, int8_t value, int8_t* o
 		if (segment < 0) {
 			oldValue = gb->video.vramBank[address & (GB_SIZE_VRAM_BANK0 - 1)];
 			gb->video.vramBank[address & (GB_SIZE_VRAM_BANK0 - 1)] = value;
+			DirtyBitmapMark(&memory->dirtyVram, (address & (GB_SIZE_VRAM_BANK0 - 1)) + GB_SIZE_VRAM_BANK0 * gb->video.vramCurrentBank);
 			gb->video.renderer->writeVRAM(gb->video.renderer, (address & (GB_SIZE_VRAM_BANK0 - 1)) + GB_SIZE_VRAM_BANK0 * gb->video.vramCurrentBank);
 		} else if (segment < 2) {
 			oldValue = gb->video.vram[(address & (GB_SIZE_VRAM_BANK0 - 1)) + segment * GB_SIZE_VRAM_BANK0];
 			gb->video.vramBank[(address & (GB_SIZE_VRAM_BANK0 - 1)) + segment * GB_SIZE_VRAM_BANK0] = value;
+			DirtyBitmapMark(&memory->dirtyVram, (address & (GB_SIZE_VRAM_BANK0 - 1)) + segment * GB_SIZE_VRAM_BANK0);
 			gb->video.renderer->writeVRAM(gb->video.renderer, (address & (GB_SIZE_VRAM_BANK0 - 1)) + segment * GB_SIZE_VRAM_BANK0);
 		} else {
 			return;
@@ -620,14 +674,17 @@ void GBPatch8(struct LR35902Core* cpu, uint16_t address, int8_t value, int8_t* o
 	case GB_REGION_WORKING_RAM_BANK0 + 2:
 		oldValue = memory->wram[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)];
 		memory->wram[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)] = value;
+		DirtyBitmapMark(&memory->dirtyWram, address & (GB_SIZE_WORKING_RAM_BANK0 - 1));
 		break;
 	case GB_REGION_WORKING_RAM_BANK1:
 		if (segment < 0) {
 			oldValue = memory->wramBank[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)];
 			memory->wramBank[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)] = value;
+			DirtyBitmapMark(&memory->dirtyWram, (memory->wramBank - memory->wram) + (address & (GB_SIZE_WORKING_RAM_BANK0 - 1)));
 		} else if (segment < 8) {
 			oldValue = memory->wram[(address & (GB_SIZE_WORKING_RAM_BANK0 - 1)) + segment * GB_SIZE_WORKING_RAM_BANK0];
 			memory->wram[(address & (GB_SIZE_WORKING_RAM_BANK0 - 1)) + segment * GB_SIZE_WORKING_RAM_BANK0] = value;
+			DirtyBitmapMark(&memory->dirtyWram, (address & (GB_SIZE_WORKING_RAM_BANK0 - 1)) + segment * GB_SIZE_WORKING_RAM_BANK0);
 		} else {
 			return;
 		}
@@ -636,9 +693,11 @@ void GBPatch8(struct LR35902Core* cpu, uint16_t address, int8_t value, int8_t* o
 		if (address < GB_BASE_OAM) {
 			oldValue = memory->wramBank[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)];
 			memory->wramBank[address & (GB_SIZE_WORKING_RAM_BANK0 - 1)] = value;
+			DirtyBitmapMark(&memory->dirtyWram, (memory->wramBank - memory->wram) + (address & (GB_SIZE_WORKING_RAM_BANK0 - 1)));
 		} else if (address < GB_BASE_UNUSABLE) {
 			oldValue = gb->video.oam.raw[address & 0xFF];
 			gb->video.oam.raw[address & 0xFF] = value;
+			DirtyBitmapMark(&memory->dirtyOam, address & 0xFF);
 			gb->video.renderer->writeOAM(gb->video.renderer, address & 0xFF);
 		} else if (address < GB_BASE_HRAM) {
 			mLOG(GB_MEM, STUB, "Unimplemented memory Patch8: 0x%08X", address);
@@ -715,7 +774,7 @@ void GBMemorySerialize(const struct GB* gb, struct GBSerializedState* state) {
 
 void GBMemoryDeserialize(struct GB* gb, const struct GBSerializedState* state) {
 	struct GBMemory* memory = &gb->memory;
-	memcpy(memory->wram, state->wram, GB_SIZE_WORKING_RAM);
+	DirtyBitmapCopy(&memory->dirtyWram, memory->wram, state->wram, GB_SIZE_WORKING_RAM);
 	memcpy(memory->hram, state->hram, GB_SIZE_HRAM);
 	LOAD_16LE(memory->currentBank, 0, &state->memory.currentBank);
 	memory->wramCurrentBank = state->memory.wramCurrentBank;
@@ -27,6 +27,7 @@ static void GBVideoSoftwareRendererPutPixels(struct GBVideoRenderer* renderer, s
 
 static void GBVideoSoftwareRendererDrawBackground(struct GBVideoSoftwareRenderer* renderer, uint8_t* maps, int startX, int endX, int sx, int sy);
 static void GBVideoSoftwareRendererDrawObj(struct GBVideoSoftwareRenderer* renderer, struct GBObj* obj, int startX, int endX, int y);
+static void _flushLine(struct GBVideoSoftwareRenderer* renderer);
 
 static void _clearScreen(struct GBVideoSoftwareRenderer* renderer) {
 	size_t sgbOffset = 0;
@@ -181,6 +182,8 @@ void GBVideoSoftwareRendererCreate(struct GBVideoSoftwareRenderer* renderer) {
 	renderer->d.disableWIN = false;
 
 	renderer->temporaryBuffer = 0;
+	renderer->batchScanlines = false;
+	renderer->nSpans = 0;
 }
 
 static void GBVideoSoftwareRendererInit(struct GBVideoRenderer* renderer, enum GBModel model, bool sgbBorders) {
@@ -203,6 +206,7 @@ static void GBVideoSoftwareRendererInit(struct GBVideoRenderer* renderer, enum G
 	softwareRenderer->offsetScy = 0;
 	softwareRenderer->offsetWx = 0;
 	softwareRenderer->offsetWy = 0;
+	softwareRenderer->nSpans = 0;
 
 	int i;
 	for (i = 0; i < 64; ++i) {
@@ -266,18 +270,21 @@ static uint8_t GBVideoSoftwareRendererWriteVideoRegister(struct GBVideoRenderer*
 		GBVideoSoftwareRendererUpdateWindow(softwareRenderer, wasWindow, _inWindow(softwareRenderer));
 		break;
 	case REG_BGP:
+		_flushLine(softwareRenderer);
 		softwareRenderer->lookup[0] = value & 3;
 		softwareRenderer->lookup[1] = (value >> 2) & 3;
 		softwareRenderer->lookup[2] = (value >> 4) & 3;
 		softwareRenderer->lookup[3] = (value >> 6) & 3;
 		break;
 	case REG_OBP0:
+		_flushLine(softwareRenderer);
 		softwareRenderer->lookup[0x20 + 0] = value & 3;
 		softwareRenderer->lookup[0x20 + 1] = (value >> 2) & 3;
 		softwareRenderer->lookup[0x20 + 2] = (value >> 4) & 3;
 		softwareRenderer->lookup[0x20 + 3] = (value >> 6) & 3;
 		break;
 	case REG_OBP1:
+		_flushLine(softwareRenderer);
 		softwareRenderer->lookup[0x24 + 0] = value & 3;
 		softwareRenderer->lookup[0x24 + 1] = (value >> 2) & 3;
 		softwareRenderer->lookup[0x24 + 2] = (value >> 4) & 3;
@@ -289,6 +296,7 @@ static uint8_t GBVideoSoftwareRendererWriteVideoRegister(struct GBVideoRenderer*
 
 static void GBVideoSoftwareRendererWriteSGBPacket(struct GBVideoRenderer* renderer, uint8_t* data) {
 	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
+	_flushLine(softwareRenderer);
 	memcpy(softwareRenderer->sgbPacket, data, sizeof(softwareRenderer->sgbPacket));
 	int i;
 	softwareRenderer->sgbCommandHeader = data[0];
@@ -428,6 +436,7 @@ static void GBVideoSoftwareRendererWriteSGBPacket(struct GBVideoRenderer* render
 
 static void GBVideoSoftwareRendererWritePalette(struct GBVideoRenderer* renderer, int index, uint16_t value) {
 	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
+	_flushLine(softwareRenderer);
 	color_t color = mColorFrom555(value);
 	if (softwareRenderer->model & GB_MODEL_SGB) {
 		if (index < 0x10 && index && !(index & 3)) {
@@ -475,6 +484,7 @@ static void GBVideoSoftwareRendererWritePalette(struct GBVideoRenderer* renderer
 }
 
 static void GBVideoSoftwareRendererWriteVRAM(struct GBVideoRenderer* renderer, uint16_t address) {
+	_flushLine((struct GBVideoSoftwareRenderer*) renderer);
 	if (renderer->cache) {
 		mCacheSetWriteVRAM(renderer->cache, address);
 	}
@@ -486,9 +496,7 @@ static void GBVideoSoftwareRendererWriteOAM(struct GBVideoRenderer* renderer, ui
 	// Nothing to do
 }
 
-static void GBVideoSoftwareRendererDrawRange(struct GBVideoRenderer* renderer, int startX, int endX, int y, struct GBObj* obj, size_t oamMax) {
-	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
-	softwareRenderer->lastY = y;
+static void _drawBackgroundRange(struct GBVideoSoftwareRenderer* softwareRenderer, int startX, int endX, int y) {
 	uint8_t* maps = &softwareRenderer->d.vram[GB_BASE_MAP];
 	if (GBRegisterLCDCIsTileMap(softwareRenderer->lcdc)) {
 		maps += GB_SIZE_MAP;
@@ -499,8 +507,16 @@ static void GBVideoSoftwareRendererDrawRange(struct GBVideoRenderer* renderer, i
 	if (GBRegisterLCDCIsBgEnable(softwareRenderer->lcdc) || softwareRenderer->model >= GB_MODEL_CGB) {
 		int wy = softwareRenderer->wy + softwareRenderer->currentWy;
 		if (GBRegisterLCDCIsWindow(softwareRenderer->lcdc) && wy <= y && endX >= softwareRenderer->wx - 7) {
-			if (softwareRenderer->wx - 7 > 0 && !softwareRenderer->d.disableBG) {
-				GBVideoSoftwareRendererDrawBackground(softwareRenderer, maps, startX, softwareRenderer->wx - 7, softwareRenderer->scx - softwareRenderer->offsetScx, softwareRenderer->scy + y - softwareRenderer->offsetScy);
+			int windowX = softwareRenderer->wx - 7;
+			bool drawBG = windowX > 0;
+			if (softwareRenderer->batchScanlines && windowX < startX) {
+				// A batched line draws its spans back to back, so anything left of startX belongs
+				// to an earlier span and was drawn with that span's registers
+				windowX = startX;
+				drawBG = false;
+			}
+			if (drawBG && !softwareRenderer->d.disableBG) {
+				GBVideoSoftwareRendererDrawBackground(softwareRenderer, maps, startX, windowX, softwareRenderer->scx - softwareRenderer->offsetScx, softwareRenderer->scy + y - softwareRenderer->offsetScy);
 			}
 
 			maps = &softwareRenderer->d.vram[GB_BASE_MAP];
@@ -508,7 +524,7 @@ static void GBVideoSoftwareRendererDrawRange(struct GBVideoRenderer* renderer, i
 				maps += GB_SIZE_MAP;
 			}
 			if (!softwareRenderer->d.disableWIN) {
-				GBVideoSoftwareRendererDrawBackground(softwareRenderer, maps, softwareRenderer->wx - 7, endX, 7 - softwareRenderer->wx - softwareRenderer->offsetWx, y - wy - softwareRenderer->offsetWy);
+				GBVideoSoftwareRendererDrawBackground(softwareRenderer, maps, windowX, endX, 7 - softwareRenderer->wx - softwareRenderer->offsetWx, y - wy - softwareRenderer->offsetWy);
 			}
 		} else if (!softwareRenderer->d.disableBG) {
 			GBVideoSoftwareRendererDrawBackground(softwareRenderer, maps, startX, endX, softwareRenderer->scx - softwareRenderer->offsetScx, softwareRenderer->scy + y - softwareRenderer->offsetScy);
@@ -516,14 +532,18 @@ static void GBVideoSoftwareRendererDrawRange(struct GBVideoRenderer* renderer, i
 	} else if (!softwareRenderer->d.disableBG) {
 		memset(&softwareRenderer->row[startX], 0, endX - startX);
 	}
+}
 
+static void _drawObjRange(struct GBVideoSoftwareRenderer* softwareRenderer, int startX, int endX, int y, struct GBObj* obj, size_t oamMax) {
 	if (GBRegisterLCDCIsObjEnable(softwareRenderer->lcdc) && !softwareRenderer->d.disableOBJ) {
 		size_t i;
 		for (i = 0; i < oamMax; ++i) {
 			GBVideoSoftwareRendererDrawObj(softwareRenderer, &obj[i], startX, endX, y);
 		}
 	}
+}
 
+static void _convertRange(struct GBVideoSoftwareRenderer* softwareRenderer, int startX, int endX, int y, int sgbRenderMode) {
 	size_t sgbOffset = 0;
 	if (softwareRenderer->model & GB_MODEL_SGB && softwareRenderer->sgbBorders) {
 		sgbOffset = softwareRenderer->outputBufferStride * 40 + 48;
@@ -531,7 +551,7 @@ static void GBVideoSoftwareRendererDrawRange(struct GBVideoRenderer* renderer, i
 	color_t* row = &softwareRenderer->outputBuffer[softwareRenderer->outputBufferStride * y + sgbOffset];
 	int x = startX;
 	int p = 0;
-	switch (softwareRenderer->d.sgbRenderMode) {
+	switch (sgbRenderMode) {
 	case 0:
 		if (softwareRenderer->model & GB_MODEL_SGB) {
 			p = softwareRenderer->d.sgbAttributes[(startX >> 5) + 5 * (y >> 3)];
@@ -609,8 +629,105 @@ static void GBVideoSoftwareRendererDrawRange(struct GBVideoRenderer* renderer, i
 	}
 }
 
+static void GBVideoSoftwareRendererDrawRange(struct GBVideoRenderer* renderer, int startX, int endX, int y, struct GBObj* obj, size_t oamMax) {
+	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
+	softwareRenderer->lastY = y;
+	if (!softwareRenderer->batchScanlines) {
+		_flushLine(softwareRenderer);
+		_drawBackgroundRange(softwareRenderer, startX, endX, y);
+		_drawObjRange(softwareRenderer, startX, endX, y, obj, oamMax);
+		_convertRange(softwareRenderer, startX, endX, y, renderer->sgbRenderMode);
+		return;
+	}
+
+	if (softwareRenderer->nSpans && softwareRenderer->spanY != y) {
+		_flushLine(softwareRenderer);
+	}
+	if (!softwareRenderer->nSpans) {
+		// The object list belongs to the caller and may not outlive this call
+		softwareRenderer->spanY = y;
+		softwareRenderer->spanObjMax = oamMax;
+		memcpy(softwareRenderer->spanObj, obj, oamMax * sizeof(*obj));
+	}
+	if (startX < endX) {
+		struct GBVideoSoftwareSpan* span = &softwareRenderer->spans[softwareRenderer->nSpans];
+		++softwareRenderer->nSpans;
+		span->startX = startX;
+		span->endX = endX;
+		span->lcdc = softwareRenderer->lcdc;
+		span->scx = softwareRenderer->scx;
+		span->scy = softwareRenderer->scy;
+		span->wx = softwareRenderer->wx;
+		span->wy = softwareRenderer->wy;
+		span->currentWy = softwareRenderer->currentWy;
+		span->sgbRenderMode = renderer->sgbRenderMode;
+	}
+	if (endX >= GB_VIDEO_HORIZONTAL_PIXELS) {
+		_flushLine(softwareRenderer);
+	}
+}
+
+static void _loadSpan(struct GBVideoSoftwareRenderer* renderer, const struct GBVideoSoftwareSpan* span) {
+	renderer->lcdc = span->lcdc;
+	renderer->scx = span->scx;
+	renderer->scy = span->scy;
+	renderer->wx = span->wx;
+	renderer->wy = span->wy;
+	renderer->currentWy = span->currentWy;
+}
+
+static bool _sameBackground(const struct GBVideoSoftwareSpan* a, const struct GBVideoSoftwareSpan* b) {
+	return a->endX == b->startX &&
+	       GBRegisterLCDCClearObjEnable(GBRegisterLCDCClearObjSize(a->lcdc)) == GBRegisterLCDCClearObjEnable(GBRegisterLCDCClearObjSize(b->lcdc)) &&
+	       a->scx == b->scx && a->scy == b->scy && a->wx == b->wx && a->wy == b->wy && a->currentWy == b->currentWy;
+}
+
+// Draws the logged spans of a line. Neighbouring spans drawn with the same registers are merged,
+// so a line is resolved once per layer however often the game wrote to registers that don't affect it.
+// Anything that changes the palettes or VRAM flushes the line first, so those are constant here.
+static void _flushLine(struct GBVideoSoftwareRenderer* renderer) {
+	if (!renderer->nSpans) {
+		return;
+	}
+	struct GBVideoSoftwareSpan live = {
+		.lcdc = renderer->lcdc,
+		.scx = renderer->scx,
+		.scy = renderer->scy,
+		.wx = renderer->wx,
+		.wy = renderer->wy,
+		.currentWy = renderer->currentWy
+	};
+	const struct GBVideoSoftwareSpan* spans = renderer->spans;
+	int nSpans = renderer->nSpans;
+	int y = renderer->spanY;
+	renderer->nSpans = 0;
+
+	int i, j;
+	for (i = 0; i < nSpans; i = j) {
+		for (j = i + 1; j < nSpans && _sameBackground(&spans[j - 1], &spans[j]); ++j);
+		_loadSpan(renderer, &spans[i]);
+		_drawBackgroundRange(renderer, spans[i].startX, spans[j - 1].endX, y);
+	}
+	for (i = 0; i < nSpans; i = j) {
+		for (j = i + 1; j < nSpans && spans[j - 1].endX == spans[j].startX && spans[j].lcdc == spans[i].lcdc; ++j);
+		// Objects may be drawn up to seven pixels past the end of a range, which the next range's
+		// background covers up when drawing eagerly; here the background was drawn already
+		uint8_t spill[8];
+		memcpy(spill, &renderer->row[spans[j - 1].endX], sizeof(spill));
+		_loadSpan(renderer, &spans[i]);
+		_drawObjRange(renderer, spans[i].startX, spans[j - 1].endX, y, renderer->spanObj, renderer->spanObjMax);
+		memcpy(&renderer->row[spans[j - 1].endX], spill, sizeof(spill));
+	}
+	for (i = 0; i < nSpans; i = j) {
+		for (j = i + 1; j < nSpans && spans[j - 1].endX == spans[j].startX && spans[j].sgbRenderMode == spans[i].sgbRenderMode; ++j);
+		_convertRange(renderer, spans[i].startX, spans[j - 1].endX, y, spans[i].sgbRenderMode);
+	}
+	_loadSpan(renderer, &live);
+}
+
 static void GBVideoSoftwareRendererFinishScanline(struct GBVideoRenderer* renderer, int y) {
 	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
+	_flushLine(softwareRenderer);
 
 	if (softwareRenderer->sgbTransfer == 1) {
 		size_t offset = 2 * ((y & 7) + (y >> 3) * GB_VIDEO_HORIZONTAL_PIXELS);
@@ -667,6 +784,7 @@ static void GBVideoSoftwareRendererFinishScanline(struct GBVideoRenderer* render
 
 static void GBVideoSoftwareRendererFinishFrame(struct GBVideoRenderer* renderer) {
 	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
+	_flushLine(softwareRenderer);
 
 	if (softwareRenderer->temporaryBuffer) {
 		mappedMemoryFree(softwareRenderer->temporaryBuffer, GB_VIDEO_HORIZONTAL_PIXELS * GB_VIDEO_VERTICAL_PIXELS * 4);
@@ -708,6 +826,7 @@ static void GBVideoSoftwareRendererFinishFrame(struct GBVideoRenderer* renderer)
 
 static void GBVideoSoftwareRendererEnableSGBBorder(struct GBVideoRenderer* renderer, bool enable) {
 	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
+	_flushLine(softwareRenderer);
 	if (softwareRenderer->model & GB_MODEL_SGB) {
 		if (enable == softwareRenderer->sgbBorders) {
 			return;
@@ -719,6 +838,22 @@ static void GBVideoSoftwareRendererEnableSGBBorder(struct GBVideoRenderer* rende
 	}
 }
 
+#define TILE_ROW_BYTES 0x0101010101010101ULL
+#ifdef __BIG_ENDIAN__
+#define TILE_ROW_MASK 0x8040201008040201ULL
+#define TILE_ROW_MASK_FLIPPED 0x0102040810204080ULL
+#else
+#define TILE_ROW_MASK 0x0102040810204080ULL
+#define TILE_ROW_MASK_FLIPPED 0x8040201008040201ULL
+#endif
+
+// Spreads one bitplane of a tile row into one byte per pixel, leftmost pixel first in memory,
+// so eight pixels are decoded at once without a lookup table
+static inline uint64_t _expandTileRow(uint8_t bits, bool xFlip) {
+	uint64_t spread = (bits * TILE_ROW_BYTES) & (xFlip ? TILE_ROW_MASK_FLIPPED : TILE_ROW_MASK);
+	return ((spread + 0x7F * TILE_ROW_BYTES) >> 7) & TILE_ROW_BYTES;
+}
+
 static void GBVideoSoftwareRendererDrawBackground(struct GBVideoSoftwareRenderer* renderer, uint8_t* maps, int startX, int endX, int sx, int sy) {
 	uint8_t* data = renderer->d.vram;
 	uint8_t* attr = &maps[GB_SIZE_VRAM_BANK0];
@@ -773,6 +908,7 @@ static void GBVideoSoftwareRendererDrawBackground(struct GBVideoSoftwareRenderer
 		uint8_t* localData = data;
 		int localY = bottomY;
 		int topX = ((x + sx) >> 3) & 0x1F;
+		bool xFlip = false;
 		int bgTile;
 		if (GBRegisterLCDCIsTileData(renderer->lcdc)) {
 			bgTile = maps[topX + topY];
@@ -793,29 +929,13 @@ static void GBVideoSoftwareRendererDrawBackground(struct GBVideoSoftwareRenderer
 				localY = 7 - bottomY;
 			}
 			if (GBObjAttributesIsXFlip(attrs)) {
-				uint8_t tileDataLower = localData[(bgTile * 8 + localY) * 2];
-				uint8_t tileDataUpper = localData[(bgTile * 8 + localY) * 2 + 1];
-				renderer->row[x + 0] = p | ((tileDataUpper & 1) << 1) | (tileDataLower & 1);
-				renderer->row[x + 1] = p | (tileDataUpper & 2) | ((tileDataLower & 2) >> 1);
-				renderer->row[x + 2] = p | ((tileDataUpper & 4) >> 1) | ((tileDataLower & 4) >> 2);
-				renderer->row[x + 3] = p | ((tileDataUpper & 8) >> 2) | ((tileDataLower & 8) >> 3);
-				renderer->row[x + 4] = p | ((tileDataUpper & 16) >> 3) | ((tileDataLower & 16) >> 4);
-				renderer->row[x + 5] = p | ((tileDataUpper & 32) >> 4) | ((tileDataLower & 32) >> 5);
-				renderer->row[x + 6] = p | ((tileDataUpper & 64) >> 5) | ((tileDataLower & 64) >> 6);
-				renderer->row[x + 7] = p | ((tileDataUpper & 128) >> 6) | ((tileDataLower & 128) >> 7);
-				continue;
+				xFlip = true;
 			}
 		}
 		uint8_t tileDataLower = localData[(bgTile * 8 + localY) * 2];
 		uint8_t tileDataUpper = localData[(bgTile * 8 + localY) * 2 + 1];
-		renderer->row[x + 7] = p | ((tileDataUpper & 1) << 1) | (tileDataLower & 1);
-		renderer->row[x + 6] = p | (tileDataUpper & 2) | ((tileDataLower & 2) >> 1);
-		renderer->row[x + 5] = p | ((tileDataUpper & 4) >> 1) | ((tileDataLower & 4) >> 2);
-		renderer->row[x + 4] = p | ((tileDataUpper & 8) >> 2) | ((tileDataLower & 8) >> 3);
-		renderer->row[x + 3] = p | ((tileDataUpper & 16) >> 3) | ((tileDataLower & 16) >> 4);
-		renderer->row[x + 2] = p | ((tileDataUpper & 32) >> 4) | ((tileDataLower & 32) >> 5);
-		renderer->row[x + 1] = p | ((tileDataUpper & 64) >> 5) | ((tileDataLower & 64) >> 6);
-		renderer->row[x + 0] = p | ((tileDataUpper & 128) >> 6) | ((tileDataLower & 128) >> 7);
+		uint64_t pixels = (p * TILE_ROW_BYTES) | _expandTileRow(tileDataLower, xFlip) | (_expandTileRow(tileDataUpper, xFlip) << 1);
+		memcpy(&renderer->row[x], &pixels, sizeof(pixels));
 	}
 }
 
@@ -965,12 +1085,14 @@ static void GBVideoSoftwareRendererDrawObj(struct GBVideoSoftwareRenderer* rende
 
 static void GBVideoSoftwareRendererGetPixels(struct GBVideoRenderer* renderer, size_t* stride, const void** pixels) {
 	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
+	_flushLine(softwareRenderer);
 	*stride = softwareRenderer->outputBufferStride;
 	*pixels = softwareRenderer->outputBuffer;
 }
 
 static void GBVideoSoftwareRendererPutPixels(struct GBVideoRenderer* renderer, size_t stride, const void* pixels) {
 	struct GBVideoSoftwareRenderer* softwareRenderer = (struct GBVideoSoftwareRenderer*) renderer;
+	_flushLine(softwareRenderer);
 	// TODO: Share with GBAVideoSoftwareRendererGetPixels
 
 	const color_t* colorPixels = pixels;
@@ -9,6 +9,7 @@
 #include <mgba/internal/gb/timer.h>
 #include <mgba/internal/lr35902/lr35902.h>
 
+#include <mgba-util/hash.h>
 #include <mgba-util/memory.h>
 
 mLOG_DEFINE_CATEGORY(GB_STATE, "GB Savestate", "gb.serialize");
@@ -62,6 +63,7 @@ void GBSerialize(struct GB* gb, struct GBSerializedState* state) {
 	GBIOSerialize(gb, state);
 	GBVideoSerialize(&gb->video, state);
 	GBTimerSerialize(&gb->timer, state);
+	GBAudioRun(&gb->audio, mTimingCurrentTime(&gb->timing));
 	GBAudioSerialize(&gb->audio, state);
 
 	if (gb->model & GB_MODEL_SGB) {
@@ -139,6 +141,7 @@ bool GBDeserialize(struct GB* gb, const struct GBSerializedState* state) {
 		return false;
 	}
 	gb->timing.root = NULL;
+	gb->timing.reroot = NULL;
 	LOAD_32LE(gb->timing.masterCycles, 0, &state->masterCycles);
 
 	gb->cpu->a = state->cpu.a;
@@ -183,6 +186,9 @@ bool GBDeserialize(struct GB* gb, const struct GBSerializedState* state) {
 
 	GBMemoryDeserialize(gb, state);
 	GBVideoDeserialize(&gb->video, state);
+	// Memory regions mark the pages they change while loading; cartridge RAM
+	// comes from extdata and isn't compared, so assume all of it changed
+	DirtyBitmapFill(&gb->memory.dirtySram);
 	GBIODeserialize(gb, state);
 	GBTimerDeserialize(&gb->timer, state);
 	GBAudioDeserialize(&gb->audio, state);
@@ -199,6 +205,42 @@ bool GBDeserialize(struct GB* gb, const struct GBSerializedState* state) {
 	return true;
 }
 
+void GBHashState(struct GB* gb, struct Hash128* hash) {
+	// Lazy timing leaves registers stale until something looks at them
+	GBAudioRun(&gb->audio, mTimingCurrentTime(&gb->timing));
+
+	struct LR35902Core* cpu = gb->cpu;
+	uint8_t registers[16] = {
+		cpu->a, cpu->f.packed, cpu->b, cpu->c, cpu->d, cpu->e, cpu->h, cpu->l,
+		cpu->sp, cpu->sp >> 8, cpu->pc, cpu->pc >> 8,
+		gb->memory.ime, gb->memory.ie, cpu->halted
+	};
+	hash128Update(hash, registers, sizeof(registers));
+
+	// Which banks are mapped in is visible to the game as well
+	uint8_t banks[16] = { 0 };
+	STORE_32LE(gb->memory.currentBank, 0, banks);
+	STORE_32LE(gb->memory.wramCurrentBank, 4, banks);
+	STORE_32LE(gb->memory.sramCurrentBank, 8, banks);
+	STORE_32LE(gb->video.vramCurrentBank, 12, banks);
+	hash128Update(hash, banks, sizeof(banks));
+
+	hash128Update(hash, gb->memory.io, GB_SIZE_IO);
+	hash128Update(hash, gb->memory.hram, GB_SIZE_HRAM);
+	hash128Update(hash, gb->memory.wram, GB_SIZE_WORKING_RAM);
+	hash128Update(hash, gb->video.vram, GB_SIZE_VRAM);
+	hash128Update(hash, gb->video.oam.raw, GB_SIZE_OAM);
+	uint16_t palette[64];
+	size_t i;
+	for (i = 0; i < 64; ++i) {
+		STORE_16LE(gb->video.palette[i], i * 2, palette);
+	}
+	hash128Update(hash, palette, sizeof(palette));
+	if (gb->memory.sram) {
+		hash128Update(hash, gb->memory.sram, gb->sramSize);
+	}
+}
+
 // TODO: Reorganize SGB into its own file
 void GBSGBSerialize(struct GB* gb, struct GBSerializedState* state) {
 	state->sgb.command = gb->video.sgbCommandHeader;
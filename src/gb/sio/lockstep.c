@@ -15,9 +15,18 @@ static void GBSIOLockstepNodeDeinit(struct GBSIODriver* driver);
 static void GBSIOLockstepNodeWriteSB(struct GBSIODriver* driver, uint8_t value);
 static uint8_t GBSIOLockstepNodeWriteSC(struct GBSIODriver* driver, uint8_t value);
 static void _GBSIOLockstepNodeProcessEvents(struct mTiming* timing, void* driver, uint32_t cyclesLate);
+static int32_t _GBSIOLockstepSync(struct mLockstep* lockstep, int id);
+
+static int32_t _window(const struct GBSIOLockstepNode* node) {
+	if (node->p->d.window > 0) {
+		return node->p->d.window;
+	}
+	return LOCKSTEP_INCREMENT;
+}
 
 void GBSIOLockstepInit(struct GBSIOLockstep* lockstep) {
 	mLockstepInit(&lockstep->d);
+	lockstep->d.syncNode = _GBSIOLockstepSync;
 	lockstep->players[0] = NULL;
 	lockstep->players[1] = NULL;
 	lockstep->pendingSB[0] = 0xFF;
@@ -71,7 +80,10 @@ bool GBSIOLockstepNodeInit(struct GBSIODriver* driver) {
 
 	node->nextEvent = 0;
 	node->eventDiff = 0;
-	mTimingSchedule(&driver->p->p->timing, &node->event, 0);
+	node->transferPending = false;
+	if (!node->p->d.scheduler) {
+		mTimingSchedule(&driver->p->p->timing, &node->event, 0);
+	}
 #ifndef NDEBUG
 	node->phase = node->p->d.transferActive;
 	node->transferId = node->p->d.transferId;
@@ -109,7 +121,7 @@ static int32_t _masterUpdate(struct GBSIOLockstepNode* node) {
 	switch (node->p->d.transferActive) {
 	case TRANSFER_IDLE:
 		// If the master hasn't initiated a transfer, it can keep going.
-		node->nextEvent += LOCKSTEP_INCREMENT;
+		node->nextEvent += _window(node);
 		break;
 	case TRANSFER_STARTING:
 		// Start the transfer, but wait for the other GBs to catch up
@@ -137,7 +149,7 @@ static int32_t _masterUpdate(struct GBSIOLockstepNode* node) {
 		// Everything's settled. We're done.
 		_finishTransfer(node);
 		ATOMIC_STORE(node->p->masterClaimed, false);
-		node->nextEvent += LOCKSTEP_INCREMENT;
+		node->nextEvent += _window(node);
 		ATOMIC_STORE(node->p->d.transferActive, TRANSFER_IDLE);
 		break;
 	}
@@ -169,7 +181,7 @@ static uint32_t _slaveUpdate(struct GBSIOLockstepNode* node) {
 	bool signal = false;
 	switch (node->p->d.transferActive) {
 	case TRANSFER_IDLE:
-		node->p->d.addCycles(&node->p->d, node->id, LOCKSTEP_INCREMENT);
+		node->p->d.addCycles(&node->p->d, node->id, _window(node));
 		break;
 	case TRANSFER_STARTING:
 	case TRANSFER_FINISHING:
@@ -229,14 +241,58 @@ static void GBSIOLockstepNodeWriteSB(struct GBSIODriver* driver, uint8_t value)
 static uint8_t GBSIOLockstepNodeWriteSC(struct GBSIODriver* driver, uint8_t value) {
 	struct GBSIOLockstepNode* node = (struct GBSIOLockstepNode*) driver;
 	if ((value & 0x81) == 0x81 && node->p->d.attached > 1) {
+		if (node->p->d.scheduler) {
+			// The link can only be claimed at a sync, where nodes asking in the same round go in player order
+			if (!node->p->masterClaimed) {
+				node->transferPending = true;
+				mTimingDeschedule(&driver->p->p->timing, &driver->p->event);
+			}
+			return value;
+		}
 		bool claimed = false;
 		if (ATOMIC_CMPXCHG(node->p->masterClaimed, claimed, true)) {
 			node->p->d.transferActive = TRANSFER_STARTING;
 			node->p->d.transferCycles = GBSIOCyclesPerTransfer[(value >> 1) & 1];
 			mTimingDeschedule(&driver->p->p->timing, &driver->p->event);
-			mTimingDeschedule(&driver->p->p->timing, &node->event);
+			if (mTimingIsScheduled(&driver->p->p->timing, &node->event)) {
+				// Only the cycles actually run since the last sync may be posted to the other nodes
+				node->eventDiff -= mTimingUntil(&driver->p->p->timing, &node->event);
+				mTimingDeschedule(&driver->p->p->timing, &node->event);
+			}
 			mTimingSchedule(&driver->p->p->timing, &node->event, 0);
 		}
 	}
 	return value;
 }
+
+static int32_t _GBSIOLockstepSync(struct mLockstep* lockstep, int id) {
+	struct GBSIOLockstep* gbLockstep = (struct GBSIOLockstep*) lockstep;
+	struct GBSIOLockstepNode* node = gbLockstep->players[id];
+	if (lockstep->attached < 2) {
+		return _window(node);
+	}
+	node->nextEvent = 0;
+	if (id) {
+		_slaveUpdate(node);
+		return 0;
+	}
+	int i;
+	for (i = 0; i < lockstep->attached; ++i) {
+		struct GBSIOLockstepNode* player = gbLockstep->players[i];
+		if (!player->transferPending) {
+			continue;
+		}
+		player->transferPending = false;
+		struct GBSIO* sio = player->d.p;
+		if (!gbLockstep->masterClaimed) {
+			gbLockstep->masterClaimed = true;
+			lockstep->transferActive = TRANSFER_STARTING;
+			lockstep->transferCycles = GBSIOCyclesPerTransfer[GBRegisterSCGetClockSpeed(sio->p->memory.io[REG_SC])];
+		} else {
+			// Another node claimed the link first, so this one shifts on its own
+			mTimingSchedule(&sio->p->timing, &sio->event, sio->period);
+		}
+	}
+	_masterUpdate(node);
+	return node->nextEvent;
+}
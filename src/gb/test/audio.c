@@ -0,0 +1,279 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba/internal/gb/audio.h>
+#include <mgba/internal/gb/serialize.h>
+
+#define TEST_WRITES 4000
+#define TEST_SAMPLE_INTERVAL 32
+#define TEST_FRAME_INTERVAL 0x2000
+
+struct GBAudioTest {
+	struct mTiming timing;
+	int32_t relativeCycles;
+	int32_t nextEvent;
+	uint8_t nr52;
+	struct GBAudio audio;
+	struct mTimingEvent sampleEvent;
+	struct mTimingEvent frameEvent;
+	int16_t* samples;
+	size_t nSamples;
+	size_t maxSamples;
+	unsigned stops;
+	uint8_t status[TEST_WRITES];
+};
+
+static void _sample(struct mTiming* timing, void* context, uint32_t cyclesLate) {
+	struct GBAudioTest* test = context;
+	GBAudioRun(&test->audio, mTimingCurrentTime(timing) - cyclesLate);
+	if (test->nSamples + 2 > test->maxSamples) {
+		test->maxSamples *= 2;
+		test->samples = realloc(test->samples, test->maxSamples * sizeof(*test->samples));
+	}
+	GBAudioSamplePSG(&test->audio, &test->samples[test->nSamples], &test->samples[test->nSamples + 1]);
+	test->nSamples += 2;
+	mTimingSchedule(timing, &test->sampleEvent, TEST_SAMPLE_INTERVAL - cyclesLate);
+}
+
+static void _frame(struct mTiming* timing, void* context, uint32_t cyclesLate) {
+	struct GBAudioTest* test = context;
+	// Mirrors the GB timer, which clocks the frame sequencer after channel events on the same cycle
+	GBAudioRun(&test->audio, mTimingCurrentTime(timing) - cyclesLate);
+	GBAudioUpdateFrame(&test->audio, timing);
+	mTimingSchedule(timing, &test->frameEvent, TEST_FRAME_INTERVAL - cyclesLate);
+}
+
+static void _init(struct GBAudioTest* test, enum GBAudioStyle style, bool lazy, bool suspend) {
+	memset(test, 0, sizeof(*test));
+	mTimingInit(&test->timing, &test->relativeCycles, &test->nextEvent);
+	GBAudioInit(&test->audio, 2048, &test->nr52, style);
+	test->audio.timing = &test->timing;
+	GBAudioReset(&test->audio);
+	mTimingDeschedule(&test->timing, &test->audio.sampleEvent);
+	GBAudioSetLazyChannels(&test->audio, lazy);
+	GBAudioSuspendSynthesis(&test->audio, suspend);
+
+	test->maxSamples = 0x10000;
+	test->samples = malloc(test->maxSamples * sizeof(*test->samples));
+	test->sampleEvent.context = test;
+	test->sampleEvent.name = "Test Sample";
+	test->sampleEvent.callback = _sample;
+	test->sampleEvent.priority = 0x18;
+	if (!suspend) {
+		mTimingSchedule(&test->timing, &test->sampleEvent, 0);
+	}
+	if (style != GB_AUDIO_GBA) {
+		test->frameEvent.context = test;
+		test->frameEvent.name = "Test Frame Sequencer";
+		test->frameEvent.callback = _frame;
+		test->frameEvent.priority = 0x21;
+		mTimingSchedule(&test->timing, &test->frameEvent, TEST_FRAME_INTERVAL);
+	}
+	GBAudioWriteNR52(&test->audio, 0x80);
+}
+
+static void _deinit(struct GBAudioTest* test) {
+	GBAudioDeinit(&test->audio);
+	free(test->samples);
+}
+
+static void _advance(struct GBAudioTest* test, int32_t cycles) {
+	while (cycles > 0) {
+		int32_t next = mTimingNextEvent(&test->timing);
+		if (next > cycles) {
+			next = cycles;
+		} else {
+			if (next < 0) {
+				next = 0;
+			}
+			// Every stop dispatches at least one event, so this tracks how busy the scheduler is
+			++test->stops;
+		}
+		mTimingTick(&test->timing, next);
+		cycles -= next;
+	}
+}
+
+static void _write(struct GBAudio* audio, unsigned reg, uint8_t value) {
+	switch (reg) {
+	case 0:
+		GBAudioWriteNR10(audio, value);
+		break;
+	case 1:
+		GBAudioWriteNR11(audio, value);
+		break;
+	case 2:
+		GBAudioWriteNR12(audio, value);
+		break;
+	case 3:
+		GBAudioWriteNR13(audio, value);
+		break;
+	case 4:
+		GBAudioWriteNR14(audio, value);
+		break;
+	case 5:
+		GBAudioWriteNR21(audio, value);
+		break;
+	case 6:
+		GBAudioWriteNR22(audio, value);
+		break;
+	case 7:
+		GBAudioWriteNR23(audio, value);
+		break;
+	case 8:
+		GBAudioWriteNR24(audio, value);
+		break;
+	case 9:
+		GBAudioWriteNR30(audio, value);
+		break;
+	case 10:
+		GBAudioWriteNR31(audio, value);
+		break;
+	case 11:
+		GBAudioWriteNR32(audio, value);
+		break;
+	case 12:
+		GBAudioWriteNR33(audio, value);
+		break;
+	case 13:
+		GBAudioWriteNR34(audio, value);
+		break;
+	case 14:
+		GBAudioWriteNR41(audio, value);
+		break;
+	case 15:
+		GBAudioWriteNR42(audio, value);
+		break;
+	case 16:
+		GBAudioWriteNR43(audio, value);
+		break;
+	case 17:
+		GBAudioWriteNR44(audio, value);
+		break;
+	case 18:
+		GBAudioWriteNR50(audio, value);
+		break;
+	case 19:
+		GBAudioWriteNR51(audio, value);
+		break;
+	case 20:
+		GBAudioWriteNR52(audio, value);
+		break;
+	}
+}
+
+static void _runScript(struct GBAudioTest* test, uint32_t seed) {
+	int i;
+	for (i = 0; i < TEST_WRITES; ++i) {
+		seed = seed * 1103515245 + 12345;
+		_advance(test, (seed >> 8) & 0x7FF);
+		test->status[i] = test->nr52;
+		seed = seed * 1103515245 + 12345;
+		unsigned reg = (seed >> 16) % 21;
+		uint8_t value = seed >> 8;
+		if (reg == 20 && (seed & 0x7000)) {
+			// Turning the APU off resets everything, so keep it rare
+			continue;
+		}
+		if (reg == 4 || reg == 8 || reg == 13 || reg == 17) {
+			// Restart more often than not to keep channels busy
+			value |= (seed >> 24) & 0x80;
+		}
+		_write(&test->audio, reg, value);
+	}
+	_advance(test, 0x10000);
+}
+
+static void _compareStyle(enum GBAudioStyle style, uint32_t seed) {
+	struct GBAudioTest* events = malloc(sizeof(*events));
+	struct GBAudioTest* lazy = malloc(sizeof(*lazy));
+	_init(events, style, false, false);
+	_init(lazy, style, true, false);
+	_runScript(events, seed);
+	_runScript(lazy, seed);
+
+	assert_int_equal(events->nSamples, lazy->nSamples);
+	size_t i;
+	for (i = 0; i < events->nSamples; ++i) {
+		if (events->samples[i] != lazy->samples[i]) {
+			fail_msg("Sample %zu differs: %i != %i", i / 2, events->samples[i], lazy->samples[i]);
+		}
+	}
+	assert_int_equal(events->nr52, lazy->nr52);
+
+	struct GBSerializedPSGState eventsState;
+	struct GBSerializedPSGState lazyState;
+	uint32_t eventsFlags;
+	uint32_t lazyFlags;
+	memset(&eventsState, 0, sizeof(eventsState));
+	memset(&lazyState, 0, sizeof(lazyState));
+	GBAudioPSGSerialize(&events->audio, &eventsState, &eventsFlags);
+	GBAudioPSGSerialize(&lazy->audio, &lazyState, &lazyFlags);
+	assert_int_equal(eventsFlags, lazyFlags);
+	assert_memory_equal(&eventsState, &lazyState, sizeof(eventsState));
+
+	assert_true(lazy->stops < events->stops);
+
+	_deinit(events);
+	_deinit(lazy);
+	free(events);
+	free(lazy);
+}
+
+static void _compareSuspended(enum GBAudioStyle style, uint32_t seed) {
+	struct GBAudioTest* events = malloc(sizeof(*events));
+	struct GBAudioTest* suspended = malloc(sizeof(*suspended));
+	_init(events, style, false, false);
+	_init(suspended, style, false, true);
+	_runScript(events, seed);
+	_runScript(suspended, seed);
+
+	assert_int_equal(suspended->nSamples, 0);
+	assert_memory_equal(events->status, suspended->status, sizeof(events->status));
+	assert_int_equal(events->nr52, suspended->nr52);
+	assert_int_equal(events->audio.ch1.control.length, suspended->audio.ch1.control.length);
+	assert_int_equal(events->audio.ch2.control.length, suspended->audio.ch2.control.length);
+	assert_int_equal(events->audio.ch3.length, suspended->audio.ch3.length);
+	assert_int_equal(events->audio.ch4.length, suspended->audio.ch4.length);
+	assert_int_equal(events->audio.ch1.control.frequency, suspended->audio.ch1.control.frequency);
+	assert_true(suspended->stops < events->stops / 4);
+
+	_deinit(events);
+	_deinit(suspended);
+	free(events);
+	free(suspended);
+}
+
+M_TEST_DEFINE(lazyMatchesDMG) {
+	_compareStyle(GB_AUDIO_DMG, 1);
+	_compareStyle(GB_AUDIO_DMG, 0x5EED);
+}
+
+M_TEST_DEFINE(lazyMatchesCGB) {
+	_compareStyle(GB_AUDIO_CGB, 2);
+	_compareStyle(GB_AUDIO_CGB, 0xC6B);
+}
+
+M_TEST_DEFINE(lazyMatchesGBA) {
+	_compareStyle(GB_AUDIO_GBA, 3);
+	_compareStyle(GB_AUDIO_GBA, 0x6BA);
+}
+
+M_TEST_DEFINE(suspendKeepsStatusDMG) {
+	_compareSuspended(GB_AUDIO_DMG, 4);
+}
+
+M_TEST_DEFINE(suspendKeepsStatusGBA) {
+	_compareSuspended(GB_AUDIO_GBA, 5);
+}
+
+M_TEST_SUITE_DEFINE(GBAudio,
+	cmocka_unit_test(lazyMatchesDMG),
+	cmocka_unit_test(lazyMatchesCGB),
+	cmocka_unit_test(lazyMatchesGBA),
+	cmocka_unit_test(suspendKeepsStatusDMG),
+	cmocka_unit_test(suspendKeepsStatusGBA))
@@ -5,11 +5,130 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include "util/test/suite.h"
 
+#include <mgba/core/config.h>
 #include <mgba/core/core.h>
+#include <mgba/core/profile.h>
 #include <mgba/gb/core.h>
 #include <mgba/internal/gb/gb.h>
+#include <mgba/internal/gb/io.h>
 #include <mgba-util/vfs.h>
 
+#define SPAN_SKIP_FRAMES 8
+#define SPAN_TEST_FRAMES 12
+#define SPAN_OAM_TABLE 0x200
+
+static const uint8_t _spanEntry[] = {
+	0x00, // nop
+	0xC3, 0x50, 0x01, // jp $0150
+};
+
+// Fills VRAM and OAM, then writes scroll, window, palette and LCDC registers as fast as
+// it can, so most of them land in the middle of a scanline
+static const uint8_t _spanRom[] = {
+	0xF3, // di
+	0x31, 0xFE, 0xFF, // ld sp, $FFFE
+	0xF0, 0x44, // .vblank: ldh a, [LY]
+	0xFE, 0x90, // cp 144
+	0x38, 0xFA, // jr c, .vblank
+	0xAF, // xor a
+	0xE0, 0x40, // ldh [LCDC], a
+	0x21, 0x00, 0x80, // ld hl, $8000
+	0x7D, // .tiles: ld a, l
+	0xCB, 0x3F, // srl a
+	0xCB, 0x3F, // srl a
+	0xCB, 0x3F, // srl a
+	0xAD, // xor l
+	0xAC, // xor h
+	0x22, // ld [hl+], a
+	0x7C, // ld a, h
+	0xFE, 0x90, // cp $90
+	0x20, 0xF1, // jr nz, .tiles
+	0x7D, // .maps: ld a, l
+	0xCB, 0x64, // bit 4, h
+	0x28, 0x02, // jr z, .map0
+	0xEE, 0x5A, // xor $5A
+	0x22, // .map0: ld [hl+], a
+	0x7C, // ld a, h
+	0xFE, 0xA0, // cp $A0
+	0x20, 0xF3, // jr nz, .maps
+	0x21, 0x00, 0xFE, // ld hl, $FE00
+	0x11, 0x00, 0x02, // ld de, SPAN_OAM_TABLE
+	0x1A, // .oam: ld a, [de]
+	0x13, // inc de
+	0x22, // ld [hl+], a
+	0x7D, // ld a, l
+	0xFE, 0xA0, // cp $A0
+	0x20, 0xF8, // jr nz, .oam
+	0x3E, 0xE4, // ld a, $E4
+	0xE0, 0x47, // ldh [BGP], a
+	0x3E, 0xD2, // ld a, $D2
+	0xE0, 0x48, // ldh [OBP0], a
+	0x3E, 0x1B, // ld a, $1B
+	0xE0, 0x49, // ldh [OBP1], a
+	0x3E, 0x28, // ld a, 40
+	0xE0, 0x4A, // ldh [WY], a
+	0x3E, 0x50, // ld a, 80
+	0xE0, 0x4B, // ldh [WX], a
+	0x3E, 0xE3, // ld a, $E3
+	0xE0, 0x40, // ldh [LCDC], a
+	0x0E, 0x00, // ld c, 0
+	0x06, 0x00, // ld b, 0
+	0x79, // .loop: ld a, c
+	0xE0, 0x43, // ldh [SCX], a
+	0x80, // add b
+	0xE0, 0x42, // ldh [SCY], a
+	0x0C, // inc c
+	0x79, // ld a, c
+	0xE6, 0x7F, // and $7F
+	0xC6, 0x18, // add $18
+	0xE0, 0x4B, // ldh [WX], a
+	0x79, // ld a, c
+	0x0F, // rrca
+	0x0F, // rrca
+	0xE0, 0x47, // ldh [BGP], a
+	0x79, // ld a, c
+	0xE6, 0x34, // and $34
+	0xF6, 0xC3, // or $C3
+	0xE0, 0x40, // ldh [LCDC], a
+	0xF0, 0x44, // ldh a, [LY]
+	0xFE, 0x00, // cp 0
+	0x20, 0x01, // jr nz, .skip
+	0x04, // inc b
+	0x79, // .skip: ld a, c
+	0xE6, 0x07, // and 7
+	0x20, 0xDA, // jr nz, .loop
+	0x79, // ld a, c
+	0xE0, 0x48, // ldh [OBP0], a
+	0x18, 0xD5, // jr .loop
+};
+
+static struct mCore* _spanCore(bool batch, color_t* buffer) {
+	struct VFile* vf = VFileMemChunk(NULL, 2048);
+	GBSynthesizeROM(vf);
+	vf->seek(vf, 0x100, SEEK_SET);
+	vf->write(vf, _spanEntry, sizeof(_spanEntry));
+	vf->seek(vf, 0x150, SEEK_SET);
+	vf->write(vf, _spanRom, sizeof(_spanRom));
+	// Scatter all 40 sprites across the screen with mixed palettes, flips and priorities
+	vf->seek(vf, SPAN_OAM_TABLE, SEEK_SET);
+	int i;
+	for (i = 0; i < 40; ++i) {
+		uint8_t sprite[4] = { 16 + i * 3 + (i * 7) % 5, 8 + (i * 37) % 160, (uint8_t) (i * 11), ((i & 3) << 5) | ((i & 4) << 2) | ((i & 8) << 4) };
+		vf->write(vf, sprite, sizeof(sprite));
+	}
+
+	struct mCore* core = GBCoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	mCoreInitConfig(core, NULL);
+	mCoreConfigSetIntValue(&core->config, "batchScanlines", batch);
+	mCoreLoadConfig(core);
+	core->setVideoBuffer(core, buffer, GB_VIDEO_HORIZONTAL_PIXELS);
+	assert_true(core->loadROM(core, vf));
+	core->reset(core);
+	return core;
+}
+
 M_TEST_DEFINE(create) {
 	struct mCore* core = GBCoreCreate();
 	assert_non_null(core);
@@ -55,9 +174,136 @@ M_TEST_DEFINE(isROM) {
 	core->deinit(core);
 }
 
+M_TEST_DEFINE(profile) {
+	struct VFile* vf = VFileMemChunk(NULL, 2048);
+	GBSynthesizeROM(vf);
+	struct mCore* core = GBCoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	mCoreInitConfig(core, NULL);
+	assert_true(core->loadROM(core, vf));
+	core->reset(core);
+
+	struct mProfile profile;
+	mProfileInit(&profile);
+	core->setProfile(core, &profile);
+	core->runFrame(core);
+	core->runFrame(core);
+
+	uint64_t events = profile.eventsUnlisted;
+	size_t i;
+	for (i = 0; i < profile.nEvents; ++i) {
+		events += profile.events[i].count;
+	}
+	assert_true(events > 0);
+	assert_int_equal(events, mProfileTotalEvents(&profile));
+	assert_int_equal(profile.nModes, 1);
+	assert_true(profile.instructions[0].count > 0);
+	assert_int_equal(profile.instructions[0].count, mProfileTotalInstructions(&profile));
+
+	core->setProfile(core, NULL);
+	mProfileClear(&profile);
+	core->runFrame(core);
+	assert_int_equal(profile.instructions[0].count, 0);
+	for (i = 0; i < profile.nEvents; ++i) {
+		assert_int_equal(profile.events[i].count, 0);
+	}
+
+	mCoreConfigDeinit(&core->config);
+	core->deinit(core);
+}
+
+M_TEST_DEFINE(batchScanlines) {
+	size_t size = GB_VIDEO_HORIZONTAL_PIXELS * GB_VIDEO_VERTICAL_PIXELS;
+	color_t* eagerBuffer = calloc(size, BYTES_PER_PIXEL);
+	color_t* batchBuffer = calloc(size, BYTES_PER_PIXEL);
+	struct mCore* eager = _spanCore(false, eagerBuffer);
+	struct mCore* batch = _spanCore(true, batchBuffer);
+
+	int i;
+	for (i = 0; i < SPAN_SKIP_FRAMES; ++i) {
+		eager->runFrame(eager);
+		batch->runFrame(batch);
+	}
+	for (i = 0; i < SPAN_TEST_FRAMES; ++i) {
+		eager->runFrame(eager);
+		batch->runFrame(batch);
+		assert_memory_equal(eagerBuffer, batchBuffer, size * BYTES_PER_PIXEL);
+	}
+	// Make sure the lines were really split up by the mid-line writes
+	size_t x;
+	for (x = 1; x < GB_VIDEO_HORIZONTAL_PIXELS; ++x) {
+		if (eagerBuffer[x] != eagerBuffer[0]) {
+			break;
+		}
+	}
+	assert_true(x < GB_VIDEO_HORIZONTAL_PIXELS);
+
+	mCoreConfigDeinit(&eager->config);
+	eager->deinit(eager);
+	mCoreConfigDeinit(&batch->config);
+	batch->deinit(batch);
+	free(eagerBuffer);
+	free(batchBuffer);
+}
+
+static struct mCore* _renderFrames(bool threaded, struct mProfile* profile, color_t* buffer) {
+	struct VFile* vf = VFileMemChunk(NULL, 2048);
+	GBSynthesizeROM(vf);
+	struct mCore* core = GBCoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	mCoreInitConfig(core, NULL);
+	mCoreConfigSetIntValue(&core->config, "threadedVideo", threaded);
+	mCoreLoadConfig(core);
+	core->setVideoBuffer(core, buffer, GB_VIDEO_HORIZONTAL_PIXELS);
+	assert_true(core->loadROM(core, vf));
+	core->reset(core);
+	mProfileInit(profile);
+	core->setProfile(core, profile);
+
+	// Stripe the background so the frame has something in it
+	int i;
+	for (i = 0; i < 16; ++i) {
+		core->busWrite8(core, 0x8000 + i, i & 1 ? 0x0F : 0xF0);
+	}
+	core->busWrite8(core, GB_BASE_IO | REG_BGP, 0xE4);
+	core->busWrite8(core, GB_BASE_IO | REG_LCDC, 0x91);
+	for (i = 0; i < 3; ++i) {
+		core->runFrame(core);
+	}
+	return core;
+}
+
+M_TEST_DEFINE(threadedVideo) {
+	size_t size = GB_VIDEO_HORIZONTAL_PIXELS * GB_VIDEO_VERTICAL_PIXELS;
+	color_t* eagerBuffer = calloc(size, BYTES_PER_PIXEL);
+	color_t* threadedBuffer = calloc(size, BYTES_PER_PIXEL);
+	struct mProfile eagerProfile;
+	struct mProfile threadedProfile;
+	struct mCore* eager = _renderFrames(false, &eagerProfile, eagerBuffer);
+	struct mCore* threaded = _renderFrames(true, &threadedProfile, threadedBuffer);
+
+	// Only the proxy queues packets, so this shows the render thread really drew the frame
+	assert_int_equal(eagerProfile.proxyPackets, 0);
+	assert_true(threadedProfile.proxyPackets > 0);
+	assert_true(eagerBuffer[0] != eagerBuffer[4]);
+	assert_memory_equal(eagerBuffer, threadedBuffer, size * BYTES_PER_PIXEL);
+
+	mCoreConfigDeinit(&eager->config);
+	eager->deinit(eager);
+	mCoreConfigDeinit(&threaded->config);
+	threaded->deinit(threaded);
+	free(eagerBuffer);
+	free(threadedBuffer);
+}
+
 M_TEST_SUITE_DEFINE(GBCore,
 	cmocka_unit_test(create),
 	cmocka_unit_test(platform),
 	cmocka_unit_test(reset),
 	cmocka_unit_test(loadNullROM),
-	cmocka_unit_test(isROM))
+	cmocka_unit_test(isROM),
+	cmocka_unit_test(profile),
+	cmocka_unit_test(batchScanlines),
+	cmocka_unit_test(threadedVideo))
@@ -32,6 +32,7 @@ static void _GBTimerDivIncrement(struct GBTimer* timer, uint32_t cyclesLate) {
 		}
 		unsigned timingFactor = 0x3FF >> !timer->p->doubleSpeed;
 		if ((timer->internalDiv & timingFactor) == timingFactor) {
+			GBAudioRun(&timer->p->audio, mTimingCurrentTime(&timer->p->timing) - cyclesLate);
 			GBAudioUpdateFrame(&timer->p->audio, &timer->p->timing);
 		}
 		++timer->internalDiv;
@@ -82,6 +83,7 @@ void GBTimerDivReset(struct GBTimer* timer) {
 	}
 	unsigned timingFactor = 0x400 >> !timer->p->doubleSpeed;
 	if (timer->internalDiv & timingFactor) {
+		GBAudioRun(&timer->p->audio, mTimingCurrentTime(&timer->p->timing));
 		GBAudioUpdateFrame(&timer->p->audio, &timer->p->timing);
 	}
 	timer->p->memory.io[REG_DIV] = 0;
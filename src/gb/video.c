@@ -808,8 +808,17 @@ void GBVideoSerialize(const struct GBVideo* video, struct GBSerializedState* sta
 		STORE_16LE(video->palette[i], i * 2, state->video.palette);
 	}
 
-	STORE_32LE(video->modeEvent.when - mTimingCurrentTime(&video->p->timing), 0, &state->video.nextMode);
-	STORE_32LE(video->frameEvent.when - mTimingCurrentTime(&video->p->timing), 0, &state->video.nextFrame);
+	// Unscheduled events keep a stale timestamp, which would otherwise leak into the state
+	if (mTimingIsScheduled(&video->p->timing, &video->modeEvent)) {
+		STORE_32LE(video->modeEvent.when - mTimingCurrentTime(&video->p->timing), 0, &state->video.nextMode);
+	} else {
+		STORE_32LE(0, 0, &state->video.nextMode);
+	}
+	if (mTimingIsScheduled(&video->p->timing, &video->frameEvent)) {
+		STORE_32LE(video->frameEvent.when - mTimingCurrentTime(&video->p->timing), 0, &state->video.nextFrame);
+	} else {
+		STORE_32LE(0, 0, &state->video.nextFrame);
+	}
 
 	memcpy(state->vram, video->vram, GB_SIZE_VRAM);
 	memcpy(state->oam, &video->oam.raw, GB_SIZE_OAM);
@@ -862,8 +871,8 @@ void GBVideoDeserialize(struct GBVideo* video, const struct GBSerializedState* s
 		video->renderer->writePalette(video->renderer, i, video->palette[i]);
 	}
 
-	memcpy(video->vram, state->vram, GB_SIZE_VRAM);
-	memcpy(&video->oam.raw, state->oam, GB_SIZE_OAM);
+	DirtyBitmapCopy(&video->p->memory.dirtyVram, video->vram, state->vram, GB_SIZE_VRAM);
+	DirtyBitmapCopy(&video->p->memory.dirtyOam, &video->oam.raw, state->oam, GB_SIZE_OAM);
 
 	_cleanOAM(video, video->ly);
 	GBVideoSwitchBank(video, video->vramCurrentBank);
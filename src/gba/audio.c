@@ -57,7 +57,9 @@ void GBAAudioInit(struct GBAAudio* audio, size_t samples) {
 void GBAAudioReset(struct GBAAudio* audio) {
 	GBAudioReset(&audio->psg);
 	mTimingDeschedule(&audio->p->timing, &audio->sampleEvent);
-	mTimingSchedule(&audio->p->timing, &audio->sampleEvent, 0);
+	if (!audio->psg.suspendSynthesis) {
+		mTimingSchedule(&audio->p->timing, &audio->sampleEvent, 0);
+	}
 	audio->chA.dmaSource = 1;
 	audio->chB.dmaSource = 2;
 	audio->chA.sample = 0;
@@ -90,6 +92,18 @@ void GBAAudioDeinit(struct GBAAudio* audio) {
 	CircleBufferDeinit(&audio->chB.fifo);
 }
 
+void GBAAudioSuspendSynthesis(struct GBAAudio* audio, bool suspend) {
+	if (audio->psg.suspendSynthesis == suspend) {
+		return;
+	}
+	GBAudioSuspendSynthesis(&audio->psg, suspend);
+	// FIFO consumption and DMA requests are driven by the timers, so they carry on regardless
+	mTimingDeschedule(&audio->p->timing, &audio->sampleEvent);
+	if (!suspend) {
+		mTimingSchedule(&audio->p->timing, &audio->sampleEvent, 0);
+	}
+}
+
 void GBAAudioResizeBuffer(struct GBAAudio* audio, size_t samples) {
 	mCoreSyncLockAudio(audio->p->sync);
 	audio->samples = samples;
@@ -140,6 +154,7 @@ void GBAAudioWriteSOUND2CNT_HI(struct GBAAudio* audio, uint16_t value) {
 }
 
 void GBAAudioWriteSOUND3CNT_LO(struct GBAAudio* audio, uint16_t value) {
+	GBAudioRun(&audio->psg, mTimingCurrentTime(&audio->p->timing));
 	audio->psg.ch3.size = GBAudioRegisterBankGetSize(value);
 	audio->psg.ch3.bank = GBAudioRegisterBankGetBank(value);
 	GBAudioWriteNR30(&audio->psg, value);
@@ -198,6 +213,7 @@ void GBAAudioWriteSOUNDBIAS(struct GBAAudio* audio, uint16_t value) {
 }
 
 void GBAAudioWriteWaveRAM(struct GBAAudio* audio, int address, uint32_t value) {
+	GBAudioRun(&audio->psg, mTimingCurrentTime(&audio->p->timing));
 	audio->psg.ch3.wavedata32[address | (!audio->psg.ch3.bank * 4)] = value;
 }
 
@@ -261,6 +277,7 @@ static void _sample(struct mTiming* timing, void* user, uint32_t cyclesLate) {
 	int16_t sampleLeft = 0;
 	int16_t sampleRight = 0;
 	int psgShift = 4 - audio->volume;
+	GBAudioRun(&audio->psg, mTimingCurrentTime(timing) - cyclesLate);
 	GBAudioSamplePSG(&audio->psg, &sampleLeft, &sampleRight);
 	sampleLeft >>= psgShift;
 	sampleRight >>= psgShift;
@@ -326,7 +343,11 @@ void GBAAudioSerialize(const struct GBAAudio* audio, struct GBASerializedState*
 	CircleBufferDump(&audio->chB.fifo, state->audio.fifoB, sizeof(state->audio.fifoB));
 	uint32_t fifoSize = CircleBufferSize(&audio->chA.fifo);
 	STORE_32(fifoSize, 0, &state->audio.fifoSize);
-	STORE_32(audio->sampleEvent.when - mTimingCurrentTime(&audio->p->timing), 0, &state->audio.nextSample);
+	if (audio->psg.suspendSynthesis) {
+		STORE_32(0, 0, &state->audio.nextSample);
+	} else {
+		STORE_32(audio->sampleEvent.when - mTimingCurrentTime(&audio->p->timing), 0, &state->audio.nextSample);
+	}
 }
 
 void GBAAudioDeserialize(struct GBAAudio* audio, const struct GBASerializedState* state) {
@@ -347,7 +368,9 @@ void GBAAudioDeserialize(struct GBAAudio* audio, const struct GBASerializedState
 
 	uint32_t when;
 	LOAD_32(when, 0, &state->audio.nextSample);
-	mTimingSchedule(&audio->p->timing, &audio->sampleEvent, when);
+	if (!audio->psg.suspendSynthesis) {
+		mTimingSchedule(&audio->p->timing, &audio->sampleEvent, when);
+	}
 }
 
 float GBAAudioCalculateRatio(float inputSampleRate, float desiredFPS, float desiredSampleRate) {
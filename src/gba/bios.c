@@ -37,6 +37,7 @@ static void _SoftReset(struct GBA* gba) {
 	cpu->gprs[ARM_SP] = SP_BASE_SYSTEM;
 	int8_t flag = ((int8_t*) gba->memory.iwram)[0x7FFA];
 	memset(((int8_t*) gba->memory.iwram) + SIZE_WORKING_IRAM - 0x200, 0, 0x200);
+	DirtyBitmapMarkRange(&gba->memory.dirtyIwram, SIZE_WORKING_IRAM - 0x200, 0x200);
 	if (flag) {
 		cpu->gprs[ARM_PC] = BASE_WORKING_RAM;
 	} else {
@@ -52,18 +53,23 @@ static void _RegisterRamReset(struct GBA* gba) {
 	cpu->memory.store16(cpu, BASE_IO | REG_DISPCNT, 0x0080, 0);
 	if (registers & 0x01) {
 		memset(gba->memory.wram, 0, SIZE_WORKING_RAM);
+		DirtyBitmapFill(&gba->memory.dirtyWram);
 	}
 	if (registers & 0x02) {
 		memset(gba->memory.iwram, 0, SIZE_WORKING_IRAM - 0x200);
+		DirtyBitmapMarkRange(&gba->memory.dirtyIwram, 0, SIZE_WORKING_IRAM - 0x200);
 	}
 	if (registers & 0x04) {
 		memset(gba->video.palette, 0, SIZE_PALETTE_RAM);
+		DirtyBitmapFill(&gba->memory.dirtyPalette);
 	}
 	if (registers & 0x08) {
 		memset(gba->video.vram, 0, SIZE_VRAM);
+		DirtyBitmapFill(&gba->memory.dirtyVram);
 	}
 	if (registers & 0x10) {
 		memset(gba->video.oam.raw, 0, SIZE_OAM);
+		DirtyBitmapFill(&gba->memory.dirtyOam);
 	}
 	if (registers & 0x20) {
 		cpu->memory.store16(cpu, BASE_IO | REG_SIOCNT, 0x0000, 0);
@@ -7,6 +7,7 @@
 
 #include <mgba/core/core.h>
 #include <mgba/core/log.h>
+#include <mgba/core/profile.h>
 #include <mgba/internal/arm/debugger/debugger.h>
 #include <mgba/internal/debugger/symbols.h>
 #include <mgba/internal/gba/cheats.h>
@@ -48,8 +49,8 @@ static const struct mCoreChannelInfo _GBAAudioChannels[] = {
 static const struct mCoreMemoryBlock _GBAMemoryBlocks[] = {
 	{ -1, "mem", "All", "All", 0, 0x10000000, 0x10000000, mCORE_MEMORY_VIRTUAL },
 	{ REGION_BIOS, "bios", "BIOS", "BIOS (16kiB)", BASE_BIOS, SIZE_BIOS, SIZE_BIOS, mCORE_MEMORY_READ | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
+	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
+	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
 	{ REGION_IO, "io", "MMIO", "Memory-Mapped I/O", BASE_IO, BASE_IO + SIZE_IO, SIZE_IO, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_PALETTE_RAM, "palette", "Palette", "Palette RAM (1kiB)", BASE_PALETTE_RAM, BASE_PALETTE_RAM + SIZE_PALETTE_RAM, SIZE_PALETTE_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_VRAM, "vram", "VRAM", "Video RAM (96kiB)", BASE_VRAM, BASE_VRAM + SIZE_VRAM, SIZE_VRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
@@ -62,8 +63,8 @@ static const struct mCoreMemoryBlock _GBAMemoryBlocks[] = {
 static const struct mCoreMemoryBlock _GBAMemoryBlocksSRAM[] = {
 	{ -1, "mem", "All", "All", 0, 0x10000000, 0x10000000, mCORE_MEMORY_VIRTUAL },
 	{ REGION_BIOS, "bios", "BIOS", "BIOS (16kiB)", BASE_BIOS, SIZE_BIOS, SIZE_BIOS, mCORE_MEMORY_READ | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
+	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
+	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
 	{ REGION_IO, "io", "MMIO", "Memory-Mapped I/O", BASE_IO, BASE_IO + SIZE_IO, SIZE_IO, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_PALETTE_RAM, "palette", "Palette", "Palette RAM (1kiB)", BASE_PALETTE_RAM, BASE_PALETTE_RAM + SIZE_PALETTE_RAM, SIZE_PALETTE_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_VRAM, "vram", "VRAM", "Video RAM (96kiB)", BASE_VRAM, BASE_VRAM + SIZE_VRAM, SIZE_VRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
@@ -77,8 +78,8 @@ static const struct mCoreMemoryBlock _GBAMemoryBlocksSRAM[] = {
 static const struct mCoreMemoryBlock _GBAMemoryBlocksFlash512[] = {
 	{ -1, "mem", "All", "All", 0, 0x10000000, 0x10000000, mCORE_MEMORY_VIRTUAL },
 	{ REGION_BIOS, "bios", "BIOS", "BIOS (16kiB)", BASE_BIOS, SIZE_BIOS, SIZE_BIOS, mCORE_MEMORY_READ | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
+	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
+	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
 	{ REGION_IO, "io", "MMIO", "Memory-Mapped I/O", BASE_IO, BASE_IO + SIZE_IO, SIZE_IO, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_PALETTE_RAM, "palette", "Palette", "Palette RAM (1kiB)", BASE_PALETTE_RAM, BASE_PALETTE_RAM + SIZE_PALETTE_RAM, SIZE_PALETTE_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_VRAM, "vram", "VRAM", "Video RAM (96kiB)", BASE_VRAM, BASE_VRAM + SIZE_VRAM, SIZE_VRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
@@ -92,8 +93,8 @@ static const struct mCoreMemoryBlock _GBAMemoryBlocksFlash512[] = {
 static const struct mCoreMemoryBlock _GBAMemoryBlocksFlash1M[] = {
 	{ -1, "mem", "All", "All", 0, 0x10000000, 0x10000000, mCORE_MEMORY_VIRTUAL },
 	{ REGION_BIOS, "bios", "BIOS", "BIOS (16kiB)", BASE_BIOS, SIZE_BIOS, SIZE_BIOS, mCORE_MEMORY_READ | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
+	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
+	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
 	{ REGION_IO, "io", "MMIO", "Memory-Mapped I/O", BASE_IO, BASE_IO + SIZE_IO, SIZE_IO, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_PALETTE_RAM, "palette", "Palette", "Palette RAM (1kiB)", BASE_PALETTE_RAM, BASE_PALETTE_RAM + SIZE_PALETTE_RAM, SIZE_PALETTE_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_VRAM, "vram", "VRAM", "Video RAM (96kiB)", BASE_VRAM, BASE_VRAM + SIZE_VRAM, SIZE_VRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
@@ -107,8 +108,8 @@ static const struct mCoreMemoryBlock _GBAMemoryBlocksFlash1M[] = {
 static const struct mCoreMemoryBlock _GBAMemoryBlocksEEPROM[] = {
 	{ -1, "mem", "All", "All", 0, 0x10000000, 0x10000000, mCORE_MEMORY_VIRTUAL },
 	{ REGION_BIOS, "bios", "BIOS", "BIOS (16kiB)", BASE_BIOS, SIZE_BIOS, SIZE_BIOS, mCORE_MEMORY_READ | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
-	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
+	{ REGION_WORKING_RAM, "wram", "EWRAM", "Working RAM (256kiB)", BASE_WORKING_RAM, BASE_WORKING_RAM + SIZE_WORKING_RAM, SIZE_WORKING_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
+	{ REGION_WORKING_IRAM, "iwram", "IWRAM", "Internal Working RAM (32kiB)", BASE_WORKING_IRAM, BASE_WORKING_IRAM + SIZE_WORKING_IRAM, SIZE_WORKING_IRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED | mCORE_MEMORY_DIRECT },
 	{ REGION_IO, "io", "MMIO", "Memory-Mapped I/O", BASE_IO, BASE_IO + SIZE_IO, SIZE_IO, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_PALETTE_RAM, "palette", "Palette", "Palette RAM (1kiB)", BASE_PALETTE_RAM, BASE_PALETTE_RAM + SIZE_PALETTE_RAM, SIZE_PALETTE_RAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
 	{ REGION_VRAM, "vram", "VRAM", "Video RAM (96kiB)", BASE_VRAM, BASE_VRAM + SIZE_VRAM, SIZE_VRAM, mCORE_MEMORY_RW | mCORE_MEMORY_MAPPED },
@@ -134,6 +135,9 @@ struct GBACore {
 	const struct Configuration* overrides;
 	struct mDebuggerPlatform* debuggerPlatform;
 	struct mCheatDevice* cheatDevice;
+	bool audioDisabled;
+	bool videoSuppressed;
+	bool audioSuppressed;
 };
 
 static bool _GBACoreInit(struct mCore* core) {
@@ -155,6 +159,9 @@ static bool _GBACoreInit(struct mCore* core) {
 	gbacore->debuggerPlatform = NULL;
 	gbacore->cheatDevice = NULL;
 	gbacore->logContext = NULL;
+	gbacore->audioDisabled = false;
+	gbacore->videoSuppressed = false;
+	gbacore->audioSuppressed = false;
 
 	GBACreate(gba);
 	// TODO: Restore cheats
@@ -177,6 +184,7 @@ static bool _GBACoreInit(struct mCore* core) {
 
 #if !defined(MINIMAL_CORE) || MINIMAL_CORE < 2
 	mDirectorySetInit(&core->dirs);
+	core->stateSlots = NULL;
 #endif
 	
 	return true;
@@ -212,6 +220,7 @@ static void _GBACoreSetSync(struct mCore* core, struct mCoreSync* sync) {
 }
 
 static void _GBACoreLoadConfig(struct mCore* core, const struct mCoreConfig* config) {
+	struct GBACore* gbacore = (struct GBACore*) core;
 	struct GBA* gba = core->board;
 	if (core->opts.mute) {
 		gba->audio.masterVolume = 0;
@@ -221,7 +230,6 @@ static void _GBACoreLoadConfig(struct mCore* core, const struct mCoreConfig* con
 	gba->video.frameskip = core->opts.frameskip;
 
 #if !defined(MINIMAL_CORE) || MINIMAL_CORE < 2
-	struct GBACore* gbacore = (struct GBACore*) core;
 	gbacore->overrides = mCoreConfigGetOverridesConst(config);
 #endif
 
@@ -244,6 +252,18 @@ static void _GBACoreLoadConfig(struct mCore* core, const struct mCoreConfig* con
 	mCoreConfigGetIntValue(config, "allowOpposingDirections", &fakeBool);
 	gba->allowOpposingDirections = fakeBool;
 
+	if (mCoreConfigGetIntValue(config, "lazyAudio", &fakeBool)) {
+		GBAudioSetLazyChannels(&gba->audio.psg, fakeBool);
+	}
+	if (mCoreConfigGetIntValue(config, "lazyVideo", &fakeBool)) {
+		GBAVideoSetLazyTiming(&gba->video, fakeBool);
+	}
+
+	if (mCoreConfigGetIntValue(config, "disableAudio", &fakeBool)) {
+		gbacore->audioDisabled = fakeBool;
+		GBAAudioSuspendSynthesis(&gba->audio, gbacore->audioDisabled || gbacore->audioSuppressed);
+	}
+
 	mCoreConfigCopyValue(&core->config, config, "allowOpposingDirections");
 	mCoreConfigCopyValue(&core->config, config, "gba.bios");
 
@@ -315,6 +335,42 @@ static void _GBACoreSetAVStream(struct mCore* core, struct mAVStream* stream) {
 	}
 }
 
+static void _GBACoreEnableOutput(struct mCore* core, bool video, bool audio) {
+	struct GBACore* gbacore = (struct GBACore*) core;
+	struct GBA* gba = core->board;
+	// Holding the frameskip counter up skips rendering without touching anything the game can see
+	if (!video) {
+		gba->video.frameskipCounter = INT_MAX;
+	} else if (gbacore->videoSuppressed) {
+		gba->video.frameskipCounter = 0;
+	}
+	gbacore->videoSuppressed = !video;
+	GBAVideoReschedule(&gba->video);
+	gbacore->audioSuppressed = !audio;
+	GBAAudioSuspendSynthesis(&gba->audio, gbacore->audioDisabled || gbacore->audioSuppressed);
+}
+
+static void _GBACoreSetProfile(struct mCore* core, struct mProfile* profile) {
+	struct GBACore* gbacore = (struct GBACore*) core;
+	struct GBA* gba = core->board;
+	if (profile) {
+		profile->instructions[MODE_ARM].name = "ARM";
+		profile->instructions[MODE_THUMB].name = "Thumb";
+		profile->nModes = 2;
+		profile->dma[0].name = "DMA0";
+		profile->dma[1].name = "DMA1";
+		profile->dma[2].name = "DMA2";
+		profile->dma[3].name = "DMA3";
+		profile->nDMAs = 4;
+	}
+	gba->timing.profile = profile;
+	gba->cpu->profile = profile;
+	gbacore->renderer.profile = profile;
+#ifndef DISABLE_THREADING
+	gbacore->threadProxy.d.profile = profile;
+#endif
+}
+
 static bool _GBACoreLoadROM(struct mCore* core, struct VFile* vf) {
 #ifdef USE_ELF
 	struct ELF* elf = ELFOpen(vf);
@@ -481,6 +537,10 @@ static bool _GBACoreSaveState(struct mCore* core, void* state) {
 	return true;
 }
 
+static void _GBACoreHashState(struct mCore* core, struct Hash128* hash) {
+	GBAHashState(core->board, hash);
+}
+
 static void _GBACoreSetKeys(struct mCore* core, uint32_t keys) {
 	struct GBACore* gbacore = (struct GBACore*) core;
 	gbacore->keys = keys;
@@ -498,6 +558,11 @@ static void _GBACoreClearKeys(struct mCore* core, uint32_t keys) {
 	gbacore->keys &= ~keys;
 }
 
+static uint32_t _GBACoreGetKeys(struct mCore* core) {
+	struct GBACore* gbacore = (struct GBACore*) core;
+	return gbacore->keys;
+}
+
 static int32_t _GBACoreFrameCounter(const struct mCore* core) {
 	const struct GBA* gba = core->board;
 	return gba->video.frameCounter;
@@ -666,6 +731,60 @@ void* _GBAGetMemoryBlock(struct mCore* core, size_t id, size_t* sizeOut) {
 	}
 }
 
+static void _GBACoreSetDirtyTracking(struct mCore* core, bool enable) {
+	GBAMemorySetDirtyTracking(core->board, enable);
+}
+
+static struct DirtyBitmap* _GBACoreGetDirtyPages(struct mCore* core, size_t id) {
+	struct GBA* gba = core->board;
+	struct DirtyBitmap* pages;
+	switch (id) {
+	default:
+		return NULL;
+	case REGION_WORKING_RAM:
+		pages = &gba->memory.dirtyWram;
+		break;
+	case REGION_WORKING_IRAM:
+		pages = &gba->memory.dirtyIwram;
+		break;
+	case REGION_PALETTE_RAM:
+		pages = &gba->memory.dirtyPalette;
+		break;
+	case REGION_VRAM:
+		pages = &gba->memory.dirtyVram;
+		break;
+	case REGION_OAM:
+		pages = &gba->memory.dirtyOam;
+		break;
+	case REGION_CART_SRAM:
+	case REGION_CART_SRAM_MIRROR:
+		pages = &gba->memory.savedata.dirtyPages;
+		break;
+	}
+	if (!pages->bits) {
+		return NULL;
+	}
+	return pages;
+}
+
+static void _GBACoreClearDirtyPages(struct mCore* core) {
+	GBAMemoryClearDirty(core->board);
+}
+
+static bool _GBACoreStateDirtyPages(struct mCore* core, struct DirtyBitmap* pages) {
+	struct GBA* gba = core->board;
+	if (!gba->memory.dirtyWram.bits) {
+		return false;
+	}
+	DirtyBitmapFill(pages);
+	DirtyBitmapProject(pages, offsetof(struct GBASerializedState, pram), &gba->memory.dirtyPalette, SIZE_PALETTE_RAM);
+	DirtyBitmapProject(pages, offsetof(struct GBASerializedState, oam), &gba->memory.dirtyOam, SIZE_OAM);
+	DirtyBitmapProject(pages, offsetof(struct GBASerializedState, vram), &gba->memory.dirtyVram, SIZE_VRAM);
+	DirtyBitmapProject(pages, offsetof(struct GBASerializedState, iwram), &gba->memory.dirtyIwram, SIZE_WORKING_IRAM);
+	DirtyBitmapProject(pages, offsetof(struct GBASerializedState, wram), &gba->memory.dirtyWram, SIZE_WORKING_RAM);
+	return true;
+}
+
 #ifdef USE_DEBUGGERS
 static bool _GBACoreSupportsDebuggerType(struct mCore* core, enum mDebuggerType type) {
 	UNUSED(core);
@@ -932,6 +1051,8 @@ struct mCore* GBACoreCreate(void) {
 	core->addCoreCallbacks = _GBACoreAddCoreCallbacks;
 	core->clearCoreCallbacks = _GBACoreClearCoreCallbacks;
 	core->setAVStream = _GBACoreSetAVStream;
+	core->enableOutput = _GBACoreEnableOutput;
+	core->setProfile = _GBACoreSetProfile;
 	core->isROM = GBAIsROM;
 	core->loadROM = _GBACoreLoadROM;
 	core->loadBIOS = _GBACoreLoadBIOS;
@@ -947,9 +1068,11 @@ struct mCore* GBACoreCreate(void) {
 	core->stateSize = _GBACoreStateSize;
 	core->loadState = _GBACoreLoadState;
 	core->saveState = _GBACoreSaveState;
+	core->hashState = _GBACoreHashState;
 	core->setKeys = _GBACoreSetKeys;
 	core->addKeys = _GBACoreAddKeys;
 	core->clearKeys = _GBACoreClearKeys;
+	core->getKeys = _GBACoreGetKeys;
 	core->frameCounter = _GBACoreFrameCounter;
 	core->frameCycles = _GBACoreFrameCycles;
 	core->frequency = _GBACoreFrequency;
@@ -970,6 +1093,10 @@ struct mCore* GBACoreCreate(void) {
 	core->rawWrite32 = _GBACoreRawWrite32;
 	core->listMemoryBlocks = _GBAListMemoryBlocks;
 	core->getMemoryBlock = _GBAGetMemoryBlock;
+	core->setDirtyTracking = _GBACoreSetDirtyTracking;
+	core->getDirtyPages = _GBACoreGetDirtyPages;
+	core->clearDirtyPages = _GBACoreClearDirtyPages;
+	core->stateDirtyPages = _GBACoreStateDirtyPages;
 #ifdef USE_DEBUGGERS
 	core->supportsDebuggerType = _GBACoreSupportsDebuggerType;
 	core->debuggerPlatform = _GBACoreDebuggerPlatform;
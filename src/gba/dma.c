@@ -5,6 +5,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <mgba/internal/gba/dma.h>
 
+#include <mgba/core/profile.h>
 #include <mgba/internal/gba/gba.h>
 #include <mgba/internal/gba/io.h>
 
@@ -97,6 +98,9 @@ uint16_t GBADMAWriteCNT_HI(struct GBA* gba, int dma, uint16_t control) {
 		}
 
 		GBADMASchedule(gba, dma, currentDma);
+		if (GBADMARegisterGetTiming(currentDma->reg) == GBA_DMA_TIMING_HBLANK || (dma == 3 && GBADMARegisterGetTiming(currentDma->reg) == GBA_DMA_TIMING_CUSTOM)) {
+			GBAVideoReschedule(&gba->video);
+		}
 	}
 	// If the DMA has already occurred, this value might have changed since the function started
 	return currentDma->reg;
@@ -296,6 +300,9 @@ void GBADMAService(struct GBA* gba, int number, struct GBADMA* info) {
 	dest += destOffset;
 	--wordsRemaining;
 	gba->performingDMA = 0;
+	if (gba->timing.profile) {
+		++gba->timing.profile->dma[number].count;
+	}
 
 	info->nextCount = wordsRemaining;
 	info->nextSource = source;
@@ -5,6 +5,8 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <mgba/internal/gba/gba.h>
 
+#include <mgba/core/rom-cache.h>
+
 #include <mgba/internal/arm/isa-inlines.h>
 #include <mgba/internal/arm/debugger/debugger.h>
 #include <mgba/internal/arm/decoder.h>
@@ -98,6 +100,7 @@ static void GBAInit(void* cpu, struct mCPUComponent* component) {
 	gba->rr = 0;
 
 	gba->romVf = 0;
+	gba->romCache = NULL;
 	gba->biosVf = 0;
 
 	gba->stream = NULL;
@@ -127,7 +130,11 @@ static void GBAInit(void* cpu, struct mCPUComponent* component) {
 }
 
 void GBAUnloadROM(struct GBA* gba) {
-	if (gba->memory.rom && !gba->isPristine) {
+	if (gba->romCache) {
+		mROMCacheUnmap(gba->romCache, gba->memory.rom, SIZE_CART0);
+		gba->romCache = NULL;
+		gba->yankedRomSize = 0;
+	} else if (gba->memory.rom && !gba->isPristine) {
 		if (gba->yankedRomSize) {
 			gba->yankedRomSize = 0;
 		}
@@ -229,6 +236,7 @@ void GBAReset(struct ARMCore* cpu) {
 		gba->romVf->seek(gba->romVf, 0, SEEK_SET);
 		gba->romVf->read(gba->romVf, gba->memory.wram, gba->pristineRomSize);
 	}
+	GBAMemoryMarkAllDirty(gba);
 
 	gba->lastJump = 0;
 	gba->haltPending = false;
@@ -403,14 +411,28 @@ bool GBALoadROM(struct GBA* gba, struct VFile* vf) {
 	gba->memory.romMask = toPow2(gba->memory.romSize) - 1;
 	gba->memory.mirroring = false;
 	gba->romCrc32 = doCrc32(gba->memory.rom, gba->memory.romSize);
+#ifndef FIXED_ROM_BUFFER
+	if (gba->isPristine) {
+		// Instances running the same ROM share one copy of it instead of each mapping their own
+		void* rom = mROMCacheMap(gba->memory.rom, gba->pristineRomSize, gba->romCrc32, SIZE_CART0, &gba->romCache);
+		if (rom) {
+			vf->unmap(vf, gba->memory.rom, gba->pristineRomSize);
+			vf->close(vf);
+			gba->romVf = VFileFromConstMemory(rom, gba->pristineRomSize);
+			gba->memory.rom = rom;
+		}
+	}
+#endif
 	GBAHardwareInit(&gba->memory.hw, &((uint16_t*) gba->memory.rom)[GPIO_REG_DATA >> 1]);
 	GBAVFameDetect(&gba->memory.vfame, gba->memory.rom, gba->memory.romSize);
 	if (popcount32(gba->memory.romSize) != 1) {
 		// This ROM is either a bad dump or homebrew. Emulate flash cart behavior.
 #ifndef FIXED_ROM_BUFFER
-		void* newRom = anonymousMemoryMap(SIZE_CART0);
-		memcpy(newRom, gba->memory.rom, gba->pristineRomSize);
-		gba->memory.rom = newRom;
+		if (!gba->romCache) {
+			void* newRom = anonymousMemoryMap(SIZE_CART0);
+			memcpy(newRom, gba->memory.rom, gba->pristineRomSize);
+			gba->memory.rom = newRom;
+		}
 #endif
 		gba->memory.romSize = SIZE_CART0;
 		gba->memory.romMask = SIZE_CART0 - 1;
@@ -477,6 +499,10 @@ void GBAApplyPatch(struct GBA* gba, struct Patch* patch) {
 		gba->romVf->close(gba->romVf);
 		gba->romVf = NULL;
 	}
+	if (gba->romCache) {
+		mROMCacheUnmap(gba->romCache, gba->memory.rom, SIZE_CART0);
+		gba->romCache = NULL;
+	}
 	gba->isPristine = false;
 	gba->memory.rom = newRom;
 	gba->memory.hw.gpioBase = &((uint16_t*) gba->memory.rom)[GPIO_REG_DATA >> 1];
@@ -796,7 +822,7 @@ void GBAFrameEnded(struct GBA* gba) {
 	GBASavedataClean(&gba->memory.savedata, gba->video.frameCounter);
 
 	if (gba->rr) {
-		gba->rr->nextFrame(gba->rr);
+		gba->rr->frameEnded(gba->rr, gba);
 	}
 
 	if (gba->cpu->components && gba->cpu->components[CPU_COMPONENT_CHEAT_DEVICE]) {
@@ -710,6 +710,11 @@ uint16_t GBAIORead(struct GBA* gba, uint32_t address) {
 	}
 
 	switch (address) {
+	case REG_DISPSTAT:
+	case REG_VCOUNT:
+		GBAVideoRun(&gba->video, mTimingCurrentTime(&gba->timing));
+		break;
+
 	// Reading this takes two cycles (1N+1I), so let's remove them preemptively
 	case REG_TM0CNT_LO:
 		GBATimerUpdateRegister(gba, 0, 4);
@@ -847,8 +852,6 @@ uint16_t GBAIORead(struct GBA* gba, uint32_t address) {
 		}
 		// Fall through
 	case REG_DISPCNT:
-	case REG_DISPSTAT:
-	case REG_VCOUNT:
 	case REG_BG0CNT:
 	case REG_BG1CNT:
 	case REG_BG2CNT:
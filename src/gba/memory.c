@@ -22,6 +22,7 @@
 mLOG_DEFINE_CATEGORY(GBA_MEM, "GBA Memory", "gba.memory");
 
 static void _pristineCow(struct GBA* gba);
+static void _extendRom(struct GBA* gba, uint32_t size);
 static void _agbPrintStore(struct GBA* gba, uint32_t address, int16_t value);
 static int16_t  _agbPrintLoad(struct GBA* gba, uint32_t address);
 static uint8_t _deadbeef[4] = { 0x10, 0xB7, 0x10, 0xE7 }; // Illegal instruction on both ARM and Thumb
@@ -95,6 +96,7 @@ void GBAMemoryInit(struct GBA* gba) {
 }
 
 void GBAMemoryDeinit(struct GBA* gba) {
+	GBAMemorySetDirtyTracking(gba, false);
 	mappedMemoryFree(gba->memory.wram, SIZE_WORKING_RAM + SIZE_WORKING_IRAM);
 	if (gba->memory.rom) {
 		mappedMemoryFree(gba->memory.rom, gba->memory.romSize);
@@ -134,6 +136,51 @@ void GBAMemoryReset(struct GBA* gba) {
 	memset(&gba->memory.matrix, 0, sizeof(gba->memory.matrix));
 }
 
+void GBAMemorySetDirtyTracking(struct GBA* gba, bool enable) {
+	struct GBAMemory* memory = &gba->memory;
+	if (enable == !!memory->dirtyWram.bits) {
+		return;
+	}
+	if (!enable) {
+		DirtyBitmapDeinit(&memory->dirtyWram);
+		DirtyBitmapDeinit(&memory->dirtyIwram);
+		DirtyBitmapDeinit(&memory->dirtyPalette);
+		DirtyBitmapDeinit(&memory->dirtyVram);
+		DirtyBitmapDeinit(&memory->dirtyOam);
+		DirtyBitmapDeinit(&memory->savedata.dirtyPages);
+		return;
+	}
+	DirtyBitmapInit(&memory->dirtyWram, SIZE_WORKING_RAM);
+	DirtyBitmapInit(&memory->dirtyIwram, SIZE_WORKING_IRAM);
+	DirtyBitmapInit(&memory->dirtyPalette, SIZE_PALETTE_RAM);
+	DirtyBitmapInit(&memory->dirtyVram, SIZE_VRAM);
+	DirtyBitmapInit(&memory->dirtyOam, SIZE_OAM);
+	// Sized for the largest save type so that changing types never reallocates
+	DirtyBitmapInit(&memory->savedata.dirtyPages, SIZE_CART_FLASH1M);
+	// Nothing is known about writes that happened before tracking began
+	GBAMemoryMarkAllDirty(gba);
+}
+
+void GBAMemoryMarkAllDirty(struct GBA* gba) {
+	struct GBAMemory* memory = &gba->memory;
+	DirtyBitmapFill(&memory->dirtyWram);
+	DirtyBitmapFill(&memory->dirtyIwram);
+	DirtyBitmapFill(&memory->dirtyPalette);
+	DirtyBitmapFill(&memory->dirtyVram);
+	DirtyBitmapFill(&memory->dirtyOam);
+	DirtyBitmapFill(&memory->savedata.dirtyPages);
+}
+
+void GBAMemoryClearDirty(struct GBA* gba) {
+	struct GBAMemory* memory = &gba->memory;
+	DirtyBitmapClear(&memory->dirtyWram);
+	DirtyBitmapClear(&memory->dirtyIwram);
+	DirtyBitmapClear(&memory->dirtyPalette);
+	DirtyBitmapClear(&memory->dirtyVram);
+	DirtyBitmapClear(&memory->dirtyOam);
+	DirtyBitmapClear(&memory->savedata.dirtyPages);
+}
+
 static void _analyzeForIdleLoop(struct GBA* gba, struct ARMCore* cpu, uint32_t address) {
 	struct ARMInstructionInfo info;
 	uint32_t nextAddress = address;
@@ -699,10 +746,12 @@ uint32_t GBALoad8(struct ARMCore* cpu, uint32_t address, int* cycleCounter) {
 
 #define STORE_WORKING_RAM \
 	STORE_32(value, address & (SIZE_WORKING_RAM - 4), memory->wram); \
+	DirtyBitmapMark(&memory->dirtyWram, address & (SIZE_WORKING_RAM - 4)); \
 	wait += waitstatesRegion[REGION_WORKING_RAM];
 
 #define STORE_WORKING_IRAM \
-	STORE_32(value, address & (SIZE_WORKING_IRAM - 4), memory->iwram);
+	STORE_32(value, address & (SIZE_WORKING_IRAM - 4), memory->iwram); \
+	DirtyBitmapMark(&memory->dirtyIwram, address & (SIZE_WORKING_IRAM - 4));
 
 #define STORE_IO \
 	GBAIOWrite32(gba, address & (OFFSET_MASK - 3), value);
@@ -711,6 +760,7 @@ uint32_t GBALoad8(struct ARMCore* cpu, uint32_t address, int* cycleCounter) {
 	LOAD_32(oldValue, address & (SIZE_PALETTE_RAM - 4), gba->video.palette); \
 	if (oldValue != value) { \
 		STORE_32(value, address & (SIZE_PALETTE_RAM - 4), gba->video.palette); \
+		DirtyBitmapMark(&memory->dirtyPalette, address & (SIZE_PALETTE_RAM - 4)); \
 		gba->video.renderer->writePalette(gba->video.renderer, (address & (SIZE_PALETTE_RAM - 4)) + 2, value >> 16); \
 		gba->video.renderer->writePalette(gba->video.renderer, address & (SIZE_PALETTE_RAM - 4), value); \
 	} \
@@ -721,6 +771,7 @@ uint32_t GBALoad8(struct ARMCore* cpu, uint32_t address, int* cycleCounter) {
 		LOAD_32(oldValue, address & 0x0001FFFC, gba->video.vram); \
 		if (oldValue != value) { \
 			STORE_32(value, address & 0x0001FFFC, gba->video.vram); \
+			DirtyBitmapMark(&memory->dirtyVram, address & 0x0001FFFC); \
 			gba->video.renderer->writeVRAM(gba->video.renderer, (address & 0x0001FFFC) + 2); \
 			gba->video.renderer->writeVRAM(gba->video.renderer, (address & 0x0001FFFC)); \
 		} \
@@ -728,6 +779,7 @@ uint32_t GBALoad8(struct ARMCore* cpu, uint32_t address, int* cycleCounter) {
 		LOAD_32(oldValue, address & 0x00017FFC, gba->video.vram); \
 		if (oldValue != value) { \
 			STORE_32(value, address & 0x00017FFC, gba->video.vram); \
+			DirtyBitmapMark(&memory->dirtyVram, address & 0x00017FFC); \
 			gba->video.renderer->writeVRAM(gba->video.renderer, (address & 0x00017FFC) + 2); \
 			gba->video.renderer->writeVRAM(gba->video.renderer, (address & 0x00017FFC)); \
 		} \
@@ -738,6 +790,7 @@ uint32_t GBALoad8(struct ARMCore* cpu, uint32_t address, int* cycleCounter) {
 	LOAD_32(oldValue, address & (SIZE_OAM - 4), gba->video.oam.raw); \
 	if (oldValue != value) { \
 		STORE_32(value, address & (SIZE_OAM - 4), gba->video.oam.raw); \
+		DirtyBitmapMark(&memory->dirtyOam, address & (SIZE_OAM - 4)); \
 		gba->video.renderer->writeOAM(gba->video.renderer, (address & (SIZE_OAM - 4)) >> 1); \
 		gba->video.renderer->writeOAM(gba->video.renderer, ((address & (SIZE_OAM - 4)) >> 1) + 1); \
 	}
@@ -824,10 +877,12 @@ void GBAStore16(struct ARMCore* cpu, uint32_t address, int16_t value, int* cycle
 	switch (address >> BASE_OFFSET) {
 	case REGION_WORKING_RAM:
 		STORE_16(value, address & (SIZE_WORKING_RAM - 2), memory->wram);
+		DirtyBitmapMark(&memory->dirtyWram, address & (SIZE_WORKING_RAM - 2));
 		wait = memory->waitstatesNonseq16[REGION_WORKING_RAM];
 		break;
 	case REGION_WORKING_IRAM:
 		STORE_16(value, address & (SIZE_WORKING_IRAM - 2), memory->iwram);
+		DirtyBitmapMark(&memory->dirtyIwram, address & (SIZE_WORKING_IRAM - 2));
 		break;
 	case REGION_IO:
 		GBAIOWrite(gba, address & (OFFSET_MASK - 1), value);
@@ -836,6 +891,7 @@ void GBAStore16(struct ARMCore* cpu, uint32_t address, int16_t value, int* cycle
 		LOAD_16(oldValue, address & (SIZE_PALETTE_RAM - 2), gba->video.palette);
 		if (oldValue != value) {
 			STORE_16(value, address & (SIZE_PALETTE_RAM - 2), gba->video.palette);
+			DirtyBitmapMark(&memory->dirtyPalette, address & (SIZE_PALETTE_RAM - 2));
 			gba->video.renderer->writePalette(gba->video.renderer, address & (SIZE_PALETTE_RAM - 2), value);
 		}
 		break;
@@ -844,12 +900,14 @@ void GBAStore16(struct ARMCore* cpu, uint32_t address, int16_t value, int* cycle
 			LOAD_16(oldValue, address & 0x0001FFFE, gba->video.vram);
 			if (value != oldValue) {
 				STORE_16(value, address & 0x0001FFFE, gba->video.vram);
+				DirtyBitmapMark(&memory->dirtyVram, address & 0x0001FFFE);
 				gba->video.renderer->writeVRAM(gba->video.renderer, address & 0x0001FFFE);
 			}
 		} else {
 			LOAD_16(oldValue, address & 0x00017FFE, gba->video.vram);
 			if (value != oldValue) {
 				STORE_16(value, address & 0x00017FFE, gba->video.vram);
+				DirtyBitmapMark(&memory->dirtyVram, address & 0x00017FFE);
 				gba->video.renderer->writeVRAM(gba->video.renderer, address & 0x00017FFE);
 			}
 		}
@@ -858,6 +916,7 @@ void GBAStore16(struct ARMCore* cpu, uint32_t address, int16_t value, int* cycle
 		LOAD_16(oldValue, address & (SIZE_OAM - 2), gba->video.oam.raw);
 		if (value != oldValue) {
 			STORE_16(value, address & (SIZE_OAM - 2), gba->video.oam.raw);
+			DirtyBitmapMark(&memory->dirtyOam, address & (SIZE_OAM - 2));
 			gba->video.renderer->writeOAM(gba->video.renderer, (address & (SIZE_OAM - 2)) >> 1);
 		}
 		break;
@@ -926,10 +985,12 @@ void GBAStore8(struct ARMCore* cpu, uint32_t address, int8_t value, int* cycleCo
 	switch (address >> BASE_OFFSET) {
 	case REGION_WORKING_RAM:
 		((int8_t*) memory->wram)[address & (SIZE_WORKING_RAM - 1)] = value;
+		DirtyBitmapMark(&memory->dirtyWram, address & (SIZE_WORKING_RAM - 1));
 		wait = memory->waitstatesNonseq16[REGION_WORKING_RAM];
 		break;
 	case REGION_WORKING_IRAM:
 		((int8_t*) memory->iwram)[address & (SIZE_WORKING_IRAM - 1)] = value;
+		DirtyBitmapMark(&memory->dirtyIwram, address & (SIZE_WORKING_IRAM - 1));
 		break;
 	case REGION_IO:
 		GBAIOWrite8(gba, address & OFFSET_MASK, value);
@@ -946,6 +1007,7 @@ void GBAStore8(struct ARMCore* cpu, uint32_t address, int8_t value, int* cycleCo
 		oldValue = gba->video.renderer->vram[(address & 0x1FFFE) >> 1];
 		if (oldValue != (((uint8_t) value) | (value << 8))) {
 			gba->video.renderer->vram[(address & 0x1FFFE) >> 1] = ((uint8_t) value) | (value << 8);
+			DirtyBitmapMark(&memory->dirtyVram, address & 0x0001FFFE);
 			gba->video.renderer->writeVRAM(gba->video.renderer, address & 0x0001FFFE);
 		}
 		break;
@@ -971,8 +1033,11 @@ void GBAStore8(struct ARMCore* cpu, uint32_t address, int8_t value, int* cycleCo
 		} else if (memory->savedata.type == SAVEDATA_SRAM) {
 			if (memory->vfame.cartType) {
 				GBAVFameSramWrite(&memory->vfame, address, value, memory->savedata.data);
+				// The address is scrambled, so the touched page isn't known here
+				DirtyBitmapFill(&memory->savedata.dirtyPages);
 			} else {
 				memory->savedata.data[address & (SIZE_CART_SRAM - 1)] = value;
+				DirtyBitmapMark(&memory->savedata.dirtyPages, address & (SIZE_CART_SRAM - 1));
 			}
 			memory->savedata.dirty |= SAVEDATA_DIRT_NEW;
 		} else if (memory->hw.devices & HW_TILT) {
@@ -1116,10 +1181,12 @@ void GBAPatch32(struct ARMCore* cpu, uint32_t address, int32_t value, int32_t* o
 	case REGION_WORKING_RAM:
 		LOAD_32(oldValue, address & (SIZE_WORKING_RAM - 4), memory->wram);
 		STORE_32(value, address & (SIZE_WORKING_RAM - 4), memory->wram);
+		DirtyBitmapMark(&memory->dirtyWram, address & (SIZE_WORKING_RAM - 4));
 		break;
 	case REGION_WORKING_IRAM:
 		LOAD_32(oldValue, address & (SIZE_WORKING_IRAM - 4), memory->iwram);
 		STORE_32(value, address & (SIZE_WORKING_IRAM - 4), memory->iwram);
+		DirtyBitmapMark(&memory->dirtyIwram, address & (SIZE_WORKING_IRAM - 4));
 		break;
 	case REGION_IO:
 		mLOG(GBA_MEM, STUB, "Unimplemented memory Patch32: 0x%08X", address);
@@ -1127,6 +1194,7 @@ void GBAPatch32(struct ARMCore* cpu, uint32_t address, int32_t value, int32_t* o
 	case REGION_PALETTE_RAM:
 		LOAD_32(oldValue, address & (SIZE_PALETTE_RAM - 1), gba->video.palette);
 		STORE_32(value, address & (SIZE_PALETTE_RAM - 4), gba->video.palette);
+		DirtyBitmapMark(&memory->dirtyPalette, address & (SIZE_PALETTE_RAM - 4));
 		gba->video.renderer->writePalette(gba->video.renderer, address & (SIZE_PALETTE_RAM - 4), value);
 		gba->video.renderer->writePalette(gba->video.renderer, (address & (SIZE_PALETTE_RAM - 4)) + 2, value >> 16);
 		break;
@@ -1134,14 +1202,17 @@ void GBAPatch32(struct ARMCore* cpu, uint32_t address, int32_t value, int32_t* o
 		if ((address & 0x0001FFFF) < SIZE_VRAM) {
 			LOAD_32(oldValue, address & 0x0001FFFC, gba->video.vram);
 			STORE_32(value, address & 0x0001FFFC, gba->video.vram);
+			DirtyBitmapMark(&memory->dirtyVram, address & 0x0001FFFC);
 		} else {
 			LOAD_32(oldValue, address & 0x00017FFC, gba->video.vram);
 			STORE_32(value, address & 0x00017FFC, gba->video.vram);
+			DirtyBitmapMark(&memory->dirtyVram, address & 0x00017FFC);
 		}
 		break;
 	case REGION_OAM:
 		LOAD_32(oldValue, address & (SIZE_OAM - 4), gba->video.oam.raw);
 		STORE_32(value, address & (SIZE_OAM - 4), gba->video.oam.raw);
+		DirtyBitmapMark(&memory->dirtyOam, address & (SIZE_OAM - 4));
 		gba->video.renderer->writeOAM(gba->video.renderer, (address & (SIZE_OAM - 4)) >> 1);
 		gba->video.renderer->writeOAM(gba->video.renderer, ((address & (SIZE_OAM - 4)) + 2) >> 1);
 		break;
@@ -1153,8 +1224,7 @@ void GBAPatch32(struct ARMCore* cpu, uint32_t address, int32_t value, int32_t* o
 	case REGION_CART2_EX:
 		_pristineCow(gba);
 		if ((address & (SIZE_CART0 - 4)) >= gba->memory.romSize) {
-			gba->memory.romSize = (address & (SIZE_CART0 - 4)) + 4;
-			gba->memory.romMask = toPow2(gba->memory.romSize) - 1;
+			_extendRom(gba, (address & (SIZE_CART0 - 4)) + 4);
 		}
 		LOAD_32(oldValue, address & (SIZE_CART0 - 4), gba->memory.rom);
 		STORE_32(value, address & (SIZE_CART0 - 4), gba->memory.rom);
@@ -1164,6 +1234,7 @@ void GBAPatch32(struct ARMCore* cpu, uint32_t address, int32_t value, int32_t* o
 		if (memory->savedata.type == SAVEDATA_SRAM) {
 			LOAD_32(oldValue, address & (SIZE_CART_SRAM - 4), memory->savedata.data);
 			STORE_32(value, address & (SIZE_CART_SRAM - 4), memory->savedata.data);
+			DirtyBitmapMark(&memory->savedata.dirtyPages, address & (SIZE_CART_SRAM - 4));
 		} else {
 			mLOG(GBA_MEM, GAME_ERROR, "Writing to non-existent SRAM: 0x%08X", address);
 		}
@@ -1186,10 +1257,12 @@ void GBAPatch16(struct ARMCore* cpu, uint32_t address, int16_t value, int16_t* o
 	case REGION_WORKING_RAM:
 		LOAD_16(oldValue, address & (SIZE_WORKING_RAM - 2), memory->wram);
 		STORE_16(value, address & (SIZE_WORKING_RAM - 2), memory->wram);
+		DirtyBitmapMark(&memory->dirtyWram, address & (SIZE_WORKING_RAM - 2));
 		break;
 	case REGION_WORKING_IRAM:
 		LOAD_16(oldValue, address & (SIZE_WORKING_IRAM - 2), memory->iwram);
 		STORE_16(value, address & (SIZE_WORKING_IRAM - 2), memory->iwram);
+		DirtyBitmapMark(&memory->dirtyIwram, address & (SIZE_WORKING_IRAM - 2));
 		break;
 	case REGION_IO:
 		mLOG(GBA_MEM, STUB, "Unimplemented memory Patch16: 0x%08X", address);
@@ -1197,20 +1270,24 @@ void GBAPatch16(struct ARMCore* cpu, uint32_t address, int16_t value, int16_t* o
 	case REGION_PALETTE_RAM:
 		LOAD_16(oldValue, address & (SIZE_PALETTE_RAM - 2), gba->video.palette);
 		STORE_16(value, address & (SIZE_PALETTE_RAM - 2), gba->video.palette);
+		DirtyBitmapMark(&memory->dirtyPalette, address & (SIZE_PALETTE_RAM - 2));
 		gba->video.renderer->writePalette(gba->video.renderer, address & (SIZE_PALETTE_RAM - 2), value);
 		break;
 	case REGION_VRAM:
 		if ((address & 0x0001FFFF) < SIZE_VRAM) {
 			LOAD_16(oldValue, address & 0x0001FFFE, gba->video.vram);
 			STORE_16(value, address & 0x0001FFFE, gba->video.vram);
+			DirtyBitmapMark(&memory->dirtyVram, address & 0x0001FFFE);
 		} else {
 			LOAD_16(oldValue, address & 0x00017FFE, gba->video.vram);
 			STORE_16(value, address & 0x00017FFE, gba->video.vram);
+			DirtyBitmapMark(&memory->dirtyVram, address & 0x00017FFE);
 		}
 		break;
 	case REGION_OAM:
 		LOAD_16(oldValue, address & (SIZE_OAM - 2), gba->video.oam.raw);
 		STORE_16(value, address & (SIZE_OAM - 2), gba->video.oam.raw);
+		DirtyBitmapMark(&memory->dirtyOam, address & (SIZE_OAM - 2));
 		gba->video.renderer->writeOAM(gba->video.renderer, (address & (SIZE_OAM - 2)) >> 1);
 		break;
 	case REGION_CART0:
@@ -1221,8 +1298,7 @@ void GBAPatch16(struct ARMCore* cpu, uint32_t address, int16_t value, int16_t* o
 	case REGION_CART2_EX:
 		_pristineCow(gba);
 		if ((address & (SIZE_CART0 - 1)) >= gba->memory.romSize) {
-			gba->memory.romSize = (address & (SIZE_CART0 - 2)) + 2;
-			gba->memory.romMask = toPow2(gba->memory.romSize) - 1;
+			_extendRom(gba, (address & (SIZE_CART0 - 2)) + 2);
 		}
 		LOAD_16(oldValue, address & (SIZE_CART0 - 2), gba->memory.rom);
 		STORE_16(value, address & (SIZE_CART0 - 2), gba->memory.rom);
@@ -1232,6 +1308,7 @@ void GBAPatch16(struct ARMCore* cpu, uint32_t address, int16_t value, int16_t* o
 		if (memory->savedata.type == SAVEDATA_SRAM) {
 			LOAD_16(oldValue, address & (SIZE_CART_SRAM - 2), memory->savedata.data);
 			STORE_16(value, address & (SIZE_CART_SRAM - 2), memory->savedata.data);
+			DirtyBitmapMark(&memory->savedata.dirtyPages, address & (SIZE_CART_SRAM - 2));
 		} else {
 			mLOG(GBA_MEM, GAME_ERROR, "Writing to non-existent SRAM: 0x%08X", address);
 		}
@@ -1254,10 +1331,12 @@ void GBAPatch8(struct ARMCore* cpu, uint32_t address, int8_t value, int8_t* old)
 	case REGION_WORKING_RAM:
 		oldValue = ((int8_t*) memory->wram)[address & (SIZE_WORKING_RAM - 1)];
 		((int8_t*) memory->wram)[address & (SIZE_WORKING_RAM - 1)] = value;
+		DirtyBitmapMark(&memory->dirtyWram, address & (SIZE_WORKING_RAM - 1));
 		break;
 	case REGION_WORKING_IRAM:
 		oldValue = ((int8_t*) memory->iwram)[address & (SIZE_WORKING_IRAM - 1)];
 		((int8_t*) memory->iwram)[address & (SIZE_WORKING_IRAM - 1)] = value;
+		DirtyBitmapMark(&memory->dirtyIwram, address & (SIZE_WORKING_IRAM - 1));
 		break;
 	case REGION_IO:
 		mLOG(GBA_MEM, STUB, "Unimplemented memory Patch8: 0x%08X", address);
@@ -1279,8 +1358,7 @@ void GBAPatch8(struct ARMCore* cpu, uint32_t address, int8_t value, int8_t* old)
 	case REGION_CART2_EX:
 		_pristineCow(gba);
 		if ((address & (SIZE_CART0 - 1)) >= gba->memory.romSize) {
-			gba->memory.romSize = (address & (SIZE_CART0 - 2)) + 2;
-			gba->memory.romMask = toPow2(gba->memory.romSize) - 1;
+			_extendRom(gba, (address & (SIZE_CART0 - 2)) + 2);
 		}
 		oldValue = ((int8_t*) memory->rom)[address & (SIZE_CART0 - 1)];
 		((int8_t*) memory->rom)[address & (SIZE_CART0 - 1)] = value;
@@ -1290,6 +1368,7 @@ void GBAPatch8(struct ARMCore* cpu, uint32_t address, int8_t value, int8_t* old)
 		if (memory->savedata.type == SAVEDATA_SRAM) {
 			oldValue = ((int8_t*) memory->savedata.data)[address & (SIZE_CART_SRAM - 1)];
 			((int8_t*) memory->savedata.data)[address & (SIZE_CART_SRAM - 1)] = value;
+			DirtyBitmapMark(&memory->savedata.dirtyPages, address & (SIZE_CART_SRAM - 1));
 		} else {
 			mLOG(GBA_MEM, GAME_ERROR, "Writing to non-existent SRAM: 0x%08X", address);
 		}
@@ -1620,8 +1699,8 @@ void GBAMemorySerialize(const struct GBAMemory* memory, struct GBASerializedStat
 }
 
 void GBAMemoryDeserialize(struct GBAMemory* memory, const struct GBASerializedState* state) {
-	memcpy(memory->wram, state->wram, SIZE_WORKING_RAM);
-	memcpy(memory->iwram, state->iwram, SIZE_WORKING_IRAM);
+	DirtyBitmapCopy(&memory->dirtyWram, memory->wram, state->wram, SIZE_WORKING_RAM);
+	DirtyBitmapCopy(&memory->dirtyIwram, memory->iwram, state->iwram, SIZE_WORKING_IRAM);
 }
 
 void _pristineCow(struct GBA* gba) {
@@ -1629,6 +1708,15 @@ void _pristineCow(struct GBA* gba) {
 		return;
 	}
 #if !defined(FIXED_ROM_BUFFER) && !defined(__wii__)
+	if (gba->romCache) {
+		// Shared ROMs are already mapped copy-on-write, so only the pages that get written are copied
+		if (gba->romVf) {
+			gba->romVf->close(gba->romVf);
+			gba->romVf = NULL;
+		}
+		gba->isPristine = false;
+		return;
+	}
 	void* newRom = anonymousMemoryMap(SIZE_CART0);
 	memcpy(newRom, gba->memory.rom, gba->memory.romSize);
 	memset(((uint8_t*) newRom) + gba->memory.romSize, 0xFF, SIZE_CART0 - gba->memory.romSize);
@@ -1646,6 +1734,16 @@ void _pristineCow(struct GBA* gba) {
 	gba->isPristine = false;
 }
 
+void _extendRom(struct GBA* gba, uint32_t size) {
+	size_t start = gba->memory.romSize > gba->pristineRomSize ? gba->memory.romSize : gba->pristineRomSize;
+	if (gba->romCache && size > start) {
+		// Unlike a full copy, the shared mapping leaves the space past the end of the ROM zeroed
+		memset(&((uint8_t*) gba->memory.rom)[start], 0xFF, size - start);
+	}
+	gba->memory.romSize = size;
+	gba->memory.romMask = toPow2(size) - 1;
+}
+
 void GBAPrintFlush(struct GBA* gba) {
 	char oolBuf[0x101];
 	size_t i;
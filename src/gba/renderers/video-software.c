@@ -6,6 +6,7 @@
 #include "gba/renderers/software-private.h"
 
 #include <mgba/core/cache-set.h>
+#include <mgba/core/profile.h>
 #include <mgba/internal/arm/macros.h>
 #include <mgba/internal/gba/io.h>
 #include <mgba/internal/gba/renderers/cache-set.h>
@@ -64,6 +65,7 @@ void GBAVideoSoftwareRendererCreate(struct GBAVideoSoftwareRenderer* renderer) {
 	renderer->d.disableOBJ = false;
 
 	renderer->temporaryBuffer = 0;
+	renderer->profile = NULL;
 }
 
 static void GBAVideoSoftwareRendererInit(struct GBAVideoRenderer* renderer) {
@@ -544,6 +546,14 @@ static void GBAVideoSoftwareRendererDrawScanline(struct GBAVideoRenderer* render
 	softwareRenderer->cache[y].scale[1][0] = softwareRenderer->bg[3].sx;
 	softwareRenderer->cache[y].scale[1][1] = softwareRenderer->bg[3].sy;
 
+	if (softwareRenderer->profile) {
+		if (dirty) {
+			++softwareRenderer->profile->scanlinesRendered;
+		} else {
+			++softwareRenderer->profile->scanlinesSkipped;
+		}
+	}
+
 	if (!dirty) {
 		if (GBARegisterDISPCNTGetMode(softwareRenderer->dispcnt) != 0) {
 			softwareRenderer->bg[2].sx += softwareRenderer->bg[2].dmx;
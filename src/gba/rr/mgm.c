@@ -56,6 +56,9 @@ static void _streamEndReached(struct GBAMGMContext*);
 static struct VFile* GBAMGMOpenSavedata(struct GBARRContext*, int flags);
 static struct VFile* GBAMGMOpenSavestate(struct GBARRContext*, int flags);
 
+static bool GBAMGMGetPosition(struct GBARRContext*, struct GBARRPosition*);
+static bool GBAMGMSetPosition(struct GBARRContext*, const struct GBARRPosition*);
+
 void GBAMGMContextCreate(struct GBAMGMContext* mgm) {
 	memset(mgm, 0, sizeof(*mgm));
 
@@ -70,6 +73,7 @@ void GBAMGMContextCreate(struct GBAMGMContext* mgm) {
 	mgm->d.isRecording = GBAMGMIsRecording;
 
 	mgm->d.nextFrame = GBAMGMNextFrame;
+	mgm->d.frameEnded = GBARRFrameEnded;
 	mgm->d.logInput = GBAMGMLogInput;
 	mgm->d.queryInput = GBAMGMQueryInput;
 	mgm->d.queryReset = GBAMGMQueryReset;
@@ -79,6 +83,9 @@ void GBAMGMContextCreate(struct GBAMGMContext* mgm) {
 
 	mgm->d.openSavedata = GBAMGMOpenSavedata;
 	mgm->d.openSavestate = GBAMGMOpenSavestate;
+
+	mgm->d.getPosition = GBAMGMGetPosition;
+	mgm->d.setPosition = GBAMGMSetPosition;
 }
 
 void GBAMGMContextDestroy(struct GBARRContext* rr) {
@@ -588,3 +595,47 @@ struct VFile* GBAMGMOpenSavestate(struct GBARRContext* rr, int flags) {
 	struct GBAMGMContext* mgm = (struct GBAMGMContext*) rr;
 	return mgm->streamDir->openFile(mgm->streamDir, "movie.ssm", flags);
 }
+
+bool GBAMGMGetPosition(struct GBARRContext* rr, struct GBARRPosition* position) {
+	struct GBAMGMContext* mgm = (struct GBAMGMContext*) rr;
+	if (!mgm->movieStream) {
+		return false;
+	}
+	off_t offset = mgm->movieStream->seek(mgm->movieStream, 0, SEEK_CUR);
+	if (offset < 0) {
+		return false;
+	}
+	// Playback has already read the tag after the frame marker
+	if (mgm->isPlaying && mgm->peekedTag != TAG_EOF) {
+		--offset;
+	}
+	position->streamId = mgm->streamId;
+	position->offset = offset;
+	position->frames = mgm->d.frames;
+	position->lagFrames = mgm->d.lagFrames;
+	position->input = mgm->currentInput;
+	return true;
+}
+
+bool GBAMGMSetPosition(struct GBARRContext* rr, const struct GBARRPosition* position) {
+	struct GBAMGMContext* mgm = (struct GBAMGMContext*) rr;
+	if (!mgm->isPlaying) {
+		return false;
+	}
+	if (!mgm->movieStream || mgm->streamId != position->streamId) {
+		_loadStream(mgm, position->streamId);
+	}
+	if (!mgm->isPlaying || !mgm->movieStream) {
+		return false;
+	}
+	if (mgm->movieStream->seek(mgm->movieStream, position->offset, SEEK_SET) < 0) {
+		return false;
+	}
+	mgm->d.frames = position->frames;
+	mgm->d.lagFrames = position->lagFrames;
+	mgm->currentInput = position->input;
+	mgm->peekedTag = TAG_INVALID;
+	// This may reach the end of the movie, which is still a valid place to be
+	_readTag(mgm, mgm->movieStream);
+	return true;
+}
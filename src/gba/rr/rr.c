@@ -7,10 +7,47 @@
 
 #include <mgba/core/log.h>
 #include <mgba/core/serialize.h>
+#include <mgba/internal/gba/gba.h>
 #include <mgba-util/vfs.h>
 
+#define KEYFRAME_MAGIC "GBAk"
+#define KEYFRAME_VERSION 2
+#define KEYFRAME_SAVEDATA_SIZE SIZE_CART_FLASH1M
+
 mLOG_DEFINE_CATEGORY(GBA_RR, "GBA RR", "gba.rr");
 
+struct GBARRKeyframeHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t interval;
+	uint32_t stateSize;
+	uint32_t savedataSize;
+	uint32_t reserved[3];
+};
+
+// Each keyframe is followed by a GBASerializedState. Savestates do not otherwise carry the save
+// contents, so the savedata in effect follows that, but only in the keyframe where it last
+// changed; later keyframes refer back to that one with savedataKeyframe
+struct GBARRKeyframe {
+	uint32_t streamId;
+	uint32_t offset;
+	uint32_t frames;
+	uint32_t lagFrames;
+	uint16_t input;
+	uint16_t reserved;
+	uint32_t savedataSize;
+	uint32_t savedataKeyframe;
+	uint32_t reserved2;
+};
+
+static const size_t _keyframeStateSize = sizeof(struct GBARRKeyframe) + sizeof(struct GBASerializedState);
+static const size_t _keyframeBufferSize = sizeof(struct GBARRKeyframe) + sizeof(struct GBASerializedState) + KEYFRAME_SAVEDATA_SIZE;
+
+static void _resetKeyframes(struct GBARRContext* rr);
+static off_t _indexKeyframes(struct GBARRContext* rr, struct VFile* vf, ssize_t size);
+static void _writeKeyframe(struct GBA* gba, uint32_t index);
+static void _verifyKeyframe(struct GBA* gba, uint32_t index);
+
 void GBARRInitRecord(struct GBA* gba) {
 	if (!gba || !gba->rr) {
 		return;
@@ -36,6 +73,11 @@ void GBARRInitRecord(struct GBA* gba) {
 	} else {
 		ARMReset(gba->cpu);
 	}
+
+	gba->rr->currentFrame = 0;
+	if (gba->rr->keyframes && !gba->rr->verifyKeyframes && gba->rr->isRecording(gba->rr)) {
+		_writeKeyframe(gba, 0);
+	}
 }
 
 void GBARRInitPlay(struct GBA* gba) {
@@ -60,6 +102,374 @@ void GBARRInitPlay(struct GBA* gba) {
 	} else {
 		ARMReset(gba->cpu);
 	}
+
+	gba->rr->currentFrame = 0;
+	if (gba->rr->keyframes && !gba->rr->verifyKeyframes && gba->rr->isPlaying(gba->rr)) {
+		_writeKeyframe(gba, 0);
+	}
+}
+
+void GBARRFrameEnded(struct GBARRContext* rr, struct GBA* gba) {
+	// The last frame of a movie still counts even though it stops playback
+	bool active = rr->isPlaying(rr) || rr->isRecording(rr);
+	rr->nextFrame(rr);
+	if (!active) {
+		return;
+	}
+	++rr->currentFrame;
+	if (!rr->keyframes || rr->currentFrame % rr->keyframeInterval) {
+		return;
+	}
+	uint32_t index = rr->currentFrame / rr->keyframeInterval;
+	if (rr->verifyKeyframes) {
+		_verifyKeyframe(gba, index);
+	} else if (rr->isPlaying(rr) || rr->isRecording(rr)) {
+		_writeKeyframe(gba, index);
+	}
+}
+
+bool GBARRSetKeyframes(struct GBARRContext* rr, struct VFile* vf, uint32_t interval) {
+	if (!vf || !interval) {
+		return false;
+	}
+	struct GBARRKeyframeHeader header;
+	bool reuse = false;
+	ssize_t size = vf->size(vf);
+	if (size >= (ssize_t) sizeof(header) && vf->seek(vf, 0, SEEK_SET) == 0 && vf->read(vf, &header, sizeof(header)) == sizeof(header)) {
+		uint32_t version, headerInterval, stateSize, savedataSize;
+		LOAD_32LE(version, 0, &header.version);
+		LOAD_32LE(headerInterval, 0, &header.interval);
+		LOAD_32LE(stateSize, 0, &header.stateSize);
+		LOAD_32LE(savedataSize, 0, &header.savedataSize);
+		reuse = memcmp(header.magic, KEYFRAME_MAGIC, sizeof(header.magic)) == 0 && version == KEYFRAME_VERSION &&
+		        headerInterval == interval && stateSize == sizeof(struct GBASerializedState) &&
+		        savedataSize == KEYFRAME_SAVEDATA_SIZE;
+	}
+	if (!reuse && rr->verifyKeyframes) {
+		return false;
+	}
+	if (!reuse) {
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, KEYFRAME_MAGIC, sizeof(header.magic));
+		STORE_32LE(KEYFRAME_VERSION, 0, &header.version);
+		STORE_32LE(interval, 0, &header.interval);
+		STORE_32LE(sizeof(struct GBASerializedState), 0, &header.stateSize);
+		STORE_32LE(KEYFRAME_SAVEDATA_SIZE, 0, &header.savedataSize);
+		vf->truncate(vf, 0);
+		vf->seek(vf, 0, SEEK_SET);
+		if (vf->write(vf, &header, sizeof(header)) != sizeof(header)) {
+			return false;
+		}
+	}
+	_resetKeyframes(rr);
+	if (reuse) {
+		off_t end = _indexKeyframes(rr, vf, size);
+		if (!rr->verifyKeyframes) {
+			// Drop a keyframe that was only partially written
+			vf->truncate(vf, end);
+		}
+	}
+	if (rr->keyframes) {
+		rr->keyframes->close(rr->keyframes);
+	}
+	rr->keyframes = vf;
+	rr->keyframeInterval = interval;
+	return true;
+}
+
+uint32_t GBARRKeyframeCount(const struct GBARRContext* rr) {
+	if (!rr->keyframes) {
+		return 0;
+	}
+	return rr->nKeyframes;
+}
+
+static size_t _keyframeRecordSize(uint32_t index, uint32_t savedataSize, uint32_t savedataKeyframe) {
+	if (savedataKeyframe != index) {
+		return _keyframeStateSize;
+	}
+	return _keyframeStateSize + savedataSize;
+}
+
+// Makes the keyframe at index the last one, ending at end
+static void _setKeyframeEnd(struct GBARRContext* rr, uint32_t index, uint64_t end) {
+	if (index + 2 > rr->keyframeOffsetsCapacity) {
+		uint32_t capacity = rr->keyframeOffsetsCapacity;
+		while (index + 2 > capacity) {
+			capacity *= 2;
+		}
+		rr->keyframeOffsets = realloc(rr->keyframeOffsets, capacity * sizeof(*rr->keyframeOffsets));
+		rr->keyframeOffsetsCapacity = capacity;
+	}
+	rr->keyframeOffsets[index + 1] = end;
+	rr->nKeyframes = index + 1;
+}
+
+static void _resetKeyframes(struct GBARRContext* rr) {
+	if (!rr->keyframeOffsetsCapacity) {
+		rr->keyframeOffsetsCapacity = 16;
+		rr->keyframeOffsets = malloc(rr->keyframeOffsetsCapacity * sizeof(*rr->keyframeOffsets));
+	}
+	rr->keyframeOffsets[0] = sizeof(struct GBARRKeyframeHeader);
+	rr->nKeyframes = 0;
+}
+
+// Finds where each complete keyframe of an existing index starts, returning where the last one ends
+static off_t _indexKeyframes(struct GBARRContext* rr, struct VFile* vf, ssize_t size) {
+	off_t offset = sizeof(struct GBARRKeyframeHeader);
+	uint32_t index;
+	for (index = 0; index < UINT32_MAX; ++index) {
+		struct GBARRKeyframe keyframe;
+		if (vf->seek(vf, offset, SEEK_SET) != offset || vf->read(vf, &keyframe, sizeof(keyframe)) != sizeof(keyframe)) {
+			break;
+		}
+		uint32_t savedataSize;
+		uint32_t savedataKeyframe;
+		LOAD_32LE(savedataSize, 0, &keyframe.savedataSize);
+		LOAD_32LE(savedataKeyframe, 0, &keyframe.savedataKeyframe);
+		if (savedataSize > KEYFRAME_SAVEDATA_SIZE || savedataKeyframe > index) {
+			break;
+		}
+		off_t end = offset + _keyframeRecordSize(index, savedataSize, savedataKeyframe);
+		if (end > size) {
+			break;
+		}
+		_setKeyframeEnd(rr, index, end);
+		offset = end;
+	}
+	return offset;
+}
+
+// Reads a keyframe without its savedata into a buffer of _keyframeBufferSize bytes
+static bool _readKeyframe(struct GBARRContext* rr, uint32_t index, uint8_t* buffer) {
+	if (index >= rr->nKeyframes) {
+		return false;
+	}
+	struct VFile* vf = rr->keyframes;
+	off_t offset = rr->keyframeOffsets[index];
+	return vf->seek(vf, offset, SEEK_SET) == offset && vf->read(vf, buffer, _keyframeStateSize) == (ssize_t) _keyframeStateSize;
+}
+
+// Fills in the savedata after a keyframe read with _readKeyframe from wherever it was stored
+static bool _readKeyframeSavedata(struct GBARRContext* rr, uint8_t* buffer) {
+	const struct GBARRKeyframe* keyframe = (const struct GBARRKeyframe*) buffer;
+	uint32_t savedataSize;
+	uint32_t savedataKeyframe;
+	LOAD_32LE(savedataSize, 0, &keyframe->savedataSize);
+	LOAD_32LE(savedataKeyframe, 0, &keyframe->savedataKeyframe);
+	if (!savedataSize) {
+		return true;
+	}
+	if (savedataKeyframe >= rr->nKeyframes) {
+		return false;
+	}
+	off_t offset = rr->keyframeOffsets[savedataKeyframe] + _keyframeStateSize;
+	if ((uint64_t) offset + savedataSize > rr->keyframeOffsets[savedataKeyframe + 1]) {
+		return false;
+	}
+	struct VFile* vf = rr->keyframes;
+	return vf->seek(vf, offset, SEEK_SET) == offset && vf->read(vf, &buffer[_keyframeStateSize], savedataSize) == (ssize_t) savedataSize;
+}
+
+// Returns a keyframe record with everything but the movie position filled in
+static uint8_t* _captureKeyframe(struct GBA* gba, uint32_t index) {
+	struct GBARRContext* rr = gba->rr;
+	uint8_t* buffer = calloc(1, _keyframeBufferSize);
+	struct GBARRKeyframe* keyframe = (struct GBARRKeyframe*) buffer;
+	struct GBASerializedState* state = (struct GBASerializedState*) &buffer[sizeof(*keyframe)];
+	uint8_t* savedata = &buffer[sizeof(*keyframe) + sizeof(*state)];
+
+	// Saving a state while recording would otherwise start a new segment of the movie
+	gba->rr = NULL;
+	GBASerialize(gba, state);
+	gba->rr = rr;
+	if (index) {
+		// Later keyframes are taken as the frame ends, before the video event advances the frame counter
+		uint32_t frameCounter;
+		LOAD_32LE(frameCounter, 0, &state->video.frameCounter);
+		STORE_32LE(frameCounter + 1, 0, &state->video.frameCounter);
+	}
+
+	size_t savedataSize = 0;
+	if (gba->memory.savedata.data) {
+		savedataSize = GBASavedataSize(&gba->memory.savedata);
+		if (savedataSize > KEYFRAME_SAVEDATA_SIZE) {
+			savedataSize = KEYFRAME_SAVEDATA_SIZE;
+		}
+		memcpy(savedata, gba->memory.savedata.data, savedataSize);
+	}
+	STORE_32LE(savedataSize, 0, &keyframe->savedataSize);
+	STORE_32LE(index, 0, &keyframe->savedataKeyframe);
+	return buffer;
+}
+
+void _writeKeyframe(struct GBA* gba, uint32_t index) {
+	struct GBARRContext* rr = gba->rr;
+	bool recording = rr->isRecording(rr);
+	uint32_t count = rr->nKeyframes;
+	// Playback only fills in keyframes it has not seen yet
+	if (index > count || (index < count && !recording)) {
+		return;
+	}
+	struct GBARRPosition position;
+	if (!rr->getPosition || !rr->getPosition(rr, &position)) {
+		return;
+	}
+
+	uint8_t* buffer = _captureKeyframe(gba, index);
+	struct GBARRKeyframe* keyframe = (struct GBARRKeyframe*) buffer;
+	STORE_32LE(position.streamId, 0, &keyframe->streamId);
+	STORE_32LE(position.offset, 0, &keyframe->offset);
+	STORE_32LE(position.frames, 0, &keyframe->frames);
+	STORE_32LE(position.lagFrames, 0, &keyframe->lagFrames);
+	STORE_16LE(position.input, 0, &keyframe->input);
+
+	uint32_t savedataSize;
+	uint32_t savedataKeyframe = index;
+	LOAD_32LE(savedataSize, 0, &keyframe->savedataSize);
+	if (index) {
+		// Nothing was saved since the previous keyframe, so its savedata still applies
+		uint8_t* previous = malloc(_keyframeBufferSize);
+		const struct GBARRKeyframe* previousKeyframe = (const struct GBARRKeyframe*) previous;
+		uint32_t previousSize;
+		if (_readKeyframe(rr, index - 1, previous) && _readKeyframeSavedata(rr, previous)) {
+			LOAD_32LE(previousSize, 0, &previousKeyframe->savedataSize);
+			if (previousSize == savedataSize && memcmp(&previous[_keyframeStateSize], &buffer[_keyframeStateSize], savedataSize) == 0) {
+				LOAD_32LE(savedataKeyframe, 0, &previousKeyframe->savedataKeyframe);
+			}
+		}
+		free(previous);
+	}
+	STORE_32LE(savedataKeyframe, 0, &keyframe->savedataKeyframe);
+
+	struct VFile* vf = rr->keyframes;
+	off_t offset = rr->keyframeOffsets[index];
+	size_t size = _keyframeRecordSize(index, savedataSize, savedataKeyframe);
+	if (vf->seek(vf, offset, SEEK_SET) != offset || vf->write(vf, buffer, size) != (ssize_t) size) {
+		mLOG(GBA_RR, ERROR, "Could not write keyframe %u", index);
+		rr->nKeyframes = index;
+	} else {
+		_setKeyframeEnd(rr, index, offset + size);
+		if (recording) {
+			// Anything after this belonged to an earlier take
+			vf->truncate(vf, offset + size);
+		}
+	}
+	free(buffer);
+}
+
+void _verifyKeyframe(struct GBA* gba, uint32_t index) {
+	struct GBARRContext* rr = gba->rr;
+	if (index >= rr->nKeyframes) {
+		return;
+	}
+	uint8_t* expected = malloc(_keyframeBufferSize);
+	uint8_t* actual = _captureKeyframe(gba, index);
+	const struct GBARRKeyframe* expectedKeyframe = (const struct GBARRKeyframe*) expected;
+	const struct GBARRKeyframe* actualKeyframe = (const struct GBARRKeyframe*) actual;
+	uint32_t savedataSize;
+	LOAD_32LE(savedataSize, 0, &actualKeyframe->savedataSize);
+	// The position is left out, since the state can only match if the input did
+	if (!_readKeyframe(rr, index, expected) || !_readKeyframeSavedata(rr, expected)) {
+		mLOG(GBA_RR, ERROR, "Could not read keyframe %u", index);
+		++rr->keyframeMismatches;
+	} else if (expectedKeyframe->savedataSize != actualKeyframe->savedataSize ||
+	           memcmp(&expected[sizeof(*expectedKeyframe)], &actual[sizeof(*actualKeyframe)], sizeof(struct GBASerializedState) + savedataSize) != 0) {
+		mLOG(GBA_RR, WARN, "Keyframe %u does not match playback", index);
+		++rr->keyframeMismatches;
+	}
+	free(expected);
+	free(actual);
+}
+
+static bool _loadKeyframe(struct GBA* gba, uint32_t index) {
+	struct GBARRContext* rr = gba->rr;
+	uint8_t* buffer = malloc(_keyframeBufferSize);
+	if (!_readKeyframe(rr, index, buffer) || !_readKeyframeSavedata(rr, buffer)) {
+		free(buffer);
+		return false;
+	}
+	struct GBARRKeyframe* keyframe = (struct GBARRKeyframe*) buffer;
+	const struct GBASerializedState* state = (const struct GBASerializedState*) &buffer[sizeof(*keyframe)];
+	const uint8_t* savedata = &buffer[sizeof(*keyframe) + sizeof(*state)];
+	struct GBARRPosition position;
+	uint32_t savedataSize;
+	LOAD_32LE(position.streamId, 0, &keyframe->streamId);
+	LOAD_32LE(position.offset, 0, &keyframe->offset);
+	LOAD_32LE(position.frames, 0, &keyframe->frames);
+	LOAD_32LE(position.lagFrames, 0, &keyframe->lagFrames);
+	LOAD_16LE(position.input, 0, &keyframe->input);
+	LOAD_32LE(savedataSize, 0, &keyframe->savedataSize);
+
+	gba->rr = NULL;
+	bool success = GBADeserialize(gba, state);
+	gba->rr = rr;
+	if (success && gba->memory.savedata.data) {
+		if (savedataSize == GBASavedataSize(&gba->memory.savedata)) {
+			memcpy(gba->memory.savedata.data, savedata, savedataSize);
+		} else {
+			mLOG(GBA_RR, WARN, "Keyframe %u savedata size mismatch", index);
+		}
+	}
+	free(buffer);
+	if (!success || !rr->setPosition(rr, &position)) {
+		mLOG(GBA_RR, ERROR, "Could not load keyframe %u", index);
+		return false;
+	}
+	rr->currentFrame = index * rr->keyframeInterval;
+	return true;
+}
+
+bool GBARRSeek(struct GBA* gba, uint32_t frame) {
+	struct GBARRContext* rr = gba->rr;
+	if (!rr || !rr->keyframes || !rr->setPosition || rr->isRecording(rr)) {
+		return false;
+	}
+	uint32_t count = GBARRKeyframeCount(rr);
+	if (!count) {
+		return false;
+	}
+	uint32_t index = frame / rr->keyframeInterval;
+	if (index >= count) {
+		index = count - 1;
+	}
+	bool reload = frame < rr->currentFrame || index * rr->keyframeInterval > rr->currentFrame;
+	if (!rr->isPlaying(rr)) {
+		// Playback has to be restarted, so the emulated state no longer matches the movie
+		if (!rr->startPlaying(rr, false)) {
+			return false;
+		}
+		reload = true;
+	}
+	if (reload && !_loadKeyframe(gba, index)) {
+		return false;
+	}
+	while (rr->currentFrame < frame && rr->isPlaying(rr)) {
+		ARMRunLoop(gba->cpu);
+	}
+	return rr->currentFrame == frame;
+}
+
+bool GBARRVerifySegment(struct GBA* gba, uint32_t index) {
+	struct GBARRContext* rr = gba->rr;
+	if (!rr || !rr->keyframes || !rr->verifyKeyframes || !rr->setPosition || rr->isRecording(rr)) {
+		return false;
+	}
+	if (!rr->isPlaying(rr) && !rr->startPlaying(rr, false)) {
+		return false;
+	}
+	if (!_loadKeyframe(gba, index)) {
+		return false;
+	}
+	uint32_t mismatches = rr->keyframeMismatches;
+	uint32_t end = rr->currentFrame + rr->keyframeInterval;
+	if (index + 1 >= GBARRKeyframeCount(rr)) {
+		end = UINT32_MAX;
+	}
+	while (rr->currentFrame < end && rr->isPlaying(rr)) {
+		ARMRunLoop(gba->cpu);
+	}
+	return rr->keyframeMismatches == mismatches;
 }
 
 void GBARRDestroy(struct GBARRContext* rr) {
@@ -73,5 +483,13 @@ void GBARRDestroy(struct GBARRContext* rr) {
 		rr->savedata->close(rr->savedata);
 		rr->savedata = 0;
 	}
+	if (rr->keyframes) {
+		rr->keyframes->close(rr->keyframes);
+		rr->keyframes = 0;
+	}
+	free(rr->keyframeOffsets);
+	rr->keyframeOffsets = NULL;
+	rr->nKeyframes = 0;
+	rr->keyframeOffsetsCapacity = 0;
 	rr->destroy(rr);
 }
@@ -35,6 +35,9 @@ static void GBAVBMStateLoaded(struct GBARRContext* rr, const struct GBASerialize
 static struct VFile* GBAVBMOpenSavedata(struct GBARRContext*, int flags);
 static struct VFile* GBAVBMOpenSavestate(struct GBARRContext*, int flags);
 
+static bool GBAVBMGetPosition(struct GBARRContext*, struct GBARRPosition*);
+static bool GBAVBMSetPosition(struct GBARRContext*, const struct GBARRPosition*);
+
 void GBAVBMContextCreate(struct GBAVBMContext* vbm) {
 	memset(vbm, 0, sizeof(*vbm));
 
@@ -49,6 +52,7 @@ void GBAVBMContextCreate(struct GBAVBMContext* vbm) {
 	vbm->d.isRecording = GBAVBMIsRecording;
 
 	vbm->d.nextFrame = GBAVBMNextFrame;
+	vbm->d.frameEnded = GBARRFrameEnded;
 	vbm->d.logInput = 0;
 	vbm->d.queryInput = GBAVBMQueryInput;
 	vbm->d.queryReset = GBAVBMQueryReset;
@@ -58,6 +62,9 @@ void GBAVBMContextCreate(struct GBAVBMContext* vbm) {
 
 	vbm->d.openSavedata = GBAVBMOpenSavedata;
 	vbm->d.openSavestate = GBAVBMOpenSavestate;
+
+	vbm->d.getPosition = GBAVBMGetPosition;
+	vbm->d.setPosition = GBAVBMSetPosition;
 }
 
 bool GBAVBMStartPlaying(struct GBARRContext* rr, bool autorecord) {
@@ -217,6 +224,25 @@ struct VFile* GBAVBMOpenSavestate(struct GBARRContext* rr, int flags) {
 	return 0;
 }
 
+bool GBAVBMGetPosition(struct GBARRContext* rr, struct GBARRPosition* position) {
+	struct GBAVBMContext* vbm = (struct GBAVBMContext*) rr;
+	off_t offset = vbm->vbmFile->seek(vbm->vbmFile, 0, SEEK_CUR);
+	if (offset < 0) {
+		return false;
+	}
+	memset(position, 0, sizeof(*position));
+	position->offset = offset;
+	return true;
+}
+
+bool GBAVBMSetPosition(struct GBARRContext* rr, const struct GBARRPosition* position) {
+	struct GBAVBMContext* vbm = (struct GBAVBMContext*) rr;
+	if (!vbm->isPlaying || position->offset < (uint32_t) vbm->inputOffset) {
+		return false;
+	}
+	return vbm->vbmFile->seek(vbm->vbmFile, position->offset, SEEK_SET) >= 0;
+}
+
 void GBAVBMContextDestroy(struct GBARRContext* rr) {
 	struct GBAVBMContext* vbm = (struct GBAVBMContext*) rr;
 	if (vbm->vbmFile) {
@@ -178,6 +178,7 @@ bool GBASavedataLoad(struct GBASavedata* savedata, struct VFile* in) {
 		}
 		ssize_t size = GBASavedataSize(savedata);
 		in->seek(in, 0, SEEK_SET);
+		DirtyBitmapFill(&savedata->dirtyPages);
 		return in->read(in, savedata->data, size) == size;
 	} else if (savedata->vf) {
 		off_t read = 0;
@@ -267,6 +268,7 @@ void GBASavedataInitFlash(struct GBASavedata* savedata) {
 	if (end < SIZE_CART_FLASH512) {
 		memset(&savedata->data[end], 0xFF, flashSize - end);
 	}
+	DirtyBitmapFill(&savedata->dirtyPages);
 }
 
 void GBASavedataInitEEPROM(struct GBASavedata* savedata) {
@@ -294,6 +296,7 @@ void GBASavedataInitEEPROM(struct GBASavedata* savedata) {
 	if (end < SIZE_CART_EEPROM512) {
 		memset(&savedata->data[end], 0xFF, SIZE_CART_EEPROM512 - end);
 	}
+	DirtyBitmapFill(&savedata->dirtyPages);
 }
 
 void GBASavedataInitSRAM(struct GBASavedata* savedata) {
@@ -318,6 +321,7 @@ void GBASavedataInitSRAM(struct GBASavedata* savedata) {
 	if (end < SIZE_CART_SRAM) {
 		memset(&savedata->data[end], 0xFF, SIZE_CART_SRAM - end);
 	}
+	DirtyBitmapFill(&savedata->dirtyPages);
 }
 
 uint8_t GBASavedataReadFlash(struct GBASavedata* savedata, uint16_t address) {
@@ -345,6 +349,7 @@ void GBASavedataWriteFlash(struct GBASavedata* savedata, uint16_t address, uint8
 		case FLASH_COMMAND_PROGRAM:
 			savedata->dirty |= SAVEDATA_DIRT_NEW;
 			savedata->currentBank[address] = value;
+			DirtyBitmapMark(&savedata->dirtyPages, (savedata->currentBank - savedata->data) + address);
 			savedata->command = FLASH_COMMAND_NONE;
 			mTimingDeschedule(savedata->timing, &savedata->dust);
 			mTimingSchedule(savedata->timing, &savedata->dust, FLASH_PROGRAM_CYCLES);
@@ -444,6 +449,7 @@ static void _ensureEeprom(struct GBASavedata* savedata, uint32_t size) {
 	} else {
 		savedata->data = savedata->vf->map(savedata->vf, SIZE_CART_EEPROM, savedata->mapMode);
 	}
+	DirtyBitmapFill(&savedata->dirtyPages);
 }
 
 void GBASavedataWriteEEPROM(struct GBASavedata* savedata, uint16_t value, uint32_t writeSize) {
@@ -477,6 +483,7 @@ void GBASavedataWriteEEPROM(struct GBASavedata* savedata, uint16_t value, uint32
 			current |= (value & 0x1) << (0x7 - (savedata->writeAddress & 0x7));
 			savedata->dirty |= SAVEDATA_DIRT_NEW;
 			savedata->data[savedata->writeAddress >> 3] = current;
+			DirtyBitmapMark(&savedata->dirtyPages, savedata->writeAddress >> 3);
 			mTimingDeschedule(savedata->timing, &savedata->dust);
 			mTimingSchedule(savedata->timing, &savedata->dust, EEPROM_SETTLE_CYCLES);
 			++savedata->writeAddress;
@@ -610,6 +617,7 @@ void _flashSwitchBank(struct GBASavedata* savedata, int bank) {
 			} else {
 				savedata->data = savedata->vf->map(savedata->vf, SIZE_CART_FLASH1M, MAP_WRITE);
 			}
+			DirtyBitmapFill(&savedata->dirtyPages);
 		}
 	}
 }
@@ -622,6 +630,7 @@ void _flashErase(struct GBASavedata* savedata) {
 		size = SIZE_CART_FLASH1M;
 	}
 	memset(savedata->data, 0xFF, size);
+	DirtyBitmapMarkRange(&savedata->dirtyPages, 0, size);
 }
 
 void _flashEraseSector(struct GBASavedata* savedata, uint16_t sectorStart) {
@@ -635,4 +644,5 @@ void _flashEraseSector(struct GBASavedata* savedata, uint16_t sectorStart) {
 	mTimingDeschedule(savedata->timing, &savedata->dust);
 	mTimingSchedule(savedata->timing, &savedata->dust, FLASH_ERASE_CYCLES);
 	memset(&savedata->currentBank[sectorStart & ~(size - 1)], 0xFF, size);
+	DirtyBitmapMarkRange(&savedata->dirtyPages, (savedata->currentBank - savedata->data) + (sectorStart & ~(size - 1)), size);
 }
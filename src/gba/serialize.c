@@ -9,6 +9,7 @@
 #include <mgba/internal/gba/io.h>
 #include <mgba/internal/gba/rr/rr.h>
 
+#include <mgba-util/hash.h>
 #include <mgba-util/memory.h>
 #include <mgba-util/vfs.h>
 
@@ -69,8 +70,10 @@ void GBASerialize(struct GBA* gba, struct GBASerializedState* state) {
 	STORE_32(miscFlags, 0, &state->miscFlags);
 
 	GBAMemorySerialize(&gba->memory, state);
+	GBAVideoRun(&gba->video, mTimingCurrentTime(&gba->timing));
 	GBAIOSerialize(gba, state);
 	GBAVideoSerialize(&gba->video, state);
+	GBAudioRun(&gba->audio.psg, mTimingCurrentTime(&gba->timing));
 	GBAAudioSerialize(&gba->audio, state);
 	GBASavedataSerialize(&gba->memory.savedata, state);
 
@@ -133,6 +136,7 @@ bool GBADeserialize(struct GBA* gba, const struct GBASerializedState* state) {
 		return false;
 	}
 	gba->timing.root = NULL;
+	gba->timing.reroot = NULL;
 	LOAD_32(gba->timing.masterCycles, 0, &state->masterCycles);
 
 	size_t i;
@@ -192,8 +196,12 @@ bool GBADeserialize(struct GBA* gba, const struct GBASerializedState* state) {
 	GBAVideoDeserialize(&gba->video, state);
 	GBAMemoryDeserialize(&gba->memory, state);
 	GBAIODeserialize(gba, state);
+	GBAVideoReschedule(&gba->video);
 	GBAAudioDeserialize(&gba->audio, state);
 	GBASavedataDeserialize(&gba->memory.savedata, state);
+	// Memory regions mark the pages they change while loading; savedata comes
+	// from extdata and isn't compared, so assume all of it changed
+	DirtyBitmapFill(&gba->memory.savedata.dirtyPages);
 
 	if (gba->rr) {
 		gba->rr->stateLoaded(gba->rr, state);
@@ -204,3 +212,46 @@ bool GBADeserialize(struct GBA* gba, const struct GBASerializedState* state) {
 
 	return true;
 }
+
+static void _hashWords(struct Hash128* hash, const int32_t* words, size_t count) {
+	uint32_t buffer[16];
+	while (count) {
+		size_t chunk = count < 16 ? count : 16;
+		size_t i;
+		for (i = 0; i < chunk; ++i) {
+			STORE_32LE(words[i], i * 4, buffer);
+		}
+		hash128Update(hash, buffer, chunk * 4);
+		words += chunk;
+		count -= chunk;
+	}
+}
+
+void GBAHashState(struct GBA* gba, struct Hash128* hash) {
+	// Lazy timing leaves registers stale until something looks at them
+	GBAVideoRun(&gba->video, mTimingCurrentTime(&gba->timing));
+	GBAudioRun(&gba->audio.psg, mTimingCurrentTime(&gba->timing));
+
+	struct ARMCore* cpu = gba->cpu;
+	_hashWords(hash, cpu->gprs, 16);
+	int32_t psrs[2] = { cpu->cpsr.packed, cpu->spsr.packed };
+	_hashWords(hash, psrs, 2);
+	_hashWords(hash, &cpu->bankedRegisters[0][0], 6 * 7);
+	_hashWords(hash, cpu->bankedSPSRs, 6);
+
+	// I/O registers are kept in host order, unlike the rest of memory
+	uint16_t io[SIZE_IO >> 1];
+	size_t i;
+	for (i = 0; i < SIZE_IO >> 1; ++i) {
+		STORE_16LE(gba->memory.io[i], i * 2, io);
+	}
+	hash128Update(hash, io, sizeof(io));
+	hash128Update(hash, gba->memory.wram, SIZE_WORKING_RAM);
+	hash128Update(hash, gba->memory.iwram, SIZE_WORKING_IRAM);
+	hash128Update(hash, gba->video.palette, SIZE_PALETTE_RAM);
+	hash128Update(hash, gba->video.vram, SIZE_VRAM);
+	hash128Update(hash, gba->video.oam.raw, SIZE_OAM);
+	if (gba->memory.savedata.data) {
+		hash128Update(hash, gba->memory.savedata.data, GBASavedataSize(&gba->memory.savedata));
+	}
+}
@@ -17,9 +17,28 @@ static bool GBASIOLockstepNodeUnload(struct GBASIODriver* driver);
 static uint16_t GBASIOLockstepNodeMultiWriteRegister(struct GBASIODriver* driver, uint32_t address, uint16_t value);
 static uint16_t GBASIOLockstepNodeNormalWriteRegister(struct GBASIODriver* driver, uint32_t address, uint16_t value);
 static void _GBASIOLockstepNodeProcessEvents(struct mTiming* timing, void* driver, uint32_t cyclesLate);
+static int32_t _GBASIOLockstepSync(struct mLockstep* lockstep, int id);
+
+static int32_t _window(const struct GBASIOLockstepNode* node) {
+	if (node->p->d.window > 0) {
+		return node->p->d.window;
+	}
+	return LOCKSTEP_INCREMENT;
+}
+
+static void _wakeNode(struct GBASIOLockstepNode* node) {
+	struct mTiming* timing = &node->d.p->p->timing;
+	if (mTimingIsScheduled(timing, &node->event)) {
+		// Only the cycles actually run since the last sync may be posted to the other nodes
+		node->eventDiff -= mTimingUntil(timing, &node->event);
+		mTimingDeschedule(timing, &node->event);
+	}
+	mTimingSchedule(timing, &node->event, 0);
+}
 
 void GBASIOLockstepInit(struct GBASIOLockstep* lockstep) {
 	mLockstepInit(&lockstep->d);
+	lockstep->d.syncNode = _GBASIOLockstepSync;
 	lockstep->players[0] = 0;
 	lockstep->players[1] = 0;
 	lockstep->players[2] = 0;
@@ -87,14 +106,20 @@ bool GBASIOLockstepNodeLoad(struct GBASIODriver* driver) {
 	struct GBASIOLockstepNode* node = (struct GBASIOLockstepNode*) driver;
 	node->nextEvent = 0;
 	node->eventDiff = 0;
-	mTimingSchedule(&driver->p->p->timing, &node->event, 0);
+	node->transferPending = false;
+	if (!node->p->d.scheduler) {
+		mTimingSchedule(&driver->p->p->timing, &node->event, 0);
+	}
 	node->mode = driver->p->mode;
 	switch (node->mode) {
 	case SIO_MULTI:
 		node->d.writeRegister = GBASIOLockstepNodeMultiWriteRegister;
 		node->d.p->rcnt |= 3;
-		++node->p->attachedMulti;
-		node->d.p->multiplayerControl.ready = node->p->attachedMulti == node->p->d.attached;
+		if (!node->p->d.scheduler) {
+			// Scheduled nodes may be loading concurrently, so they're counted at the next sync instead
+			++node->p->attachedMulti;
+			node->d.p->multiplayerControl.ready = node->p->attachedMulti == node->p->d.attached;
+		}
 		if (node->id) {
 			node->d.p->rcnt |= 4;
 			node->d.p->multiplayerControl.slave = 1;
@@ -118,7 +143,9 @@ bool GBASIOLockstepNodeUnload(struct GBASIODriver* driver) {
 	node->mode = driver->p->mode;
 	switch (node->mode) {
 	case SIO_MULTI:
-		--node->p->attachedMulti;
+		if (!node->p->d.scheduler) {
+			--node->p->attachedMulti;
+		}
 		break;
 	default:
 		break;
@@ -135,10 +162,14 @@ static uint16_t GBASIOLockstepNodeMultiWriteRegister(struct GBASIODriver* driver
 		if (value & 0x0080 && node->p->d.transferActive == TRANSFER_IDLE) {
 			if (!node->id && node->d.p->multiplayerControl.ready) {
 				mLOG(GBA_SIO, DEBUG, "Lockstep %i: Transfer initiated", node->id);
-				node->p->d.transferActive = TRANSFER_STARTING;
 				node->p->d.transferCycles = GBASIOCyclesPerTransfer[node->d.p->multiplayerControl.baud][node->p->d.attached - 1];
-				mTimingDeschedule(&driver->p->p->timing, &node->event);
-				mTimingSchedule(&driver->p->p->timing, &node->event, 0);
+				if (node->p->d.scheduler) {
+					// The other nodes may be looking at the phase right now, so it changes at the next sync
+					node->transferPending = true;
+				} else {
+					node->p->d.transferActive = TRANSFER_STARTING;
+					_wakeNode(node);
+				}
 			} else {
 				value &= ~0x0080;
 			}
@@ -212,7 +243,7 @@ static int32_t _masterUpdate(struct GBASIOLockstepNode* node) {
 	switch (node->p->d.transferActive) {
 	case TRANSFER_IDLE:
 		// If the master hasn't initiated a transfer, it can keep going.
-		node->nextEvent += LOCKSTEP_INCREMENT;
+		node->nextEvent += _window(node);
 		node->d.p->multiplayerControl.ready = node->p->attachedMulti == node->p->d.attached;
 		break;
 	case TRANSFER_STARTING:
@@ -245,7 +276,7 @@ static int32_t _masterUpdate(struct GBASIOLockstepNode* node) {
 	case TRANSFER_FINISHED:
 		// Everything's settled. We're done.
 		_finishTransfer(node);
-		node->nextEvent += LOCKSTEP_INCREMENT;
+		node->nextEvent += _window(node);
 		ATOMIC_STORE(node->p->d.transferActive, TRANSFER_IDLE);
 		break;
 	}
@@ -281,7 +312,7 @@ static uint32_t _slaveUpdate(struct GBASIOLockstepNode* node) {
 	switch (node->p->d.transferActive) {
 	case TRANSFER_IDLE:
 		if (!node->d.p->multiplayerControl.ready) {
-			node->p->d.addCycles(&node->p->d, node->id, LOCKSTEP_INCREMENT);
+			node->p->d.addCycles(&node->p->d, node->id, _window(node));
 		}
 		break;
 	case TRANSFER_STARTING:
@@ -365,17 +396,22 @@ static uint16_t GBASIOLockstepNodeNormalWriteRegister(struct GBASIODriver* drive
 		if (!node->id) {
 			driver->p->normalControl.si = 1;
 		}
-		if (value & 0x0080 && !node->id) {
-			// Internal shift clock
-			if (value & 1) {
-				node->p->d.transferActive = TRANSFER_STARTING;
-			}
+		if (value & 0x0080 && !node->id && node->p->d.transferActive == TRANSFER_IDLE) {
 			// Frequency
 			if (value & 2) {
 				node->p->d.transferCycles = GBA_ARM7TDMI_FREQUENCY / 1024;
 			} else {
 				node->p->d.transferCycles = GBA_ARM7TDMI_FREQUENCY / 8192;
 			}
+			// Internal shift clock
+			if (value & 1) {
+				if (node->p->d.scheduler) {
+					node->transferPending = true;
+				} else {
+					node->p->d.transferActive = TRANSFER_STARTING;
+					_wakeNode(node);
+				}
+			}
 		}
 	} else if (address == REG_SIODATA32_LO) {
 		mLOG(GBA_SIO, DEBUG, "Lockstep %i: SIODATA32_LO <- %04x", node->id, value);
@@ -384,3 +420,35 @@ static uint16_t GBASIOLockstepNodeNormalWriteRegister(struct GBASIODriver* drive
 	}
 	return value;
 }
+
+static int32_t _GBASIOLockstepSync(struct mLockstep* lockstep, int id) {
+	struct GBASIOLockstep* gbaLockstep = (struct GBASIOLockstep*) lockstep;
+	struct GBASIOLockstepNode* node = gbaLockstep->players[id];
+	if (!id) {
+		int attachedMulti = 0;
+		int i;
+		for (i = 0; i < lockstep->attached; ++i) {
+			struct GBASIOLockstepNode* player = gbaLockstep->players[i];
+			if (player->d.p->activeDriver == &player->d && player->mode == SIO_MULTI) {
+				++attachedMulti;
+			}
+		}
+		gbaLockstep->attachedMulti = attachedMulti;
+	}
+	if (lockstep->attached < 2 || node->d.p->activeDriver != &node->d) {
+		return _window(node);
+	}
+	node->nextEvent = 0;
+	if (id) {
+		_slaveUpdate(node);
+		return 0;
+	}
+	if (node->transferPending) {
+		node->transferPending = false;
+		if (lockstep->transferActive == TRANSFER_IDLE) {
+			lockstep->transferActive = TRANSFER_STARTING;
+		}
+	}
+	_masterUpdate(node);
+	return node->nextEvent;
+}
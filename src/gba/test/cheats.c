@@ -7,6 +7,7 @@
 
 #include <mgba/core/cheats.h>
 #include <mgba/core/core.h>
+#include <mgba/core/rewind.h>
 #include <mgba/gba/core.h>
 #include <mgba/internal/gba/cheats.h>
 
@@ -75,6 +76,30 @@ M_TEST_DEFINE(doPARv3Assign) {
 	set->deinit(set);
 }
 
+M_TEST_DEFINE(doPARv3AssignAppend) {
+	struct mCore* core = *state;
+	struct mCheatDevice* device = core->cheatDevice(core);
+	assert_non_null(device);
+	struct mCheatSet* set = device->createSet(device, NULL);
+	assert_non_null(set);
+	GBACheatSetGameSharkVersion((struct GBACheatSet*) set, GBA_GS_PARV3_RAW);
+	assert_true(set->addLine(set, "00300000 00000078", GBA_CHEAT_PRO_ACTION_REPLAY));
+
+	core->reset(core);
+	mCheatRefresh(device, set);
+	assert_int_equal(core->rawRead8(core, 0x03000000, -1), 0x78);
+	assert_int_equal(core->rawRead8(core, 0x02000000, -1), 0);
+
+	// Mirrored addresses aren't covered by a memory block, so this one goes through the bus
+	assert_true(set->addLine(set, "00240000 00000056", GBA_CHEAT_PRO_ACTION_REPLAY));
+	core->rawWrite8(core, 0x03000000, -1, 0);
+	mCheatRefresh(device, set);
+	assert_int_equal(core->rawRead8(core, 0x03000000, -1), 0x78);
+	assert_int_equal(core->rawRead8(core, 0x02000000, -1), 0x56);
+
+	set->deinit(set);
+}
+
 M_TEST_DEFINE(doPARv3Slide1) {
 	struct mCore* core = *state;
 	struct mCheatDevice* device = core->cheatDevice(core);
@@ -1049,10 +1074,48 @@ M_TEST_DEFINE(doPARv3IfButton) {
 	set->deinit(set);
 }
 
+M_TEST_DEFINE(rewindDirectCheat) {
+	struct mCore* core = *state;
+	struct mCheatDevice* device = core->cheatDevice(core);
+	assert_non_null(device);
+	struct mCheatSet* set = device->createSet(device, NULL);
+	assert_non_null(set);
+	GBACheatSetGameSharkVersion((struct GBACheatSet*) set, GBA_GS_PARV3_RAW);
+	assert_true(set->addLine(set, "00301000 00000078", GBA_CHEAT_PRO_ACTION_REPLAY));
+
+	core->reset(core);
+	uint8_t original = core->rawRead8(core, 0x03001000, -1);
+	assert_int_not_equal(original, 0x78);
+
+	struct mCoreRewindContext rewind;
+	mCoreRewindContextInit(&rewind, 4, false);
+	mCoreRewindAppend(&rewind, core);
+	core->runFrame(core);
+	mCoreRewindAppend(&rewind, core);
+
+	// Cheats write IWRAM through a host pointer, so the diff between these two
+	// snapshots only sees the change if the cheat marked the page itself
+	mCheatRefresh(device, set);
+	assert_int_equal(core->rawRead8(core, 0x03001000, -1), 0x78);
+	mCoreRewindAppend(&rewind, core);
+	core->runFrame(core);
+	mCoreRewindAppend(&rewind, core);
+
+	assert_true(mCoreRewindRestore(&rewind, core));
+	assert_int_equal(core->rawRead8(core, 0x03001000, -1), 0x78);
+	assert_true(mCoreRewindRestore(&rewind, core));
+	assert_int_equal(core->rawRead8(core, 0x03001000, -1), original);
+
+	mCoreRewindContextDeinit(&rewind);
+	core->setDirtyTracking(core, false);
+	set->deinit(set);
+}
+
 M_TEST_SUITE_DEFINE_SETUP_TEARDOWN(GBACheats,
 	cmocka_unit_test(createSet),
 	cmocka_unit_test(addRawPARv3),
 	cmocka_unit_test(doPARv3Assign),
+	cmocka_unit_test(doPARv3AssignAppend),
 	cmocka_unit_test(doPARv3Slide1),
 	cmocka_unit_test(doPARv3Slide2),
 	cmocka_unit_test(doPARv3Slide4),
@@ -1070,4 +1133,5 @@ M_TEST_SUITE_DEFINE_SETUP_TEARDOWN(GBACheats,
 	cmocka_unit_test(doPARv3IfXContain1Else),
 	cmocka_unit_test(doPARv3IfXElseContain1),
 	cmocka_unit_test(doPARv3IfXContain1ElseContain1),
-	cmocka_unit_test(doPARv3IfButton))
+	cmocka_unit_test(doPARv3IfButton),
+	cmocka_unit_test(rewindDirectCheat))
@@ -6,7 +6,12 @@
 #include "util/test/suite.h"
 
 #include <mgba/core/core.h>
+#include <mgba/core/rom-cache.h>
+#include <mgba/core/serialize.h>
+#include <mgba/core/state-slots.h>
 #include <mgba/gba/core.h>
+#include <mgba/internal/gba/gba.h>
+#include <mgba-util/vfs.h>
 
 M_TEST_DEFINE(create) {
 	struct mCore* core = GBACoreCreate();
@@ -40,8 +45,240 @@ M_TEST_DEFINE(loadNullROM) {
 	core->deinit(core);
 }
 
+M_TEST_DEFINE(stateBufferRoundTrip) {
+	struct mCore* core = GBACoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	core->reset(core);
+
+	size_t size = mCoreSaveStateBufferSize(core, 0, SAVESTATE_RTC);
+	assert_true(size > core->stateSize(core));
+	uint8_t* buffer = malloc(size);
+	uint8_t* reloaded = malloc(size);
+	assert_false(mCoreSaveStateBuffer(core, buffer, core->stateSize(core), SAVESTATE_RTC));
+	assert_true(mCoreSaveStateBuffer(core, buffer, size, SAVESTATE_RTC));
+
+	// Loading in place must behave exactly like loading through a VFile
+	uint8_t* expected = malloc(size);
+	struct VFile* vf = VFileFromConstMemory(buffer, size);
+	core->runFrame(core);
+	assert_true(mCoreLoadStateNamed(core, vf, SAVESTATE_RTC));
+	assert_true(mCoreSaveStateBuffer(core, expected, size, SAVESTATE_RTC));
+	vf->close(vf);
+
+	core->runFrame(core);
+	assert_true(mCoreLoadStateBuffer(core, buffer, size, SAVESTATE_RTC));
+	assert_true(mCoreSaveStateBuffer(core, reloaded, size, SAVESTATE_RTC));
+	assert_memory_equal(expected, reloaded, size);
+
+	free(expected);
+	free(reloaded);
+	free(buffer);
+	core->deinit(core);
+}
+
+M_TEST_DEFINE(stateSlots) {
+	struct mCore* core = GBACoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	core->reset(core);
+
+	size_t size = mCoreSaveStateBufferSize(core, 0, SAVESTATE_RTC);
+	struct VFile* vf = VFileMemChunk(NULL, 0);
+	struct mStateSlots slots;
+	assert_true(mStateSlotsInit(&slots, vf, 4, size));
+	assert_int_equal(mStateSlotsSequence(&slots, 1), 0);
+	assert_false(mStateSlotsLoad(&slots, core, 1, SAVESTATE_RTC));
+	assert_false(mStateSlotsSave(&slots, core, 4, SAVESTATE_RTC));
+
+	uint8_t* expected = malloc(size);
+	uint8_t* reloaded = malloc(size);
+	assert_true(mStateSlotsSave(&slots, core, 1, SAVESTATE_RTC));
+	assert_int_equal(mStateSlotsSequence(&slots, 1), 1);
+	core->runFrame(core);
+	assert_true(mStateSlotsSave(&slots, core, 2, SAVESTATE_RTC));
+	assert_true(mStateSlotsSave(&slots, core, 1, SAVESTATE_RTC));
+	assert_int_equal(mStateSlotsSequence(&slots, 1), 3);
+
+	// Saves alternate between the two copies, leaving the previous state untouched
+	size_t slotSize;
+	const uint8_t* previous = mStateSlotsGet(&slots, 1, &slotSize);
+	assert_non_null(previous);
+	assert_true(slotSize >= size);
+	memcpy(reloaded, previous, size);
+	core->runFrame(core);
+	assert_true(mStateSlotsSave(&slots, core, 1, SAVESTATE_RTC));
+	assert_int_equal(mStateSlotsSequence(&slots, 1), 4);
+	assert_true(mStateSlotsGet(&slots, 1, NULL) != previous);
+	assert_memory_equal(previous, reloaded, size);
+	mStateSlotsDeinit(&slots);
+
+	// Reopening keeps the slots and their order
+	assert_true(mStateSlotsInit(&slots, vf, 4, size));
+	assert_int_equal(mStateSlotsSequence(&slots, 1), 4);
+	assert_int_equal(mStateSlotsSequence(&slots, 2), 2);
+	mStateSlotsDelete(&slots, 1);
+	assert_int_equal(mStateSlotsSequence(&slots, 1), 0);
+	assert_null(mStateSlotsGet(&slots, 1, NULL));
+	core->runFrame(core);
+	assert_true(mCoreSaveStateBuffer(core, expected, size, SAVESTATE_RTC));
+	assert_true(mStateSlotsSave(&slots, core, 3, SAVESTATE_RTC));
+	assert_int_equal(mStateSlotsSequence(&slots, 3), 5);
+	core->runFrame(core);
+	assert_true(mStateSlotsLoad(&slots, core, 3, SAVESTATE_RTC));
+	assert_true(mCoreSaveStateBuffer(core, reloaded, size, SAVESTATE_RTC));
+	assert_memory_equal(expected, reloaded, size);
+	mStateSlotsDeinit(&slots);
+
+	// Files laid out for a different slot count start over empty
+	assert_true(mStateSlotsInit(&slots, vf, 2, size));
+	assert_int_equal(mStateSlotsSequence(&slots, 1), 0);
+	mStateSlotsDeinit(&slots);
+
+	free(expected);
+	free(reloaded);
+	vf->close(vf);
+	core->deinit(core);
+}
+
+M_TEST_DEFINE(stateHash) {
+	struct mCore* core = GBACoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	core->reset(core);
+	core->runFrame(core);
+
+	uint64_t before[2];
+	uint64_t after[2];
+	mCoreHashState(core, before);
+	mCoreHashState(core, after);
+	assert_memory_equal(before, after, sizeof(before));
+
+	void* saved = malloc(core->stateSize(core));
+	assert_true(core->saveState(core, saved));
+	core->busWrite8(core, 0x03000000, core->busRead8(core, 0x03000000) ^ 1);
+	mCoreHashState(core, after);
+	assert_true(before[0] != after[0] || before[1] != after[1]);
+
+	// Loading the state reschedules events, which must not change the hash
+	assert_true(core->loadState(core, saved));
+	mCoreHashState(core, after);
+	assert_memory_equal(before, after, sizeof(before));
+
+	free(saved);
+	core->deinit(core);
+}
+
+M_TEST_DEFINE(quickSaveSlots) {
+	struct mCore* core = GBACoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	core->reset(core);
+
+	size_t size = mCoreSaveStateBufferSize(core, 0, SAVESTATE_RTC);
+	struct VFile* vf = VFileMemChunk(NULL, 0);
+	struct mStateSlots slots;
+	assert_true(mStateSlotsInit(&slots, vf, 4, size));
+	assert_true(slots.durable);
+	core->stateSlots = &slots;
+
+	uint8_t* expected = malloc(size);
+	uint8_t* reloaded = malloc(size);
+	core->runFrame(core);
+	assert_true(mCoreSaveStateBuffer(core, expected, size, SAVESTATE_RTC));
+	// Quick-saves land in the slot file, screenshot or not
+	assert_true(mCoreSaveState(core, 2, SAVESTATE_RTC | SAVESTATE_SCREENSHOT));
+	assert_int_equal(mStateSlotsSequence(&slots, 2), 1);
+	core->runFrame(core);
+	assert_true(mCoreLoadState(core, 2, SAVESTATE_RTC | SAVESTATE_SCREENSHOT));
+	assert_true(mCoreSaveStateBuffer(core, reloaded, size, SAVESTATE_RTC));
+	assert_memory_equal(expected, reloaded, size);
+
+	mCoreDeleteState(core, 2);
+	assert_int_equal(mStateSlotsSequence(&slots, 2), 0);
+	assert_false(mCoreLoadState(core, 2, SAVESTATE_RTC));
+
+	core->stateSlots = NULL;
+	mStateSlotsDeinit(&slots);
+	free(expected);
+	free(reloaded);
+	vf->close(vf);
+	core->deinit(core);
+}
+
+static struct mCore* _loadROMCore(const uint8_t* rom, size_t size) {
+	struct mCore* core = GBACoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	assert_true(core->loadROM(core, VFileFromConstMemory(rom, size)));
+	core->reset(core);
+	return core;
+}
+
+static void _fillROM(uint8_t* rom, size_t size) {
+	size_t i;
+	for (i = 0; i < size; ++i) {
+		rom[i] = i * 7;
+	}
+}
+
+M_TEST_DEFINE(romCacheShared) {
+	static uint8_t rom[0x1000];
+	_fillROM(rom, sizeof(rom));
+	mROMCacheSetEnabled(true);
+	struct mCore* a = _loadROMCore(rom, sizeof(rom));
+	struct mCore* b = _loadROMCore(rom, sizeof(rom));
+	struct GBA* gbaA = a->board;
+	struct GBA* gbaB = b->board;
+
+#ifdef HAVE_MEMFD_CREATE
+	assert_non_null(gbaA->romCache);
+	assert_true(gbaA->romCache == gbaB->romCache);
+#endif
+	assert_true(gbaA->memory.rom != gbaB->memory.rom);
+	assert_memory_equal(gbaA->memory.rom, rom, sizeof(rom));
+
+	// Patching one instance's ROM must not leak into the other's
+	a->rawWrite8(a, 0x08000010, -1, 0xA5);
+	assert_int_equal(a->rawRead8(a, 0x08000010, -1), 0xA5);
+	assert_int_equal(b->rawRead8(b, 0x08000010, -1), rom[0x10]);
+	assert_memory_equal(gbaB->memory.rom, rom, sizeof(rom));
+
+	a->deinit(a);
+	assert_memory_equal(gbaB->memory.rom, rom, sizeof(rom));
+	b->deinit(b);
+	mROMCacheSetEnabled(false);
+}
+
+M_TEST_DEFINE(romCacheDisabled) {
+	static uint8_t rom[0x1000];
+	_fillROM(rom, sizeof(rom));
+	assert_false(mROMCacheIsEnabled());
+	struct mCore* a = _loadROMCore(rom, sizeof(rom));
+	struct mCore* b = _loadROMCore(rom, sizeof(rom));
+	struct GBA* gbaA = a->board;
+	struct GBA* gbaB = b->board;
+
+	assert_null(gbaA->romCache);
+	assert_null(gbaB->romCache);
+	assert_memory_equal(gbaA->memory.rom, rom, sizeof(rom));
+
+	a->rawWrite8(a, 0x08000010, -1, 0xA5);
+	assert_int_equal(a->rawRead8(a, 0x08000010, -1), 0xA5);
+	assert_int_equal(b->rawRead8(b, 0x08000010, -1), rom[0x10]);
+
+	a->deinit(a);
+	b->deinit(b);
+}
+
 M_TEST_SUITE_DEFINE(GBACore,
 	cmocka_unit_test(create),
 	cmocka_unit_test(platform),
 	cmocka_unit_test(reset),
-	cmocka_unit_test(loadNullROM))
+	cmocka_unit_test(loadNullROM),
+	cmocka_unit_test(stateBufferRoundTrip),
+	cmocka_unit_test(stateSlots),
+	cmocka_unit_test(stateHash),
+	cmocka_unit_test(quickSaveSlots),
+	cmocka_unit_test(romCacheShared),
+	cmocka_unit_test(romCacheDisabled))
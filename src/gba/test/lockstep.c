@@ -0,0 +1,121 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba/core/core.h>
+#include <mgba/core/lockstep.h>
+#include <mgba/gba/core.h>
+#include <mgba/internal/gba/gba.h>
+#include <mgba/internal/gba/sio/lockstep.h>
+#include <mgba-util/vfs.h>
+
+#define TEST_PLAYERS 4
+#define TEST_FRAMES 10
+
+// Runs multiplayer transfers back to back, accumulating what the first two players sent
+static const uint8_t _multiRom[] = {
+	0x01, 0x13, 0xA0, 0xE3, // mov r1, #0x04000000
+	0x01, 0x1C, 0x81, 0xE2, // add r1, r1, #0x100
+	0x00, 0x00, 0xA0, 0xE3, // mov r0, #0
+	0xB4, 0x03, 0xC1, 0xE1, // strh r0, [r1, #0x34]
+	0x02, 0x0A, 0xA0, 0xE3, // mov r0, #0x2000
+	0x03, 0x00, 0x80, 0xE3, // orr r0, r0, #3
+	0xB8, 0x02, 0xC1, 0xE1, // strh r0, [r1, #0x28]
+	0x00, 0x20, 0xA0, 0xE3, // mov r2, #0
+	0x00, 0x50, 0xA0, 0xE3, // mov r5, #0
+	0x01, 0x20, 0x82, 0xE2, // loop: add r2, r2, #1
+	0xBA, 0x22, 0xC1, 0xE1, // strh r2, [r1, #0x2A]
+	0x80, 0x00, 0x80, 0xE3, // orr r0, r0, #0x80
+	0xB8, 0x02, 0xC1, 0xE1, // strh r0, [r1, #0x28]
+	0xB8, 0x02, 0xD1, 0xE1, // wait: ldrh r0, [r1, #0x28]
+	0x80, 0x00, 0x10, 0xE3, // tst r0, #0x80
+	0xFC, 0xFF, 0xFF, 0x1A, // bne wait
+	0xB0, 0x32, 0xD1, 0xE1, // ldrh r3, [r1, #0x20]
+	0xB2, 0x42, 0xD1, 0xE1, // ldrh r4, [r1, #0x22]
+	0x03, 0x50, 0x85, 0xE0, // add r5, r5, r3
+	0x04, 0x58, 0x85, 0xE0, // add r5, r5, r4, lsl #16
+	0x03, 0x64, 0xA0, 0xE3, // mov r6, #0x03000000
+	0x00, 0x50, 0x86, 0xE5, // str r5, [r6]
+	0x04, 0x20, 0x86, 0xE5, // str r2, [r6, #4]
+	0xF0, 0xFF, 0xFF, 0xEA, // b loop
+};
+
+struct GBALockstepTest {
+	struct GBASIOLockstep lockstep;
+	struct GBASIOLockstepNode nodes[TEST_PLAYERS];
+	struct mCore* cores[TEST_PLAYERS];
+	struct mLockstepScheduler scheduler;
+	uint8_t rom[0x200];
+};
+
+static void _run(struct GBALockstepTest* test, size_t threads, uint64_t hashes[TEST_PLAYERS][2], uint32_t results[TEST_PLAYERS][2]) {
+	memset(test, 0, sizeof(*test));
+	memcpy(test->rom, _multiRom, sizeof(_multiRom));
+	GBASIOLockstepInit(&test->lockstep);
+	mLockstepSchedulerInit(&test->scheduler, &test->lockstep.d, threads);
+
+	int i;
+	for (i = 0; i < TEST_PLAYERS; ++i) {
+		struct mCore* core = GBACoreCreate();
+		assert_non_null(core);
+		assert_true(core->init(core));
+		assert_true(core->loadROM(core, VFileFromConstMemory(test->rom, sizeof(test->rom))));
+		core->opts.skipBios = true;
+		core->reset(core);
+		test->cores[i] = core;
+
+		struct GBA* gba = core->board;
+		GBASIOLockstepNodeCreate(&test->nodes[i]);
+		assert_true(GBASIOLockstepAttachNode(&test->lockstep, &test->nodes[i]));
+		GBASIOSetDriver(&gba->sio, &test->nodes[i].d, SIO_MULTI);
+		assert_true(mLockstepSchedulerAttachCore(&test->scheduler, core));
+	}
+
+	mLockstepSchedulerRunFrames(&test->scheduler, TEST_FRAMES);
+
+	for (i = 0; i < TEST_PLAYERS; ++i) {
+		struct mCore* core = test->cores[i];
+		mCoreHashState(core, hashes[i]);
+		results[i][0] = core->rawRead32(core, BASE_WORKING_IRAM, -1);
+		results[i][1] = core->rawRead32(core, BASE_WORKING_IRAM + 4, -1);
+	}
+
+	for (i = TEST_PLAYERS - 1; i >= 0; --i) {
+		struct GBA* gba = test->cores[i]->board;
+		GBASIOSetDriver(&gba->sio, NULL, SIO_MULTI);
+		GBASIOLockstepDetachNode(&test->lockstep, &test->nodes[i]);
+	}
+	mLockstepSchedulerDeinit(&test->scheduler);
+	for (i = 0; i < TEST_PLAYERS; ++i) {
+		test->cores[i]->deinit(test->cores[i]);
+	}
+}
+
+M_TEST_DEFINE(threadedMatchesSerial) {
+	static struct GBALockstepTest test;
+	uint64_t serialHashes[TEST_PLAYERS][2];
+	uint32_t serialResults[TEST_PLAYERS][2];
+	_run(&test, 1, serialHashes, serialResults);
+
+	// The master only moves on once its transfers complete, and everyone sees what it sent
+	assert_true(serialResults[0][1] > 1);
+	int i;
+	for (i = 0; i < TEST_PLAYERS; ++i) {
+		assert_int_not_equal(serialResults[i][0] & 0xFFFF, 0);
+	}
+
+	size_t threads;
+	for (threads = 2; threads <= TEST_PLAYERS; ++threads) {
+		uint64_t hashes[TEST_PLAYERS][2];
+		uint32_t results[TEST_PLAYERS][2];
+		_run(&test, threads, hashes, results);
+		assert_memory_equal(results, serialResults, sizeof(results));
+		assert_memory_equal(hashes, serialHashes, sizeof(hashes));
+	}
+}
+
+M_TEST_SUITE_DEFINE(GBALockstep,
+	cmocka_unit_test(threadedMatchesSerial))
@@ -0,0 +1,122 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba/core/core.h>
+#include <mgba/core/interface.h>
+#include <mgba/core/mem-search.h>
+#include <mgba/gba/core.h>
+
+M_TEST_SUITE_SETUP(GBAMemorySearch) {
+	struct mCore* core = GBACoreCreate();
+	core->init(core);
+	mCoreInitConfig(core, NULL);
+	core->reset(core);
+	*state = core;
+	return 0;
+}
+
+M_TEST_SUITE_TEARDOWN(GBAMemorySearch) {
+	if (!*state) {
+		return 0;
+	}
+	struct mCore* core = *state;
+	mCoreConfigDeinit(&core->config);
+	core->deinit(core);
+	return 0;
+}
+
+M_TEST_DEFINE(searchInt) {
+	struct mCore* core = *state;
+	core->rawWrite16(core, 0x02000010, -1, 0x5A5A);
+	core->rawWrite16(core, 0x0203FFFE, -1, 0x5A5A);
+	core->rawWrite16(core, 0x03000100, -1, 0x5A5A);
+
+	struct mCoreMemorySearchParams params = {
+		.memoryFlags = mCORE_MEMORY_RW,
+		.type = mCORE_MEMORY_SEARCH_INT,
+		.op = mCORE_MEMORY_SEARCH_EQUAL,
+		.align = 2,
+		.width = 2,
+		.valueInt = 0x5A5A
+	};
+	struct mCoreMemorySearchResults results;
+	mCoreMemorySearchResultsInit(&results, 0);
+	mCoreMemorySearch(core, &params, &results, 0);
+	assert_int_equal(mCoreMemorySearchResultsSize(&results), 3);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 0)->address, 0x02000010);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 1)->address, 0x0203FFFE);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 2)->address, 0x03000100);
+
+	mCoreMemorySearchResultsClear(&results);
+	mCoreMemorySearch(core, &params, &results, 2);
+	assert_int_equal(mCoreMemorySearchResultsSize(&results), 2);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 1)->address, 0x0203FFFE);
+
+	mCoreMemorySearchResultsClear(&results);
+	mCoreMemorySearch(core, &params, &results, 0);
+	core->rawWrite16(core, 0x0203FFFE, -1, 0x5A5B);
+	params.op = mCORE_MEMORY_SEARCH_DELTA;
+	params.valueInt = 0;
+	mCoreMemorySearchRepeat(core, &params, &results);
+	assert_int_equal(mCoreMemorySearchResultsSize(&results), 2);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 0)->address, 0x02000010);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 1)->address, 0x03000100);
+
+	mCoreMemorySearchResultsDeinit(&results);
+}
+
+M_TEST_DEFINE(searchSnapshot) {
+	struct mCore* core = *state;
+	core->rawWrite8(core, 0x02000020, -1, 0x10);
+	core->rawWrite8(core, 0x03000020, -1, 0x10);
+	core->rawWrite8(core, 0x03000021, -1, 0x10);
+
+	struct mCoreMemorySnapshot snapshot;
+	mCoreMemorySnapshotInit(&snapshot);
+	mCoreMemorySnapshotTake(core, mCORE_MEMORY_DIRECT, &snapshot);
+
+	core->rawWrite8(core, 0x02000020, -1, 0x13);
+	core->rawWrite8(core, 0x03000020, -1, 0x11);
+	core->rawWrite8(core, 0x03000021, -1, 0x0F);
+
+	struct mCoreMemorySearchParams params = {
+		.memoryFlags = mCORE_MEMORY_DIRECT,
+		.type = mCORE_MEMORY_SEARCH_INT,
+		.op = mCORE_MEMORY_SEARCH_GREATER,
+		.align = 1,
+		.width = 1
+	};
+	struct mCoreMemorySearchResults results;
+	mCoreMemorySearchResultsInit(&results, 0);
+	mCoreMemorySearchSnapshot(core, &params, &snapshot, &results, 0);
+	assert_int_equal(mCoreMemorySearchResultsSize(&results), 2);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 0)->address, 0x02000020);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 1)->address, 0x03000020);
+
+	params.op = mCORE_MEMORY_SEARCH_DELTA;
+	params.valueInt = -1;
+	mCoreMemorySearchResultsClear(&results);
+	mCoreMemorySearchSnapshot(core, &params, &snapshot, &results, 0);
+	assert_int_equal(mCoreMemorySearchResultsSize(&results), 1);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 0)->address, 0x03000021);
+
+	params.op = mCORE_MEMORY_SEARCH_GREATER;
+	mCoreMemorySearchResultsClear(&results);
+	mCoreMemorySearchSnapshot(core, &params, &snapshot, &results, 0);
+	mCoreMemorySnapshotTake(core, mCORE_MEMORY_DIRECT, &snapshot);
+	core->rawWrite8(core, 0x03000020, -1, 0x12);
+	mCoreMemorySearchRepeatSnapshot(core, &params, &snapshot, &results);
+	assert_int_equal(mCoreMemorySearchResultsSize(&results), 1);
+	assert_int_equal(mCoreMemorySearchResultsGetPointer(&results, 0)->address, 0x03000020);
+
+	mCoreMemorySearchResultsDeinit(&results);
+	mCoreMemorySnapshotDeinit(&snapshot);
+}
+
+M_TEST_SUITE_DEFINE_SETUP_TEARDOWN(GBAMemorySearch,
+	cmocka_unit_test(searchInt),
+	cmocka_unit_test(searchSnapshot))
@@ -0,0 +1,334 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba/core/core.h>
+#include <mgba/gba/core.h>
+#include <mgba/internal/arm/arm.h>
+#include <mgba/internal/gba/gba.h>
+#include <mgba/internal/gba/rr/rr.h>
+#include <mgba-util/vfs.h>
+
+#define TEST_FRAMES 60
+#define TEST_INTERVAL 10
+#define TEST_KEYFRAMES 6
+
+// Adds up the keys every poll, and saves the total to SRAM whenever A is held. Movies start
+// from a reset, so it begins with a branch for the BIOS to recognize the ROM by.
+static const uint8_t _keyRom[] = {
+	0xFF, 0xFF, 0xFF, 0xEA, // b 4
+	0x01, 0x13, 0xA0, 0xE3, // mov r1, #0x04000000
+	0x13, 0x1E, 0x81, 0xE2, // add r1, r1, #0x130
+	0x0E, 0x34, 0xA0, 0xE3, // mov r3, #0x0E000000
+	0xB0, 0x00, 0xD1, 0xE1, // ldrh r0, [r1]
+	0x00, 0x20, 0x82, 0xE0, // add r2, r2, r0
+	0x01, 0x00, 0x10, 0xE3, // tst r0, #1
+	0x00, 0x20, 0xC3, 0x05, // strbeq r2, [r3]
+	0xFA, 0xFF, 0xFF, 0xEA, // b 0x10
+};
+
+// Plays back a fixed list of inputs, one per frame
+struct GBARRTestMovie {
+	struct GBARRContext d;
+	uint16_t inputs[TEST_FRAMES];
+	uint32_t cursor;
+	bool playing;
+};
+
+struct GBARRTest {
+	struct mCore* core;
+	struct GBARRTestMovie movie;
+	uint8_t rom[0x200];
+};
+
+static void _movieDestroy(struct GBARRContext* rr) {
+	UNUSED(rr);
+}
+
+static bool _movieStartPlaying(struct GBARRContext* rr, bool autorecord) {
+	UNUSED(autorecord);
+	struct GBARRTestMovie* movie = (struct GBARRTestMovie*) rr;
+	movie->cursor = 0;
+	movie->playing = true;
+	return true;
+}
+
+static void _movieStopPlaying(struct GBARRContext* rr) {
+	struct GBARRTestMovie* movie = (struct GBARRTestMovie*) rr;
+	movie->playing = false;
+}
+
+static bool _movieStartRecording(struct GBARRContext* rr) {
+	UNUSED(rr);
+	return false;
+}
+
+static void _movieStopRecording(struct GBARRContext* rr) {
+	UNUSED(rr);
+}
+
+static bool _movieIsPlaying(const struct GBARRContext* rr) {
+	const struct GBARRTestMovie* movie = (const struct GBARRTestMovie*) rr;
+	return movie->playing;
+}
+
+static bool _movieIsRecording(const struct GBARRContext* rr) {
+	UNUSED(rr);
+	return false;
+}
+
+static void _movieNextFrame(struct GBARRContext* rr) {
+	struct GBARRTestMovie* movie = (struct GBARRTestMovie*) rr;
+	if (!movie->playing) {
+		return;
+	}
+	++movie->cursor;
+	if (movie->cursor >= TEST_FRAMES) {
+		movie->playing = false;
+	}
+}
+
+static void _movieLogInput(struct GBARRContext* rr, uint16_t input) {
+	UNUSED(rr);
+	UNUSED(input);
+}
+
+static uint16_t _movieQueryInput(struct GBARRContext* rr) {
+	struct GBARRTestMovie* movie = (struct GBARRTestMovie*) rr;
+	return movie->inputs[movie->cursor];
+}
+
+static bool _movieQueryReset(struct GBARRContext* rr) {
+	UNUSED(rr);
+	return false;
+}
+
+static void _movieStateSaved(struct GBARRContext* rr, struct GBASerializedState* state) {
+	UNUSED(rr);
+	UNUSED(state);
+}
+
+static void _movieStateLoaded(struct GBARRContext* rr, const struct GBASerializedState* state) {
+	UNUSED(rr);
+	UNUSED(state);
+}
+
+static bool _movieGetPosition(struct GBARRContext* rr, struct GBARRPosition* position) {
+	struct GBARRTestMovie* movie = (struct GBARRTestMovie*) rr;
+	memset(position, 0, sizeof(*position));
+	position->offset = movie->cursor;
+	return true;
+}
+
+static bool _movieSetPosition(struct GBARRContext* rr, const struct GBARRPosition* position) {
+	struct GBARRTestMovie* movie = (struct GBARRTestMovie*) rr;
+	if (position->offset >= TEST_FRAMES) {
+		return false;
+	}
+	movie->cursor = position->offset;
+	return true;
+}
+
+static void _init(struct GBARRTest* test, uint32_t pressA, uint32_t pressAAgain) {
+	memset(test->rom, 0, sizeof(test->rom));
+	memcpy(test->rom, _keyRom, sizeof(_keyRom));
+	test->core = GBACoreCreate();
+	assert_non_null(test->core);
+	assert_true(test->core->init(test->core));
+	mCoreInitConfig(test->core, NULL);
+	assert_true(test->core->loadROM(test->core, VFileFromConstMemory(test->rom, sizeof(test->rom))));
+	test->core->reset(test->core);
+	struct GBA* gba = test->core->board;
+	GBASavedataForceType(&gba->memory.savedata, SAVEDATA_SRAM);
+
+	struct GBARRTestMovie* movie = &test->movie;
+	memset(movie, 0, sizeof(*movie));
+	movie->d.destroy = _movieDestroy;
+	movie->d.startPlaying = _movieStartPlaying;
+	movie->d.stopPlaying = _movieStopPlaying;
+	movie->d.startRecording = _movieStartRecording;
+	movie->d.stopRecording = _movieStopRecording;
+	movie->d.isPlaying = _movieIsPlaying;
+	movie->d.isRecording = _movieIsRecording;
+	movie->d.nextFrame = _movieNextFrame;
+	movie->d.frameEnded = GBARRFrameEnded;
+	movie->d.logInput = _movieLogInput;
+	movie->d.queryInput = _movieQueryInput;
+	movie->d.queryReset = _movieQueryReset;
+	movie->d.stateSaved = _movieStateSaved;
+	movie->d.stateLoaded = _movieStateLoaded;
+	movie->d.getPosition = _movieGetPosition;
+	movie->d.setPosition = _movieSetPosition;
+	movie->inputs[pressA] = 1;
+	movie->inputs[pressA + 1] = 1;
+	movie->inputs[pressAAgain] = 1;
+}
+
+static void _start(struct GBARRTest* test) {
+	struct GBA* gba = test->core->board;
+	gba->rr = &test->movie.d;
+	assert_true(test->movie.d.startPlaying(&test->movie.d, false));
+	GBARRInitPlay(gba);
+}
+
+static void _deinit(struct GBARRTest* test) {
+	struct GBA* gba = test->core->board;
+	gba->rr = NULL;
+	GBARRDestroy(&test->movie.d);
+	mCoreConfigDeinit(&test->core->config);
+	test->core->deinit(test->core);
+}
+
+static void _runTo(struct GBARRTest* test, uint32_t frame) {
+	struct GBA* gba = test->core->board;
+	while (test->movie.d.currentFrame < frame && test->movie.playing) {
+		ARMRunLoop(gba->cpu);
+	}
+	assert_int_equal(test->movie.d.currentFrame, frame);
+}
+
+static struct VFile* _copyIndex(struct VFile* vf, size_t extra) {
+	ssize_t size = vf->size(vf);
+	uint8_t* buffer = calloc(1, size + extra);
+	vf->seek(vf, 0, SEEK_SET);
+	assert_int_equal(vf->read(vf, buffer, size), size);
+	struct VFile* copy = VFileMemChunk(buffer, size + extra);
+	free(buffer);
+	return copy;
+}
+
+// Plays the whole movie to fill in an index, keeping a copy of it and hashes of a few frames
+static struct VFile* _buildIndex(uint64_t (*hashes)[2], uint8_t** savedata, const uint32_t* frames, size_t nFrames) {
+	struct GBARRTest test;
+	_init(&test, 25, 41);
+	struct VFile* vf = VFileMemChunk(NULL, 0);
+	assert_true(GBARRSetKeyframes(&test.movie.d, vf, TEST_INTERVAL));
+	_start(&test);
+	struct GBA* gba = test.core->board;
+	size_t i;
+	for (i = 0; i < nFrames; ++i) {
+		_runTo(&test, frames[i]);
+		mCoreHashState(test.core, hashes[i]);
+		savedata[i] = malloc(SIZE_CART_SRAM);
+		memcpy(savedata[i], gba->memory.savedata.data, SIZE_CART_SRAM);
+	}
+	_runTo(&test, TEST_FRAMES);
+	assert_int_equal(GBARRKeyframeCount(&test.movie.d), TEST_KEYFRAMES);
+	struct VFile* copy = _copyIndex(vf, 0);
+	_deinit(&test);
+	return copy;
+}
+
+M_TEST_DEFINE(keyframeSavedata) {
+	struct VFile* vf = _buildIndex(NULL, NULL, NULL, 0);
+	// The savedata changes before keyframes 3 and 5, so only those and the first keyframe carry it
+	ssize_t size = vf->size(vf);
+	assert_true(size > (ssize_t) (TEST_KEYFRAMES * sizeof(struct GBASerializedState) + 3 * SIZE_CART_SRAM));
+	assert_true(size < (ssize_t) (TEST_KEYFRAMES * sizeof(struct GBASerializedState) + 4 * SIZE_CART_SRAM));
+	vf->close(vf);
+}
+
+M_TEST_DEFINE(keyframeSeek) {
+	static const uint32_t frames[] = { 12, 35, 47 };
+	uint64_t hashes[3][2];
+	uint8_t* savedata[3];
+	struct VFile* vf = _buildIndex(hashes, savedata, frames, 3);
+
+	struct GBARRTest test;
+	_init(&test, 25, 41);
+	assert_true(GBARRSetKeyframes(&test.movie.d, vf, TEST_INTERVAL));
+	assert_int_equal(GBARRKeyframeCount(&test.movie.d), TEST_KEYFRAMES);
+	_start(&test);
+	_runTo(&test, TEST_FRAMES);
+	assert_false(test.movie.playing);
+
+	struct GBA* gba = test.core->board;
+	uint64_t hash[2];
+	// Back from the end, which restarts playback, then back past a save, then forward past a keyframe
+	static const size_t order[] = { 1, 0, 2 };
+	size_t i;
+	for (i = 0; i < 3; ++i) {
+		size_t frame = order[i];
+		assert_true(GBARRSeek(gba, frames[frame]));
+		assert_int_equal(test.movie.d.currentFrame, frames[frame]);
+		mCoreHashState(test.core, hash);
+		assert_memory_equal(hash, hashes[frame], sizeof(hash));
+		assert_memory_equal(gba->memory.savedata.data, savedata[frame], SIZE_CART_SRAM);
+	}
+	// Seeking within a keyframe interval runs ahead without reloading
+	assert_true(GBARRSeek(gba, frames[2] + 2));
+	assert_int_equal(test.movie.d.currentFrame, frames[2] + 2);
+
+	for (i = 0; i < 3; ++i) {
+		free(savedata[i]);
+	}
+	_deinit(&test);
+}
+
+M_TEST_DEFINE(keyframeReuse) {
+	struct VFile* vf = _buildIndex(NULL, NULL, NULL, 0);
+	ssize_t size = vf->size(vf);
+
+	// A keyframe cut short by an interrupted run is dropped, and playing again leaves the rest alone
+	struct GBARRTest test;
+	_init(&test, 25, 41);
+	assert_true(GBARRSetKeyframes(&test.movie.d, _copyIndex(vf, 0x100), TEST_INTERVAL));
+	assert_int_equal(GBARRKeyframeCount(&test.movie.d), TEST_KEYFRAMES);
+	assert_int_equal(test.movie.d.keyframes->size(test.movie.d.keyframes), size);
+	_start(&test);
+	_runTo(&test, TEST_FRAMES);
+	assert_int_equal(GBARRKeyframeCount(&test.movie.d), TEST_KEYFRAMES);
+	assert_int_equal(test.movie.d.keyframes->size(test.movie.d.keyframes), size);
+	_deinit(&test);
+
+	// Keyframes taken at another interval are thrown out, unless only verifying
+	_init(&test, 25, 41);
+	test.movie.d.verifyKeyframes = true;
+	struct VFile* copy = _copyIndex(vf, 0);
+	assert_false(GBARRSetKeyframes(&test.movie.d, copy, TEST_INTERVAL / 2));
+	copy->close(copy);
+	test.movie.d.verifyKeyframes = false;
+	assert_true(GBARRSetKeyframes(&test.movie.d, _copyIndex(vf, 0), TEST_INTERVAL / 2));
+	assert_int_equal(GBARRKeyframeCount(&test.movie.d), 0);
+	_deinit(&test);
+
+	vf->close(vf);
+}
+
+M_TEST_DEFINE(keyframeVerify) {
+	struct VFile* vf = _buildIndex(NULL, NULL, NULL, 0);
+	struct GBARRTest test;
+	uint32_t i;
+
+	_init(&test, 25, 41);
+	test.movie.d.verifyKeyframes = true;
+	assert_true(GBARRSetKeyframes(&test.movie.d, _copyIndex(vf, 0), TEST_INTERVAL));
+	_start(&test);
+	struct GBA* gba = test.core->board;
+	for (i = 0; i < TEST_KEYFRAMES; ++i) {
+		assert_true(GBARRVerifySegment(gba, i));
+	}
+	assert_int_equal(test.movie.d.keyframeMismatches, 0);
+	_deinit(&test);
+
+	// Saving at another time changes both the state and the savedata from keyframe 2 on
+	_init(&test, 15, 41);
+	test.movie.d.verifyKeyframes = true;
+	assert_true(GBARRSetKeyframes(&test.movie.d, _copyIndex(vf, 0), TEST_INTERVAL));
+	_start(&test);
+	gba = test.core->board;
+	assert_true(GBARRVerifySegment(gba, 0));
+	assert_false(GBARRVerifySegment(gba, 1));
+	_deinit(&test);
+
+	vf->close(vf);
+}
+
+M_TEST_SUITE_DEFINE(GBARR,
+	cmocka_unit_test(keyframeSavedata),
+	cmocka_unit_test(keyframeSeek),
+	cmocka_unit_test(keyframeReuse),
+	cmocka_unit_test(keyframeVerify))
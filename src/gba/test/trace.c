@@ -0,0 +1,84 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba/core/core.h>
+#include <mgba/gba/core.h>
+#include <mgba/internal/arm/trace.h>
+#include <mgba-util/vfs.h>
+
+#define STEPS 8
+
+static const uint8_t _rom[] = {
+	0x05, 0x00, 0xA0, 0xE3, // mov r0, #5
+	0x01, 0x10, 0x80, 0xE2, // add r1, r0, #1
+	0x01, 0x20, 0x8F, 0xE2, // add r2, pc, #1
+	0x12, 0xFF, 0x2F, 0xE1, // bx r2
+	0x07, 0x20, // movs r0, #7
+	0x01, 0x30, // adds r0, #1
+	0xFE, 0xE7, // b .
+};
+
+M_TEST_DEFINE(recordAndParse) {
+	uint8_t rom[0x200] = { 0 };
+	memcpy(rom, _rom, sizeof(_rom));
+	struct mCore* core = GBACoreCreate();
+	assert_non_null(core);
+	assert_true(core->init(core));
+	mCoreInitConfig(core, NULL);
+	assert_true(core->loadROM(core, VFileFromConstMemory(rom, sizeof(rom))));
+	core->opts.skipBios = true;
+	core->reset(core);
+
+	struct VFile* vf = VFileMemChunk(NULL, 0);
+	struct ARMTracer tracer;
+	assert_true(ARMTracerInit(&tracer, vf, ARM_TRACE_FLAG_REGISTERS));
+	ARMTracerAttach(&tracer, core->cpu, core->timing);
+
+	struct ARMCore* cpu = core->cpu;
+	int32_t expected[STEPS][ARM_TRACE_REGISTERS];
+	uint32_t expectedAddress[STEPS];
+	size_t i;
+	for (i = 0; i < STEPS; ++i) {
+		memcpy(expected[i], cpu->gprs, sizeof(int32_t) * ARM_TRACE_CPSR);
+		expected[i][ARM_TRACE_CPSR] = cpu->cpsr.packed;
+		expectedAddress[i] = cpu->executionMode == MODE_THUMB ? (cpu->gprs[ARM_PC] - WORD_SIZE_THUMB) | 1 : cpu->gprs[ARM_PC] - WORD_SIZE_ARM;
+		core->step(core);
+	}
+	ARMTracerDetach(&tracer, core->cpu);
+	assert_int_equal(tracer.records, STEPS);
+	assert_false(tracer.failed);
+	ARMTracerDeinit(&tracer);
+
+	size_t size = vf->size(vf);
+	const uint8_t* data = vf->map(vf, size, MAP_READ);
+	struct ARMTraceHeader header;
+	assert_true(ARMTraceParseHeader(data, size, &header));
+	assert_int_equal(header.flags, ARM_TRACE_FLAG_REGISTERS);
+
+	int32_t registers[ARM_TRACE_REGISTERS] = { 0 };
+	size_t offset = sizeof(header);
+	for (i = 0; i < STEPS; ++i) {
+		struct ARMTraceRecord record;
+		size_t length = ARMTraceParseRecord(&data[offset], size - offset, &record, registers);
+		assert_int_not_equal(length, 0);
+		offset += length;
+		assert_int_equal(record.address, expectedAddress[i]);
+		assert_memory_equal(registers, expected[i], sizeof(registers));
+	}
+	assert_int_equal(offset, size);
+	assert_int_equal(expectedAddress[0], 0x08000000);
+	assert_int_equal(expectedAddress[4], 0x08000011);
+	assert_int_equal(expectedAddress[6], 0x08000015);
+
+	vf->unmap(vf, (void*) data, size);
+	vf->close(vf);
+	mCoreConfigDeinit(&core->config);
+	core->deinit(core);
+}
+
+M_TEST_SUITE_DEFINE(ARMTrace,
+	cmocka_unit_test(recordAndParse))
@@ -0,0 +1,179 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba/core/config.h>
+#include <mgba/core/core.h>
+#include <mgba/core/profile.h>
+#include <mgba/gba/core.h>
+#include <mgba/internal/arm/macros.h>
+#include <mgba/internal/gba/gba.h>
+#include <mgba/internal/gba/io.h>
+#include <mgba/internal/gba/serialize.h>
+#include <mgba-util/vfs.h>
+
+#define TEST_FRAMES 24
+
+static const uint8_t _spinRom[] = {
+	0xFE, 0xFF, 0xFF, 0xEA, // b .
+};
+
+static const uint8_t _pollRom[] = {
+	0x01, 0x13, 0xA0, 0xE3, // mov r1, #0x04000000
+	0xB6, 0x00, 0xD1, 0xE1, // ldrh r0, [r1, #6]
+	0xFD, 0xFF, 0xFF, 0xEA, // b 4
+};
+
+struct GBAVideoTest {
+	struct mCore* core;
+	struct mProfile profile;
+	uint8_t rom[0x200];
+	color_t* buffer;
+	uint8_t* state;
+};
+
+static void _init(struct GBAVideoTest* test, const uint8_t* rom, size_t size, bool lazy) {
+	memset(test->rom, 0, sizeof(test->rom));
+	memcpy(test->rom, rom, size);
+	test->core = GBACoreCreate();
+	assert_non_null(test->core);
+	assert_true(test->core->init(test->core));
+	mCoreInitConfig(test->core, NULL);
+	mCoreConfigSetIntValue(&test->core->config, "lazyVideo", lazy);
+	mCoreConfigSetIntValue(&test->core->config, "lazyAudio", lazy);
+	mCoreLoadConfig(test->core);
+	test->buffer = calloc(VIDEO_HORIZONTAL_PIXELS * VIDEO_VERTICAL_PIXELS, BYTES_PER_PIXEL);
+	test->core->setVideoBuffer(test->core, test->buffer, VIDEO_HORIZONTAL_PIXELS);
+	assert_true(test->core->loadROM(test->core, VFileFromConstMemory(test->rom, sizeof(test->rom))));
+	test->core->opts.skipBios = true;
+	test->core->reset(test->core);
+	mProfileInit(&test->profile);
+	test->core->setProfile(test->core, &test->profile);
+	test->state = malloc(test->core->stateSize(test->core));
+}
+
+static void _deinit(struct GBAVideoTest* test) {
+	free(test->state);
+	mCoreConfigDeinit(&test->core->config);
+	test->core->deinit(test->core);
+	free(test->buffer);
+}
+
+// Lazy timing dispatches fewer events, so the split between master cycles and cycles since
+// the last event differs, as does the distance to the next event; only the sum must match
+static void _normalize(uint8_t* buffer) {
+	struct GBASerializedState* state = (struct GBASerializedState*) buffer;
+	uint32_t masterCycles;
+	int32_t cycles;
+	LOAD_32(masterCycles, 0, &state->masterCycles);
+	LOAD_32(cycles, 0, &state->cpu.cycles);
+	STORE_32(masterCycles + cycles, 0, &state->masterCycles);
+	STORE_32(0, 0, &state->cpu.cycles);
+	STORE_32(0, 0, &state->cpu.nextEvent);
+}
+
+static void _act(struct mCore* core, int frame) {
+	switch (frame) {
+	case 2:
+		core->enableOutput(core, false, true);
+		break;
+	case 4:
+		core->busWrite16(core, BASE_IO | REG_DISPSTAT, 0x0008);
+		break;
+	case 6:
+		core->busWrite16(core, BASE_IO | REG_DISPSTAT, 0x6428);
+		break;
+	case 8:
+		core->busWrite32(core, BASE_IO | REG_DMA3SAD_LO, BASE_WORKING_IRAM);
+		core->busWrite32(core, BASE_IO | REG_DMA3DAD_LO, BASE_WORKING_RAM);
+		core->busWrite16(core, BASE_IO | REG_DMA3CNT_LO, 1);
+		core->busWrite16(core, BASE_IO | REG_DMA3CNT_HI, 0xA360);
+		break;
+	case 11:
+		core->busWrite16(core, BASE_IO | REG_DMA3CNT_HI, 0);
+		break;
+	case 13:
+		core->busWrite16(core, BASE_IO | REG_DISPSTAT, 0x0010);
+		break;
+	case 15:
+		core->busWrite16(core, BASE_IO | REG_DISPSTAT, 0);
+		core->busWrite16(core, BASE_IO | REG_DMA3CNT_HI, 0xB160);
+		break;
+	case 18:
+		core->busWrite16(core, BASE_IO | REG_DMA3CNT_HI, 0);
+		core->enableOutput(core, true, true);
+		break;
+	case 20:
+		core->busWrite16(core, BASE_IO | REG_DISPSTAT, 0x9F20);
+		break;
+	}
+}
+
+static void _compare(const uint8_t* rom, size_t size) {
+	struct GBAVideoTest eager;
+	struct GBAVideoTest lazy;
+	_init(&eager, rom, size, false);
+	_init(&lazy, rom, size, true);
+	size_t stateSize = eager.core->stateSize(eager.core);
+	assert_int_equal(stateSize, lazy.core->stateSize(lazy.core));
+
+	int frame;
+	for (frame = 0; frame < TEST_FRAMES; ++frame) {
+		// Act partway into the frame, so changes land between scanline events
+		int steps = (frame % 7) * 2000;
+		int i;
+		for (i = 0; i < steps; ++i) {
+			eager.core->step(eager.core);
+			lazy.core->step(lazy.core);
+		}
+		// Hashing has to see the same registers a savestate would, even if nothing has caught up yet
+		uint64_t eagerHash[2];
+		uint64_t lazyHash[2];
+		mCoreHashState(eager.core, eagerHash);
+		mCoreHashState(lazy.core, lazyHash);
+		assert_memory_equal(eagerHash, lazyHash, sizeof(eagerHash));
+		assert_int_equal(eager.core->busRead16(eager.core, BASE_IO | REG_VCOUNT), lazy.core->busRead16(lazy.core, BASE_IO | REG_VCOUNT));
+		_act(eager.core, frame);
+		_act(lazy.core, frame);
+
+		assert_true(eager.core->saveState(eager.core, eager.state));
+		assert_true(lazy.core->saveState(lazy.core, lazy.state));
+		// Loading a state must pick up lazy scheduling from where it left off
+		assert_true(lazy.core->loadState(lazy.core, lazy.state));
+		_normalize(eager.state);
+		_normalize(lazy.state);
+		assert_memory_equal(eager.state, lazy.state, stateSize);
+
+		eager.core->runFrame(eager.core);
+		lazy.core->runFrame(lazy.core);
+		assert_true(eager.core->saveState(eager.core, eager.state));
+		assert_true(lazy.core->saveState(lazy.core, lazy.state));
+		_normalize(eager.state);
+		_normalize(lazy.state);
+		assert_memory_equal(eager.state, lazy.state, stateSize);
+		assert_memory_equal(eager.buffer, lazy.buffer, VIDEO_HORIZONTAL_PIXELS * VIDEO_VERTICAL_PIXELS * BYTES_PER_PIXEL);
+	}
+	struct GBA* gba = lazy.core->board;
+	assert_true(gba->memory.io[REG_IF >> 1] & (1 << IRQ_VCOUNTER));
+	assert_true(gba->memory.io[REG_IF >> 1] & (1 << IRQ_HBLANK));
+	// Nothing observes the frame while it's spinning without output, so it should take fewer events
+	assert_true(mProfileTotalEvents(&lazy.profile) < mProfileTotalEvents(&eager.profile));
+
+	_deinit(&eager);
+	_deinit(&lazy);
+}
+
+M_TEST_DEFINE(lazySpin) {
+	_compare(_spinRom, sizeof(_spinRom));
+}
+
+M_TEST_DEFINE(lazyPoll) {
+	_compare(_pollRom, sizeof(_pollRom));
+}
+
+M_TEST_SUITE_DEFINE(GBAVideo,
+	cmocka_unit_test(lazySpin),
+	cmocka_unit_test(lazyPoll))
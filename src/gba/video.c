@@ -32,6 +32,9 @@ static void GBAVideoDummyRendererPutPixels(struct GBAVideoRenderer* renderer, si
 
 static void _startHblank(struct mTiming*, void* context, uint32_t cyclesLate);
 static void _startHdraw(struct mTiming*, void* context, uint32_t cyclesLate);
+static void _lazyBoundary(struct mTiming*, void* context, uint32_t cyclesLate);
+static void _scheduleBoundary(struct GBAVideo* video, struct mTiming* timing, bool hblank, int32_t when);
+static void _scheduleLazy(struct GBAVideo* video, struct mTiming* timing);
 
 const int GBAVideoObjSizes[16][2] = {
 	{ 8, 8 },
@@ -75,6 +78,7 @@ void GBAVideoInit(struct GBAVideo* video) {
 	video->event.callback = NULL;
 	video->event.context = video;
 	video->event.priority = 8;
+	video->lazyTiming = false;
 }
 
 void GBAVideoReset(struct GBAVideo* video) {
@@ -88,11 +92,10 @@ void GBAVideoReset(struct GBAVideo* video) {
 	}
 	video->p->memory.io[REG_VCOUNT >> 1] = video->vcount;
 
-	video->event.callback = _startHblank;
-	mTimingSchedule(&video->p->timing, &video->event, nextEvent);
-
 	video->frameCounter = 0;
 	video->frameskipCounter = 0;
+	_scheduleBoundary(video, &video->p->timing, true, nextEvent);
+
 	video->renderer->vram = video->vram;
 
 	memset(video->palette, 0, sizeof(video->palette));
@@ -121,14 +124,13 @@ void _startHdraw(struct mTiming* timing, void* context, uint32_t cyclesLate) {
 	struct GBAVideo* video = context;
 	GBARegisterDISPSTAT dispstat = video->p->memory.io[REG_DISPSTAT >> 1];
 	dispstat = GBARegisterDISPSTATClearInHblank(dispstat);
-	video->event.callback = _startHblank;
-	mTimingSchedule(timing, &video->event, VIDEO_HDRAW_LENGTH - cyclesLate);
 
 	++video->vcount;
 	if (video->vcount == VIDEO_VERTICAL_TOTAL_PIXELS) {
 		video->vcount = 0;
 	}
 	video->p->memory.io[REG_VCOUNT >> 1] = video->vcount;
+	_scheduleBoundary(video, timing, true, VIDEO_HDRAW_LENGTH - cyclesLate);
 
 	if (video->vcount == GBARegisterDISPSTATGetVcountSetting(dispstat)) {
 		dispstat = GBARegisterDISPSTATFillVcounter(dispstat);
@@ -172,8 +174,7 @@ void _startHblank(struct mTiming* timing, void* context, uint32_t cyclesLate) {
 	struct GBAVideo* video = context;
 	GBARegisterDISPSTAT dispstat = video->p->memory.io[REG_DISPSTAT >> 1];
 	dispstat = GBARegisterDISPSTATFillInHblank(dispstat);
-	video->event.callback = _startHdraw;
-	mTimingSchedule(timing, &video->event, VIDEO_HBLANK_LENGTH - cyclesLate);
+	_scheduleBoundary(video, timing, false, VIDEO_HBLANK_LENGTH - cyclesLate);
 
 	// Begin Hblank
 	dispstat = GBARegisterDISPSTATFillInHblank(dispstat);
@@ -193,10 +194,152 @@ void _startHblank(struct mTiming* timing, void* context, uint32_t cyclesLate) {
 	video->p->memory.io[REG_DISPSTAT >> 1] = dispstat;
 }
 
+static bool _isHblankObserved(const struct GBAVideo* video, GBARegisterDISPSTAT dispstat, int vcount) {
+	if (GBARegisterDISPSTATIsHblankIRQ(dispstat)) {
+		return true;
+	}
+	const struct GBADMA* dma = video->p->memory.dma;
+	if (vcount < VIDEO_VERTICAL_PIXELS) {
+		if (video->frameskipCounter <= 0) {
+			return true;
+		}
+		int i;
+		for (i = 0; i < 4; ++i) {
+			if (GBADMARegisterIsEnable(dma[i].reg) && GBADMARegisterGetTiming(dma[i].reg) == GBA_DMA_TIMING_HBLANK) {
+				return true;
+			}
+		}
+	}
+	if (vcount >= 2 && vcount < VIDEO_VERTICAL_PIXELS + 2) {
+		if (GBADMARegisterIsEnable(dma[3].reg) && GBADMARegisterGetTiming(dma[3].reg) == GBA_DMA_TIMING_CUSTOM) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool _isHdrawObserved(GBARegisterDISPSTAT dispstat, int vcount) {
+	if (vcount == 0 || vcount == VIDEO_VERTICAL_PIXELS) {
+		return true;
+	}
+	return GBARegisterDISPSTATIsVcounterIRQ(dispstat) && vcount == GBARegisterDISPSTATGetVcountSetting(dispstat);
+}
+
+// Applies the register side effects of the next boundary without running its event
+static void _skipBoundary(struct GBAVideo* video) {
+	GBARegisterDISPSTAT dispstat = video->p->memory.io[REG_DISPSTAT >> 1];
+	if (video->nextHblank) {
+		dispstat = GBARegisterDISPSTATFillInHblank(dispstat);
+		video->nextBoundary += VIDEO_HBLANK_LENGTH;
+	} else {
+		dispstat = GBARegisterDISPSTATClearInHblank(dispstat);
+		++video->vcount;
+		if (video->vcount == VIDEO_VERTICAL_TOTAL_PIXELS) {
+			video->vcount = 0;
+		}
+		video->p->memory.io[REG_VCOUNT >> 1] = video->vcount;
+		if (video->vcount == GBARegisterDISPSTATGetVcountSetting(dispstat)) {
+			dispstat = GBARegisterDISPSTATFillVcounter(dispstat);
+		} else {
+			dispstat = GBARegisterDISPSTATClearVcounter(dispstat);
+		}
+		if (video->vcount == VIDEO_VERTICAL_TOTAL_PIXELS - 1) {
+			dispstat = GBARegisterDISPSTATClearInVblank(dispstat);
+		}
+		video->nextBoundary += VIDEO_HDRAW_LENGTH;
+	}
+	video->nextHblank = !video->nextHblank;
+	video->p->memory.io[REG_DISPSTAT >> 1] = dispstat;
+}
+
+void _lazyBoundary(struct mTiming* timing, void* context, uint32_t cyclesLate) {
+	struct GBAVideo* video = context;
+	while (video->nextBoundary != video->event.when) {
+		_skipBoundary(video);
+	}
+	if (video->nextHblank) {
+		_startHblank(timing, context, cyclesLate);
+	} else {
+		_startHdraw(timing, context, cyclesLate);
+	}
+}
+
+void _scheduleBoundary(struct GBAVideo* video, struct mTiming* timing, bool hblank, int32_t when) {
+	video->nextBoundary = mTimingCurrentTime(timing) + when;
+	video->nextHblank = hblank;
+	if (video->lazyTiming) {
+		_scheduleLazy(video, timing);
+		return;
+	}
+	video->event.callback = hblank ? _startHblank : _startHdraw;
+	mTimingSchedule(timing, &video->event, when);
+}
+
+void _scheduleLazy(struct GBAVideo* video, struct mTiming* timing) {
+	GBARegisterDISPSTAT dispstat = video->p->memory.io[REG_DISPSTAT >> 1];
+	uint32_t when = video->nextBoundary;
+	bool hblank = video->nextHblank;
+	int vcount = video->vcount;
+	// The walk always ends by the start of the next frame, since line 0 is observed
+	while (true) {
+		if (hblank) {
+			if (_isHblankObserved(video, dispstat, vcount)) {
+				break;
+			}
+			when += VIDEO_HBLANK_LENGTH;
+		} else {
+			++vcount;
+			if (vcount == VIDEO_VERTICAL_TOTAL_PIXELS) {
+				vcount = 0;
+			}
+			if (_isHdrawObserved(dispstat, vcount)) {
+				break;
+			}
+			when += VIDEO_HDRAW_LENGTH;
+		}
+		hblank = !hblank;
+	}
+	video->event.callback = _lazyBoundary;
+	mTimingSchedule(timing, &video->event, (int32_t) (when - mTimingCurrentTime(timing)));
+}
+
 void GBAVideoWriteDISPSTAT(struct GBAVideo* video, uint16_t value) {
+	GBAVideoRun(video, mTimingCurrentTime(&video->p->timing));
 	video->p->memory.io[REG_DISPSTAT >> 1] &= 0x7;
 	video->p->memory.io[REG_DISPSTAT >> 1] |= value;
 	// TODO: Does a VCounter IRQ trigger on write?
+	GBAVideoReschedule(video);
+}
+
+void GBAVideoSetLazyTiming(struct GBAVideo* video, bool enable) {
+	struct mTiming* timing = &video->p->timing;
+	GBAVideoRun(video, mTimingCurrentTime(timing));
+	video->lazyTiming = enable;
+	if (!mTimingIsScheduled(timing, &video->event)) {
+		return;
+	}
+	mTimingDeschedule(timing, &video->event);
+	_scheduleBoundary(video, timing, video->nextHblank, (int32_t) (video->nextBoundary - mTimingCurrentTime(timing)));
+}
+
+void GBAVideoRun(struct GBAVideo* video, uint32_t timestamp) {
+	if (!video->lazyTiming) {
+		return;
+	}
+	// The scheduled boundary is left for its event to run
+	while (video->nextBoundary != video->event.when && (int32_t) (timestamp - video->nextBoundary) >= 0) {
+		_skipBoundary(video);
+	}
+}
+
+void GBAVideoReschedule(struct GBAVideo* video) {
+	if (!video->lazyTiming) {
+		return;
+	}
+	struct mTiming* timing = &video->p->timing;
+	GBAVideoRun(video, mTimingCurrentTime(timing));
+	mTimingDeschedule(timing, &video->event);
+	_scheduleLazy(video, timing);
 }
 
 static void GBAVideoDummyRendererInit(struct GBAVideoRenderer* renderer) {
@@ -303,12 +446,12 @@ void GBAVideoSerialize(const struct GBAVideo* video, struct GBASerializedState*
 	memcpy(state->vram, video->vram, SIZE_VRAM);
 	memcpy(state->oam, video->oam.raw, SIZE_OAM);
 	memcpy(state->pram, video->palette, SIZE_PALETTE_RAM);
-	STORE_32(video->event.when - mTimingCurrentTime(&video->p->timing), 0, &state->video.nextEvent);
+	STORE_32(video->nextBoundary - mTimingCurrentTime(&video->p->timing), 0, &state->video.nextEvent);
 	STORE_32(video->frameCounter, 0, &state->video.frameCounter);
 }
 
 void GBAVideoDeserialize(struct GBAVideo* video, const struct GBASerializedState* state) {
-	memcpy(video->vram, state->vram, SIZE_VRAM);
+	DirtyBitmapCopy(&video->p->memory.dirtyVram, video->vram, state->vram, SIZE_VRAM);
 	uint16_t value;
 	int i;
 	for (i = 0; i < SIZE_OAM; i += 2) {
@@ -321,16 +464,16 @@ void GBAVideoDeserialize(struct GBAVideo* video, const struct GBASerializedState
 	}
 	LOAD_32(video->frameCounter, 0, &state->video.frameCounter);
 
+	LOAD_16(video->vcount, REG_VCOUNT, state->io);
+
+	// The real boundary is scheduled even with lazy timing, since the rest of the
+	// state it depends on hasn't been loaded yet; GBADeserialize reschedules after
 	uint32_t when;
 	LOAD_32(when, 0, &state->video.nextEvent);
 	GBARegisterDISPSTAT dispstat = state->io[REG_DISPSTAT >> 1];
-	if (GBARegisterDISPSTATIsInHblank(dispstat)) {
-		video->event.callback = _startHdraw;
-	} else {
-		video->event.callback = _startHblank;
-	}
+	video->nextHblank = !GBARegisterDISPSTATIsInHblank(dispstat);
+	video->nextBoundary = mTimingCurrentTime(&video->p->timing) + when;
+	video->event.callback = video->nextHblank ? _startHblank : _startHdraw;
 	mTimingSchedule(&video->p->timing, &video->event, when);
-
-	LOAD_16(video->vcount, REG_VCOUNT, state->io);
 	video->renderer->reset(video->renderer);
 }
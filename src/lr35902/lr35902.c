@@ -5,9 +5,11 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <mgba/internal/lr35902/lr35902.h>
 
+#include <mgba/core/profile.h>
 #include <mgba/internal/lr35902/isa-lr35902.h>
 
 void LR35902Init(struct LR35902Core* cpu) {
+	cpu->profile = NULL;
 	cpu->master->init(cpu, cpu->master);
 	size_t i;
 	for (i = 0; i < cpu->numComponents; ++i) {
@@ -117,6 +119,9 @@ static void _LR35902Step(struct LR35902Core* cpu) {
 		cpu->bus = cpu->memory.cpuLoad8(cpu, cpu->pc);
 		cpu->instruction = _lr35902InstructionTable[cpu->bus];
 		++cpu->pc;
+		if (cpu->profile) {
+			++cpu->profile->instructions[0].count;
+		}
 		break;
 	case LR35902_CORE_MEMORY_LOAD:
 		cpu->bus = cpu->memory.load8(cpu, cpu->index);
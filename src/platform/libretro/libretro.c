@@ -28,6 +28,7 @@
 
 #define SAMPLES 1024
 #define RUMBLE_PWM 35
+#define SERIALIZE_FLAGS (SAVESTATE_SAVEDATA | SAVESTATE_RTC)
 
 static retro_environment_t environCallback;
 static retro_video_refresh_t videoCallback;
@@ -53,6 +54,7 @@ static void* outputBuffer;
 static void* data;
 static size_t dataSize;
 static void* savedata;
+static size_t serializeSize;
 static struct mAVStream stream;
 static int rumbleUp;
 static int rumbleDown;
@@ -555,6 +557,9 @@ bool retro_load_game(const struct retro_game_info* game) {
 	core->reset(core);
 	_setupMaps(core);
 
+	// Run-ahead queries this every frame, so work it out once. Savedata never outgrows its buffer.
+	serializeSize = mCoreSaveStateBufferSize(core, SIZE_CART_FLASH1M, SERIALIZE_FLAGS);
+
 	return true;
 }
 
@@ -567,36 +572,19 @@ void retro_unload_game(void) {
 	data = 0;
 	mappedMemoryFree(savedata, SIZE_CART_FLASH1M);
 	savedata = 0;
+	serializeSize = 0;
 }
 
 size_t retro_serialize_size(void) {
-	struct VFile* vfm = VFileMemChunk(NULL, 0);
-	mCoreSaveStateNamed(core, vfm, SAVESTATE_SAVEDATA | SAVESTATE_RTC);
-	size_t size = vfm->size(vfm);
-	vfm->close(vfm);
-	return size;
+	return serializeSize;
 }
 
 bool retro_serialize(void* data, size_t size) {
-	struct VFile* vfm = VFileMemChunk(NULL, 0);
-	mCoreSaveStateNamed(core, vfm, SAVESTATE_SAVEDATA | SAVESTATE_RTC);
-	if ((ssize_t) size > vfm->size(vfm)) {
-		size = vfm->size(vfm);
-	} else if ((ssize_t) size < vfm->size(vfm)) {
-		vfm->close(vfm);
-		return false;
-	}
-	vfm->seek(vfm, 0, SEEK_SET);
-	vfm->read(vfm, data, size);
-	vfm->close(vfm);
-	return true;
+	return mCoreSaveStateBuffer(core, data, size, SERIALIZE_FLAGS);
 }
 
 bool retro_unserialize(const void* data, size_t size) {
-	struct VFile* vfm = VFileFromConstMemory(data, size);
-	bool success = mCoreLoadStateNamed(core, vfm, SAVESTATE_RTC);
-	vfm->close(vfm);
-	return success;
+	return mCoreLoadStateBuffer(core, data, size, SAVESTATE_RTC);
 }
 
 void retro_cheat_reset(void) {
@@ -44,6 +44,7 @@ void free(void*);
 #include <mgba/core/version.h>
 
 #define PYEXPORT extern "Python+C"
+#include "platform/python/batch.h"
 #include "platform/python/core.h"
 #include "platform/python/log.h"
 #include "platform/python/sio.h"
@@ -43,6 +43,7 @@ ffi.set_source("mgba._pylib", """
 #include <mgba-util/vfs.h>
 
 #define PYEXPORT
+#include "platform/python/batch.h"
 #include "platform/python/core.h"
 #include "platform/python/log.h"
 #include "platform/python/sio.h"
@@ -53,7 +54,7 @@ ffi.set_source("mgba._pylib", """
      libraries=["mgba"],
      library_dirs=[bindir],
      runtime_library_dirs=[libdir],
-     sources=[os.path.join(pydir, path) for path in ["vfs-py.c", "core.c", "log.c", "sio.c"]])
+     sources=[os.path.join(pydir, path) for path in ["vfs-py.c", "batch.c", "core.c", "log.c", "sio.c"]])
 
 preprocessed = subprocess.check_output(cpp + ["-fno-inline", "-P"] + cppflags + [os.path.join(pydir, "_builder.h")], universal_newlines=True)
 
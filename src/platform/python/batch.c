@@ -0,0 +1,138 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "flags.h"
+
+#include "batch.h"
+
+#include <mgba/core/core.h>
+#include <mgba-util/thread-pool.h>
+#include <mgba-util/vector.h>
+
+struct mCoreBatchRegion {
+	uint32_t address;
+	size_t size;
+	size_t offset;
+};
+
+DECLARE_VECTOR(mCoreBatchCoreList, struct mCore*);
+DEFINE_VECTOR(mCoreBatchCoreList, struct mCore*);
+DECLARE_VECTOR(mCoreBatchRegionList, struct mCoreBatchRegion);
+DEFINE_VECTOR(mCoreBatchRegionList, struct mCoreBatchRegion);
+
+struct mCoreBatch {
+	struct mCoreBatchCoreList cores;
+	struct mCoreBatchRegionList regions;
+	size_t regionSize;
+
+	unsigned frames;
+	const uint32_t* keys;
+	size_t keyFrames;
+	uint8_t* regionOut;
+
+	struct ThreadPool pool;
+};
+
+static void _copyRegions(struct mCoreBatch* batch, struct mCore* core, uint8_t* out) {
+	const struct mCoreMemoryBlock* blocks;
+	size_t nBlocks = core->listMemoryBlocks(core, &blocks);
+	size_t i;
+	for (i = 0; i < mCoreBatchRegionListSize(&batch->regions); ++i) {
+		const struct mCoreBatchRegion* region = mCoreBatchRegionListGetConstPointer(&batch->regions, i);
+		uint8_t* dest = &out[region->offset];
+		size_t copied = 0;
+		size_t b;
+		for (b = 0; b < nBlocks; ++b) {
+			if (blocks[b].flags & mCORE_MEMORY_VIRTUAL) {
+				continue;
+			}
+			if (region->address < blocks[b].start || region->address + region->size > blocks[b].end) {
+				continue;
+			}
+			size_t blockSize;
+			const uint8_t* block = core->getMemoryBlock(core, blocks[b].id, &blockSize);
+			size_t offset = region->address - blocks[b].start;
+			if (!block) {
+				continue;
+			}
+			if (offset < blockSize) {
+				copied = blockSize - offset;
+				if (copied > region->size) {
+					copied = region->size;
+				}
+				memcpy(dest, &block[offset], copied);
+			}
+			break;
+		}
+		if (b == nBlocks) {
+			// Not backed by a single block (e.g. I/O registers), so go through the bus without side effects
+			for (; copied < region->size; ++copied) {
+				dest[copied] = core->rawRead8(core, region->address + copied, -1);
+			}
+		}
+		memset(&dest[copied], 0, region->size - copied);
+	}
+}
+
+static void _runCore(void* context, size_t index) {
+	struct mCoreBatch* batch = context;
+	struct mCore* core = *mCoreBatchCoreListGetPointer(&batch->cores, index);
+	unsigned frame;
+	for (frame = 0; frame < batch->frames; ++frame) {
+		if (batch->keys) {
+			size_t keyFrame = frame < batch->keyFrames ? frame : batch->keyFrames - 1;
+			core->setKeys(core, batch->keys[index * batch->keyFrames + keyFrame]);
+		}
+		core->runFrame(core);
+	}
+	if (batch->regionOut) {
+		_copyRegions(batch, core, &batch->regionOut[index * batch->regionSize]);
+	}
+}
+
+struct mCoreBatch* mCoreBatchCreate(size_t threads) {
+	struct mCoreBatch* batch = calloc(1, sizeof(*batch));
+	mCoreBatchCoreListInit(&batch->cores, 0);
+	mCoreBatchRegionListInit(&batch->regions, 0);
+	ThreadPoolInit(&batch->pool, threads, "Core Batch Thread");
+	return batch;
+}
+
+void mCoreBatchDestroy(struct mCoreBatch* batch) {
+	ThreadPoolDeinit(&batch->pool);
+	mCoreBatchRegionListDeinit(&batch->regions);
+	mCoreBatchCoreListDeinit(&batch->cores);
+	free(batch);
+}
+
+size_t mCoreBatchAddCore(struct mCoreBatch* batch, struct mCore* core) {
+	*mCoreBatchCoreListAppend(&batch->cores) = core;
+	return mCoreBatchCoreListSize(&batch->cores) - 1;
+}
+
+size_t mCoreBatchAddRegion(struct mCoreBatch* batch, uint32_t address, size_t size) {
+	struct mCoreBatchRegion* region = mCoreBatchRegionListAppend(&batch->regions);
+	region->address = address;
+	region->size = size;
+	region->offset = batch->regionSize;
+	batch->regionSize += size;
+	return region->offset;
+}
+
+size_t mCoreBatchRegionSize(const struct mCoreBatch* batch) {
+	return batch->regionSize;
+}
+
+void mCoreBatchRun(struct mCoreBatch* batch, unsigned frames, const uint32_t* keys, size_t keyFrames, uint8_t* regions) {
+	size_t nCores = mCoreBatchCoreListSize(&batch->cores);
+	if (!nCores) {
+		return;
+	}
+	batch->frames = frames;
+	batch->keys = keyFrames ? keys : NULL;
+	batch->keyFrames = keyFrames;
+	batch->regionOut = batch->regionSize ? regions : NULL;
+	ThreadPoolRun(&batch->pool, nCores, _runCore, batch);
+}
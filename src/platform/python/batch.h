@@ -0,0 +1,20 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba-util/common.h>
+
+#include "pycommon.h"
+
+struct mCore;
+struct mCoreBatch;
+
+struct mCoreBatch* mCoreBatchCreate(size_t threads);
+void mCoreBatchDestroy(struct mCoreBatch*);
+
+size_t mCoreBatchAddCore(struct mCoreBatch*, struct mCore*);
+size_t mCoreBatchAddRegion(struct mCoreBatch*, uint32_t address, size_t size);
+size_t mCoreBatchRegionSize(const struct mCoreBatch*);
+
+void mCoreBatchRun(struct mCoreBatch*, unsigned frames, const uint32_t* keys, size_t keyFrames, uint8_t* regions);
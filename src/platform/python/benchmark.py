@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+# Copyright (c) 2013-2019 Jeffrey Pfau
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+"""Measures how many observations (one frame plus a frame buffer and memory
+readout) per second the Python bindings can produce with each access method."""
+import argparse
+import time
+
+import mgba.core
+import mgba.image
+import mgba.log
+from mgba.batch import CoreBatch
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+
+def load(path):
+    core = mgba.core.load_path(path)
+    if not core:
+        raise SystemExit("Could not load {}".format(path))
+    core.reset()
+    return core
+
+
+def bench_bus(core, block, size, frames):
+    # Per-access bus reads, and a frame copied out of an Image
+    memory = getattr(core.memory, block)
+    image = mgba.image.Image(*core.desired_video_dimensions())
+    core.set_video_buffer(image)
+    for _ in range(frames):
+        core.run_frame()
+        pixels = bytes(mgba.image.ffi.buffer(image.buffer))
+        ram = memory[0:size]
+
+
+def bench_copy(core, block, size, frames):
+    # Zero-copy views, copied out once per observation
+    memory = getattr(core.memory, block)
+    image = mgba.image.Image(*core.desired_video_dimensions())
+    core.set_video_buffer(image)
+    for _ in range(frames):
+        core.run_frame()
+        pixels = bytes(core.video_view())
+        ram = bytes(memory.view()[:size])
+
+
+def bench_view(core, block, size, frames):
+    # Zero-copy views handed straight to the consumer
+    memory = getattr(core.memory, block)
+    image = mgba.image.Image(*core.desired_video_dimensions())
+    core.set_video_buffer(image)
+    for _ in range(frames):
+        core.run_frame()
+        pixels = core.video_view()
+        ram = memory.view()[:size]
+        if numpy is not None:
+            pixels = numpy.asarray(pixels)
+            ram = numpy.asarray(ram)
+
+
+def bench_batch(cores, block, size, frames):
+    # Several cores stepped together on the native thread pool
+    batch = CoreBatch(cores, regions=[(getattr(cores[0].memory, block).base, size)])
+    for _ in range(frames):
+        batch.run()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("rom")
+    parser.add_argument("-f", "--frames", type=int, default=600, help="frames per method")
+    parser.add_argument("-b", "--block", default="vram", help="memory region to observe, e.g. wram, iwram, vram or oam")
+    parser.add_argument("-s", "--size", type=int, default=0x1000, help="bytes of the block to observe")
+    parser.add_argument("-n", "--cores", type=int, default=4, help="cores for the batch method")
+    args = parser.parse_args()
+
+    mgba.log.silence()
+    for name, method in (("bus", bench_bus), ("copy", bench_copy), ("view", bench_view)):
+        core = load(args.rom)
+        start = time.time()
+        method(core, args.block, args.size, args.frames)
+        elapsed = time.time() - start
+        print("{:>6}: {:10.1f} observations/s".format(name, args.frames / elapsed))
+
+    cores = [load(args.rom) for _ in range(args.cores)]
+    start = time.time()
+    bench_batch(cores, args.block, args.size, args.frames)
+    elapsed = time.time() - start
+    print("{:>6}: {:10.1f} observations/s ({} cores)".format("batch", args.frames * args.cores / elapsed, args.cores))
+
+
+if __name__ == "__main__":
+    main()
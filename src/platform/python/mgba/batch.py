@@ -0,0 +1,102 @@
+# Copyright (c) 2013-2019 Jeffrey Pfau
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+from ._pylib import ffi, lib  # pylint: disable=no-name-in-module
+import multiprocessing
+
+try:
+    import numpy
+except ImportError:
+    pass
+
+
+class CoreBatch(object):
+    """Steps several cores in lockstep on a native thread pool.
+
+    Each core renders straight into its slice of one contiguous frame buffer,
+    and the requested memory regions are copied into a second contiguous
+    buffer after every run, so nothing is allocated per frame. The GIL is
+    released for the whole run.
+    """
+
+    def __init__(self, cores, regions=(), threads=None):
+        self.cores = list(cores)
+        if not self.cores:
+            raise ValueError("CoreBatch needs at least one core")
+        for core in self.cores:
+            if not core._was_reset:
+                raise RuntimeError("Core must be reset first")
+        self.width, self.height = self.cores[0].desired_video_dimensions()
+        for core in self.cores[1:]:
+            if core.desired_video_dimensions() != (self.width, self.height):
+                raise ValueError("All cores in a batch must have the same video dimensions")
+
+        if threads is None:
+            threads = multiprocessing.cpu_count()
+        threads = max(1, min(threads, len(self.cores)))
+        self._native = ffi.gc(lib.mCoreBatchCreate(threads), lib.mCoreBatchDestroy)
+
+        frame_size = self.width * self.height
+        self._frame_buffer = ffi.new("color_t[]", frame_size * len(self.cores))
+        for index, core in enumerate(self.cores):
+            lib.mCoreBatchAddCore(self._native, core._core)
+            core._core.setVideoBuffer(core._core, self._frame_buffer + index * frame_size, self.width)
+
+        self._region_offsets = []
+        for address, size in regions:
+            self._region_offsets.append((lib.mCoreBatchAddRegion(self._native, address, size), size))
+        self.region_size = lib.mCoreBatchRegionSize(self._native)
+        if self.region_size:
+            self._region_buffer = ffi.new("uint8_t[]", self.region_size * len(self.cores))
+        else:
+            self._region_buffer = ffi.NULL
+
+        self._keys = ffi.new("uint32_t[]", len(self.cores))
+
+        if 'numpy' in globals():
+            dtype = numpy.uint16 if ffi.sizeof("color_t") == 2 else numpy.uint32
+            self.frames = numpy.frombuffer(ffi.buffer(self._frame_buffer), dtype=dtype)
+            self.frames = self.frames.reshape((len(self.cores), self.height, self.width))
+            if self.region_size:
+                region_bytes = numpy.frombuffer(ffi.buffer(self._region_buffer), dtype=numpy.uint8)
+                region_bytes = region_bytes.reshape((len(self.cores), self.region_size))
+                self.regions = [region_bytes[:, offset:offset + size] for offset, size in self._region_offsets]
+            else:
+                self.regions = []
+        else:
+            self.frames = memoryview(ffi.buffer(self._frame_buffer))
+            if self.region_size:
+                self.regions = memoryview(ffi.buffer(self._region_buffer))
+            else:
+                self.regions = None
+
+    def __len__(self):
+        return len(self.cores)
+
+    def run(self, frames=1, keys=None):
+        """Runs every core for `frames` frames.
+
+        `keys` is either one key bitmask per core, held for all frames, or, as
+        a 2D uint32 array shaped (cores, frames), one bitmask per core per
+        frame. Returns the frame and region views, which are updated in place.
+        """
+        key_frames = 0
+        key_buffer = ffi.NULL
+        if keys is not None:
+            if 'numpy' in globals() and isinstance(keys, numpy.ndarray):
+                keys = numpy.ascontiguousarray(keys, dtype=numpy.uint32)
+                if keys.shape[0] != len(self.cores):
+                    raise ValueError("Need keys for every core")
+                key_frames = keys.shape[1] if keys.ndim > 1 else 1
+                key_buffer = ffi.from_buffer("uint32_t[]", keys)
+            else:
+                if len(keys) != len(self.cores):
+                    raise ValueError("Need keys for every core")
+                for index, key in enumerate(keys):
+                    self._keys[index] = key
+                key_frames = 1
+                key_buffer = self._keys
+        lib.mCoreBatchRun(self._native, frames, key_buffer, key_frames, self._region_buffer)
+        return self.frames, self.regions
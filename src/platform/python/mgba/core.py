@@ -4,7 +4,8 @@
 # License, v. 2.0. If a copy of the MPL was not distributed with this
 # file, You can obtain one at http://mozilla.org/MPL/2.0/.
 from ._pylib import ffi, lib  # pylint: disable=no-name-in-module
-from . import tile, audio
+from . import tile, audio, image
+from .memory import block_view
 from cached_property import cached_property
 from functools import wraps
 
@@ -225,6 +226,23 @@ class Core(object):
     def set_video_buffer(self, image):
         self._core.setVideoBuffer(self._core, image.buffer, image.stride)
 
+    @protected
+    def video_view(self):
+        """Returns a writable memoryview shaped (height, stride) directly over the pixels the core renders into."""
+        buffer = ffi.new("const void**")
+        stride = ffi.new("size_t*")
+        self._core.getPixels(self._core, buffer, stride)
+        if buffer[0] == ffi.NULL:
+            raise RuntimeError("Core has no video buffer")
+        _, height = self.desired_video_dimensions()
+        pixels = ffi.buffer(ffi.cast("color_t*", buffer[0]), stride[0] * height * ffi.sizeof("color_t"))
+        return memoryview(pixels).cast(image.COLOR_FORMAT, (height, stride[0]))
+
+    @needs_reset
+    def memory_view(self, name):
+        """Returns a read-only memoryview directly over a memory block, such as "wram", "vram" or "oam"."""
+        return block_view(self._core, name)
+
     @protected
     def set_audio_buffer_size(self, size):
         self._core.setAudioBufferSize(self._core, size)
@@ -276,6 +294,14 @@ class Core(object):
             return state
         return None
 
+    @needs_reset
+    @protected
+    def state_hash(self):
+        """128-bit hash of the state the game can observe, comparable across machines"""
+        digest = ffi.new('uint64_t[2]')
+        lib.mCoreHashState(self._core, digest)
+        return digest[0] | (digest[1] << 64)
+
     @staticmethod
     def _keys_to_int(*args, **kwargs):
         keys = 0
@@ -27,6 +27,7 @@ class GB(Core):
         self.sprites = GBObjs(self)
         self.cpu = LR35902Core(self._core.cpu)
         self.memory = None
+        self._sio_attached = False
 
     @needs_reset
     def _init_cache(self, cache):
@@ -43,10 +44,12 @@ class GB(Core):
         self.memory = GBMemory(self._core)
 
     def attach_sio(self, link):
+        self._sio_attached = True
         lib.GBSIOSetDriver(ffi.addressof(self._native.sio), link._native)
 
     def __del__(self):
-        lib.GBSIOSetDriver(ffi.addressof(self._native.sio), ffi.NULL)
+        if self._sio_attached:
+            lib.GBSIOSetDriver(ffi.addressof(self._native.sio), ffi.NULL)
 
 
 create_callback("GBSIOPythonDriver", "init")
@@ -121,12 +124,12 @@ class GBMemory(Memory):
         super(GBMemory, self).__init__(core, 0x10000)
 
         self.cart = Memory(core, lib.GB_SIZE_CART_BANK0 * 2, lib.GB_BASE_CART_BANK0)
-        self.vram = Memory(core, lib.GB_SIZE_VRAM, lib.GB_BASE_VRAM)
-        self.sram = Memory(core, lib.GB_SIZE_EXTERNAL_RAM, lib.GB_REGION_EXTERNAL_RAM)
-        self.iwram = Memory(core, lib.GB_SIZE_WORKING_RAM_BANK0, lib.GB_BASE_WORKING_RAM_BANK0)
-        self.oam = Memory(core, lib.GB_SIZE_OAM, lib.GB_BASE_OAM)
+        self.vram = Memory(core, lib.GB_SIZE_VRAM, lib.GB_BASE_VRAM, block="vram")
+        self.sram = Memory(core, lib.GB_SIZE_EXTERNAL_RAM, lib.GB_REGION_EXTERNAL_RAM, block="sram")
+        self.iwram = Memory(core, lib.GB_SIZE_WORKING_RAM_BANK0, lib.GB_BASE_WORKING_RAM_BANK0, block="wram")
+        self.oam = Memory(core, lib.GB_SIZE_OAM, lib.GB_BASE_OAM, block="oam")
         self.io = Memory(core, lib.GB_SIZE_IO, lib.GB_BASE_IO)  # pylint: disable=invalid-name
-        self.hram = Memory(core, lib.GB_SIZE_HRAM, lib.GB_BASE_HRAM)
+        self.hram = Memory(core, lib.GB_SIZE_HRAM, lib.GB_BASE_HRAM, block="hram")
 
 
 class GBSprite(Sprite):
@@ -124,18 +124,18 @@ class GBAMemory(Memory):
         super(GBAMemory, self).__init__(core, 0x100000000)
 
         self.bios = Memory(core, lib.SIZE_BIOS, lib.BASE_BIOS)
-        self.wram = Memory(core, lib.SIZE_WORKING_RAM, lib.BASE_WORKING_RAM)
-        self.iwram = Memory(core, lib.SIZE_WORKING_IRAM, lib.BASE_WORKING_IRAM)
+        self.wram = Memory(core, lib.SIZE_WORKING_RAM, lib.BASE_WORKING_RAM, block="wram")
+        self.iwram = Memory(core, lib.SIZE_WORKING_IRAM, lib.BASE_WORKING_IRAM, block="iwram")
         self.io = Memory(core, lib.SIZE_IO, lib.BASE_IO)  # pylint: disable=invalid-name
-        self.palette = Memory(core, lib.SIZE_PALETTE_RAM, lib.BASE_PALETTE_RAM)
-        self.vram = Memory(core, lib.SIZE_VRAM, lib.BASE_VRAM)
-        self.oam = Memory(core, lib.SIZE_OAM, lib.BASE_OAM)
+        self.palette = Memory(core, lib.SIZE_PALETTE_RAM, lib.BASE_PALETTE_RAM, block="palette")
+        self.vram = Memory(core, lib.SIZE_VRAM, lib.BASE_VRAM, block="vram")
+        self.oam = Memory(core, lib.SIZE_OAM, lib.BASE_OAM, block="oam")
         self.cart0 = Memory(core, romSize, lib.BASE_CART0)
         self.cart1 = Memory(core, romSize, lib.BASE_CART1)
         self.cart2 = Memory(core, romSize, lib.BASE_CART2)
         self.cart = self.cart0
         self.rom = self.cart0
-        self.sram = Memory(core, lib.SIZE_CART_SRAM, lib.BASE_CART_SRAM)
+        self.sram = Memory(core, lib.SIZE_CART_SRAM, lib.BASE_CART_SRAM, block="sram")
 
 
 class GBASprite(Sprite):
@@ -11,6 +11,9 @@ try:
 except ImportError:
     pass
 
+# struct.pack format character matching color_t, used to shape buffer views
+COLOR_FORMAT = "H" if ffi.sizeof("color_t") == 2 else "I"
+
 
 class Image:
     def __init__(self, width, height, stride=0, alpha=False):
@@ -25,6 +28,10 @@ class Image:
             self.stride = self.width
         self.buffer = ffi.new("color_t[{}]".format(self.stride * self.height))
 
+    def view(self):
+        """Returns a writable memoryview shaped (height, stride) over the pixels, without copying."""
+        return memoryview(ffi.buffer(self.buffer)).cast(COLOR_FORMAT, (self.height, self.stride))
+
     def save_png(self, fileobj):
         png_file = png.PNG(fileobj, mode=png.MODE_RGBA if self.alpha else png.MODE_RGB)
         success = png_file.write_header(self)
@@ -6,6 +6,31 @@
 from ._pylib import ffi, lib  # pylint: disable=no-name-in-module
 
 
+def block_view(core, name):
+    """Returns a read-only memoryview directly over the backing store of the named memory block.
+
+    The view covers every bank of the block, not just the ones currently mapped, and
+    stays valid until the core is reset or deinitialized. Writing to the store directly
+    would skip the side effects a bus write has, so writes go through MemoryView instead.
+    Python versions before 3.8 cannot make a view read-only, so they get a copy instead.
+    """
+    blocks = ffi.new("const struct mCoreMemoryBlock**")
+    count = core.listMemoryBlocks(core, blocks)
+    for i in range(count):
+        block = blocks[0][i]
+        if ffi.string(block.internalName).decode("ascii") != name:
+            continue
+        size = ffi.new("size_t*")
+        data = core.getMemoryBlock(core, block.id, size)
+        if data == ffi.NULL:
+            break
+        view = memoryview(ffi.buffer(data, size[0]))
+        if not hasattr(view, "toreadonly"):
+            return memoryview(view.tobytes())
+        return view.toreadonly()
+    raise KeyError(name)
+
+
 class MemoryView(object):
     def __init__(self, core, width, size, base=0, sign="u"):
         self._core = core
@@ -111,10 +136,11 @@ class Memory(object):
     WRITE = lib.mCORE_MEMORY_READ
     RW = lib.mCORE_MEMORY_RW
 
-    def __init__(self, core, size, base=0):
+    def __init__(self, core, size, base=0, block=None):
         self.size = size
         self.base = base
         self._core = core
+        self._block = block
 
         self.u8 = MemoryView(core, 1, size, base, "u")
         self.u16 = MemoryView(core, 2, size, base, "u")
@@ -126,6 +152,11 @@ class Memory(object):
     def __len__(self):
         return self.size
 
+    def view(self):
+        if not self._block:
+            raise ValueError("Region has no backing memory block")
+        return block_view(self._core, self._block)
+
     def search(self, value, type=SEARCH_GUESS, flags=RW, limit=10000, old_results=[]):
         results = ffi.new("struct mCoreMemorySearchResults*")
         lib.mCoreMemorySearchResultsInit(results, len(old_results))
@@ -26,10 +26,10 @@ setup(
     extras_require={'pil': ['Pillow>=2.3'], 'cinema': ['pyyaml', 'pytest']},
     tests_require=['pytest'],
     cffi_modules=["_builder.py:ffi"],
+    python_requires=">=3.3",
     license="MPL 2.0",
     classifiers=[
         "Programming Language :: C",
-        "Programming Language :: Python :: 2",
         "Programming Language :: Python :: 3",
         "License :: OSI Approved :: Mozilla Public License 2.0 (MPL 2.0)",
         "Topic :: Games/Entertainment",
@@ -0,0 +1,71 @@
+import os.path
+import pytest
+
+import mgba.core
+import mgba.image
+import mgba.log
+from mgba._pylib import ffi  # pylint: disable=no-name-in-module
+from mgba.batch import CoreBatch
+
+mgba.log.install_default(mgba.log.NullLogger())
+
+ROM = os.path.join(os.path.dirname(__file__), '..', '..', '..', '..', '..', 'cinema', 'gb', 'mooneye-gb', 'emulator-only', 'mbc1', 'rom_1Mb', 'test.gb')
+
+pytestmark = pytest.mark.skipif(not os.path.exists(ROM), reason="Test ROM not found")
+
+FRAMES = 30
+KEYS = [0, 0x1, 0x80]
+
+
+def load_core():
+    core = mgba.core.load_path(ROM)
+    core.reset()
+    return core
+
+
+def run_batch(threads):
+    batch = CoreBatch([load_core() for _ in KEYS], regions=[(0xC000, 0x100), (0xFF80, 0x7F)], threads=threads)
+    batch.run(FRAMES, keys=KEYS)
+    return batch, bytes(ffi.buffer(batch._frame_buffer)), bytes(ffi.buffer(batch._region_buffer))
+
+
+def test_batch_matches_serial():
+    batch, frames, regions = run_batch(len(KEYS))
+    frame_bytes = len(frames) // len(KEYS)
+    assert batch.region_size == 0x17F
+
+    for index, keys in enumerate(KEYS):
+        core = load_core()
+        image = mgba.image.Image(*core.desired_video_dimensions())
+        core.set_video_buffer(image)
+        core._core.setKeys(core._core, keys)
+        for _ in range(FRAMES):
+            core.run_frame()
+        assert frames[index * frame_bytes:(index + 1) * frame_bytes] == bytes(ffi.buffer(image.buffer))
+
+        region = regions[index * batch.region_size:(index + 1) * batch.region_size]
+        assert region[:0x100] == bytes(core.memory.iwram[0:0x100])
+        assert region[0x100:] == bytes(core.memory.hram[0:0x7F])
+
+
+def test_batch_thread_count():
+    _, frames, regions = run_batch(1)
+    _, threaded_frames, threaded_regions = run_batch(3)
+    assert frames == threaded_frames
+    assert regions == threaded_regions
+
+
+def test_batch_per_frame_keys():
+    numpy = pytest.importorskip("numpy")
+    batch = CoreBatch([load_core() for _ in KEYS], regions=[(0xC000, 0x100)], threads=2)
+    keys = numpy.zeros((len(KEYS), FRAMES), dtype=numpy.uint32)
+    keys[:, FRAMES // 2:] = numpy.array(KEYS, dtype=numpy.uint32)[:, None]
+    frames, regions = batch.run(FRAMES, keys=keys)
+    assert frames.shape == (len(KEYS), batch.height, batch.width)
+    assert regions[0].shape == (len(KEYS), 0x100)
+
+    stepped = CoreBatch([load_core() for _ in KEYS], regions=[(0xC000, 0x100)], threads=2)
+    stepped.run(FRAMES // 2, keys=[0] * len(KEYS))
+    stepped_frames, stepped_regions = stepped.run(FRAMES - FRAMES // 2, keys=KEYS)
+    assert (frames == stepped_frames).all()
+    assert (regions[0] == stepped_regions[0]).all()
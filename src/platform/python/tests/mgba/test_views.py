@@ -0,0 +1,55 @@
+import os.path
+import pytest
+
+import mgba.core
+import mgba.image
+import mgba.log
+from mgba._pylib import ffi  # pylint: disable=no-name-in-module
+
+mgba.log.install_default(mgba.log.NullLogger())
+
+ROM = os.path.join(os.path.dirname(__file__), '..', '..', '..', '..', '..', 'cinema', 'gb', 'mooneye-gb', 'emulator-only', 'mbc1', 'rom_1Mb', 'test.gb')
+
+pytestmark = pytest.mark.skipif(not os.path.exists(ROM), reason="Test ROM not found")
+
+
+@pytest.fixture
+def core():
+    core = mgba.core.load_path(ROM)
+    core.reset()
+    image = mgba.image.Image(*core.desired_video_dimensions())
+    core.set_video_buffer(image)
+    core.image = image
+    for _ in range(10):
+        core.run_frame()
+    return core
+
+
+def test_video_view(core):
+    view = core.video_view()
+    assert view.shape == (core.image.height, core.image.stride)
+    assert view.tobytes() == bytes(ffi.buffer(core.image.buffer))
+    assert core.image.view().tobytes() == view.tobytes()
+
+    view[0, 0] = 0x1234
+    assert core.image.buffer[0] == 0x1234
+
+
+def test_memory_view(core):
+    for region in (core.memory.iwram, core.memory.vram, core.memory.oam, core.memory.hram):
+        view = region.view()
+        # Banked regions may be larger or smaller than the bus window depending on the model
+        size = min(len(view), len(region))
+        assert view[:size].tobytes() == bytes(region[0:size])
+
+    wram = core.memory_view("wram")
+    assert wram.readonly
+    with pytest.raises(TypeError):
+        wram[0x10] = 0x5A
+    core.memory.iwram.u8[0x10] = 0x5A
+    assert wram[0x10] == 0x5A
+
+    with pytest.raises(ValueError):
+        core.memory.io.view()
+    with pytest.raises(KeyError):
+        core.memory_view("nonexistent")
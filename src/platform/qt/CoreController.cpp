@@ -253,6 +253,7 @@ void CoreController::loadConfig(ConfigController* config) {
 	if (hasStarted()) {
 		updateFastForward();
 		mCoreThreadRewindParamsChanged(&m_threadContext);
+		mCoreThreadRunAheadParamsChanged(&m_threadContext);
 	}
 }
 
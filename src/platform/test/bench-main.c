@@ -0,0 +1,535 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/core/config.h>
+#include <mgba/core/core.h>
+#include <mgba/core/log.h>
+#include <mgba/core/mem-search.h>
+#include <mgba/core/rewind.h>
+#include <mgba/core/serialize.h>
+#include <mgba/core/timing.h>
+#include <mgba/core/version.h>
+
+#include <mgba/feature/commandline.h>
+#include <mgba-util/string.h>
+#include <mgba-util/vfs.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <sys/time.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#define BENCH_OPTIONS "EF:I:L:O:S:"
+#define BENCH_USAGE \
+	"\nBenchmark options:\n" \
+	"  -E               Count instructions and scheduler runs by single-stepping (slow)\n" \
+	"  -F FRAMES        Run each frame-based phase for FRAMES frames [default: 600]\n" \
+	"  -I COUNT         Repeat each iteration-based phase COUNT times [default: 100]\n" \
+	"  -L FILE          Load a savestate before each scenario\n" \
+	"  -O FILE          Write the JSON report to FILE instead of stdout\n" \
+	"  -S SCENARIOS     Comma-separated list of scenarios to run [default: all]\n" \
+	"\nScenarios: load, run, savestate, rewind, search, render"
+
+enum BenchScenario {
+	BENCH_LOAD = 1,
+	BENCH_RUN = 2,
+	BENCH_SAVESTATE = 4,
+	BENCH_REWIND = 8,
+	BENCH_SEARCH = 16,
+	BENCH_RENDER = 32,
+	BENCH_ALL = 63
+};
+
+enum BenchRenderer {
+	BENCH_RENDERER_SOFTWARE,
+	BENCH_RENDERER_THREADED,
+	BENCH_RENDERER_NONE
+};
+
+static const char* const _rendererNames[] = {
+	[BENCH_RENDERER_SOFTWARE] = "software",
+	[BENCH_RENDERER_THREADED] = "threaded-software",
+	[BENCH_RENDERER_NONE] = "none",
+};
+
+struct BenchOpts {
+	unsigned frames;
+	unsigned iterations;
+	char* savestate;
+	char* output;
+	int scenarios;
+	bool count;
+};
+
+struct BenchSample {
+	uint64_t usec;
+	uint64_t instructions;
+	uint64_t schedulerRuns;
+	uint32_t frames;
+	int64_t heapInUse;
+};
+
+struct BenchCounters {
+	uint64_t instructions;
+	uint64_t schedulerRuns;
+};
+
+struct BenchReport {
+	FILE* out;
+	bool firstPhase;
+};
+
+static bool _parseBenchOpts(struct mSubParser* parser, int option, const char* arg);
+static bool _parseScenarios(const char* arg, int* scenarios);
+static bool _benchRom(struct BenchReport*, const char* fname, const struct mArguments*, const struct BenchOpts*);
+static void _log(struct mLogger*, int, enum mLogLevel, const char*, va_list);
+
+static bool _dispatchExiting = false;
+static struct VFile* _savestate = NULL;
+static void* _outputBuffer = NULL;
+static struct BenchCounters* _counters = NULL;
+
+static void _benchShutdown(int signal) {
+	UNUSED(signal);
+	_dispatchExiting = true;
+}
+
+int main(int argc, char** argv) {
+	signal(SIGINT, _benchShutdown);
+	int didFail = 0;
+
+	struct mLogger logger = { .log = _log };
+	mLogSetDefaultLogger(&logger);
+
+	struct BenchOpts benchOpts = { 600, 100, NULL, NULL, BENCH_ALL, false };
+	struct mSubParser subparser = {
+		.usage = BENCH_USAGE,
+		.parse = _parseBenchOpts,
+		.extraOptions = BENCH_OPTIONS,
+		.opts = &benchOpts
+	};
+
+	struct mArguments args = {};
+	bool parsed = parseArguments(&args, argc, argv, &subparser);
+	if (!args.fname) {
+		parsed = false;
+	}
+	if (!parsed || args.showHelp) {
+		usage(argv[0], BENCH_USAGE);
+		didFail = !parsed;
+		goto cleanup;
+	}
+
+	if (args.showVersion) {
+		version(argv[0]);
+		goto cleanup;
+	}
+
+	if (benchOpts.savestate) {
+		_savestate = VFileOpen(benchOpts.savestate, O_RDONLY);
+		if (!_savestate) {
+			fprintf(stderr, "Could not open savestate %s\n", benchOpts.savestate);
+			didFail = 1;
+			goto cleanup;
+		}
+	}
+
+	struct BenchReport report = { stdout, true };
+	if (benchOpts.output) {
+		report.out = fopen(benchOpts.output, "w");
+		if (!report.out) {
+			fprintf(stderr, "Could not open %s for writing\n", benchOpts.output);
+			didFail = 1;
+			goto cleanup;
+		}
+	}
+
+	_outputBuffer = malloc(256 * 256 * 4);
+	struct BenchCounters counters = { 0, 0 };
+	if (benchOpts.count) {
+		_counters = &counters;
+	}
+	fprintf(report.out, "{\n\t\"version\": \"%s\",\n\t\"commit\": \"%s\",\n\t\"frames\": %u,\n\t\"iterations\": %u", projectVersion, gitCommit, benchOpts.frames, benchOpts.iterations);
+	didFail = !_benchRom(&report, args.fname, &args, &benchOpts);
+	fputs("\n}\n", report.out);
+	free(_outputBuffer);
+
+	if (report.out != stdout) {
+		fclose(report.out);
+	}
+
+	cleanup:
+	if (_savestate) {
+		_savestate->close(_savestate);
+	}
+	free(benchOpts.savestate);
+	free(benchOpts.output);
+	freeArguments(&args);
+
+	return didFail;
+}
+
+static int64_t _heapUsage(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2();
+	return (int64_t) info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+	struct mallinfo info = mallinfo();
+	return (int64_t) (unsigned) info.uordblks + (unsigned) info.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+static void _sample(struct mCore* core, struct BenchSample* sample) {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	sample->usec = 1000000LL * tv.tv_sec + tv.tv_usec;
+	sample->instructions = 0;
+	sample->schedulerRuns = 0;
+	sample->frames = 0;
+	sample->heapInUse = _heapUsage();
+	if (_counters) {
+		sample->instructions = _counters->instructions;
+		sample->schedulerRuns = _counters->schedulerRuns;
+	}
+	if (core) {
+		sample->frames = core->frameCounter(core);
+	}
+}
+
+static void _writeString(FILE* out, const char* string) {
+	fputc('"', out);
+	for (; *string; ++string) {
+		unsigned char c = *string;
+		if (c == '"' || c == '\\') {
+			fputc('\\', out);
+			fputc(c, out);
+		} else if (c < 0x20) {
+			fprintf(out, "\\u%04x", c);
+		} else {
+			fputc(c, out);
+		}
+	}
+	fputc('"', out);
+}
+
+static void _reportPhase(struct BenchReport* report, const char* name, enum BenchRenderer renderer, unsigned iterations, const struct BenchSample* start, const struct BenchSample* end) {
+	uint64_t duration = end->usec - start->usec;
+	fprintf(report->out, "%s\n\t\t{ \"name\": \"%s\", \"renderer\": \"%s\", \"iterations\": %u, \"frames\": %" PRIi32 ", \"duration_us\": %" PRIu64,
+	        report->firstPhase ? "" : ",", name, _rendererNames[renderer], iterations, (int32_t) (end->frames - start->frames), duration);
+	if (_counters) {
+		fprintf(report->out, ", \"instructions\": %" PRIu64 ", \"scheduler_runs\": %" PRIu64,
+		        end->instructions - start->instructions, end->schedulerRuns - start->schedulerRuns);
+	}
+	// Bytes in use on the heap at the end minus at the start, not a count of allocations
+	fprintf(report->out, ", \"heap_delta_bytes\": %" PRIi64, end->heapInUse - start->heapInUse);
+	if (duration) {
+		fprintf(report->out, ", \"per_second\": %.2f", iterations * 1000000.0 / duration);
+	}
+	fputs(" }", report->out);
+	report->firstPhase = false;
+}
+
+static struct mCore* _benchLoad(const char* fname, const struct mArguments* args, enum BenchRenderer renderer) {
+	struct mCore* core = mCoreFind(fname);
+	if (!core) {
+		return NULL;
+	}
+	core->init(core);
+	if (renderer != BENCH_RENDERER_NONE) {
+		core->setVideoBuffer(core, _outputBuffer, 256);
+	}
+	if (!mCoreLoadFile(core, fname)) {
+		core->deinit(core);
+		return NULL;
+	}
+	mCoreConfigInit(&core->config, "bench");
+	mCoreConfigLoad(&core->config);
+	mCoreConfigSetOverrideIntValue(&core->config, "threadedVideo", renderer == BENCH_RENDERER_THREADED);
+
+	struct mCoreOptions opts = {};
+	mCoreConfigMap(&core->config, &opts);
+	opts.audioSync = false;
+	opts.videoSync = false;
+	applyArguments(args, NULL, &core->config);
+	mCoreConfigLoadDefaults(&core->config, &opts);
+	mCoreConfigSetDefaultValue(&core->config, "idleOptimization", "detect");
+	mCoreLoadConfig(core);
+	mCoreConfigFreeOpts(&opts);
+
+	core->reset(core);
+	if (_savestate) {
+		_savestate->seek(_savestate, 0, SEEK_SET);
+		mCoreLoadStateNamed(core, _savestate, 0);
+	}
+	return core;
+}
+
+static void _benchUnload(struct mCore* core) {
+	mCoreConfigDeinit(&core->config);
+	core->deinit(core);
+}
+
+static void _runFrame(struct mCore* core) {
+	if (!_counters) {
+		core->runFrame(core);
+		return;
+	}
+	// Step one instruction at a time so the cores need no counters of their own. The
+	// scheduler advances masterCycles only when it runs, which marks each pass over due events.
+	int32_t frame = core->frameCounter(core);
+	uint32_t masterCycles = core->timing->masterCycles;
+	while (core->frameCounter(core) == frame && !_dispatchExiting) {
+		core->step(core);
+		++_counters->instructions;
+		if (core->timing->masterCycles != masterCycles) {
+			masterCycles = core->timing->masterCycles;
+			++_counters->schedulerRuns;
+		}
+	}
+}
+
+static unsigned _runFrames(struct mCore* core, unsigned frames) {
+	unsigned i;
+	for (i = 0; i < frames && !_dispatchExiting; ++i) {
+		_runFrame(core);
+	}
+	return i;
+}
+
+static void _benchSavestate(struct BenchReport* report, struct mCore* core, const struct BenchOpts* opts) {
+	struct VFile* vf = VFileMemChunk(NULL, 0);
+	struct BenchSample start, end;
+	unsigned i;
+
+	_sample(core, &start);
+	for (i = 0; i < opts->iterations && !_dispatchExiting; ++i) {
+		vf->seek(vf, 0, SEEK_SET);
+		mCoreSaveStateNamed(core, vf, 0);
+	}
+	_sample(core, &end);
+	_reportPhase(report, "savestate-save", BENCH_RENDERER_SOFTWARE, i, &start, &end);
+
+	_sample(core, &start);
+	for (i = 0; i < opts->iterations && !_dispatchExiting; ++i) {
+		vf->seek(vf, 0, SEEK_SET);
+		mCoreLoadStateNamed(core, vf, 0);
+	}
+	_sample(core, &end);
+	_reportPhase(report, "savestate-load", BENCH_RENDERER_SOFTWARE, i, &start, &end);
+	vf->close(vf);
+}
+
+static void _benchRewind(struct BenchReport* report, struct mCore* core, const struct BenchOpts* opts) {
+	struct mCoreRewindContext rewind;
+	struct BenchSample start, end;
+	unsigned i;
+
+	mCoreRewindContextInit(&rewind, opts->frames, false);
+	_sample(core, &start);
+	for (i = 0; i < opts->frames && !_dispatchExiting; ++i) {
+		_runFrame(core);
+		mCoreRewindAppend(&rewind, core);
+	}
+	_sample(core, &end);
+	_reportPhase(report, "rewind-record", BENCH_RENDERER_SOFTWARE, i, &start, &end);
+
+	_sample(core, &start);
+	for (i = 0; i < opts->frames && !_dispatchExiting; ++i) {
+		if (!mCoreRewindRestore(&rewind, core)) {
+			break;
+		}
+	}
+	_sample(core, &end);
+	_reportPhase(report, "rewind-restore", BENCH_RENDERER_SOFTWARE, i, &start, &end);
+	mCoreRewindContextDeinit(&rewind);
+}
+
+static void _benchSearch(struct BenchReport* report, struct mCore* core, const struct BenchOpts* opts) {
+	struct mCoreMemorySearchParams params = {
+		.memoryFlags = mCORE_MEMORY_RW,
+		.type = mCORE_MEMORY_SEARCH_INT,
+		.op = mCORE_MEMORY_SEARCH_EQUAL,
+		.align = 1,
+		.width = 1,
+		.valueInt = 0
+	};
+	struct mCoreMemorySearchResults results;
+	struct BenchSample start, end;
+	unsigned i;
+
+	mCoreMemorySearchResultsInit(&results, 0);
+	_sample(core, &start);
+	for (i = 0; i < opts->iterations && !_dispatchExiting; ++i) {
+		mCoreMemorySearchResultsClear(&results);
+		mCoreMemorySearch(core, &params, &results, 0);
+	}
+	_sample(core, &end);
+	_reportPhase(report, "search-full", BENCH_RENDERER_SOFTWARE, i, &start, &end);
+
+	// Narrow down the last full scan the way a user hunting for an unchanged value would
+	params.op = mCORE_MEMORY_SEARCH_DELTA;
+	_sample(core, &start);
+	for (i = 0; i < opts->iterations && !_dispatchExiting; ++i) {
+		_runFrame(core);
+		mCoreMemorySearchRepeat(core, &params, &results);
+	}
+	_sample(core, &end);
+	_reportPhase(report, "search-refine", BENCH_RENDERER_SOFTWARE, i, &start, &end);
+
+	// Unknown initial value: look for anything that went down since the last snapshot
+	struct mCoreMemorySnapshot snapshot;
+	mCoreMemorySnapshotInit(&snapshot);
+	params.op = mCORE_MEMORY_SEARCH_LESS;
+	_sample(core, &start);
+	for (i = 0; i < opts->iterations && !_dispatchExiting; ++i) {
+		mCoreMemorySnapshotTake(core, params.memoryFlags, &snapshot);
+		core->runFrame(core);
+		mCoreMemorySearchResultsClear(&results);
+		mCoreMemorySearchSnapshot(core, &params, &snapshot, &results, 0);
+	}
+	_sample(core, &end);
+	_reportPhase(report, "search-snapshot", BENCH_RENDERER_SOFTWARE, i, &start, &end);
+	mCoreMemorySnapshotDeinit(&snapshot);
+	mCoreMemorySearchResultsDeinit(&results);
+}
+
+static bool _benchRom(struct BenchReport* report, const char* fname, const struct mArguments* args, const struct BenchOpts* opts) {
+	struct BenchSample start, end;
+	char gameCode[9] = { 0 };
+	char title[17] = { 0 };
+
+	_sample(NULL, &start);
+	struct mCore* core = _benchLoad(fname, args, BENCH_RENDERER_SOFTWARE);
+	if (!core) {
+		fprintf(stderr, "Could not load %s\n", fname);
+		return false;
+	}
+	_sample(NULL, &end);
+
+	core->getGameCode(core, gameCode);
+	core->getGameTitle(core, title);
+	fputs(",\n\t\"rom\": ", report->out);
+	_writeString(report->out, fname);
+	fputs(",\n\t\"title\": ", report->out);
+	_writeString(report->out, title);
+	fputs(",\n\t\"game_code\": ", report->out);
+	_writeString(report->out, gameCode);
+	fprintf(report->out, ",\n\t\"frame_cycles\": %" PRIu32 ",\n\t\"phases\": [", core->frameCycles(core));
+
+	if (opts->scenarios & BENCH_LOAD) {
+		_reportPhase(report, "load", BENCH_RENDERER_SOFTWARE, 1, &start, &end);
+	}
+	if (opts->scenarios & BENCH_RUN) {
+		_sample(core, &start);
+		unsigned frames = _runFrames(core, opts->frames);
+		_sample(core, &end);
+		_reportPhase(report, "run", BENCH_RENDERER_SOFTWARE, frames, &start, &end);
+	}
+	if (opts->scenarios & BENCH_SAVESTATE) {
+		_benchSavestate(report, core, opts);
+	}
+	if (opts->scenarios & BENCH_REWIND) {
+		_benchRewind(report, core, opts);
+	}
+	if (opts->scenarios & BENCH_SEARCH) {
+		_benchSearch(report, core, opts);
+	}
+	_benchUnload(core);
+
+	if (opts->scenarios & BENCH_RENDER) {
+		enum BenchRenderer renderer;
+		for (renderer = BENCH_RENDERER_SOFTWARE; renderer <= BENCH_RENDERER_NONE && !_dispatchExiting; ++renderer) {
+			core = _benchLoad(fname, args, renderer);
+			if (!core) {
+				continue;
+			}
+			_sample(core, &start);
+			unsigned frames = _runFrames(core, opts->frames);
+			_sample(core, &end);
+			_reportPhase(report, "render", renderer, frames, &start, &end);
+			_benchUnload(core);
+		}
+	}
+
+	fputs("\n\t]", report->out);
+	return true;
+}
+
+static bool _parseScenarios(const char* arg, int* scenarios) {
+	static const struct {
+		const char* name;
+		enum BenchScenario scenario;
+	} names[] = {
+		{ "load", BENCH_LOAD },
+		{ "run", BENCH_RUN },
+		{ "savestate", BENCH_SAVESTATE },
+		{ "rewind", BENCH_REWIND },
+		{ "search", BENCH_SEARCH },
+		{ "render", BENCH_RENDER },
+		{ "all", BENCH_ALL },
+	};
+	*scenarios = 0;
+	while (*arg) {
+		size_t len = strcspn(arg, ",");
+		size_t i;
+		for (i = 0; i < sizeof(names) / sizeof(*names); ++i) {
+			if (strlen(names[i].name) == len && strncmp(names[i].name, arg, len) == 0) {
+				*scenarios |= names[i].scenario;
+				break;
+			}
+		}
+		if (i == sizeof(names) / sizeof(*names)) {
+			fprintf(stderr, "Unknown scenario: %.*s\n", (int) len, arg);
+			return false;
+		}
+		arg += len;
+		if (*arg == ',') {
+			++arg;
+		}
+	}
+	return *scenarios != 0;
+}
+
+static bool _parseBenchOpts(struct mSubParser* parser, int option, const char* arg) {
+	struct BenchOpts* opts = parser->opts;
+	errno = 0;
+	switch (option) {
+	case 'E':
+		opts->count = true;
+		return true;
+	case 'F':
+		opts->frames = strtoul(arg, 0, 10);
+		return !errno && opts->frames;
+	case 'I':
+		opts->iterations = strtoul(arg, 0, 10);
+		return !errno && opts->iterations;
+	case 'L':
+		free(opts->savestate);
+		opts->savestate = strdup(arg);
+		return true;
+	case 'O':
+		free(opts->output);
+		opts->output = strdup(arg);
+		return true;
+	case 'S':
+		return _parseScenarios(arg, &opts->scenarios);
+	default:
+		return false;
+	}
+}
+
+static void _log(struct mLogger* log, int category, enum mLogLevel level, const char* format, va_list args) {
+	UNUSED(log);
+	UNUSED(category);
+	UNUSED(level);
+	UNUSED(format);
+	UNUSED(args);
+}
@@ -0,0 +1,644 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/core/config.h>
+#include <mgba/core/core.h>
+#include <mgba/core/log.h>
+
+#include <mgba-util/png-io.h>
+#include <mgba-util/string.h>
+#include <mgba-util/thread-pool.h>
+#include <mgba-util/vector.h>
+#include <mgba-util/vfs.h>
+
+#ifdef _MSC_VER
+#include <mgba-util/platform/windows/getopt.h>
+#else
+#include <getopt.h>
+#include <unistd.h>
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+#define CINEMA_OPTIONS "hj:o:qv"
+#define CINEMA_USAGE \
+	"usage: %s [option ...] [DIRECTORY ...]\n" \
+	"\nOptions:\n" \
+	"  -j JOBS          Run JOBS tests in parallel (default: one per CPU)\n" \
+	"  -o FILE          Write JUnit-style XML results to FILE\n" \
+	"  -q               Only report failures\n" \
+	"  -v               Report per-frame mismatches\n" \
+	"  -h               Print this usage and exit\n"
+
+#define MAX_TEST_CONFIG 16
+#define MAX_BASELINE_FRAMES 4096
+
+struct CinemaConfigEntry {
+	char key[64];
+	char value[64];
+};
+
+struct CinemaSettings {
+	int skip;
+	int frames;
+	bool fail;
+	size_t nConfig;
+	struct CinemaConfigEntry config[MAX_TEST_CONFIG];
+};
+
+enum CinemaResult {
+	CINEMA_PENDING = 0,
+	CINEMA_PASS,
+	CINEMA_FAIL,
+	CINEMA_XFAIL,
+	CINEMA_ERROR
+};
+
+struct CinemaTest {
+	char name[PATH_MAX];
+	char directory[PATH_MAX];
+	char filename[PATH_MAX];
+	struct CinemaSettings settings;
+
+	enum CinemaResult result;
+	unsigned framesChecked;
+	unsigned framesFailed;
+	uint64_t duration;
+	char message[PATH_MAX + 64];
+};
+
+DECLARE_VECTOR(CinemaTestList, struct CinemaTest);
+DEFINE_VECTOR(CinemaTestList, struct CinemaTest);
+
+struct CinemaRunner {
+	struct CinemaTestList tests;
+	Mutex mutex;
+	bool quiet;
+	bool verbose;
+};
+
+static void _log(struct mLogger* log, int category, enum mLogLevel level, const char* format, va_list args) {
+	UNUSED(log);
+	UNUSED(category);
+	UNUSED(level);
+	UNUSED(format);
+	UNUSED(args);
+}
+
+static uint64_t _now(void) {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return 1000000LL * tv.tv_sec + tv.tv_usec;
+}
+
+static void _copyString(char* dest, const char* src, size_t size) {
+	strncpy(dest, src, size - 1);
+	dest[size - 1] = '\0';
+}
+
+static char* _strip(char* string) {
+	while (*string == ' ' || *string == '\t') {
+		++string;
+	}
+	size_t len = strlen(string);
+	while (len && strchr(" \t\r\n", string[len - 1])) {
+		string[len - 1] = '\0';
+		--len;
+	}
+	if (len >= 2 && (string[0] == '"' || string[0] == '\'') && string[len - 1] == string[0]) {
+		string[len - 1] = '\0';
+		++string;
+	}
+	return string;
+}
+
+static void _setConfig(struct CinemaSettings* settings, const char* key, const char* value) {
+	size_t i;
+	for (i = 0; i < settings->nConfig; ++i) {
+		if (strcmp(settings->config[i].key, key) == 0) {
+			break;
+		}
+	}
+	if (i == MAX_TEST_CONFIG) {
+		return;
+	}
+	if (i == settings->nConfig) {
+		++settings->nConfig;
+	}
+	// YAML booleans need to be stored in a form the config parser understands
+	if (strcasecmp(value, "true") == 0) {
+		value = "1";
+	} else if (strcasecmp(value, "false") == 0) {
+		value = "0";
+	}
+	_copyString(settings->config[i].key, key, sizeof(settings->config[i].key));
+	_copyString(settings->config[i].value, value, sizeof(settings->config[i].value));
+}
+
+static void _setInlineConfig(struct CinemaSettings* settings, char* list) {
+	char* end = strchr(list, '}');
+	if (end) {
+		*end = '\0';
+	}
+	char* item = list;
+	while (item) {
+		char* next = strchr(item, ',');
+		if (next) {
+			*next = '\0';
+			++next;
+		}
+		char* colon = strchr(item, ':');
+		if (!colon) {
+			item = next;
+			continue;
+		}
+		*colon = '\0';
+		_setConfig(settings, _strip(item), _strip(&colon[1]));
+		item = next;
+	}
+}
+
+// Only the subset of YAML that cinema manifests actually use is understood here
+static void _loadManifest(struct CinemaSettings* settings, struct VDir* dir) {
+	struct VFile* vf = dir->openFile(dir, "manifest.yml", O_RDONLY);
+	if (!vf) {
+		return;
+	}
+	char line[512];
+	bool inConfig = false;
+	while (vf->readline(vf, line, sizeof(line)) > 0) {
+		char* comment = strchr(line, '#');
+		if (comment) {
+			*comment = '\0';
+		}
+		bool indented = line[0] == ' ' || line[0] == '\t';
+		char* key = _strip(line);
+		char* colon = strchr(key, ':');
+		if (!key[0] || !colon) {
+			continue;
+		}
+		*colon = '\0';
+		char* value = _strip(&colon[1]);
+		key = _strip(key);
+		if (indented && inConfig) {
+			_setConfig(settings, key, value);
+			continue;
+		}
+		inConfig = false;
+		if (strcmp(key, "config") == 0) {
+			if (value[0] == '{') {
+				_setInlineConfig(settings, &value[1]);
+			} else {
+				inConfig = true;
+			}
+		} else if (strcmp(key, "skip") == 0) {
+			settings->skip = strtol(value, NULL, 10);
+		} else if (strcmp(key, "frames") == 0) {
+			settings->frames = strtol(value, NULL, 10);
+		} else if (strcmp(key, "fail") == 0) {
+			settings->fail = strcasecmp(value, "false") != 0 && strcmp(value, "0") != 0 && value[0];
+		}
+	}
+	vf->close(vf);
+}
+
+static bool _isTestFile(const char* name) {
+	return strcmp(name, "test.mvl") == 0 || strcmp(name, "test.gb") == 0 || strcmp(name, "test.gba") == 0;
+}
+
+static void _gatherTests(struct CinemaTestList* tests, const char* path, const char* name, const struct CinemaSettings* parent) {
+	struct VDir* dir = VDirOpen(path);
+	if (!dir) {
+		return;
+	}
+	struct CinemaSettings settings = *parent;
+	_loadManifest(&settings, dir);
+
+	struct VDirEntry* dirent;
+	while ((dirent = dir->listNext(dir))) {
+		const char* entry = dirent->name(dirent);
+		if (entry[0] == '.') {
+			continue;
+		}
+		if (dirent->type(dirent) == VFS_DIRECTORY) {
+			char subpath[PATH_MAX];
+			char subname[PATH_MAX];
+			snprintf(subpath, sizeof(subpath), "%s" PATH_SEP "%s", path, entry);
+			if (name[0]) {
+				snprintf(subname, sizeof(subname), "%s.%s", name, entry);
+			} else {
+				_copyString(subname, entry, sizeof(subname));
+			}
+			_gatherTests(tests, subpath, subname, &settings);
+		} else if (_isTestFile(entry)) {
+			struct CinemaTest* test = CinemaTestListAppend(tests);
+			memset(test, 0, sizeof(*test));
+			_copyString(test->name, name, sizeof(test->name));
+			_copyString(test->directory, path, sizeof(test->directory));
+			snprintf(test->filename, sizeof(test->filename), "%s" PATH_SEP "%s", path, entry);
+			test->settings = settings;
+		}
+	}
+	dir->close(dir);
+}
+
+static int _compareTests(const void* a, const void* b) {
+	const struct CinemaTest* testA = a;
+	const struct CinemaTest* testB = b;
+	return strcmp(testA->name, testB->name);
+}
+
+static bool _loadBaseline(const struct CinemaTest* test, unsigned frame, color_t* pixels, unsigned width, unsigned height) {
+	char path[PATH_MAX];
+	int written = snprintf(path, sizeof(path), "%s" PATH_SEP "baseline_%04u.png", test->directory, frame);
+	if (written < 0 || (size_t) written >= sizeof(path)) {
+		return false;
+	}
+	struct VFile* vf = VFileOpen(path, O_RDONLY);
+	if (!vf) {
+		return false;
+	}
+	png_structp png = PNGReadOpen(vf, 0);
+	png_infop info = png_create_info_struct(png);
+	png_infop end = png_create_info_struct(png);
+	bool success = PNGReadHeader(png, info);
+	if (success && (png_get_image_width(png, info) != width || png_get_image_height(png, info) != height)) {
+		success = false;
+	}
+	if (success && !setjmp(png_jmpbuf(png))) {
+		png_byte type = png_get_color_type(png, info);
+		if (type == PNG_COLOR_TYPE_PALETTE) {
+			png_set_palette_to_rgb(png);
+		}
+		if (type == PNG_COLOR_TYPE_GRAY || type == PNG_COLOR_TYPE_GRAY_ALPHA) {
+			png_set_gray_to_rgb(png);
+		}
+		if (type & PNG_COLOR_MASK_ALPHA) {
+			png_set_strip_alpha(png);
+		}
+		png_set_strip_16(png);
+		png_read_update_info(png, info);
+	} else {
+		success = false;
+	}
+	success = success && PNGReadPixels(png, info, pixels, width, height, width);
+	PNGReadClose(png, info, end);
+	vf->close(vf);
+	return success;
+}
+
+static void _normalizeFrame(color_t* pixels, size_t nPixels) {
+#ifndef COLOR_16_BIT
+	// Baselines carry no alpha, so the unused channel must not take part in the comparison
+	size_t i;
+	for (i = 0; i < nPixels; ++i) {
+		pixels[i] |= 0xFF000000;
+	}
+#else
+	UNUSED(pixels);
+	UNUSED(nPixels);
+#endif
+}
+
+static unsigned _diffFrame(const color_t* a, const color_t* b, size_t nPixels) {
+	unsigned diff = 0;
+	size_t i;
+	for (i = 0; i < nPixels; ++i) {
+		if (a[i] != b[i]) {
+			++diff;
+		}
+	}
+	return diff;
+}
+
+static bool _checkFrame(struct CinemaRunner* runner, struct CinemaTest* test, const color_t* frame, color_t* baseline, unsigned width, unsigned height) {
+	size_t nPixels = width * height;
+	unsigned index = test->framesChecked;
+	++test->framesChecked;
+	if (!_loadBaseline(test, index, baseline, width, height)) {
+		++test->framesFailed;
+		if (!test->message[0]) {
+			snprintf(test->message, sizeof(test->message), "Frame %u: missing or unreadable baseline", index);
+		}
+		return false;
+	}
+	// Only count the differing pixels once the frame is known not to match
+	if (!memcmp(frame, baseline, nPixels * BYTES_PER_PIXEL)) {
+		return true;
+	}
+	unsigned diff = _diffFrame(frame, baseline, nPixels);
+	++test->framesFailed;
+	if (!test->message[0]) {
+		snprintf(test->message, sizeof(test->message), "Frame %u: %u of %zu pixels differ", index, diff, nPixels);
+	}
+	if (runner->verbose) {
+		MutexLock(&runner->mutex);
+		printf("     %s: frame %u: %u of %zu pixels differ\n", test->name, index, diff, nPixels);
+		MutexUnlock(&runner->mutex);
+	}
+	return false;
+}
+
+static void _runTest(struct CinemaRunner* runner, struct CinemaTest* test) {
+	struct mCore* core = mCoreFind(test->filename);
+	if (!core) {
+		test->result = CINEMA_ERROR;
+		snprintf(test->message, sizeof(test->message), "Could not find a core for %s", test->filename);
+		return;
+	}
+	core->init(core);
+	mCoreInitConfig(core, NULL);
+	size_t i;
+	for (i = 0; i < test->settings.nConfig; ++i) {
+		mCoreConfigSetDefaultValue(&core->config, test->settings.config[i].key, test->settings.config[i].value);
+	}
+	if (!mCoreLoadFile(core, test->filename)) {
+		test->result = CINEMA_ERROR;
+		snprintf(test->message, sizeof(test->message), "Could not load %s", test->filename);
+		mCoreConfigDeinit(&core->config);
+		core->deinit(core);
+		return;
+	}
+	if (test->settings.nConfig) {
+		mCoreLoadConfig(core);
+	}
+
+	unsigned width, height;
+	core->desiredVideoDimensions(core, &width, &height);
+	color_t* frame = malloc(width * height * BYTES_PER_PIXEL);
+	core->setVideoBuffer(core, frame, width);
+	core->reset(core);
+
+	// The dimensions may depend on the model, which isn't known until the core has been reset
+	unsigned resetWidth, resetHeight;
+	core->desiredVideoDimensions(core, &resetWidth, &resetHeight);
+	if (resetWidth != width || resetHeight != height) {
+		width = resetWidth;
+		height = resetHeight;
+		frame = realloc(frame, width * height * BYTES_PER_PIXEL);
+		core->setVideoBuffer(core, frame, width);
+		core->reset(core);
+	}
+	color_t* baseline = malloc(width * height * BYTES_PER_PIXEL);
+
+	int skip = test->settings.skip + 1;
+	int limit = test->settings.frames;
+	int32_t frameCounter = 0;
+	for (; skip > 0; --skip) {
+		frameCounter = core->frameCounter(core);
+		core->runFrame(core);
+	}
+	bool passed = true;
+	while (frameCounter <= core->frameCounter(core) && limit != 0 && test->framesChecked < MAX_BASELINE_FRAMES) {
+		_normalizeFrame(frame, width * height);
+		passed = _checkFrame(runner, test, frame, baseline, width, height) && passed;
+		frameCounter = core->frameCounter(core);
+		core->runFrame(core);
+		if (limit > 0) {
+			--limit;
+		}
+	}
+
+	if (passed) {
+		test->result = CINEMA_PASS;
+	} else if (test->settings.fail) {
+		test->result = CINEMA_XFAIL;
+	} else {
+		test->result = CINEMA_FAIL;
+	}
+
+	free(frame);
+	free(baseline);
+	mCoreConfigDeinit(&core->config);
+	core->deinit(core);
+}
+
+static int _cpuCount(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+	long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nCpus > 0) {
+		return nCpus;
+	}
+#endif
+	return 1;
+}
+
+static const char* _resultName(enum CinemaResult result) {
+	switch (result) {
+	case CINEMA_PASS:
+		return "PASS";
+	case CINEMA_FAIL:
+		return "FAIL";
+	case CINEMA_XFAIL:
+		return "XFAIL";
+	case CINEMA_ERROR:
+		return "ERROR";
+	default:
+		return "?";
+	}
+}
+
+static void _cinemaJob(void* context, size_t index) {
+	struct CinemaRunner* runner = context;
+	struct CinemaTest* test = CinemaTestListGetPointer(&runner->tests, index);
+	uint64_t start = _now();
+	_runTest(runner, test);
+	test->duration = _now() - start;
+
+	if (!runner->quiet || test->result == CINEMA_FAIL || test->result == CINEMA_ERROR) {
+		MutexLock(&runner->mutex);
+		printf("%-5s %s (%u frames, %.3fs)%s%s\n", _resultName(test->result), test->name, test->framesChecked,
+		       test->duration / 1000000.0, test->message[0] ? ": " : "", test->message);
+		fflush(stdout);
+		MutexUnlock(&runner->mutex);
+	}
+}
+
+static void _writeEscaped(struct VFile* vf, const char* string) {
+	char buffer[1024];
+	size_t out = 0;
+	for (; *string && out < sizeof(buffer) - 8; ++string) {
+		switch (*string) {
+		case '&':
+			out += snprintf(&buffer[out], sizeof(buffer) - out, "&amp;");
+			break;
+		case '<':
+			out += snprintf(&buffer[out], sizeof(buffer) - out, "&lt;");
+			break;
+		case '>':
+			out += snprintf(&buffer[out], sizeof(buffer) - out, "&gt;");
+			break;
+		case '"':
+			out += snprintf(&buffer[out], sizeof(buffer) - out, "&quot;");
+			break;
+		default:
+			buffer[out] = *string;
+			++out;
+			break;
+		}
+	}
+	vf->write(vf, buffer, out);
+}
+
+static void _writeString(struct VFile* vf, const char* string) {
+	vf->write(vf, string, strlen(string));
+}
+
+static bool _writeJUnit(const struct CinemaRunner* runner, const char* path, uint64_t duration) {
+	struct VFile* vf = VFileOpen(path, O_WRONLY | O_CREAT | O_TRUNC);
+	if (!vf) {
+		return false;
+	}
+	size_t nTests = CinemaTestListSize(&runner->tests);
+	size_t failures = 0;
+	size_t errors = 0;
+	size_t skipped = 0;
+	size_t i;
+	for (i = 0; i < nTests; ++i) {
+		const struct CinemaTest* test = CinemaTestListGetConstPointer(&runner->tests, i);
+		switch (test->result) {
+		case CINEMA_FAIL:
+			++failures;
+			break;
+		case CINEMA_ERROR:
+			++errors;
+			break;
+		case CINEMA_XFAIL:
+			++skipped;
+			break;
+		default:
+			break;
+		}
+	}
+
+	char buffer[512];
+	snprintf(buffer, sizeof(buffer), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	         "<testsuite name=\"cinema\" tests=\"%zu\" failures=\"%zu\" errors=\"%zu\" skipped=\"%zu\" time=\"%.3f\">\n",
+	         nTests, failures, errors, skipped, duration / 1000000.0);
+	_writeString(vf, buffer);
+	for (i = 0; i < nTests; ++i) {
+		const struct CinemaTest* test = CinemaTestListGetConstPointer(&runner->tests, i);
+		const char* dot = strrchr(test->name, '.');
+		_writeString(vf, "\t<testcase classname=\"cinema");
+		if (dot) {
+			vf->write(vf, ".", 1);
+			vf->write(vf, test->name, dot - test->name);
+		}
+		_writeString(vf, "\" name=\"");
+		_writeEscaped(vf, dot ? &dot[1] : test->name);
+		snprintf(buffer, sizeof(buffer), "\" time=\"%.3f\"", test->duration / 1000000.0);
+		_writeString(vf, buffer);
+		switch (test->result) {
+		case CINEMA_PASS:
+			_writeString(vf, "/>\n");
+			continue;
+		case CINEMA_FAIL:
+			_writeString(vf, ">\n\t\t<failure message=\"");
+			break;
+		case CINEMA_ERROR:
+			_writeString(vf, ">\n\t\t<error message=\"");
+			break;
+		case CINEMA_XFAIL:
+			_writeString(vf, ">\n\t\t<skipped message=\"Expected failure: ");
+			break;
+		default:
+			_writeString(vf, ">\n\t\t<error message=\"Not run");
+			break;
+		}
+		_writeEscaped(vf, test->message);
+		_writeString(vf, "\"/>\n\t</testcase>\n");
+	}
+	_writeString(vf, "</testsuite>\n");
+	vf->close(vf);
+	return true;
+}
+
+int main(int argc, char** argv) {
+	struct mLogger logger = { .log = _log };
+	mLogSetDefaultLogger(&logger);
+
+	struct CinemaRunner runner = {
+		.quiet = false,
+		.verbose = false
+	};
+	const char* junit = NULL;
+	int jobs = _cpuCount();
+	int ch;
+	while ((ch = getopt(argc, argv, CINEMA_OPTIONS)) != -1) {
+		switch (ch) {
+		case 'j':
+			errno = 0;
+			jobs = strtol(optarg, NULL, 10);
+			if (errno || jobs < 1) {
+				fprintf(stderr, CINEMA_USAGE, argv[0]);
+				return 1;
+			}
+			break;
+		case 'o':
+			junit = optarg;
+			break;
+		case 'q':
+			runner.quiet = true;
+			break;
+		case 'v':
+			runner.verbose = true;
+			break;
+		case 'h':
+			printf(CINEMA_USAGE, argv[0]);
+			return 0;
+		default:
+			fprintf(stderr, CINEMA_USAGE, argv[0]);
+			return 1;
+		}
+	}
+
+	CinemaTestListInit(&runner.tests, 0);
+	struct CinemaSettings settings = {
+		.skip = 0,
+		.frames = -1,
+		.fail = false,
+		.nConfig = 0
+	};
+	if (optind < argc) {
+		int i;
+		for (i = optind; i < argc; ++i) {
+			_gatherTests(&runner.tests, argv[i], "", &settings);
+		}
+	} else {
+		_gatherTests(&runner.tests, "cinema", "", &settings);
+	}
+	qsort(runner.tests.vector, CinemaTestListSize(&runner.tests), sizeof(struct CinemaTest), _compareTests);
+
+	size_t nTests = CinemaTestListSize(&runner.tests);
+	if (jobs > (int) nTests) {
+		jobs = nTests ? nTests : 1;
+	}
+	MutexInit(&runner.mutex);
+	struct ThreadPool pool;
+	ThreadPoolInit(&pool, jobs, "Cinema Thread");
+	uint64_t start = _now();
+	ThreadPoolRun(&pool, nTests, _cinemaJob, &runner);
+	uint64_t duration = _now() - start;
+	ThreadPoolDeinit(&pool);
+	MutexDeinit(&runner.mutex);
+
+	size_t counts[CINEMA_ERROR + 1] = { 0 };
+	size_t t;
+	for (t = 0; t < nTests; ++t) {
+		++counts[CinemaTestListGetPointer(&runner.tests, t)->result];
+	}
+	printf("%zu tests in %.3fs: %zu passed, %zu failed, %zu expected failures, %zu errors\n", nTests, duration / 1000000.0,
+	       counts[CINEMA_PASS], counts[CINEMA_FAIL], counts[CINEMA_XFAIL], counts[CINEMA_ERROR]);
+
+	int didFail = counts[CINEMA_FAIL] || counts[CINEMA_ERROR] || !nTests;
+	if (junit && !_writeJUnit(&runner, junit, duration)) {
+		fprintf(stderr, "Could not write results to %s\n", junit);
+		didFail = 1;
+	}
+	CinemaTestListDeinit(&runner.tests);
+	return didFail;
+}
@@ -0,0 +1,548 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/core/config.h>
+#include <mgba/core/core.h>
+#include <mgba/core/lockstep.h>
+#include <mgba/core/rom-cache.h>
+#ifdef M_CORE_GBA
+#include <mgba/internal/gba/gba.h>
+#include <mgba/internal/gba/sio/lockstep.h>
+#endif
+#ifdef M_CORE_GB
+#include <mgba/internal/gb/gb.h>
+#include <mgba/internal/gb/sio/lockstep.h>
+#endif
+
+#include <mgba/feature/commandline.h>
+#include <mgba-util/crc32.h>
+#include <mgba-util/threading.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#define LINK_PERF_OPTIONS "F:j:n:PW:"
+#define LINK_PERF_USAGE \
+	"\nBenchmark options:\n" \
+	"  -F FRAMES        Run for the specified number of FRAMES before exiting\n" \
+	"  -j THREADS       Run the instances in deterministic rounds on THREADS threads\n" \
+	"  -n PLAYERS       Number of linked instances to run (2-4 on GBA, 2 on GB, default 2)\n" \
+	"  -W CYCLES        Cycles nodes may run ahead between syncs while idle\n" \
+	"  -P               CSV output, useful for parsing"
+
+#define MAX_LINK_PLAYERS 4
+
+struct LinkPerfOpts {
+	unsigned frames;
+	int players;
+	int32_t window;
+	int threads;
+	bool csv;
+};
+
+struct LinkPlayer {
+	struct mCore* core;
+	Thread thread;
+	Condition cond;
+	struct LinkPerf* link;
+	int id;
+	int awake;
+	int32_t cyclesPosted;
+	unsigned waitMask;
+	unsigned frames;
+	unsigned stalls;
+#ifdef M_CORE_GBA
+	struct GBASIOLockstepNode gbaNode;
+#endif
+#ifdef M_CORE_GB
+	struct GBSIOLockstepNode gbNode;
+#endif
+};
+
+struct LinkPerf {
+	struct mLockstep* d;
+#ifdef M_CORE_GBA
+	struct GBASIOLockstep gba;
+#endif
+#ifdef M_CORE_GB
+	struct GBSIOLockstep gb;
+#endif
+	enum mPlatform platform;
+	Mutex lock;
+	struct LinkPlayer players[MAX_LINK_PLAYERS];
+	struct mLockstepScheduler scheduler;
+	int nPlayers;
+	unsigned frames;
+	bool done;
+};
+
+static bool _dispatchExiting = false;
+
+static void _linkShutdown(int signal) {
+	UNUSED(signal);
+	_dispatchExiting = true;
+}
+
+static bool _parseLinkPerfOpts(struct mSubParser* parser, int option, const char* arg) {
+	struct LinkPerfOpts* opts = parser->opts;
+	errno = 0;
+	switch (option) {
+	case 'F':
+		opts->frames = strtoul(arg, 0, 10);
+		return !errno;
+	case 'j':
+		opts->threads = strtol(arg, 0, 10);
+		return !errno && opts->threads > 0;
+	case 'n':
+		opts->players = strtol(arg, 0, 10);
+		return !errno && opts->players >= 2 && opts->players <= MAX_LINK_PLAYERS;
+	case 'P':
+		opts->csv = true;
+		return true;
+	case 'W':
+		opts->window = strtol(arg, 0, 10);
+		return !errno && opts->window >= 0;
+	default:
+		return false;
+	}
+}
+
+static void _log(struct mLogger* log, int category, enum mLogLevel level, const char* format, va_list args) {
+	UNUSED(log);
+	UNUSED(category);
+	UNUSED(level);
+	UNUSED(format);
+	UNUSED(args);
+}
+
+static void _wake(struct LinkPlayer* player) {
+	player->awake = 1;
+	ConditionWake(&player->cond);
+}
+
+static void _postCycles(struct LinkPlayer* player) {
+	switch (player->link->platform) {
+#ifdef M_CORE_GBA
+	case PLATFORM_GBA:
+		player->gbaNode.nextEvent += player->cyclesPosted;
+		break;
+#endif
+#ifdef M_CORE_GB
+	case PLATFORM_GB:
+		player->gbNode.nextEvent += player->cyclesPosted;
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+static bool _signal(struct mLockstep* lockstep, unsigned mask) {
+	struct LinkPerf* link = lockstep->context;
+	struct LinkPlayer* player = &link->players[0];
+	bool woke = false;
+	MutexLock(&link->lock);
+	player->waitMask &= ~mask;
+	if (!player->waitMask && player->awake < 1) {
+		_wake(player);
+		woke = true;
+	}
+	MutexUnlock(&link->lock);
+	return woke;
+}
+
+static bool _wait(struct mLockstep* lockstep, unsigned mask) {
+	struct LinkPerf* link = lockstep->context;
+	struct LinkPlayer* player = &link->players[0];
+	bool slept = false;
+	MutexLock(&link->lock);
+	player->waitMask |= mask;
+	if (player->awake > 0) {
+		player->awake = 0;
+		++player->stalls;
+		slept = true;
+	}
+	MutexUnlock(&link->lock);
+	return slept;
+}
+
+static void _addCycles(struct mLockstep* lockstep, int id, int32_t cycles) {
+	struct LinkPerf* link = lockstep->context;
+	if (cycles < 0) {
+		abort();
+	}
+	MutexLock(&link->lock);
+	if (!id) {
+		int i;
+		for (i = 1; i < link->nPlayers; ++i) {
+			struct LinkPlayer* player = &link->players[i];
+			player->cyclesPosted += cycles;
+			if (player->awake < 1) {
+				_postCycles(player);
+				_wake(player);
+			}
+		}
+	} else {
+		link->players[id].cyclesPosted += cycles;
+	}
+	MutexUnlock(&link->lock);
+}
+
+static int32_t _useCycles(struct mLockstep* lockstep, int id, int32_t cycles) {
+	struct LinkPerf* link = lockstep->context;
+	MutexLock(&link->lock);
+	struct LinkPlayer* player = &link->players[id];
+	player->cyclesPosted -= cycles;
+	if (player->cyclesPosted <= 0) {
+		player->awake = 0;
+		++player->stalls;
+	}
+	cycles = player->cyclesPosted;
+	MutexUnlock(&link->lock);
+	return cycles;
+}
+
+static void _unload(struct mLockstep* lockstep, int id) {
+	struct LinkPerf* link = lockstep->context;
+	MutexLock(&link->lock);
+	if (id) {
+		struct LinkPlayer* player = &link->players[0];
+		player->waitMask &= ~(1 << id);
+		if (!player->waitMask && player->awake < 1) {
+			_wake(player);
+		}
+	} else {
+		int i;
+		for (i = 1; i < link->nPlayers; ++i) {
+			struct LinkPlayer* player = &link->players[i];
+			if (player->awake < 1) {
+				_postCycles(player);
+				_wake(player);
+			}
+		}
+	}
+	MutexUnlock(&link->lock);
+}
+
+static void _frameEnded(void* context) {
+	struct LinkPlayer* player = context;
+	struct LinkPerf* link = player->link;
+	++player->frames;
+	if (player->id) {
+		return;
+	}
+	if (!_dispatchExiting && (!link->frames || player->frames < link->frames)) {
+		return;
+	}
+	MutexLock(&link->lock);
+	link->done = true;
+	int i;
+	for (i = 0; i < link->nPlayers; ++i) {
+		_wake(&link->players[i]);
+	}
+	MutexUnlock(&link->lock);
+}
+
+static THREAD_ENTRY _linkPlayerRun(void* context) {
+	struct LinkPlayer* player = context;
+	struct LinkPerf* link = player->link;
+	ThreadSetName("CPU Thread");
+	MutexLock(&link->lock);
+	while (!link->done) {
+		if (player->awake < 1) {
+			ConditionWait(&player->cond, &link->lock);
+			continue;
+		}
+		MutexUnlock(&link->lock);
+		player->core->runLoop(player->core);
+		MutexLock(&link->lock);
+	}
+	MutexUnlock(&link->lock);
+	return 0;
+}
+
+static bool _attachPlayer(struct LinkPerf* link, struct LinkPlayer* player) {
+	switch (link->platform) {
+#ifdef M_CORE_GBA
+	case PLATFORM_GBA: {
+		struct GBA* gba = player->core->board;
+		GBASIOLockstepNodeCreate(&player->gbaNode);
+		GBASIOLockstepAttachNode(&link->gba, &player->gbaNode);
+		GBASIOSetDriver(&gba->sio, &player->gbaNode.d, SIO_MULTI);
+		return true;
+	}
+#endif
+#ifdef M_CORE_GB
+	case PLATFORM_GB: {
+		struct GB* gb = player->core->board;
+		GBSIOLockstepNodeCreate(&player->gbNode);
+		GBSIOLockstepAttachNode(&link->gb, &player->gbNode);
+		GBSIOSetDriver(&gb->sio, &player->gbNode.d);
+		return true;
+	}
+#endif
+	default:
+		return false;
+	}
+}
+
+static void _detachPlayer(struct LinkPerf* link, struct LinkPlayer* player) {
+	switch (link->platform) {
+#ifdef M_CORE_GBA
+	case PLATFORM_GBA: {
+		struct GBA* gba = player->core->board;
+		GBASIOSetDriver(&gba->sio, NULL, SIO_MULTI);
+		GBASIOLockstepDetachNode(&link->gba, &player->gbaNode);
+		break;
+	}
+#endif
+#ifdef M_CORE_GB
+	case PLATFORM_GB: {
+		struct GB* gb = player->core->board;
+		GBSIOSetDriver(&gb->sio, NULL);
+		GBSIOLockstepDetachNode(&link->gb, &player->gbNode);
+		break;
+	}
+#endif
+	default:
+		break;
+	}
+}
+
+static uint32_t _stateCrc32(struct mCore* core) {
+	size_t size = core->stateSize(core);
+	void* state = malloc(size);
+	uint32_t crc32 = 0;
+	if (core->saveState(core, state)) {
+		crc32 = doCrc32(state, size);
+	}
+	free(state);
+	return crc32;
+}
+
+static int _maxPlayers(enum mPlatform platform) {
+	switch (platform) {
+#ifdef M_CORE_GBA
+	case PLATFORM_GBA:
+		return MAX_GBAS;
+#endif
+#ifdef M_CORE_GB
+	case PLATFORM_GB:
+		return MAX_GBS;
+#endif
+	default:
+		return MAX_LINK_PLAYERS;
+	}
+}
+
+static bool _loadPlayer(struct LinkPlayer* player, const char* fname, const struct mArguments* args) {
+	player->core = mCoreFind(fname);
+	if (!player->core) {
+		return false;
+	}
+	struct mCore* core = player->core;
+	core->init(core);
+	mCoreLoadFile(core, fname);
+	mCoreConfigInit(&core->config, "perf");
+	mCoreConfigLoad(&core->config);
+
+	struct mCoreOptions opts = {};
+	mCoreConfigMap(&core->config, &opts);
+	opts.audioSync = false;
+	opts.videoSync = false;
+	applyArguments(args, NULL, &core->config);
+	mCoreConfigLoadDefaults(&core->config, &opts);
+	mCoreConfigSetDefaultValue(&core->config, "idleOptimization", "detect");
+	mCoreLoadConfig(core);
+	mCoreConfigFreeOpts(&opts);
+
+	struct mCoreCallbacks callbacks = {
+		.videoFrameEnded = _frameEnded,
+		.context = player
+	};
+	core->addCoreCallbacks(core, &callbacks);
+	core->reset(core);
+	return true;
+}
+
+static bool _runLink(const char* fname, const struct mArguments* args, const struct LinkPerfOpts* perfOpts) {
+	struct LinkPerf link;
+	memset(&link, 0, sizeof(link));
+	link.nPlayers = perfOpts->players;
+	link.frames = perfOpts->frames;
+	// Every player usually runs the same ROM, so let them share its pages
+	mROMCacheSetEnabled(true);
+	MutexInit(&link.lock);
+
+	bool success = true;
+	int i;
+	for (i = 0; i < link.nPlayers; ++i) {
+		struct LinkPlayer* player = &link.players[i];
+		player->link = &link;
+		player->id = i;
+		player->awake = 1;
+		ConditionInit(&player->cond);
+		if (!_loadPlayer(player, fname, args)) {
+			success = false;
+			break;
+		}
+	}
+	if (success) {
+		link.platform = link.players[0].core->platform(link.players[0].core);
+		int maxPlayers = _maxPlayers(link.platform);
+		if (link.nPlayers > maxPlayers) {
+			fprintf(stderr, "At most %i players can be linked on this platform\n", maxPlayers);
+			success = false;
+		}
+	}
+	if (!success) {
+		for (--i; i >= 0; --i) {
+			mCoreConfigDeinit(&link.players[i].core->config);
+			link.players[i].core->deinit(link.players[i].core);
+			ConditionDeinit(&link.players[i].cond);
+		}
+		MutexDeinit(&link.lock);
+		return false;
+	}
+
+	switch (link.platform) {
+#ifdef M_CORE_GBA
+	case PLATFORM_GBA:
+		GBASIOLockstepInit(&link.gba);
+		link.d = &link.gba.d;
+		break;
+#endif
+#ifdef M_CORE_GB
+	case PLATFORM_GB:
+		GBSIOLockstepInit(&link.gb);
+		link.d = &link.gb.d;
+		break;
+#endif
+	default:
+		success = false;
+		break;
+	}
+	bool scheduled = success && perfOpts->threads;
+	if (scheduled) {
+		mLockstepSchedulerInit(&link.scheduler, link.d, perfOpts->threads);
+		link.d->window = perfOpts->window;
+	} else if (success) {
+		link.d->context = &link;
+		link.d->signal = _signal;
+		link.d->wait = _wait;
+		link.d->addCycles = _addCycles;
+		link.d->useCycles = _useCycles;
+		link.d->unload = _unload;
+		link.d->window = perfOpts->window;
+	}
+
+	for (i = 0; i < link.nPlayers && success; ++i) {
+		success = _attachPlayer(&link, &link.players[i]);
+		if (success && scheduled) {
+			mLockstepSchedulerAttachCore(&link.scheduler, link.players[i].core);
+		}
+	}
+
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	uint64_t start = 1000000LL * tv.tv_sec + tv.tv_usec;
+	if (success && scheduled) {
+		while (!link.done) {
+			mLockstepSchedulerRunFrames(&link.scheduler, 1);
+		}
+	} else if (success) {
+		for (i = 0; i < link.nPlayers; ++i) {
+			ThreadCreate(&link.players[i].thread, _linkPlayerRun, &link.players[i]);
+		}
+		for (i = 0; i < link.nPlayers; ++i) {
+			ThreadJoin(link.players[i].thread);
+		}
+	}
+	gettimeofday(&tv, 0);
+	uint64_t end = 1000000LL * tv.tv_sec + tv.tv_usec;
+	uint64_t duration = end - start;
+
+	unsigned frames = link.players[0].frames;
+	unsigned stalls = 0;
+	for (i = 0; i < link.nPlayers; ++i) {
+		stalls += link.players[i].stalls;
+	}
+	if (success && scheduled) {
+		float scaledFrames = frames * 1000000.f;
+		uint64_t rounds = link.scheduler.rounds;
+		if (perfOpts->csv) {
+			puts("players,window,threads,frames,duration,rounds");
+			printf("%i,%" PRIi32 ",%i,%u,%" PRIu64 ",%" PRIu64 "\n", link.nPlayers, perfOpts->window, perfOpts->threads, frames, duration, rounds);
+		} else {
+			printf("%i players on %i threads, %u frames in %" PRIu64 " microseconds: %g fps (%gx), %" PRIu64 " rounds (%g per frame)\n",
+			       link.nPlayers, perfOpts->threads, frames, duration, scaledFrames / duration, scaledFrames / (duration * 60.f),
+			       rounds, frames ? rounds / (float) frames : 0.f);
+			// Runs given the same inputs end in the same state however many threads they use
+			for (i = 0; i < link.nPlayers; ++i) {
+				printf("Player %i state: %08X\n", i + 1, _stateCrc32(link.players[i].core));
+			}
+		}
+	} else if (success) {
+		float scaledFrames = frames * 1000000.f;
+		if (perfOpts->csv) {
+			puts("players,window,frames,duration,stalls");
+			printf("%i,%" PRIi32 ",%u,%" PRIu64 ",%u\n", link.nPlayers, perfOpts->window, frames, duration, stalls);
+		} else {
+			printf("%i players, %u frames in %" PRIu64 " microseconds: %g fps (%gx), %u stalls (%g per frame)\n",
+			       link.nPlayers, frames, duration, scaledFrames / duration, scaledFrames / (duration * 60.f),
+			       stalls, frames ? stalls / (float) frames : 0.f);
+		}
+	}
+
+	for (i = link.nPlayers - 1; i >= 0; --i) {
+		struct LinkPlayer* player = &link.players[i];
+		_detachPlayer(&link, player);
+	}
+	if (scheduled) {
+		mLockstepSchedulerDeinit(&link.scheduler);
+	}
+	for (i = link.nPlayers - 1; i >= 0; --i) {
+		struct LinkPlayer* player = &link.players[i];
+		mCoreConfigDeinit(&player->core->config);
+		player->core->deinit(player->core);
+		ConditionDeinit(&player->cond);
+	}
+	MutexDeinit(&link.lock);
+	return success;
+}
+
+int main(int argc, char** argv) {
+	signal(SIGINT, _linkShutdown);
+
+	struct mLogger logger = { .log = _log };
+	mLogSetDefaultLogger(&logger);
+
+	struct LinkPerfOpts perfOpts = { 0, 2, 0, 0, false };
+	struct mSubParser subparser = {
+		.usage = LINK_PERF_USAGE,
+		.parse = _parseLinkPerfOpts,
+		.extraOptions = LINK_PERF_OPTIONS,
+		.opts = &perfOpts
+	};
+
+	struct mArguments args = {};
+	bool parsed = parseArguments(&args, argc, argv, &subparser);
+	if (!args.fname) {
+		parsed = false;
+	}
+	int didFail = 0;
+	if (!parsed || args.showHelp) {
+		usage(argv[0], LINK_PERF_USAGE);
+		didFail = !parsed;
+	} else if (args.showVersion) {
+		version(argv[0]);
+	} else {
+		didFail = !_runLink(args.fname, &args, &perfOpts);
+	}
+	freeArguments(&args);
+	return didFail;
+}
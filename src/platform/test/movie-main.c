@@ -0,0 +1,516 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/core/config.h>
+#include <mgba/core/core.h>
+#include <mgba/core/serialize.h>
+#include <mgba/internal/gba/gba.h>
+#include <mgba/internal/gba/rr/mgm.h>
+#include <mgba/internal/gba/rr/vbm.h>
+
+#include <mgba/feature/commandline.h>
+#include <mgba-util/thread-pool.h>
+#include <mgba-util/vfs.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#define MOVIE_OPTIONS "e:j:k:m:R:S:"
+#define MOVIE_USAGE \
+	"\nMovie options:\n" \
+	"  -m MOVIE         Play MOVIE, either a .vbm file or an .mgm stream directory\n" \
+	"  -k FRAMES        Keep a keyframe every FRAMES frames in MOVIE.keyframes\n" \
+	"  -S FRAME         Seek to FRAME using the keyframes before playing the rest\n" \
+	"  -e HASH          Fail unless the state at the end of the movie has this hash\n" \
+	"  -j JOBS          Check the movie against existing keyframes, replaying the segments\n" \
+	"                   between them on JOBS threads\n" \
+	"  -R FRAMES        Record FRAMES frames of random input to a new .mgm stream MOVIE instead"
+
+struct MovieOpts {
+	char* movie;
+	uint32_t interval;
+	uint32_t seek;
+	bool doSeek;
+	uint64_t expected;
+	bool verify;
+	uint32_t record;
+	unsigned jobs;
+};
+
+union MovieContext {
+	struct GBARRContext d;
+	struct GBAMGMContext mgm;
+	struct GBAVBMContext vbm;
+};
+
+struct MovieInstance {
+	struct mCore* core;
+	union MovieContext context;
+	struct VDir* dir;
+};
+
+struct MovieVerifierSlot {
+	struct MovieInstance instance;
+	bool open;
+	bool busy;
+};
+
+struct MovieVerifier {
+	const char* fname;
+	const struct mArguments* args;
+	const struct MovieOpts* opts;
+	Mutex mutex;
+	// One per pool thread, so there is always a free one for each running job
+	struct MovieVerifierSlot* slots;
+	unsigned nSlots;
+	uint32_t nSegments;
+	uint32_t verified;
+	uint32_t failed;
+	uint32_t finalFrame;
+	uint64_t finalHash;
+};
+
+static bool _parseMovieOpts(struct mSubParser* parser, int option, const char* arg);
+static bool _mMovieRun(const char* fname, const struct mArguments* args, const struct MovieOpts* movieOpts);
+static bool _mMovieVerify(const char* fname, const struct mArguments* args, const struct MovieOpts* movieOpts);
+static void _mMovieShutdown(int signal);
+static void _log(struct mLogger*, int, enum mLogLevel, const char*, va_list);
+
+static bool _dispatchExiting = false;
+
+int main(int argc, char** argv) {
+	signal(SIGINT, _mMovieShutdown);
+
+	struct mLogger logger = { .log = _log };
+	mLogSetDefaultLogger(&logger);
+
+	struct MovieOpts movieOpts = { 0 };
+	struct mSubParser subparser = {
+		.usage = MOVIE_USAGE,
+		.parse = _parseMovieOpts,
+		.extraOptions = MOVIE_OPTIONS,
+		.opts = &movieOpts
+	};
+
+	int didFail = 0;
+	struct mArguments args = {};
+	bool parsed = parseArguments(&args, argc, argv, &subparser);
+	if (!args.fname || !movieOpts.movie) {
+		parsed = false;
+	}
+	if (!parsed || args.showHelp) {
+		usage(argv[0], MOVIE_USAGE);
+		didFail = !parsed;
+		goto cleanup;
+	}
+
+	if (args.showVersion) {
+		version(argv[0]);
+		goto cleanup;
+	}
+
+	if (movieOpts.jobs) {
+		didFail = !_mMovieVerify(args.fname, &args, &movieOpts);
+	} else {
+		didFail = !_mMovieRun(args.fname, &args, &movieOpts);
+	}
+
+	cleanup:
+	free(movieOpts.movie);
+	freeArguments(&args);
+	return didFail;
+}
+
+static uint64_t _mMovieNow(void) {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return 1000000LL * tv.tv_sec + tv.tv_usec;
+}
+
+static uint64_t _stateHash(struct mCore* core) {
+	uint64_t hash[2];
+	mCoreHashState(core, hash);
+	return hash[0];
+}
+
+static bool _openMovie(union MovieContext* context, const char* path, bool record, struct VDir** dir) {
+	*dir = NULL;
+	if (record) {
+#ifdef _WIN32
+		_mkdir(path);
+#else
+		mkdir(path, 0755);
+#endif
+	}
+	*dir = VDirOpen(path);
+	if (*dir) {
+		GBAMGMContextCreate(&context->mgm);
+		if (!GBAMGMSetStream(&context->mgm, *dir)) {
+			return false;
+		}
+		if (record) {
+			return GBAMGMCreateStream(&context->mgm, INIT_EX_NIHILO) && context->d.startRecording(&context->d);
+		}
+		return context->d.startPlaying(&context->d, false);
+	}
+	if (record) {
+		return false;
+	}
+	struct VFile* vf = VFileOpen(path, O_RDONLY);
+	if (!vf) {
+		return false;
+	}
+	GBAVBMContextCreate(&context->vbm);
+	if (!GBAVBMSetStream(&context->vbm, vf)) {
+		vf->close(vf);
+		return false;
+	}
+	return context->d.startPlaying(&context->d, false);
+}
+
+static bool _openKeyframes(struct GBARRContext* rr, const struct MovieOpts* movieOpts, int mode) {
+	char path[PATH_MAX];
+	snprintf(path, sizeof(path), "%s.keyframes", movieOpts->movie);
+	struct VFile* vf = VFileOpen(path, mode);
+	if (!vf || !GBARRSetKeyframes(rr, vf, movieOpts->interval)) {
+		if (vf) {
+			vf->close(vf);
+		}
+		fprintf(stderr, "Could not open keyframes %s\n", path);
+		return false;
+	}
+	return true;
+}
+
+static struct mCore* _createCore(const char* fname, const struct mArguments* args) {
+	struct mCore* core = mCoreFind(fname);
+	if (!core) {
+		fprintf(stderr, "Could not load %s\n", fname);
+		return NULL;
+	}
+	core->init(core);
+	if (core->platform(core) != PLATFORM_GBA) {
+		fprintf(stderr, "Only GBA movies are supported\n");
+		core->deinit(core);
+		return NULL;
+	}
+	mCoreLoadFile(core, fname);
+	mCoreConfigInit(&core->config, "movie");
+	mCoreConfigLoad(&core->config);
+	struct mCoreOptions opts = {};
+	mCoreConfigMap(&core->config, &opts);
+	opts.audioSync = false;
+	opts.videoSync = false;
+	applyArguments(args, NULL, &core->config);
+	mCoreConfigLoadDefaults(&core->config, &opts);
+	mCoreLoadConfig(core);
+	mCoreConfigFreeOpts(&opts);
+	core->reset(core);
+	return core;
+}
+
+static void _destroyCore(struct mCore* core) {
+	mCoreConfigDeinit(&core->config);
+	core->deinit(core);
+}
+
+static bool _mMovieRun(const char* fname, const struct mArguments* args, const struct MovieOpts* movieOpts) {
+	struct mCore* core = _createCore(fname, args);
+	if (!core) {
+		return false;
+	}
+	struct GBA* gba = core->board;
+	union MovieContext context;
+	struct VDir* dir;
+	bool record = movieOpts->record > 0;
+	bool success = _openMovie(&context, movieOpts->movie, record, &dir);
+	struct GBARRContext* rr = &context.d;
+	if (!success) {
+		fprintf(stderr, "Could not open movie %s\n", movieOpts->movie);
+		if (dir) {
+			rr->destroy(rr);
+			dir->close(dir);
+		}
+		_destroyCore(core);
+		return false;
+	}
+	if (movieOpts->interval && !_openKeyframes(rr, movieOpts, O_CREAT | O_RDWR)) {
+		success = false;
+	}
+
+	gba->rr = rr;
+	uint64_t start = _mMovieNow();
+	if (!success) {
+		// Fall through to cleanup
+	} else if (record) {
+		GBARRInitRecord(gba);
+		uint32_t seed = 0x2545F491;
+		uint32_t keys = 0;
+		uint32_t frame;
+		for (frame = 0; frame < movieOpts->record && !_dispatchExiting; ++frame) {
+			// Hold each random combination of buttons for a few frames
+			if (!(frame & 3)) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				keys = seed & 0x3FF;
+			}
+			core->setKeys(core, keys);
+			core->runFrame(core);
+		}
+		rr->stopRecording(rr);
+	} else {
+		GBARRInitPlay(gba);
+		if (movieOpts->doSeek) {
+			uint64_t seekStart = _mMovieNow();
+			if (!GBARRSeek(gba, movieOpts->seek)) {
+				fprintf(stderr, "Could not seek to frame %u\n", movieOpts->seek);
+				success = false;
+			} else {
+				printf("Seeked to frame %u in %" PRIu64 " microseconds\n", movieOpts->seek, _mMovieNow() - seekStart);
+			}
+		}
+		while (success && rr->isPlaying(rr) && !_dispatchExiting) {
+			core->runFrame(core);
+		}
+	}
+	uint64_t duration = _mMovieNow() - start;
+
+	if (success) {
+		uint64_t hash = _stateHash(core);
+		printf("%u frames in %" PRIu64 " microseconds, %u keyframes\n", rr->currentFrame, duration, GBARRKeyframeCount(rr));
+		printf("Final state: %016" PRIX64 "\n", hash);
+		if (movieOpts->verify && hash != movieOpts->expected) {
+			fprintf(stderr, "Final state does not match %016" PRIX64 "\n", movieOpts->expected);
+			success = false;
+		}
+	}
+
+	gba->rr = NULL;
+	GBARRDestroy(rr);
+	if (dir) {
+		dir->close(dir);
+	}
+	_destroyCore(core);
+	return success;
+}
+
+static bool _openInstance(struct MovieInstance* instance, const struct MovieVerifier* verifier) {
+	instance->core = _createCore(verifier->fname, verifier->args);
+	if (!instance->core) {
+		return false;
+	}
+	struct GBARRContext* rr = &instance->context.d;
+	if (!_openMovie(&instance->context, verifier->opts->movie, false, &instance->dir)) {
+		fprintf(stderr, "Could not open movie %s\n", verifier->opts->movie);
+		if (instance->dir) {
+			rr->destroy(rr);
+			instance->dir->close(instance->dir);
+		}
+		_destroyCore(instance->core);
+		return false;
+	}
+	// Each instance only reads the keyframes, so they can share the index
+	rr->verifyKeyframes = true;
+	if (!_openKeyframes(rr, verifier->opts, O_RDONLY)) {
+		GBARRDestroy(rr);
+		if (instance->dir) {
+			instance->dir->close(instance->dir);
+		}
+		_destroyCore(instance->core);
+		return false;
+	}
+	struct GBA* gba = instance->core->board;
+	gba->rr = rr;
+	GBARRInitPlay(gba);
+	return true;
+}
+
+static void _closeInstance(struct MovieInstance* instance) {
+	struct GBA* gba = instance->core->board;
+	gba->rr = NULL;
+	GBARRDestroy(&instance->context.d);
+	if (instance->dir) {
+		instance->dir->close(instance->dir);
+	}
+	_destroyCore(instance->core);
+}
+
+static struct MovieVerifierSlot* _claimSlot(struct MovieVerifier* verifier) {
+	struct MovieVerifierSlot* slot = NULL;
+	MutexLock(&verifier->mutex);
+	unsigned i;
+	for (i = 0; i < verifier->nSlots; ++i) {
+		if (!verifier->slots[i].busy) {
+			slot = &verifier->slots[i];
+			slot->busy = true;
+			break;
+		}
+	}
+	MutexUnlock(&verifier->mutex);
+	if (slot && !slot->open) {
+		slot->open = _openInstance(&slot->instance, verifier);
+	}
+	return slot;
+}
+
+static void _releaseSlot(struct MovieVerifier* verifier, struct MovieVerifierSlot* slot) {
+	MutexLock(&verifier->mutex);
+	slot->busy = false;
+	MutexUnlock(&verifier->mutex);
+}
+
+static void _verifySegment(void* context, size_t index) {
+	struct MovieVerifier* verifier = context;
+	if (_dispatchExiting) {
+		return;
+	}
+	// Opening a core costs far more than playing a segment, so cores are kept between segments
+	struct MovieVerifierSlot* slot = _claimSlot(verifier);
+	if (!slot->open) {
+		// Segments left unverified fail the verification
+		_releaseSlot(verifier, slot);
+		return;
+	}
+	struct GBA* gba = slot->instance.core->board;
+	struct GBARRContext* rr = &slot->instance.context.d;
+	uint32_t segment = index;
+	bool matched = GBARRVerifySegment(gba, segment);
+	bool last = segment + 1 == verifier->nSegments;
+	uint64_t hash = last ? _stateHash(slot->instance.core) : 0;
+	uint32_t frame = rr->currentFrame;
+	uint32_t interval = rr->keyframeInterval;
+	_releaseSlot(verifier, slot);
+
+	MutexLock(&verifier->mutex);
+	++verifier->verified;
+	if (!matched) {
+		++verifier->failed;
+		if (last) {
+			printf("Segment %u could not be played\n", segment);
+		} else {
+			printf("Segment %u (frames %u to %u) does not match keyframe %u\n", segment,
+			       segment * interval, (segment + 1) * interval, segment + 1);
+		}
+	}
+	if (last) {
+		verifier->finalFrame = frame;
+		verifier->finalHash = hash;
+	}
+	MutexUnlock(&verifier->mutex);
+}
+
+static bool _mMovieVerify(const char* fname, const struct mArguments* args, const struct MovieOpts* movieOpts) {
+	struct MovieVerifier verifier = {
+		.fname = fname,
+		.args = args,
+		.opts = movieOpts,
+	};
+	if (!movieOpts->interval) {
+		fprintf(stderr, "Verifying a movie needs its keyframe interval (-k)\n");
+		return false;
+	}
+
+	// Each segment starts at a keyframe, the last one running to the end of the movie
+	struct MovieInstance instance;
+	if (!_openInstance(&instance, &verifier)) {
+		return false;
+	}
+	verifier.nSegments = GBARRKeyframeCount(&instance.context.d);
+	_closeInstance(&instance);
+	if (!verifier.nSegments) {
+		fprintf(stderr, "No keyframes to verify against\n");
+		return false;
+	}
+
+	unsigned jobs = movieOpts->jobs;
+	if (jobs > verifier.nSegments) {
+		jobs = verifier.nSegments;
+	}
+	MutexInit(&verifier.mutex);
+	verifier.slots = calloc(jobs, sizeof(*verifier.slots));
+	verifier.nSlots = jobs;
+	uint64_t start = _mMovieNow();
+	struct ThreadPool pool;
+	ThreadPoolInit(&pool, jobs, "Movie Verify Thread");
+	ThreadPoolRun(&pool, verifier.nSegments, _verifySegment, &verifier);
+	ThreadPoolDeinit(&pool);
+	uint64_t duration = _mMovieNow() - start;
+	unsigned i;
+	for (i = 0; i < verifier.nSlots; ++i) {
+		if (verifier.slots[i].open) {
+			_closeInstance(&verifier.slots[i].instance);
+		}
+	}
+	free(verifier.slots);
+	MutexDeinit(&verifier.mutex);
+
+	bool success = !verifier.failed && verifier.verified == verifier.nSegments;
+	printf("%u segments on %u threads in %" PRIu64 " microseconds, %u failed\n", verifier.nSegments, jobs, duration, verifier.failed);
+	if (success) {
+		printf("%u frames\n", verifier.finalFrame);
+		printf("Final state: %016" PRIX64 "\n", verifier.finalHash);
+		if (movieOpts->verify && verifier.finalHash != movieOpts->expected) {
+			fprintf(stderr, "Final state does not match %016" PRIX64 "\n", movieOpts->expected);
+			success = false;
+		}
+	}
+	return success;
+}
+
+static void _mMovieShutdown(int signal) {
+	UNUSED(signal);
+	_dispatchExiting = true;
+}
+
+// Only report problems, which includes desyncs noticed by the movie
+static void _log(struct mLogger* log, int category, enum mLogLevel level, const char* format, va_list args) {
+	UNUSED(log);
+	if (!(level & (mLOG_WARN | mLOG_ERROR | mLOG_FATAL))) {
+		return;
+	}
+	if (level == mLOG_WARN && category != _mLOG_CAT_GBA_RR()) {
+		return;
+	}
+	fprintf(stderr, "%s: ", mLogCategoryName(category));
+	vfprintf(stderr, format, args);
+	fprintf(stderr, "\n");
+}
+
+static bool _parseMovieOpts(struct mSubParser* parser, int option, const char* arg) {
+	struct MovieOpts* opts = parser->opts;
+	errno = 0;
+	switch (option) {
+	case 'e':
+		opts->expected = strtoull(arg, 0, 16);
+		opts->verify = true;
+		return !errno;
+	case 'j':
+		opts->jobs = strtoul(arg, 0, 10);
+		return !errno && opts->jobs;
+	case 'k':
+		opts->interval = strtoul(arg, 0, 10);
+		return !errno && opts->interval;
+	case 'm':
+		opts->movie = strdup(arg);
+		return true;
+	case 'R':
+		opts->record = strtoul(arg, 0, 10);
+		return !errno && opts->record;
+	case 'S':
+		opts->seek = strtoul(arg, 0, 10);
+		opts->doSeek = true;
+		return !errno;
+	default:
+		return false;
+	}
+}
@@ -3,17 +3,30 @@
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// For CPU affinity
+#define _GNU_SOURCE
+#endif
 #include <mgba/core/blip_buf.h>
 #include <mgba/core/cheats.h>
 #include <mgba/core/config.h>
 #include <mgba/core/core.h>
+#include <mgba/core/profile.h>
+#include <mgba/core/rom-cache.h>
 #include <mgba/core/serialize.h>
+#include <mgba/core/state-slots.h>
 #include <mgba/gb/core.h>
 #include <mgba/gba/core.h>
 
 #include <mgba/feature/commandline.h>
+#include <mgba-util/archive-cache.h>
+#include <mgba-util/hash.h>
+#include <mgba-util/memory.h>
 #include <mgba-util/socket.h>
 #include <mgba-util/string.h>
+#ifndef DISABLE_THREADING
+#include <mgba-util/threading.h>
+#endif
 #include <mgba-util/vfs.h>
 
 #ifdef _3DS
@@ -28,17 +41,33 @@
 #include <signal.h>
 #include <inttypes.h>
 #include <sys/time.h>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
 
-#define PERF_OPTIONS "DF:L:NPS:T"
+#define PERF_ARCHIVE_CACHE_SIZE 0x10000000
+#define PERF_STATE_SLOTS 10
+#define PERF_STATE_ITERATIONS 60
+#define PERF_CSV_ROW_SIZE 4096
+
+#define PERF_OPTIONS "ADEF:HI:K:L:NPR:S:TZ:"
 #define PERF_USAGE \
 	"\nBenchmark options:\n" \
 	"  -F FRAMES        Run for the specified number of FRAMES before exiting\n" \
 	"  -N               Disable video rendering entirely\n" \
-	"  -T               Use threaded video rendering\n" \
-	"  -P               CSV output, useful for parsing\n" \
+	"  -T               Use threaded video rendering, reporting what is sent to the render thread\n" \
+	"  -P               CSV output, useful for parsing; -E, -T, -H and -K add columns\n" \
 	"  -S SEC           Run for SEC in-game seconds before exiting\n" \
 	"  -L FILE          Load a savestate when starting the test\n" \
-	"  -D               Act as a server"
+	"  -D               Act as a server\n" \
+	"  -I COUNT         Run COUNT instances at once, each on its own thread\n" \
+	"  -R ROM           Also run ROM, alternating between ROMs across instances\n" \
+	"  -A               Pin each instance's thread to its own CPU\n" \
+	"  -E               Count timing events, instructions, DMA units and scanlines\n" \
+	"  -H               Hash the state after every frame and print a digest of all of them\n" \
+	"  -Z DIR           Cache ROMs extracted from archives in DIR\n" \
+	"  -K FILE          Afterwards, time quick-saves and quick-loads using a state slot file at FILE"
 
 struct PerfOpts {
 	bool noVideo;
@@ -48,6 +77,40 @@ struct PerfOpts {
 	unsigned frames;
 	char* savestate;
 	bool server;
+	unsigned instances;
+	bool pin;
+	bool profile;
+	bool hashStates;
+	struct StringList extraRoms;
+	char* archiveCache;
+	char* stateSlots;
+};
+
+// A ROM shared by several instances, loaded once and handed to each core as read-only memory
+struct PerfRom {
+	const char* path;
+	void* data;
+	size_t size;
+	float soloFps;
+};
+
+// Counters only known once a run is over, so its header can't be printed ahead of time
+struct PerfCsvRow {
+	char header[PERF_CSV_ROW_SIZE];
+	char row[PERF_CSV_ROW_SIZE];
+};
+
+struct PerfInstance {
+	struct mCore* core;
+	struct PerfRom* rom;
+	void* outputBuffer;
+	int index;
+	int frames;
+	uint64_t duration;
+	bool pin;
+#ifndef DISABLE_THREADING
+	Thread thread;
+#endif
 };
 
 #ifdef _3DS
@@ -58,12 +121,17 @@ FS_Archive sdmcArchive;
 TimeType __nx_time_type = TimeType_LocalSystemClock;
 #endif
 
-static void _mPerfRunloop(struct mCore* context, int* frames, bool quiet);
+static void _mPerfRunloop(struct mCore* context, int* frames, bool quiet, struct Hash128* digest);
 static void _mPerfShutdown(int signal);
 static bool _parsePerfOpts(struct mSubParser* parser, int option, const char* arg);
 static void _log(struct mLogger*, int, enum mLogLevel, const char*, va_list);
 static bool _mPerfRunCore(const char* fname, const struct mArguments*, const struct PerfOpts*);
+static bool _mPerfTimeStateSlots(struct mCore*, const char* path, struct PerfCsvRow* csv);
+static bool _mPerfCsvExtended(const struct PerfOpts*);
 static bool _mPerfRunServer(const char* listen, const struct mArguments*, const struct PerfOpts*);
+#ifndef DISABLE_THREADING
+static bool _mPerfRunMulti(const char* fname, const struct mArguments*, const struct PerfOpts*);
+#endif
 
 static bool _dispatchExiting = false;
 static struct VFile* _savestate = 0;
@@ -91,7 +159,8 @@ int main(int argc, char** argv) {
 	struct mLogger logger = { .log = _log };
 	mLogSetDefaultLogger(&logger);
 
-	struct PerfOpts perfOpts = { false, false, false, 0, 0, 0, false };
+	struct PerfOpts perfOpts = { false, false, false, 0, 0, 0, false, 1, false, false };
+	StringListInit(&perfOpts.extraRoms, 0);
 	struct mSubParser subparser = {
 		.usage = PERF_USAGE,
 		.parse = _parsePerfOpts,
@@ -120,22 +189,58 @@ int main(int argc, char** argv) {
 		free(perfOpts.savestate);
 	}
 
+#if defined(USE_LIBZIP) || defined(USE_ZLIB) || defined(USE_LZMA)
+	struct ArchiveCache archiveCache;
+	if (perfOpts.archiveCache) {
+		if (!ArchiveCacheInit(&archiveCache, perfOpts.archiveCache, PERF_ARCHIVE_CACHE_SIZE)) {
+			fprintf(stderr, "Could not open archive cache %s\n", perfOpts.archiveCache);
+			didFail = 1;
+			goto cleanup;
+		}
+		ArchiveCacheSetDefault(&archiveCache);
+	}
+#endif
+
 	_outputBuffer = malloc(256 * 256 * 4);
-	if (perfOpts.csv) {
+	bool multi = perfOpts.instances > 1 || StringListSize(&perfOpts.extraRoms);
+	if (perfOpts.csv && !multi && !_mPerfCsvExtended(&perfOpts)) {
 		puts("game_code,frames,duration,renderer");
 	}
 	if (perfOpts.server) {
 		didFail = !_mPerfRunServer(args.fname, &args, &perfOpts);
+	} else if (multi) {
+#ifndef DISABLE_THREADING
+		didFail = !_mPerfRunMulti(args.fname, &args, &perfOpts);
+#else
+		puts("Multiple instances require threading support");
+		didFail = 1;
+#endif
 	} else {
 		didFail = !_mPerfRunCore(args.fname, &args, &perfOpts);
 	}
 	free(_outputBuffer);
 
+#if defined(USE_LIBZIP) || defined(USE_ZLIB) || defined(USE_LZMA)
+	if (perfOpts.archiveCache) {
+		if (!perfOpts.csv) {
+			printf("Archive cache: %" PRIu64 " hits, %" PRIu64 " misses\n", archiveCache.hits, archiveCache.misses);
+		}
+		ArchiveCacheDeinit(&archiveCache);
+	}
+#endif
+
+	cleanup:
 	if (_savestate) {
 		_savestate->close(_savestate);
 	}
-	cleanup:
+	free(perfOpts.archiveCache);
+	free(perfOpts.stateSlots);
 	freeArguments(&args);
+	size_t i;
+	for (i = 0; i < StringListSize(&perfOpts.extraRoms); ++i) {
+		free(*StringListGetPointer(&perfOpts.extraRoms, i));
+	}
+	StringListDeinit(&perfOpts.extraRoms);
 
 #ifdef _3DS
 	gfxExit();
@@ -147,20 +252,41 @@ int main(int argc, char** argv) {
 	return didFail;
 }
 
-bool _mPerfRunCore(const char* fname, const struct mArguments* args, const struct PerfOpts* perfOpts) {
+static struct mCore* _mPerfCreateCore(const char* fname, const struct mArguments* args, const struct PerfOpts* perfOpts, void* outputBuffer, struct PerfRom* rom) {
 	struct mCore* core = mCoreFind(fname);
 	if (!core) {
-		return false;
+		return NULL;
 	}
 
-	// TODO: Put back debugger
-	char gameCode[9] = { 0 };
-
 	core->init(core);
 	if (!perfOpts->noVideo) {
-		core->setVideoBuffer(core, _outputBuffer, 256);
+		core->setVideoBuffer(core, outputBuffer, 256);
+	}
+	if (!rom) {
+		mCoreLoadFile(core, fname);
+	} else {
+		if (!rom->data) {
+			struct VFile* vf = mDirectorySetOpenPath(&core->dirs, fname, core->isROM);
+			if (vf) {
+				rom->size = vf->size(vf);
+				rom->data = anonymousMemoryMap(rom->size);
+				vf->seek(vf, 0, SEEK_SET);
+				if (vf->read(vf, rom->data, rom->size) != (ssize_t) rom->size) {
+					mappedMemoryFree(rom->data, rom->size);
+					rom->data = NULL;
+				}
+				vf->close(vf);
+			}
+		}
+		struct VFile* vf = VFileFromConstMemory(rom->data, rom->size);
+		if (!vf || !core->loadROM(core, vf)) {
+			if (vf) {
+				vf->close(vf);
+			}
+			core->deinit(core);
+			return NULL;
+		}
 	}
-	mCoreLoadFile(core, fname);
 	mCoreConfigInit(&core->config, "perf");
 	mCoreConfigLoad(&core->config);
 
@@ -178,54 +304,285 @@ bool _mPerfRunCore(const char* fname, const struct mArguments* args, const struc
 	mCoreConfigLoadDefaults(&core->config, &opts);
 	mCoreConfigSetDefaultValue(&core->config, "idleOptimization", "detect");
 	mCoreLoadConfig(core);
+	mCoreConfigFreeOpts(&opts);
 
 	core->reset(core);
 	if (_savestate) {
+		_savestate->seek(_savestate, 0, SEEK_SET);
 		mCoreLoadStateNamed(core, _savestate, 0);
 	}
+	return core;
+}
+
+static void _mPerfDestroyCore(struct mCore* core) {
+	mCoreConfigDeinit(&core->config);
+	core->deinit(core);
+}
+
+static void _mPerfCsvAppend(struct PerfCsvRow* csv, const char* column, const char* value) {
+	size_t length = strlen(csv->header);
+	snprintf(&csv->header[length], sizeof(csv->header) - length, ",%s", column);
+	length = strlen(csv->row);
+	snprintf(&csv->row[length], sizeof(csv->row) - length, ",%s", value);
+}
 
+static void _mPerfPrintCounter(const char* category, const char* name, uint64_t count, int frames, struct PerfCsvRow* csv) {
+	if (csv) {
+		char column[128];
+		char value[24];
+		snprintf(column, sizeof(column), "%s:%s", category, name);
+		snprintf(value, sizeof(value), "%" PRIu64, count);
+		_mPerfCsvAppend(csv, column, value);
+	} else {
+		printf("  %-24s %14" PRIu64 " %12.1f/frame\n", name, count, frames ? count / (double) frames : 0.0);
+	}
+}
+
+static void _mPerfPrintProxy(const struct mProfile* profile, int frames, struct PerfCsvRow* csv) {
+	if (!csv) {
+		printf("Proxy renderer:\n");
+	}
+	_mPerfPrintCounter("proxy", "packets", profile->proxyPackets, frames, csv);
+	_mPerfPrintCounter("proxy", "bytes", profile->proxyBytes, frames, csv);
+}
+
+static void _mPerfPrintProfile(const struct mProfile* profile, int frames, struct PerfCsvRow* csv) {
+	size_t i;
+	if (!csv) {
+		printf("Timing events:\n");
+	}
+	for (i = 0; i < profile->nEvents; ++i) {
+		_mPerfPrintCounter("event", profile->events[i].name, profile->events[i].count, frames, csv);
+	}
+	if (profile->eventsUnlisted) {
+		_mPerfPrintCounter("event", "(other)", profile->eventsUnlisted, frames, csv);
+	}
+	if (!csv) {
+		printf("Instructions:\n");
+	}
+	for (i = 0; i < profile->nModes; ++i) {
+		_mPerfPrintCounter("instructions", profile->instructions[i].name, profile->instructions[i].count, frames, csv);
+	}
+	if (!csv) {
+		printf("DMA units:\n");
+	}
+	for (i = 0; i < profile->nDMAs; ++i) {
+		_mPerfPrintCounter("dma", profile->dma[i].name, profile->dma[i].count, frames, csv);
+	}
+	if (!csv) {
+		printf("Scanlines:\n");
+	}
+	_mPerfPrintCounter("scanlines", "rendered", profile->scanlinesRendered, frames, csv);
+	_mPerfPrintCounter("scanlines", "skipped", profile->scanlinesSkipped, frames, csv);
+}
+
+static const char* _mPerfRendererName(const struct PerfOpts* perfOpts) {
+	if (perfOpts->noVideo) {
+		return "none";
+	} else if (perfOpts->threadedVideo) {
+		return "threaded-software";
+	}
+	return "software";
+}
+
+static bool _mPerfCsvExtended(const struct PerfOpts* perfOpts) {
+	return perfOpts->profile || perfOpts->threadedVideo || perfOpts->hashStates || perfOpts->stateSlots;
+}
+
+bool _mPerfRunCore(const char* fname, const struct mArguments* args, const struct PerfOpts* perfOpts) {
+	struct mCore* core = _mPerfCreateCore(fname, args, perfOpts, _outputBuffer, NULL);
+	if (!core) {
+		return false;
+	}
+
+	// TODO: Put back debugger
+	char gameCode[9] = { 0 };
 	core->getGameCode(core, gameCode);
 
 	int frames = perfOpts->frames;
 	if (!frames) {
 		frames = perfOpts->duration * 60;
 	}
+	struct mProfile profile;
+	if (perfOpts->profile || perfOpts->threadedVideo) {
+		mProfileInit(&profile);
+		core->setProfile(core, &profile);
+	}
 	struct timeval tv;
 	gettimeofday(&tv, 0);
 	uint64_t start = 1000000LL * tv.tv_sec + tv.tv_usec;
-	_mPerfRunloop(core, &frames, perfOpts->csv);
+	struct Hash128 digest;
+	hash128Init(&digest, 0);
+	_mPerfRunloop(core, &frames, perfOpts->csv, perfOpts->hashStates ? &digest : NULL);
 	gettimeofday(&tv, 0);
 	uint64_t end = 1000000LL * tv.tv_sec + tv.tv_usec;
 	uint64_t duration = end - start;
 
-	mCoreConfigFreeOpts(&opts);
-	mCoreConfigDeinit(&core->config);
-	core->deinit(core);
-
 	float scaledFrames = frames * 1000000.f;
+	struct PerfCsvRow* csv = NULL;
 	if (perfOpts->csv) {
-		char buffer[256];
-		const char* rendererName;
-		if (perfOpts->noVideo) {
-			rendererName = "none";
-		} else if (perfOpts->threadedVideo) {
-			rendererName = "threaded-software";
-		} else {
-			rendererName = "software";
-		}
-		snprintf(buffer, sizeof(buffer), "%s,%i,%" PRIu64 ",%s\n", gameCode, frames, duration, rendererName);
-		printf("%s", buffer);
+		csv = malloc(sizeof(*csv));
+		strncpy(csv->header, "game_code,frames,duration,renderer", sizeof(csv->header) - 1);
+		csv->header[sizeof(csv->header) - 1] = '\0';
+		snprintf(csv->row, sizeof(csv->row), "%s,%i,%" PRIu64 ",%s", gameCode, frames, duration, _mPerfRendererName(perfOpts));
 		if (_socket != INVALID_SOCKET) {
-			SocketSend(_socket, buffer, strlen(buffer));
+			// The server sends its header up front, so it only gets the fixed columns
+			SocketSend(_socket, csv->row, strlen(csv->row));
+			SocketSend(_socket, "\n", 1);
 		}
 	} else {
 		printf("%u frames in %" PRIu64 " microseconds: %g fps (%gx)\n", frames, duration, scaledFrames / duration, scaledFrames / (duration * 60.f));
 	}
+	if (perfOpts->profile) {
+		_mPerfPrintProfile(&profile, frames, csv);
+	}
+	if (perfOpts->threadedVideo) {
+		_mPerfPrintProxy(&profile, frames, csv);
+	}
+	if (perfOpts->hashStates) {
+		uint64_t hash[2];
+		hash128Finish(&digest, hash);
+		if (csv) {
+			char value[33];
+			snprintf(value, sizeof(value), "%016" PRIX64 "%016" PRIX64, hash[0], hash[1]);
+			_mPerfCsvAppend(csv, "digest", value);
+		} else {
+			printf("State digest over %u frames: %016" PRIX64 "%016" PRIX64 "\n", frames, hash[0], hash[1]);
+		}
+	}
 
+	bool success = true;
+	if (perfOpts->stateSlots && !_dispatchExiting) {
+		success = _mPerfTimeStateSlots(core, perfOpts->stateSlots, csv);
+	}
+	if (csv) {
+		if (_mPerfCsvExtended(perfOpts)) {
+			// Which counters exist depends on the core, so each run gets its own header
+			puts(csv->header);
+		}
+		puts(csv->row);
+		free(csv);
+	}
+	_mPerfDestroyCore(core);
+	return success;
+}
+
+struct PerfLatency {
+	const char* name;
+	uint64_t total;
+	uint64_t max;
+};
+
+static uint64_t _mPerfNow(void) {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return 1000000LL * tv.tv_sec + tv.tv_usec;
+}
+
+static void _mPerfLatencyAdd(struct PerfLatency* latency, uint64_t start) {
+	uint64_t duration = _mPerfNow() - start;
+	latency->total += duration;
+	if (duration > latency->max) {
+		latency->max = duration;
+	}
+}
+
+// Compares one file per slot, rewritten on every save the way mCoreSaveState does it,
+// against saving into and loading from a preallocated slot file in place
+static bool _mPerfTimeStateSlots(struct mCore* core, const char* path, struct PerfCsvRow* csv) {
+	int flags = SAVESTATE_SAVEDATA | SAVESTATE_RTC | SAVESTATE_METADATA;
+	void* savedata = NULL;
+	size_t savedataSize = core->savedataClone(core, &savedata);
+	free(savedata);
+
+	struct VFile* vf = VFileOpen(path, O_CREAT | O_RDWR);
+	if (!vf) {
+		fprintf(stderr, "Could not open state slot file %s\n", path);
+		return false;
+	}
+	struct mStateSlots slots;
+	if (!mStateSlotsInit(&slots, vf, PERF_STATE_SLOTS, mCoreSaveStateBufferSize(core, savedataSize, flags))) {
+		fprintf(stderr, "Could not map state slot file %s\n", path);
+		vf->close(vf);
+		return false;
+	}
+	// Plain saves only reach the page cache, like the file they're compared against
+	mStateSlotsSetDurable(&slots, false);
+	char statePath[PATH_MAX];
+	snprintf(statePath, sizeof(statePath), "%s.ss1", path);
+
+	struct PerfLatency latencies[] = {
+		{ "file save" }, { "file load" },
+		{ "slot save" }, { "slot load" },
+		{ "durable slot save" }
+	};
+	bool success = true;
+	int i;
+	for (i = 0; i < PERF_STATE_ITERATIONS && success; ++i) {
+		unsigned slot = i % (PERF_STATE_SLOTS - 1);
+		core->runFrame(core);
+
+		uint64_t start = _mPerfNow();
+		struct VFile* state = VFileOpen(statePath, O_CREAT | O_TRUNC | O_RDWR);
+		success = state && mCoreSaveStateNamed(core, state, flags);
+		if (state) {
+			state->close(state);
+		}
+		_mPerfLatencyAdd(&latencies[0], start);
+
+		start = _mPerfNow();
+		success = success && mStateSlotsSave(&slots, core, slot, flags);
+		_mPerfLatencyAdd(&latencies[2], start);
+
+		mStateSlotsSetDurable(&slots, true);
+		start = _mPerfNow();
+		success = success && mStateSlotsSave(&slots, core, PERF_STATE_SLOTS - 1, flags);
+		_mPerfLatencyAdd(&latencies[4], start);
+		mStateSlotsSetDurable(&slots, false);
+
+		start = _mPerfNow();
+		state = VFileOpen(statePath, O_RDONLY);
+		success = success && state && mCoreLoadStateNamed(core, state, flags);
+		if (state) {
+			state->close(state);
+		}
+		_mPerfLatencyAdd(&latencies[1], start);
+
+		start = _mPerfNow();
+		success = success && mStateSlotsLoad(&slots, core, slot, flags);
+		_mPerfLatencyAdd(&latencies[3], start);
+	}
+	mStateSlotsDeinit(&slots);
+	vf->close(vf);
+	remove(statePath);
+	if (!success) {
+		fprintf(stderr, "Could not save or load state\n");
+		return false;
+	}
+
+	if (!csv) {
+		printf("State latency over %i saves:\n", PERF_STATE_ITERATIONS);
+	}
+	size_t l;
+	for (l = 0; l < sizeof(latencies) / sizeof(*latencies); ++l) {
+		double mean = latencies[l].total / (double) PERF_STATE_ITERATIONS;
+		if (csv) {
+			char column[64];
+			char value[24];
+			snprintf(column, sizeof(column), "state:%s:mean", latencies[l].name);
+			snprintf(value, sizeof(value), "%.1f", mean);
+			_mPerfCsvAppend(csv, column, value);
+			snprintf(column, sizeof(column), "state:%s:max", latencies[l].name);
+			snprintf(value, sizeof(value), "%" PRIu64, latencies[l].max);
+			_mPerfCsvAppend(csv, column, value);
+		} else {
+			printf("  %-24s %10.1f us mean %10" PRIu64 " us max\n", latencies[l].name, mean, latencies[l].max);
+		}
+	}
 	return true;
 }
 
-static void _mPerfRunloop(struct mCore* core, int* frames, bool quiet) {
+static void _mPerfRunloop(struct mCore* core, int* frames, bool quiet, struct Hash128* digest) {
 	struct timeval lastEcho;
 	gettimeofday(&lastEcho, 0);
 	int duration = *frames;
@@ -235,6 +592,15 @@ static void _mPerfRunloop(struct mCore* core, int* frames, bool quiet) {
 		core->runFrame(core);
 		++*frames;
 		++lastFrames;
+		if (digest) {
+			// Chaining the per-frame hashes catches states that diverge and later converge again
+			uint64_t hash[2];
+			uint8_t bytes[16];
+			mCoreHashState(core, hash);
+			STORE_64LE(hash[0], 0, bytes);
+			STORE_64LE(hash[1], 8, bytes);
+			hash128Update(digest, bytes, sizeof(bytes));
+		}
 		if (!quiet) {
 			struct timeval currentTime;
 			long timeDiff;
@@ -298,6 +664,155 @@ static bool _mPerfRunServer(const char* listen, const struct mArguments* args, c
 	return true;
 }
 
+#ifndef DISABLE_THREADING
+static uint64_t _mPerfTime(void) {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return 1000000LL * tv.tv_sec + tv.tv_usec;
+}
+
+static THREAD_ENTRY _mPerfInstanceThread(void* context) {
+	struct PerfInstance* instance = context;
+	char name[32];
+	snprintf(name, sizeof(name), "Perf Instance %i", instance->index);
+	ThreadSetName(name);
+#ifdef __linux__
+	if (instance->pin) {
+		long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+		int cpu = instance->index % (nCpus > 0 && nCpus < CPU_SETSIZE ? nCpus : CPU_SETSIZE);
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(cpu, &cpus);
+		if (sched_setaffinity(0, sizeof(cpus), &cpus) < 0) {
+			printf("Could not pin instance %i to CPU %i\n", instance->index, cpu);
+		}
+	}
+#endif
+	uint64_t start = _mPerfTime();
+	_mPerfRunloop(instance->core, &instance->frames, true, NULL);
+	instance->duration = _mPerfTime() - start;
+	return 0;
+}
+
+static bool _mPerfRunMulti(const char* fname, const struct mArguments* args, const struct PerfOpts* perfOpts) {
+	int frames = perfOpts->frames;
+	if (!frames) {
+		frames = perfOpts->duration * 60;
+	}
+	if (!frames) {
+		puts("Multiple instances require -F or -S");
+		return false;
+	}
+	// Instances running the same ROM can share its pages
+	mROMCacheSetEnabled(true);
+#ifndef __linux__
+	if (perfOpts->pin) {
+		puts("CPU pinning is not supported on this platform");
+	}
+#endif
+
+	size_t nRoms = StringListSize(&perfOpts->extraRoms) + 1;
+	struct PerfRom* roms = calloc(nRoms, sizeof(*roms));
+	roms[0].path = fname;
+	size_t i;
+	for (i = 1; i < nRoms; ++i) {
+		roms[i].path = *StringListGetConstPointer(&perfOpts->extraRoms, i - 1);
+	}
+
+	unsigned nInstances = perfOpts->instances;
+	if (nInstances < nRoms) {
+		nInstances = nRoms;
+	}
+	struct PerfInstance* instances = calloc(nInstances, sizeof(*instances));
+	bool success = true;
+
+	// Measure each ROM alone first so the parallel run has something to be compared against
+	for (i = 0; i < nRoms && !_dispatchExiting; ++i) {
+		struct mCore* core = _mPerfCreateCore(roms[i].path, args, perfOpts, _outputBuffer, &roms[i]);
+		if (!core) {
+			printf("Could not load %s\n", roms[i].path);
+			success = false;
+			goto cleanup;
+		}
+		int soloFrames = frames;
+		uint64_t start = _mPerfTime();
+		_mPerfRunloop(core, &soloFrames, true, NULL);
+		uint64_t duration = _mPerfTime() - start;
+		_mPerfDestroyCore(core);
+		roms[i].soloFps = soloFrames * 1000000.f / duration;
+	}
+
+	for (i = 0; i < nInstances; ++i) {
+		struct PerfInstance* instance = &instances[i];
+		instance->index = i;
+		instance->rom = &roms[i % nRoms];
+		instance->frames = frames;
+		instance->pin = perfOpts->pin;
+		if (!perfOpts->noVideo) {
+			instance->outputBuffer = malloc(256 * 256 * 4);
+		}
+		instance->core = _mPerfCreateCore(instance->rom->path, args, perfOpts, instance->outputBuffer, instance->rom);
+		if (!instance->core) {
+			printf("Could not load %s\n", instance->rom->path);
+			success = false;
+			goto cleanup;
+		}
+	}
+
+	uint64_t start = _mPerfTime();
+	for (i = 0; i < nInstances; ++i) {
+		ThreadCreate(&instances[i].thread, _mPerfInstanceThread, &instances[i]);
+	}
+	for (i = 0; i < nInstances; ++i) {
+		ThreadJoin(instances[i].thread);
+	}
+	uint64_t duration = _mPerfTime() - start;
+
+	if (perfOpts->csv) {
+		puts("instance,game_code,frames,duration,renderer,efficiency");
+	}
+	uint64_t totalFrames = 0;
+	float efficiency = 0;
+	for (i = 0; i < nInstances; ++i) {
+		struct PerfInstance* instance = &instances[i];
+		char gameCode[9] = { 0 };
+		instance->core->getGameCode(instance->core, gameCode);
+		float fps = instance->frames * 1000000.f / instance->duration;
+		float relative = instance->rom->soloFps > 0 ? fps / instance->rom->soloFps : 0;
+		totalFrames += instance->frames;
+		efficiency += relative;
+		if (perfOpts->csv) {
+			printf("%u,%s,%i,%" PRIu64 ",%s,%.4f\n", (unsigned) i, gameCode, instance->frames, instance->duration, _mPerfRendererName(perfOpts), relative);
+		} else {
+			printf("Instance %u (%s): %i frames in %" PRIu64 " microseconds: %g fps (%.1f%% of solo %g fps)\n", (unsigned) i, gameCode, instance->frames, instance->duration, fps, relative * 100, instance->rom->soloFps);
+		}
+	}
+	efficiency /= nInstances;
+	if (perfOpts->csv) {
+		printf("aggregate,,%" PRIu64 ",%" PRIu64 ",%s,%.4f\n", totalFrames, duration, _mPerfRendererName(perfOpts), efficiency);
+	} else {
+		float fps = totalFrames * 1000000.f / duration;
+		printf("Aggregate: %u instances, %" PRIu64 " frames in %" PRIu64 " microseconds: %g fps (%gx), scaling efficiency %.1f%%\n", nInstances, totalFrames, duration, fps, fps / 60.f, efficiency * 100);
+	}
+
+cleanup:
+	for (i = 0; i < nInstances; ++i) {
+		if (instances[i].core) {
+			_mPerfDestroyCore(instances[i].core);
+		}
+		free(instances[i].outputBuffer);
+	}
+	free(instances);
+	for (i = 0; i < nRoms; ++i) {
+		if (roms[i].data) {
+			mappedMemoryFree(roms[i].data, roms[i].size);
+		}
+	}
+	free(roms);
+	return success;
+}
+#endif
+
 static void _mPerfShutdown(int signal) {
 	UNUSED(signal);
 	_dispatchExiting = true;
@@ -308,27 +823,48 @@ static bool _parsePerfOpts(struct mSubParser* parser, int option, const char* ar
 	struct PerfOpts* opts = parser->opts;
 	errno = 0;
 	switch (option) {
+	case 'A':
+		opts->pin = true;
+		return true;
 	case 'D':
 		opts->server = true;
 		return true;
+	case 'E':
+		opts->profile = true;
+		return true;
 	case 'F':
 		opts->frames = strtoul(arg, 0, 10);
 		return !errno;
+	case 'H':
+		opts->hashStates = true;
+		return true;
+	case 'I':
+		opts->instances = strtoul(arg, 0, 10);
+		return !errno && opts->instances;
 	case 'N':
 		opts->noVideo = true;
 		return true;
 	case 'P':
 		opts->csv = true;
 		return true;
+	case 'R':
+		*StringListAppend(&opts->extraRoms) = strdup(arg);
+		return true;
 	case 'S':
 		opts->duration = strtoul(arg, 0, 10);
 		return !errno;
 	case 'T':
 		opts->threadedVideo = true;
 		return true;
+	case 'K':
+		opts->stateSlots = strdup(arg);
+		return true;
 	case 'L':
 		opts->savestate = strdup(arg);
 		return true;
+	case 'Z':
+		opts->archiveCache = strdup(arg);
+		return true;
 	default:
 		return false;
 	}
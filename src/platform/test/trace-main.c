@@ -0,0 +1,319 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/core/config.h>
+#include <mgba/core/core.h>
+#include <mgba/internal/arm/decoder.h>
+#include <mgba/internal/arm/trace.h>
+#ifdef USE_DEBUGGERS
+#include <mgba/internal/debugger/symbols.h>
+#endif
+
+#include <mgba/feature/commandline.h>
+#include <mgba-util/elf-read.h>
+#include <mgba-util/vfs.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#define TRACE_OPTIONS "DF:n:o:ry:"
+#define TRACE_USAGE \
+	"\nTrace options:\n" \
+	"  -o FILE          Record an instruction trace of the game to FILE\n" \
+	"  -F FRAMES        Stop recording after FRAMES frames\n" \
+	"  -r               Also record register changes\n" \
+	"  -D               Decode the trace file given instead of a game\n" \
+	"  -y FILE          Label decoded addresses using a symbol file\n" \
+	"  -n COUNT         Decode at most COUNT instructions"
+
+struct TraceOpts {
+	char* output;
+	unsigned frames;
+	bool registers;
+	bool decode;
+	char* symbols;
+	uint64_t limit;
+};
+
+static bool _parseTraceOpts(struct mSubParser* parser, int option, const char* arg);
+static bool _mTraceRecord(const char* fname, const struct mArguments* args, const struct TraceOpts* traceOpts);
+static bool _mTraceDecode(const char* fname, const struct TraceOpts* traceOpts);
+static void _mTraceShutdown(int signal);
+
+static bool _dispatchExiting = false;
+
+int main(int argc, char** argv) {
+	signal(SIGINT, _mTraceShutdown);
+
+	struct TraceOpts traceOpts = { 0 };
+	struct mSubParser subparser = {
+		.usage = TRACE_USAGE,
+		.parse = _parseTraceOpts,
+		.extraOptions = TRACE_OPTIONS,
+		.opts = &traceOpts
+	};
+
+	int didFail = 0;
+	struct mArguments args = {};
+	bool parsed = parseArguments(&args, argc, argv, &subparser);
+	if (!args.fname || (!traceOpts.decode && !traceOpts.output)) {
+		parsed = false;
+	}
+	if (!parsed || args.showHelp) {
+		usage(argv[0], TRACE_USAGE);
+		didFail = !parsed;
+		goto cleanup;
+	}
+
+	if (args.showVersion) {
+		version(argv[0]);
+		goto cleanup;
+	}
+
+	if (traceOpts.decode) {
+		didFail = !_mTraceDecode(args.fname, &traceOpts);
+	} else {
+		didFail = !_mTraceRecord(args.fname, &args, &traceOpts);
+	}
+
+	cleanup:
+	free(traceOpts.output);
+	free(traceOpts.symbols);
+	freeArguments(&args);
+	return didFail;
+}
+
+static bool _mTraceRecord(const char* fname, const struct mArguments* args, const struct TraceOpts* traceOpts) {
+	struct mCore* core = mCoreFind(fname);
+	if (!core) {
+		fprintf(stderr, "Could not load %s\n", fname);
+		return false;
+	}
+	core->init(core);
+	if (core->platform(core) != PLATFORM_GBA) {
+		fprintf(stderr, "Only GBA games can be traced\n");
+		core->deinit(core);
+		return false;
+	}
+	mCoreLoadFile(core, fname);
+	mCoreConfigInit(&core->config, "trace");
+	mCoreConfigLoad(&core->config);
+	struct mCoreOptions opts = {};
+	mCoreConfigMap(&core->config, &opts);
+	opts.audioSync = false;
+	opts.videoSync = false;
+	applyArguments(args, NULL, &core->config);
+	mCoreConfigLoadDefaults(&core->config, &opts);
+	mCoreLoadConfig(core);
+	mCoreConfigFreeOpts(&opts);
+	core->reset(core);
+
+	bool success = false;
+	struct VFile* vf = VFileOpen(traceOpts->output, O_WRONLY | O_CREAT | O_TRUNC);
+	struct ARMTracer tracer;
+	if (!vf) {
+		fprintf(stderr, "Could not open %s\n", traceOpts->output);
+	} else if (!ARMTracerInit(&tracer, vf, traceOpts->registers ? ARM_TRACE_FLAG_REGISTERS : 0)) {
+		fprintf(stderr, "Could not write %s\n", traceOpts->output);
+	} else {
+		struct timeval tv;
+		gettimeofday(&tv, 0);
+		uint64_t start = 1000000LL * tv.tv_sec + tv.tv_usec;
+
+		ARMTracerAttach(&tracer, core->cpu, core->timing);
+		unsigned frames;
+		for (frames = 0; !_dispatchExiting && (!traceOpts->frames || frames < traceOpts->frames); ++frames) {
+			core->runFrame(core);
+		}
+		ARMTracerDetach(&tracer, core->cpu);
+
+		gettimeofday(&tv, 0);
+		uint64_t duration = 1000000LL * tv.tv_sec + tv.tv_usec - start;
+		success = !tracer.failed;
+		printf("%u frames, %" PRIu64 " instructions, %lli bytes in %" PRIu64 " microseconds\n",
+		       frames, tracer.records, (long long) vf->size(vf), duration);
+		ARMTracerDeinit(&tracer);
+	}
+	if (vf) {
+		vf->close(vf);
+	}
+
+	mCoreConfigDeinit(&core->config);
+	core->deinit(core);
+	return success;
+}
+
+static void _printRegisters(const struct ARMTraceRecord* record, const int32_t* registers) {
+	static const char* const names[ARM_TRACE_REGISTERS] = {
+		"r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+		"r8", "r9", "r10", "r11", "r12", "sp", "lr", "cpsr"
+	};
+	if (!record->registers) {
+		return;
+	}
+	printf("  ;");
+	size_t i;
+	for (i = 0; i < ARM_TRACE_REGISTERS; ++i) {
+		if (record->registers & (1 << i)) {
+			printf(" %s=%08X", names[i], registers[i]);
+		}
+	}
+}
+
+static bool _mTraceDecode(const char* fname, const struct TraceOpts* traceOpts) {
+	struct VFile* vf = VFileOpen(fname, O_RDONLY);
+	if (!vf) {
+		fprintf(stderr, "Could not open %s\n", fname);
+		return false;
+	}
+	size_t size = vf->size(vf);
+	const uint8_t* data = vf->map(vf, size, MAP_READ);
+	struct ARMTraceHeader header;
+	if (!data || !ARMTraceParseHeader(data, size, &header)) {
+		fprintf(stderr, "%s is not a trace file\n", fname);
+		if (data) {
+			vf->unmap(vf, (void*) data, size);
+		}
+		vf->close(vf);
+		return false;
+	}
+
+#ifdef USE_DEBUGGERS
+	struct mDebuggerSymbols* symbols = NULL;
+	if (traceOpts->symbols) {
+		struct VFile* symbolFile = VFileOpen(traceOpts->symbols, O_RDONLY);
+		if (symbolFile) {
+			symbols = mDebuggerSymbolTableCreate();
+#ifdef USE_ELF
+			struct ELF* elf = ELFOpen(symbolFile);
+			if (elf) {
+				mCoreLoadELFSymbols(symbols, elf);
+				ELFClose(elf);
+			} else
+#endif
+			{
+				mDebuggerLoadARMIPSSymbols(symbols, symbolFile);
+			}
+			symbolFile->close(symbolFile);
+		} else {
+			fprintf(stderr, "Could not open %s\n", traceOpts->symbols);
+		}
+	}
+#else
+	if (traceOpts->symbols) {
+		fprintf(stderr, "Symbols are not supported in this build\n");
+	}
+#endif
+
+	int32_t registers[ARM_TRACE_REGISTERS] = { 0 };
+	uint64_t cycle = 0;
+	uint32_t lastCycle = 0;
+	uint64_t decoded = 0;
+	size_t offset = sizeof(header);
+	while (offset < size && (!traceOpts->limit || decoded < traceOpts->limit) && !_dispatchExiting) {
+		struct ARMTraceRecord record;
+		size_t length = ARMTraceParseRecord(&data[offset], size - offset, &record, registers);
+		if (!length) {
+			fprintf(stderr, "Trace is truncated\n");
+			break;
+		}
+		offset += length;
+		// Registers are recorded as of the start of each instruction, so show them as the
+		// result of the one before it, with the first record's set as the initial state
+		if (decoded) {
+			cycle += (uint32_t) (record.cycle - lastCycle);
+			_printRegisters(&record, registers);
+			putchar('\n');
+		} else {
+			cycle = record.cycle;
+			if (record.registers) {
+				printf("%12s  initial state", "");
+				_printRegisters(&record, registers);
+				putchar('\n');
+			}
+		}
+		lastCycle = record.cycle;
+		++decoded;
+
+		uint32_t address = record.address & ~1;
+#ifdef USE_DEBUGGERS
+		if (symbols) {
+			const char* label = mDebuggerSymbolReverseLookup(symbols, address, -1);
+			if (label) {
+				printf("%s:\n", label);
+			}
+		}
+#endif
+
+		char disassembly[64];
+		struct ARMInstructionInfo info;
+		if (record.address & 1) {
+			struct ARMInstructionInfo info2;
+			struct ARMInstructionInfo combined;
+			uint16_t instruction = record.opcode;
+			uint16_t instruction2 = record.opcode >> 16;
+			ARMDecodeThumb(instruction, &info);
+			ARMDecodeThumb(instruction2, &info2);
+			if (ARMDecodeThumbCombine(&info, &info2, &combined)) {
+				ARMDisassemble(&combined, address + WORD_SIZE_THUMB * 2, disassembly, sizeof(disassembly));
+				printf("%12" PRIu64 "  %08X:  %04X%04X  %s", cycle, address, instruction, instruction2, disassembly);
+			} else {
+				ARMDisassemble(&info, address + WORD_SIZE_THUMB * 2, disassembly, sizeof(disassembly));
+				printf("%12" PRIu64 "  %08X:      %04X  %s", cycle, address, instruction, disassembly);
+			}
+		} else {
+			ARMDecodeARM(record.opcode, &info);
+			ARMDisassemble(&info, address + WORD_SIZE_ARM * 2, disassembly, sizeof(disassembly));
+			printf("%12" PRIu64 "  %08X:  %08X  %s", cycle, address, record.opcode, disassembly);
+		}
+	}
+	if (decoded) {
+		putchar('\n');
+	}
+
+#ifdef USE_DEBUGGERS
+	if (symbols) {
+		mDebuggerSymbolTableDestroy(symbols);
+	}
+#endif
+	vf->unmap(vf, (void*) data, size);
+	vf->close(vf);
+	return true;
+}
+
+static void _mTraceShutdown(int signal) {
+	UNUSED(signal);
+	_dispatchExiting = true;
+}
+
+static bool _parseTraceOpts(struct mSubParser* parser, int option, const char* arg) {
+	struct TraceOpts* opts = parser->opts;
+	errno = 0;
+	switch (option) {
+	case 'D':
+		opts->decode = true;
+		return true;
+	case 'F':
+		opts->frames = strtoul(arg, 0, 10);
+		return !errno;
+	case 'n':
+		opts->limit = strtoull(arg, 0, 10);
+		return !errno;
+	case 'o':
+		opts->output = strdup(arg);
+		return true;
+	case 'r':
+		opts->registers = true;
+		return true;
+	case 'y':
+		opts->symbols = strdup(arg);
+		return true;
+	default:
+		return false;
+	}
+}
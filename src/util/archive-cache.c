@@ -0,0 +1,279 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba-util/archive-cache.h>
+
+#if defined(USE_LIBZIP) || defined(USE_ZLIB) || defined(USE_LZMA)
+#include <mgba-util/crc32.h>
+#include <mgba-util/string.h>
+#include <mgba-util/vector.h>
+#include <mgba-util/vfs.h>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+#define CACHE_SUFFIX ".rom"
+#define CACHE_PARTIAL_SUFFIX ".part"
+#define CACHE_MAX_PARTIALS 16
+#define CACHE_COPY_SIZE 0x4000
+
+struct ArchiveCacheEntry {
+	char* name;
+	size_t size;
+	time_t lastUsed;
+};
+
+DECLARE_VECTOR(ArchiveCacheEntryList, struct ArchiveCacheEntry);
+DEFINE_VECTOR(ArchiveCacheEntryList, struct ArchiveCacheEntry);
+
+struct VDirArchiveCache {
+	struct VDir d;
+	struct VDir* archive;
+	struct ArchiveCache* cache;
+	bool (*entryCRC32)(struct VDir*, const char* name, uint32_t* crc32);
+	char* path;
+};
+
+static bool _vdacClose(struct VDir* vd);
+static void _vdacRewind(struct VDir* vd);
+static struct VDirEntry* _vdacListNext(struct VDir* vd);
+static struct VFile* _vdacOpenFile(struct VDir* vd, const char* path, int mode);
+static struct VDir* _vdacOpenDir(struct VDir* vd, const char* path);
+static bool _vdacDeleteFile(struct VDir* vd, const char* path);
+
+static struct ArchiveCache* _defaultCache = NULL;
+
+bool ArchiveCacheInit(struct ArchiveCache* cache, const char* path, size_t maxSize) {
+#ifdef _WIN32
+	_mkdir(path);
+#else
+	mkdir(path, 0755);
+#endif
+	struct VDir* dir = VDirOpen(path);
+	if (!dir) {
+		return false;
+	}
+	dir->close(dir);
+
+	strncpy(cache->path, path, sizeof(cache->path) - 1);
+	cache->path[sizeof(cache->path) - 1] = '\0';
+	cache->maxSize = maxSize;
+	cache->hits = 0;
+	cache->misses = 0;
+	MutexInit(&cache->mutex);
+	return true;
+}
+
+void ArchiveCacheDeinit(struct ArchiveCache* cache) {
+	if (_defaultCache == cache) {
+		_defaultCache = NULL;
+	}
+	MutexDeinit(&cache->mutex);
+}
+
+static bool _entryPath(const struct ArchiveCache* cache, const char* archivePath, uint32_t crc32, char* out, size_t outLength) {
+	struct stat st;
+	if (stat(archivePath, &st) < 0) {
+		return false;
+	}
+	uint32_t pathHash = doCrc32(archivePath, strlen(archivePath));
+	int written = snprintf(out, outLength, "%s" PATH_SEP "%08X-%016" PRIX64 "-%08X" CACHE_SUFFIX, cache->path, pathHash, (uint64_t) st.st_mtime, crc32);
+	// A truncated path would name some other entry, so skip the cache instead
+	return written >= 0 && (size_t) written < outLength;
+}
+
+struct VFile* ArchiveCacheOpenFile(struct ArchiveCache* cache, const char* archivePath, struct VDir* archive, const char* name, uint32_t crc32) {
+	char path[PATH_MAX];
+	if (!_entryPath(cache, archivePath, crc32, path, sizeof(path))) {
+		return NULL;
+	}
+	struct VFile* vf = VFileOpen(path, O_RDONLY);
+	if (vf) {
+		// Eviction goes by modification time, so bump it on every use
+		utime(path, NULL);
+		MutexLock(&cache->mutex);
+		++cache->hits;
+		MutexUnlock(&cache->mutex);
+		return vf;
+	}
+	MutexLock(&cache->mutex);
+	++cache->misses;
+	MutexUnlock(&cache->mutex);
+
+	struct VFile* entry = archive->openFile(archive, name, O_RDONLY);
+	if (!entry) {
+		return NULL;
+	}
+	ssize_t size = entry->size(entry);
+	if (size < 0 || (size_t) size > cache->maxSize) {
+		entry->close(entry);
+		return NULL;
+	}
+
+	// Extract under a unique name and rename it into place once complete, so other
+	// processes never see a partial entry
+	char partial[PATH_MAX + 16];
+	struct VFile* out = NULL;
+	int i;
+	for (i = 0; i < CACHE_MAX_PARTIALS && !out; ++i) {
+		snprintf(partial, sizeof(partial), "%s.%i" CACHE_PARTIAL_SUFFIX, path, i);
+		out = VFileOpen(partial, O_WRONLY | O_CREAT | O_EXCL);
+	}
+	if (!out) {
+		entry->close(entry);
+		return NULL;
+	}
+
+	uint8_t buffer[CACHE_COPY_SIZE];
+	size_t total = 0;
+	ssize_t read;
+	while ((read = entry->read(entry, buffer, sizeof(buffer))) > 0) {
+		if (out->write(out, buffer, read) != read) {
+			read = -1;
+			break;
+		}
+		total += read;
+	}
+	entry->close(entry);
+	out->close(out);
+	if (read < 0 || total != (size_t) size) {
+		remove(partial);
+		return NULL;
+	}
+	if (rename(partial, path) < 0) {
+		// Another process may have finished extracting the same entry first
+		remove(partial);
+	}
+
+	ArchiveCacheTrim(cache);
+	return VFileOpen(path, O_RDONLY);
+}
+
+static int _entryCompare(const void* a, const void* b) {
+	const struct ArchiveCacheEntry* entryA = a;
+	const struct ArchiveCacheEntry* entryB = b;
+	if (entryA->lastUsed < entryB->lastUsed) {
+		return -1;
+	}
+	if (entryA->lastUsed > entryB->lastUsed) {
+		return 1;
+	}
+	return 0;
+}
+
+void ArchiveCacheTrim(struct ArchiveCache* cache) {
+	struct VDir* dir = VDirOpen(cache->path);
+	if (!dir) {
+		return;
+	}
+	struct ArchiveCacheEntryList entries;
+	ArchiveCacheEntryListInit(&entries, 0);
+	size_t total = 0;
+	char path[PATH_MAX * 2];
+	struct VDirEntry* dirent;
+	while ((dirent = dir->listNext(dir))) {
+		const char* name = dirent->name(dirent);
+		if (!endswith(name, CACHE_SUFFIX) && !endswith(name, CACHE_PARTIAL_SUFFIX)) {
+			continue;
+		}
+		snprintf(path, sizeof(path), "%s" PATH_SEP "%s", cache->path, name);
+		struct stat st;
+		if (stat(path, &st) < 0) {
+			continue;
+		}
+		struct ArchiveCacheEntry* entry = ArchiveCacheEntryListAppend(&entries);
+		entry->name = strdup(name);
+		entry->size = st.st_size;
+		entry->lastUsed = st.st_mtime;
+		total += entry->size;
+	}
+	dir->close(dir);
+
+	if (total > cache->maxSize) {
+		qsort(entries.vector, ArchiveCacheEntryListSize(&entries), sizeof(struct ArchiveCacheEntry), _entryCompare);
+	}
+	size_t i;
+	for (i = 0; i < ArchiveCacheEntryListSize(&entries); ++i) {
+		struct ArchiveCacheEntry* entry = ArchiveCacheEntryListGetPointer(&entries, i);
+		if (total > cache->maxSize) {
+			snprintf(path, sizeof(path), "%s" PATH_SEP "%s", cache->path, entry->name);
+			if (remove(path) == 0) {
+				total -= entry->size;
+			}
+		}
+		free(entry->name);
+	}
+	ArchiveCacheEntryListDeinit(&entries);
+}
+
+struct VDir* ArchiveCacheWrap(struct ArchiveCache* cache, const char* archivePath, struct VDir* archive,
+                              bool (*entryCRC32)(struct VDir*, const char* name, uint32_t* crc32)) {
+	struct VDirArchiveCache* vd = malloc(sizeof(*vd));
+	vd->d.close = _vdacClose;
+	vd->d.rewind = _vdacRewind;
+	vd->d.listNext = _vdacListNext;
+	vd->d.openFile = _vdacOpenFile;
+	vd->d.openDir = _vdacOpenDir;
+	vd->d.deleteFile = _vdacDeleteFile;
+	vd->archive = archive;
+	vd->cache = cache;
+	vd->entryCRC32 = entryCRC32;
+	vd->path = strdup(archivePath);
+	return &vd->d;
+}
+
+void ArchiveCacheSetDefault(struct ArchiveCache* cache) {
+	_defaultCache = cache;
+}
+
+struct ArchiveCache* ArchiveCacheGetDefault(void) {
+	return _defaultCache;
+}
+
+bool _vdacClose(struct VDir* vd) {
+	struct VDirArchiveCache* vdac = (struct VDirArchiveCache*) vd;
+	bool success = vdac->archive->close(vdac->archive);
+	free(vdac->path);
+	free(vdac);
+	return success;
+}
+
+void _vdacRewind(struct VDir* vd) {
+	struct VDirArchiveCache* vdac = (struct VDirArchiveCache*) vd;
+	vdac->archive->rewind(vdac->archive);
+}
+
+struct VDirEntry* _vdacListNext(struct VDir* vd) {
+	struct VDirArchiveCache* vdac = (struct VDirArchiveCache*) vd;
+	return vdac->archive->listNext(vdac->archive);
+}
+
+struct VFile* _vdacOpenFile(struct VDir* vd, const char* path, int mode) {
+	struct VDirArchiveCache* vdac = (struct VDirArchiveCache*) vd;
+	uint32_t crc32;
+	if ((mode & O_ACCMODE) == O_RDONLY && vdac->entryCRC32 && vdac->entryCRC32(vdac->archive, path, &crc32)) {
+		struct VFile* vf = ArchiveCacheOpenFile(vdac->cache, vdac->path, vdac->archive, path, crc32);
+		if (vf) {
+			return vf;
+		}
+	}
+	return vdac->archive->openFile(vdac->archive, path, mode);
+}
+
+struct VDir* _vdacOpenDir(struct VDir* vd, const char* path) {
+	struct VDirArchiveCache* vdac = (struct VDirArchiveCache*) vd;
+	return vdac->archive->openDir(vdac->archive, path);
+}
+
+bool _vdacDeleteFile(struct VDir* vd, const char* path) {
+	struct VDirArchiveCache* vdac = (struct VDirArchiveCache*) vd;
+	return vdac->archive->deleteFile(vdac->archive, path);
+}
+#endif
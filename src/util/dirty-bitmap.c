@@ -0,0 +1,111 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba-util/dirty-bitmap.h>
+
+#include <mgba-util/math.h>
+
+void DirtyBitmapInit(struct DirtyBitmap* bitmap, size_t size) {
+	bitmap->pages = (size + DIRTY_PAGE_SIZE - 1) >> DIRTY_PAGE_SHIFT;
+	bitmap->bits = calloc((bitmap->pages + 31) >> 5, sizeof(*bitmap->bits));
+}
+
+void DirtyBitmapDeinit(struct DirtyBitmap* bitmap) {
+	free(bitmap->bits);
+	bitmap->bits = NULL;
+	bitmap->pages = 0;
+}
+
+void DirtyBitmapClear(struct DirtyBitmap* bitmap) {
+	if (bitmap->bits) {
+		memset(bitmap->bits, 0, ((bitmap->pages + 31) >> 5) * sizeof(*bitmap->bits));
+	}
+}
+
+void DirtyBitmapFill(struct DirtyBitmap* bitmap) {
+	DirtyBitmapMarkRange(bitmap, 0, bitmap->pages << DIRTY_PAGE_SHIFT);
+}
+
+void DirtyBitmapMarkRange(struct DirtyBitmap* bitmap, size_t offset, size_t size) {
+	if (!bitmap->bits || !size) {
+		return;
+	}
+	size_t page = offset >> DIRTY_PAGE_SHIFT;
+	size_t end = (offset + size + DIRTY_PAGE_SIZE - 1) >> DIRTY_PAGE_SHIFT;
+	if (end > bitmap->pages) {
+		end = bitmap->pages;
+	}
+	for (; page < end && (page & 31); ++page) {
+		bitmap->bits[page >> 5] |= 1U << (page & 31);
+	}
+	for (; page + 32 <= end; page += 32) {
+		bitmap->bits[page >> 5] = 0xFFFFFFFF;
+	}
+	for (; page < end; ++page) {
+		bitmap->bits[page >> 5] |= 1U << (page & 31);
+	}
+}
+
+size_t DirtyBitmapCount(const struct DirtyBitmap* bitmap) {
+	if (!bitmap->bits) {
+		return 0;
+	}
+	size_t count = 0;
+	size_t i;
+	for (i = 0; i < (bitmap->pages + 31) >> 5; ++i) {
+		count += popcount32(bitmap->bits[i]);
+	}
+	return count;
+}
+
+void DirtyBitmapCopy(struct DirtyBitmap* bitmap, void* dest, const void* src, size_t size) {
+	if (!bitmap->bits) {
+		memcpy(dest, src, size);
+		return;
+	}
+	size_t offset;
+	for (offset = 0; offset < size; offset += DIRTY_PAGE_SIZE) {
+		size_t length = DIRTY_PAGE_SIZE;
+		if (offset + length > size) {
+			length = size - offset;
+		}
+		uint8_t* destPage = &((uint8_t*) dest)[offset];
+		const uint8_t* srcPage = &((const uint8_t*) src)[offset];
+		if (memcmp(destPage, srcPage, length) != 0) {
+			memcpy(destPage, srcPage, length);
+			DirtyBitmapMarkRange(bitmap, offset, length);
+		}
+	}
+}
+
+void DirtyBitmapProject(struct DirtyBitmap* dest, size_t offset, const struct DirtyBitmap* src, size_t size) {
+	if (!dest->bits || !src->bits) {
+		return;
+	}
+	size_t page = (offset + DIRTY_PAGE_SIZE - 1) >> DIRTY_PAGE_SHIFT;
+	size_t end = (offset + size) >> DIRTY_PAGE_SHIFT;
+	if (end > dest->pages) {
+		end = dest->pages;
+	}
+	for (; page < end; ++page) {
+		dest->bits[page >> 5] &= ~(1U << (page & 31));
+	}
+
+	for (page = 0; page < src->pages && (page << DIRTY_PAGE_SHIFT) < size; ++page) {
+		if (!DirtyBitmapTest(src, page)) {
+			continue;
+		}
+		size_t start = page << DIRTY_PAGE_SHIFT;
+		size_t length = DIRTY_PAGE_SIZE;
+		if (start + length > size) {
+			length = size - start;
+		}
+		DirtyBitmapMarkRange(dest, offset + start, length);
+	}
+	if ((src->pages << DIRTY_PAGE_SHIFT) < size) {
+		// Anything the source bitmap doesn't cover can't be assumed clean
+		DirtyBitmapMarkRange(dest, offset + (src->pages << DIRTY_PAGE_SHIFT), size - (src->pages << DIRTY_PAGE_SHIFT));
+	}
+}
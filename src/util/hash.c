@@ -10,6 +10,7 @@
 #include <stdlib.h>
 
 #define ROTL32(x,y)	_rotl(x,y)
+#define ROTL64(x,y)	_rotl64(x,y)
 
 #else
 
@@ -19,7 +20,12 @@ static inline uint32_t rotl32 ( uint32_t x, int8_t r ) {
   return (x << r) | (x >> (32 - r));
 }
 
+static inline uint64_t rotl64 ( uint64_t x, int8_t r ) {
+  return (x << r) | (x >> (64 - r));
+}
+
 #define	ROTL32(x,y)	rotl32(x,y)
+#define	ROTL64(x,y)	rotl64(x,y)
 
 #endif
 
@@ -44,6 +50,16 @@ static FORCE_INLINE uint32_t fmix32 (uint32_t h) {
   return h;
 }
 
+static FORCE_INLINE uint64_t fmix64 ( uint64_t k ) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+
+  return k;
+}
+
 //-----------------------------------------------------------------------------
 
 uint32_t hash32(const void* key, int len, uint32_t seed) {
@@ -97,3 +113,112 @@ uint32_t hash32(const void* key, int len, uint32_t seed) {
 
   return h1;
 } 
+
+//-----------------------------------------------------------------------------
+// MurmurHash3_x64_128, split up so that data can be hashed as it is found.
+// Blocks are read as little endian so that results match across hosts.
+
+static const uint64_t c1_128 = 0x87c37b91114253d5ULL;
+static const uint64_t c2_128 = 0x4cf5ad432745937fULL;
+
+static FORCE_INLINE void _hash128Block(struct Hash128* hash, const uint8_t* block) {
+  uint64_t k1;
+  uint64_t k2;
+  LOAD_64LE(k1, 0, block);
+  LOAD_64LE(k2, 8, block);
+
+  k1 *= c1_128; k1  = ROTL64(k1,31); k1 *= c2_128; hash->h1 ^= k1;
+
+  hash->h1 = ROTL64(hash->h1,27); hash->h1 += hash->h2; hash->h1 = hash->h1*5+0x52dce729;
+
+  k2 *= c2_128; k2  = ROTL64(k2,33); k2 *= c1_128; hash->h2 ^= k2;
+
+  hash->h2 = ROTL64(hash->h2,31); hash->h2 += hash->h1; hash->h2 = hash->h2*5+0x38495ab5;
+}
+
+void hash128Init(struct Hash128* hash, uint32_t seed) {
+  hash->h1 = seed;
+  hash->h2 = seed;
+  hash->tailSize = 0;
+  hash->length = 0;
+}
+
+void hash128Update(struct Hash128* hash, const void* key, size_t len) {
+  const uint8_t * data = (const uint8_t*)key;
+  hash->length += len;
+
+  if (hash->tailSize) {
+    size_t fill = sizeof(hash->tail) - hash->tailSize;
+    if (fill > len) {
+      fill = len;
+    }
+    memcpy(&hash->tail[hash->tailSize], data, fill);
+    hash->tailSize += fill;
+    data += fill;
+    len -= fill;
+    if (hash->tailSize < sizeof(hash->tail)) {
+      return;
+    }
+    _hash128Block(hash, hash->tail);
+    hash->tailSize = 0;
+  }
+
+  for (; len >= 16; data += 16, len -= 16) {
+    _hash128Block(hash, data);
+  }
+
+  memcpy(hash->tail, data, len);
+  hash->tailSize = len;
+}
+
+void hash128Finish(struct Hash128* hash, uint64_t out[2]) {
+  const uint8_t * tail = hash->tail;
+  uint64_t h1 = hash->h1;
+  uint64_t h2 = hash->h2;
+
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+
+  size_t i;
+  for(i = hash->tailSize; i > 8; --i)
+  {
+    k2 ^= ((uint64_t)tail[i - 1]) << ((i - 9) * 8);
+  }
+  if(hash->tailSize > 8)
+  {
+    k2 *= c2_128; k2  = ROTL64(k2,33); k2 *= c1_128; h2 ^= k2;
+  }
+
+  for(i = hash->tailSize < 8 ? hash->tailSize : 8; i > 0; --i)
+  {
+    k1 ^= ((uint64_t)tail[i - 1]) << ((i - 1) * 8);
+  }
+  if(hash->tailSize)
+  {
+    k1 *= c1_128; k1  = ROTL64(k1,31); k1 *= c2_128; h1 ^= k1;
+  }
+
+  //----------
+  // finalization
+
+  h1 ^= hash->length; h2 ^= hash->length;
+
+  h1 += h2;
+  h2 += h1;
+
+  h1 = fmix64(h1);
+  h2 = fmix64(h2);
+
+  h1 += h2;
+  h2 += h1;
+
+  out[0] = h1;
+  out[1] = h2;
+}
+
+void hash128(const void* key, size_t len, uint32_t seed, uint64_t out[2]) {
+  struct Hash128 hash;
+  hash128Init(&hash, seed);
+  hash128Update(&hash, key, len);
+  hash128Finish(&hash, out);
+}
@@ -20,14 +20,12 @@ void deinitPatchFast(struct PatchFast* patch) {
 	PatchFastExtentsDeinit(&patch->extents);
 }
 
-bool diffPatchFast(struct PatchFast* patch, const void* restrict in, const void* restrict out, size_t size) {
-	PatchFastExtentsClear(&patch->extents);
-	const uint32_t* iptr = in;
-	const uint32_t* optr = out;
+static void _diffRange(struct PatchFast* patch, const void* restrict in, const void* restrict out, size_t off, size_t size) {
+	const uint32_t* iptr = (const uint32_t*) in + off / 4;
+	const uint32_t* optr = (const uint32_t*) out + off / 4;
 	size_t extentOff = 0;
 	struct PatchFastExtent* extent = NULL;
-	size_t off;
-	for (off = 0; off < (size & ~15); off += 16) {
+	for (; off < (size & ~15); off += 16) {
 		uint32_t a = iptr[0] ^ optr[0];
 		uint32_t b = iptr[1] ^ optr[1];
 		uint32_t c = iptr[2] ^ optr[2];
@@ -80,7 +78,33 @@ bool diffPatchFast(struct PatchFast* patch, const void* restrict in, const void*
 		extent->length = extentOff;
 		extent = NULL;
 	}
+}
+
+bool diffPatchFast(struct PatchFast* patch, const void* restrict in, const void* restrict out, size_t size) {
+	PatchFastExtentsClear(&patch->extents);
+	_diffRange(patch, in, out, 0, size);
+	return true;
+}
 
+bool diffPatchFastMasked(struct PatchFast* patch, const void* restrict in, const void* restrict out, size_t size, const struct DirtyBitmap* mask) {
+	PatchFastExtentsClear(&patch->extents);
+	size_t pages = (size + DIRTY_PAGE_SIZE - 1) >> DIRTY_PAGE_SHIFT;
+	size_t page = 0;
+	while (page < pages) {
+		if (page < mask->pages && !DirtyBitmapTest(mask, page)) {
+			++page;
+			continue;
+		}
+		size_t start = page;
+		while (page < pages && (page >= mask->pages || DirtyBitmapTest(mask, page))) {
+			++page;
+		}
+		size_t end = page << DIRTY_PAGE_SHIFT;
+		if (end > size) {
+			end = size;
+		}
+		_diffRange(patch, in, out, start << DIRTY_PAGE_SHIFT, end);
+	}
 	return true;
 }
 
@@ -0,0 +1,176 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba-util/archive-cache.h>
+#include <mgba-util/string.h>
+#include <mgba-util/vfs.h>
+
+#if (defined(USE_LIBZIP) || defined(USE_ZLIB)) && !defined(_WIN32)
+#include <unistd.h>
+
+// rom.bin, containing "mGBA" 64 times
+static const uint8_t _zip[] = {
+	0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x02, 0x00, 0x08, 0x00, 0xE7, 0x85, 0x50, 0x5D, 0xE1, 0x26,
+	0xE3, 0x48, 0x09, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x72, 0x6F,
+	0x6D, 0x2E, 0x62, 0x69, 0x6E, 0xCB, 0x75, 0x77, 0x72, 0xCC, 0x1D, 0xC1, 0x18, 0x00, 0x50, 0x4B,
+	0x01, 0x02, 0x1E, 0x03, 0x14, 0x00, 0x02, 0x00, 0x08, 0x00, 0xE7, 0x85, 0x50, 0x5D, 0xE1, 0x26,
+	0xE3, 0x48, 0x09, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xA4, 0x81, 0x00, 0x00, 0x00, 0x00, 0x72, 0x6F, 0x6D, 0x2E,
+	0x62, 0x69, 0x6E, 0x50, 0x4B, 0x05, 0x06, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x35,
+	0x00, 0x00, 0x00, 0x2E, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+struct ArchiveCacheTest {
+	char base[PATH_MAX];
+	char zip[PATH_MAX];
+	char cacheDir[PATH_MAX];
+	struct ArchiveCache cache;
+};
+
+M_TEST_SUITE_SETUP(ArchiveCache) {
+	struct ArchiveCacheTest* test = calloc(1, sizeof(*test));
+	strncpy(test->base, "/tmp/mgba-archive-cache-XXXXXX", sizeof(test->base) - 1);
+	if (!mkdtemp(test->base)) {
+		free(test);
+		return -1;
+	}
+	snprintf(test->zip, sizeof(test->zip), "%s/test.zip", test->base);
+	snprintf(test->cacheDir, sizeof(test->cacheDir), "%s/cache", test->base);
+	struct VFile* vf = VFileOpen(test->zip, O_WRONLY | O_CREAT | O_TRUNC);
+	if (!vf) {
+		free(test);
+		return -1;
+	}
+	vf->write(vf, _zip, sizeof(_zip));
+	vf->close(vf);
+	if (!ArchiveCacheInit(&test->cache, test->cacheDir, 0x10000)) {
+		free(test);
+		return -1;
+	}
+	ArchiveCacheSetDefault(&test->cache);
+	*state = test;
+	return 0;
+}
+
+M_TEST_SUITE_TEARDOWN(ArchiveCache) {
+	struct ArchiveCacheTest* test = *state;
+	test->cache.maxSize = 0;
+	ArchiveCacheTrim(&test->cache);
+	ArchiveCacheDeinit(&test->cache);
+	rmdir(test->cacheDir);
+	remove(test->zip);
+	rmdir(test->base);
+	free(test);
+	return 0;
+}
+
+// Each test starts with an empty cache
+static struct ArchiveCacheTest* _reset(void** state) {
+	struct ArchiveCacheTest* test = *state;
+	test->cache.maxSize = 0;
+	ArchiveCacheTrim(&test->cache);
+	test->cache.maxSize = 0x10000;
+	test->cache.hits = 0;
+	test->cache.misses = 0;
+	return test;
+}
+
+static size_t _countEntries(const char* path) {
+	struct VDir* dir = VDirOpen(path);
+	assert_non_null(dir);
+	size_t count = 0;
+	struct VDirEntry* dirent;
+	while ((dirent = dir->listNext(dir))) {
+		if (endswith(dirent->name(dirent), ".rom")) {
+			++count;
+		}
+	}
+	dir->close(dir);
+	return count;
+}
+
+static void _checkEntry(const char* zip) {
+	struct VDir* archive = VDirOpenArchive(zip);
+	assert_non_null(archive);
+	struct VFile* vf = archive->openFile(archive, "rom.bin", O_RDONLY);
+	assert_non_null(vf);
+	assert_int_equal(vf->size(vf), 256);
+	const char* data = vf->map(vf, 256, MAP_READ);
+	assert_non_null(data);
+	size_t i;
+	for (i = 0; i < 256; i += 4) {
+		assert_memory_equal(&data[i], "mGBA", 4);
+	}
+	vf->unmap(vf, (void*) data, 256);
+	vf->close(vf);
+	archive->close(archive);
+}
+
+M_TEST_DEFINE(missThenHit) {
+	struct ArchiveCacheTest* test = _reset(state);
+	_checkEntry(test->zip);
+	assert_int_equal(test->cache.misses, 1);
+	assert_int_equal(test->cache.hits, 0);
+	assert_int_equal(_countEntries(test->cacheDir), 1);
+
+	_checkEntry(test->zip);
+	assert_int_equal(test->cache.misses, 1);
+	assert_int_equal(test->cache.hits, 1);
+	assert_int_equal(_countEntries(test->cacheDir), 1);
+}
+
+M_TEST_DEFINE(evict) {
+	struct ArchiveCacheTest* test = _reset(state);
+	_checkEntry(test->zip);
+	assert_int_equal(_countEntries(test->cacheDir), 1);
+
+	test->cache.maxSize = 128;
+	ArchiveCacheTrim(&test->cache);
+	assert_int_equal(_countEntries(test->cacheDir), 0);
+
+	// Entries too large for the cache are still read from the archive
+	_checkEntry(test->zip);
+	assert_int_equal(test->cache.misses, 2);
+	assert_int_equal(test->cache.hits, 0);
+	assert_int_equal(_countEntries(test->cacheDir), 0);
+}
+
+M_TEST_DEFINE(missingEntry) {
+	struct ArchiveCacheTest* test = _reset(state);
+	struct VDir* archive = VDirOpenArchive(test->zip);
+	assert_non_null(archive);
+	assert_null(archive->openFile(archive, "missing.bin", O_RDONLY));
+	archive->close(archive);
+	assert_int_equal(test->cache.misses, 0);
+	assert_int_equal(_countEntries(test->cacheDir), 0);
+}
+
+M_TEST_DEFINE(pathTooLong) {
+	struct ArchiveCacheTest* test = _reset(state);
+	// Entry names don't fit after a cache directory this long, so the archive is read directly
+	char path[sizeof(test->cache.path)];
+	memcpy(path, test->cache.path, sizeof(path));
+	memset(test->cache.path, 'a', sizeof(test->cache.path) - 1);
+	_checkEntry(test->zip);
+	memcpy(test->cache.path, path, sizeof(path));
+	assert_int_equal(test->cache.misses, 0);
+	assert_int_equal(test->cache.hits, 0);
+	assert_int_equal(_countEntries(test->cacheDir), 0);
+}
+
+M_TEST_SUITE_DEFINE_SETUP_TEARDOWN(ArchiveCache,
+	cmocka_unit_test(missThenHit),
+	cmocka_unit_test(evict),
+	cmocka_unit_test(missingEntry),
+	cmocka_unit_test(pathTooLong))
+#else
+M_TEST_DEFINE(unsupported) {
+}
+
+M_TEST_SUITE_DEFINE(ArchiveCache,
+	cmocka_unit_test(unsupported))
+#endif
@@ -0,0 +1,143 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba-util/dirty-bitmap.h>
+#include <mgba-util/patch/fast.h>
+
+M_TEST_DEFINE(dirtyBitmapInert) {
+	struct DirtyBitmap bitmap = { 0 };
+	DirtyBitmapMark(&bitmap, 0x100);
+	DirtyBitmapMarkRange(&bitmap, 0, 0x1000);
+	DirtyBitmapFill(&bitmap);
+	assert_int_equal(DirtyBitmapCount(&bitmap), 0);
+}
+
+M_TEST_DEFINE(dirtyBitmapMarkRange) {
+	struct DirtyBitmap bitmap;
+	DirtyBitmapInit(&bitmap, DIRTY_PAGE_SIZE * 100 + 1);
+	assert_int_equal(bitmap.pages, 101);
+	assert_int_equal(DirtyBitmapCount(&bitmap), 0);
+
+	DirtyBitmapMark(&bitmap, DIRTY_PAGE_SIZE * 3 + 7);
+	assert_true(DirtyBitmapTest(&bitmap, 3));
+	assert_false(DirtyBitmapTest(&bitmap, 2));
+	assert_int_equal(DirtyBitmapCount(&bitmap), 1);
+
+	// Straddles word boundaries on both ends
+	DirtyBitmapMarkRange(&bitmap, DIRTY_PAGE_SIZE * 30 - 1, DIRTY_PAGE_SIZE * 40);
+	assert_false(DirtyBitmapTest(&bitmap, 28));
+	assert_true(DirtyBitmapTest(&bitmap, 29));
+	assert_true(DirtyBitmapTest(&bitmap, 69));
+	assert_false(DirtyBitmapTest(&bitmap, 70));
+	assert_int_equal(DirtyBitmapCount(&bitmap), 42);
+
+	// Clamped to the end of the bitmap
+	DirtyBitmapMarkRange(&bitmap, DIRTY_PAGE_SIZE * 99, DIRTY_PAGE_SIZE * 10);
+	assert_int_equal(DirtyBitmapCount(&bitmap), 44);
+
+	DirtyBitmapClear(&bitmap);
+	assert_int_equal(DirtyBitmapCount(&bitmap), 0);
+	DirtyBitmapFill(&bitmap);
+	assert_int_equal(DirtyBitmapCount(&bitmap), 101);
+	DirtyBitmapDeinit(&bitmap);
+}
+
+M_TEST_DEFINE(dirtyBitmapProject) {
+	struct DirtyBitmap dest;
+	struct DirtyBitmap src;
+	DirtyBitmapInit(&dest, DIRTY_PAGE_SIZE * 16);
+	DirtyBitmapInit(&src, DIRTY_PAGE_SIZE * 4);
+	DirtyBitmapFill(&dest);
+	DirtyBitmapMark(&src, DIRTY_PAGE_SIZE * 2);
+
+	// Source is unaligned within the destination, so its first and last
+	// destination pages are only partially covered and stay dirty
+	DirtyBitmapProject(&dest, DIRTY_PAGE_SIZE * 4 + 0x10, &src, DIRTY_PAGE_SIZE * 4);
+	assert_true(DirtyBitmapTest(&dest, 4));
+	assert_false(DirtyBitmapTest(&dest, 5));
+	assert_true(DirtyBitmapTest(&dest, 6));
+	assert_true(DirtyBitmapTest(&dest, 7));
+	assert_true(DirtyBitmapTest(&dest, 8));
+	assert_int_equal(DirtyBitmapCount(&dest), 15);
+
+	DirtyBitmapDeinit(&src);
+	DirtyBitmapDeinit(&dest);
+}
+
+M_TEST_DEFINE(dirtyBitmapCopy) {
+	static uint8_t dest[DIRTY_PAGE_SIZE * 4];
+	static uint8_t src[DIRTY_PAGE_SIZE * 4];
+	memset(dest, 0, sizeof(dest));
+	memset(src, 0, sizeof(src));
+	src[DIRTY_PAGE_SIZE * 2 + 3] = 1;
+
+	struct DirtyBitmap bitmap;
+	DirtyBitmapInit(&bitmap, sizeof(dest));
+	DirtyBitmapCopy(&bitmap, dest, src, sizeof(dest));
+	assert_memory_equal(dest, src, sizeof(dest));
+	assert_int_equal(DirtyBitmapCount(&bitmap), 1);
+	assert_true(DirtyBitmapTest(&bitmap, 2));
+
+	// Copying identical contents leaves the bitmap alone
+	DirtyBitmapClear(&bitmap);
+	DirtyBitmapCopy(&bitmap, dest, src, sizeof(dest));
+	assert_int_equal(DirtyBitmapCount(&bitmap), 0);
+	DirtyBitmapDeinit(&bitmap);
+
+	src[0] = 2;
+	DirtyBitmapCopy(&bitmap, dest, src, sizeof(dest));
+	assert_memory_equal(dest, src, sizeof(dest));
+}
+
+M_TEST_DEFINE(patchFastMasked) {
+	static uint32_t inBuffer[DIRTY_PAGE_SIZE * 2];
+	static uint32_t outBuffer[DIRTY_PAGE_SIZE * 2];
+	static uint32_t resultBuffer[DIRTY_PAGE_SIZE * 2];
+	uint8_t* in = (uint8_t*) inBuffer;
+	uint8_t* out = (uint8_t*) outBuffer;
+	uint8_t* result = (uint8_t*) resultBuffer;
+	size_t size = sizeof(inBuffer);
+	size_t i;
+	for (i = 0; i < size; ++i) {
+		in[i] = i;
+		out[i] = i;
+	}
+	out[DIRTY_PAGE_SIZE * 1 + 4] ^= 0xFF;
+	out[DIRTY_PAGE_SIZE * 5 + 8] ^= 0xFF;
+	out[DIRTY_PAGE_SIZE * 7 + 12] ^= 0xFF;
+
+	// The mask covers only the first six pages; page 7 lies past it and must
+	// still be compared
+	struct DirtyBitmap mask;
+	DirtyBitmapInit(&mask, DIRTY_PAGE_SIZE * 6);
+	DirtyBitmapMark(&mask, DIRTY_PAGE_SIZE * 1);
+
+	struct PatchFast patch;
+	initPatchFast(&patch);
+	assert_true(diffPatchFastMasked(&patch, in, out, size, &mask));
+	memcpy(result, in, size);
+	assert_true(patch.d.applyPatch(&patch.d, in, size, result, size));
+	assert_int_equal(result[DIRTY_PAGE_SIZE * 1 + 4], out[DIRTY_PAGE_SIZE * 1 + 4]);
+	assert_int_equal(result[DIRTY_PAGE_SIZE * 5 + 8], in[DIRTY_PAGE_SIZE * 5 + 8]);
+	assert_int_equal(result[DIRTY_PAGE_SIZE * 7 + 12], out[DIRTY_PAGE_SIZE * 7 + 12]);
+
+	DirtyBitmapMark(&mask, DIRTY_PAGE_SIZE * 5);
+	assert_true(diffPatchFastMasked(&patch, in, out, size, &mask));
+	memcpy(result, in, size);
+	assert_true(patch.d.applyPatch(&patch.d, in, size, result, size));
+	assert_memory_equal(result, out, size);
+
+	deinitPatchFast(&patch);
+	DirtyBitmapDeinit(&mask);
+}
+
+M_TEST_SUITE_DEFINE(DirtyBitmap,
+	cmocka_unit_test(dirtyBitmapInert),
+	cmocka_unit_test(dirtyBitmapMarkRange),
+	cmocka_unit_test(dirtyBitmapProject),
+	cmocka_unit_test(dirtyBitmapCopy),
+	cmocka_unit_test(patchFastMasked))
@@ -0,0 +1,60 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba-util/hash.h>
+
+static const char fox[] = "The quick brown fox jumps over the lazy dog";
+
+M_TEST_DEFINE(hash128Empty) {
+	uint64_t out[2];
+	hash128(NULL, 0, 0, out);
+	assert_true(out[0] == 0);
+	assert_true(out[1] == 0);
+}
+
+M_TEST_DEFINE(hash128Vectors) {
+	uint64_t out[2];
+	hash128(fox, sizeof(fox) - 1, 0, out);
+	assert_true(out[0] == 0xE34BBC7BBC071B6CULL);
+	assert_true(out[1] == 0x7A433CA9C49A9347ULL);
+
+	hash128(fox, sizeof(fox) - 1, 1, out);
+	assert_true(out[0] == 0xE533566DBBD1E13EULL);
+	assert_true(out[1] == 0x625A21A4C967FA20ULL);
+}
+
+M_TEST_DEFINE(hash128Incremental) {
+	uint8_t data[1024];
+	size_t i;
+	for (i = 0; i < sizeof(data); ++i) {
+		data[i] = i;
+	}
+	uint64_t expected[2];
+	hash128(data, sizeof(data), 0x1234, expected);
+	assert_true(expected[0] == 0x547EFD1E8610E490ULL);
+	assert_true(expected[1] == 0xDF718455B8DB9079ULL);
+
+	// Pieces that straddle blocks in every possible way
+	size_t step;
+	for (step = 1; step <= 33; ++step) {
+		struct Hash128 hash;
+		hash128Init(&hash, 0x1234);
+		for (i = 0; i < sizeof(data); i += step) {
+			size_t size = sizeof(data) - i < step ? sizeof(data) - i : step;
+			hash128Update(&hash, &data[i], size);
+		}
+		uint64_t out[2];
+		hash128Finish(&hash, out);
+		assert_true(out[0] == expected[0]);
+		assert_true(out[1] == expected[1]);
+	}
+}
+
+M_TEST_SUITE_DEFINE(Hash,
+	cmocka_unit_test(hash128Empty),
+	cmocka_unit_test(hash128Vectors),
+	cmocka_unit_test(hash128Incremental))
@@ -0,0 +1,43 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include "util/test/suite.h"
+
+#include <mgba-util/thread-pool.h>
+
+#define TEST_JOBS 100
+
+static void _square(void* context, size_t index) {
+	unsigned* out = context;
+	out[index] += index * index;
+}
+
+static void _runPool(size_t threads) {
+	struct ThreadPool pool;
+	unsigned out[TEST_JOBS] = { 0 };
+	ThreadPoolInit(&pool, threads, "Test Thread");
+	ThreadPoolRun(&pool, 0, _square, out);
+	// Every job runs exactly once per call, however the threads split them
+	ThreadPoolRun(&pool, TEST_JOBS, _square, out);
+	ThreadPoolRun(&pool, TEST_JOBS / 2, _square, out);
+	ThreadPoolDeinit(&pool);
+
+	size_t i;
+	for (i = 0; i < TEST_JOBS; ++i) {
+		assert_int_equal(out[i], i * i * (i < TEST_JOBS / 2 ? 2 : 1));
+	}
+}
+
+M_TEST_DEFINE(threadPoolSerial) {
+	_runPool(1);
+}
+
+M_TEST_DEFINE(threadPoolThreaded) {
+	_runPool(4);
+}
+
+M_TEST_SUITE_DEFINE(ThreadPool,
+	cmocka_unit_test(threadPoolSerial),
+	cmocka_unit_test(threadPoolThreaded))
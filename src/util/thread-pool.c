@@ -0,0 +1,94 @@
+/* Copyright (c) 2013-2019 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba-util/thread-pool.h>
+
+// Claims and runs jobs until none are left. Must be called with the mutex held.
+static void _drain(struct ThreadPool* pool) {
+	while (pool->next < pool->end) {
+		size_t index = pool->next;
+		++pool->next;
+		MutexUnlock(&pool->mutex);
+		pool->job(pool->context, index);
+		MutexLock(&pool->mutex);
+		++pool->finished;
+		if (pool->finished == pool->end) {
+			ConditionWake(&pool->done);
+		}
+	}
+}
+
+#ifndef DISABLE_THREADING
+static THREAD_ENTRY _poolThread(void* context) {
+	struct ThreadPool* pool = context;
+	ThreadSetName(pool->name);
+	MutexLock(&pool->mutex);
+	while (!pool->shutdown) {
+		_drain(pool);
+		if (!pool->shutdown) {
+			ConditionWait(&pool->work, &pool->mutex);
+		}
+	}
+	MutexUnlock(&pool->mutex);
+	return 0;
+}
+#endif
+
+void ThreadPoolInit(struct ThreadPool* pool, size_t threads, const char* name) {
+	memset(pool, 0, sizeof(*pool));
+	pool->name = name;
+	MutexInit(&pool->mutex);
+	ConditionInit(&pool->work);
+	ConditionInit(&pool->done);
+#ifndef DISABLE_THREADING
+	if (threads > 1) {
+		pool->nThreads = threads - 1;
+		pool->threads = calloc(pool->nThreads, sizeof(*pool->threads));
+		size_t i;
+		for (i = 0; i < pool->nThreads; ++i) {
+			ThreadCreate(&pool->threads[i], _poolThread, pool);
+		}
+	}
+#else
+	UNUSED(threads);
+#endif
+}
+
+void ThreadPoolDeinit(struct ThreadPool* pool) {
+#ifndef DISABLE_THREADING
+	MutexLock(&pool->mutex);
+	pool->shutdown = true;
+	ConditionWake(&pool->work);
+	MutexUnlock(&pool->mutex);
+	size_t i;
+	for (i = 0; i < pool->nThreads; ++i) {
+		ThreadJoin(pool->threads[i]);
+	}
+	free(pool->threads);
+	pool->threads = NULL;
+	pool->nThreads = 0;
+#endif
+	ConditionDeinit(&pool->done);
+	ConditionDeinit(&pool->work);
+	MutexDeinit(&pool->mutex);
+}
+
+void ThreadPoolRun(struct ThreadPool* pool, size_t count, ThreadPoolJob job, void* context) {
+	if (!count) {
+		return;
+	}
+	MutexLock(&pool->mutex);
+	pool->job = job;
+	pool->context = context;
+	pool->next = 0;
+	pool->end = count;
+	pool->finished = 0;
+	ConditionWake(&pool->work);
+	_drain(pool);
+	while (pool->finished < count) {
+		ConditionWait(&pool->done, &pool->mutex);
+	}
+	MutexUnlock(&pool->mutex);
+}
@@ -5,6 +5,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <mgba-util/vfs.h>
 
+#include <mgba-util/archive-cache.h>
 #include <mgba-util/string.h>
 
 #ifdef PSP2
@@ -99,14 +100,25 @@ struct VFile* VFileOpen(const char* path, int flags) {
 struct VDir* VDirOpenArchive(const char* path) {
 	struct VDir* dir = 0;
 	UNUSED(path);
+#if defined(USE_LIBZIP) || defined(USE_ZLIB) || defined(USE_LZMA)
+	bool (*entryCRC32)(struct VDir*, const char*, uint32_t*) = NULL;
+#endif
 #if defined(USE_LIBZIP) || defined(USE_ZLIB)
 	if (!dir) {
 		dir = VDirOpenZip(path, 0);
+		entryCRC32 = VDirZipEntryCRC32;
 	}
 #endif
 #ifdef USE_LZMA
 	if (!dir) {
 		dir = VDirOpen7z(path, 0);
+		entryCRC32 = VDir7zEntryCRC32;
+	}
+#endif
+#if defined(USE_LIBZIP) || defined(USE_ZLIB) || defined(USE_LZMA)
+	struct ArchiveCache* cache = ArchiveCacheGetDefault();
+	if (dir && cache) {
+		dir = ArchiveCacheWrap(cache, path, dir, entryCRC32);
 	}
 #endif
 	return dir;
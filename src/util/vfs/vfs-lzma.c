@@ -236,21 +236,7 @@ struct VDirEntry* _vd7zListNext(struct VDir* vd) {
 	return &vd7z->dirent.d;
 }
 
-struct VFile* _vd7zOpenFile(struct VDir* vd, const char* path, int mode) {
-	UNUSED(mode);
-	// TODO: support truncating, appending and creating, and write
-	struct VDir7z* vd7z = (struct VDir7z*) vd;
-
-	if ((mode & O_RDWR) == O_RDWR) {
-		// Read/Write support is not yet implemented.
-		return 0;
-	}
-
-	if (mode & O_WRONLY) {
-		// Write support is not yet implemented.
-		return 0;
-	}
-
+static UInt32 _vd7zFindFile(struct VDir7z* vd7z, const char* path) {
 	size_t pathLength = strlen(path);
 
 	UInt32 i;
@@ -269,7 +255,25 @@ struct VFile* _vd7zOpenFile(struct VDir* vd, const char* path, int mode) {
 
 		free(name);
 	}
+	return i;
+}
+
+struct VFile* _vd7zOpenFile(struct VDir* vd, const char* path, int mode) {
+	UNUSED(mode);
+	// TODO: support truncating, appending and creating, and write
+	struct VDir7z* vd7z = (struct VDir7z*) vd;
+
+	if ((mode & O_RDWR) == O_RDWR) {
+		// Read/Write support is not yet implemented.
+		return 0;
+	}
+
+	if (mode & O_WRONLY) {
+		// Write support is not yet implemented.
+		return 0;
+	}
 
+	UInt32 i = _vd7zFindFile(vd7z, path);
 	if (i == vd7z->db.NumFiles) {
 		return 0; // No file found
 	}
@@ -306,6 +310,16 @@ struct VFile* _vd7zOpenFile(struct VDir* vd, const char* path, int mode) {
 	return &vf->d;
 }
 
+bool VDir7zEntryCRC32(struct VDir* vd, const char* path, uint32_t* crc32) {
+	struct VDir7z* vd7z = (struct VDir7z*) vd;
+	UInt32 i = _vd7zFindFile(vd7z, path);
+	if (i == vd7z->db.NumFiles || !SzBitWithVals_Check(&vd7z->db.CRCs, i)) {
+		return false;
+	}
+	*crc32 = vd7z->db.CRCs.Vals[i];
+	return true;
+}
+
 struct VDir* _vd7zOpenDir(struct VDir* vd, const char* path) {
 	UNUSED(vd);
 	UNUSED(path);
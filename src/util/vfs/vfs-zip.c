@@ -413,6 +413,16 @@ struct VFile* _vdzOpenFile(struct VDir* vd, const char* path, int mode) {
 	return &vfz->d;
 }
 
+bool VDirZipEntryCRC32(struct VDir* vd, const char* path, uint32_t* crc32) {
+	struct VDirZip* vdz = (struct VDirZip*) vd;
+	struct zip_stat s;
+	if (zip_stat(vdz->z, path, 0, &s) < 0 || !(s.valid & ZIP_STAT_CRC)) {
+		return false;
+	}
+	*crc32 = s.crc;
+	return true;
+}
+
 struct VDir* _vdzOpenDir(struct VDir* vd, const char* path) {
 	UNUSED(vd);
 	UNUSED(path);
@@ -641,6 +651,19 @@ struct VFile* _vdzOpenFile(struct VDir* vd, const char* path, int mode) {
 	return &vfz->d;
 }
 
+bool VDirZipEntryCRC32(struct VDir* vd, const char* path, uint32_t* crc32) {
+	struct VDirZip* vdz = (struct VDirZip*) vd;
+	if (unzLocateFile(vdz->z, path, 0) != UNZ_OK) {
+		return false;
+	}
+	unz_file_info64 info;
+	if (unzGetCurrentFileInfo64(vdz->z, &info, 0, 0, 0, 0, 0, 0) < 0) {
+		return false;
+	}
+	*crc32 = info.crc;
+	return true;
+}
+
 struct VDir* _vdzOpenDir(struct VDir* vd, const char* path) {
 	UNUSED(vd);
 	UNUSED(path);